@@ -29,6 +29,7 @@ set(header_rppanda_gui
 set(header_rppanda_interval
     "${PROJECT_SOURCE_DIR}/render_pipeline/rppanda/interval/actor_interval.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rppanda/interval/lerp_interval.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rppanda/interval/lerp_interval_batch.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rppanda/interval/meta_interval.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rppanda/interval/sound_interval.hpp"
 )
@@ -61,6 +62,7 @@ set(header_rpcore
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/render_target.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/rpobject.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/stage_manager.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/temporal_manager.hpp"
 )
 
 set(header_rpcore_gui
@@ -70,6 +72,7 @@ set(header_rpcore_gui
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/gui/draggable_window.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/gui/error_message_display.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/gui/labeled_checkbox.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/gui/overlay_batch.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/gui/slider.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/gui/sprite.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/gui/text.hpp"
@@ -128,18 +131,27 @@ set(header_rpcore_stages
 
 set(header_rpcore_util
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/basic_effects.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/bilateral_upscaler.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/cpu_light_culler.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/cubemap_filter.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/dynamic_resolution_controller.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/frame_pacer.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/generic.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/light_data_codec.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/line_node.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/instancing_node.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/movement_controller.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/occlusion_culler.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/points_node.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/post_process_region.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/primitives.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/rpgeomnode.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/rpmaterial.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/rprender_state.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/separable_blur.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/shader_input_blocks.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/shader_variant_manifest.hpp"
+    "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/stage_fusion_planner.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/task_scheduler.hpp"
     "${PROJECT_SOURCE_DIR}/render_pipeline/rpcore/util/rptextnode.hpp"
 )
@@ -212,6 +224,7 @@ set(source_rppanda_interval
     "${PROJECT_SOURCE_DIR}/src/rppanda/interval/config_rppanda_interval.cpp"
     "${PROJECT_SOURCE_DIR}/src/rppanda/interval/config_rppanda_interval.hpp"
     "${PROJECT_SOURCE_DIR}/src/rppanda/interval/lerp_interval.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rppanda/interval/lerp_interval_batch.cpp"
     "${PROJECT_SOURCE_DIR}/src/rppanda/interval/meta_interval.cpp"
     "${PROJECT_SOURCE_DIR}/src/rppanda/interval/sound_interval.cpp"
 )
@@ -246,6 +259,8 @@ set(source_rpcore
     "${PROJECT_SOURCE_DIR}/src/rpcore/gpu_command_queue.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/gpu_command_queue.hpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/image.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/light_command_buffer.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/light_command_buffer.hpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/light_manager.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/loader.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/logger_manager.cpp"
@@ -255,6 +270,7 @@ set(source_rpcore
     "${PROJECT_SOURCE_DIR}/src/rpcore/render_target.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/rpobject.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/stage_manager.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/temporal_manager.cpp"
 )
 
 set(source_rpcore_gui
@@ -272,6 +288,7 @@ set(source_rpcore_gui
     "${PROJECT_SOURCE_DIR}/src/rpcore/gui/labeled_checkbox.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/gui/loading_screen.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/gui/loading_screen.hpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/gui/overlay_batch.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/gui/pipe_viewer.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/gui/pipe_viewer.hpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/gui/pixel_inspector.cpp"
@@ -329,23 +346,32 @@ set(source_rpcore_stages
 
 set(source_rpcore_util
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/basic_effects.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/util/bilateral_upscaler.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/util/cpu_light_culler.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/cubemap_filter.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/display_shader_builder.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/display_shader_builder.hpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/util/dynamic_resolution_controller.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/util/frame_pacer.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/generic.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/util/light_data_codec.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/line_node.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/ies_profile_loader.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/ies_profile_loader.hpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/instancing_node.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/movement_controller.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/util/occlusion_culler.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/points_node.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/post_process_region.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/primitives.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/rpgeomnode.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/rprender_state.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/util/separable_blur.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/shader_input_blocks.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/util/shader_variant_manifest.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/smooth_connected_curve.hpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/smooth_connected_curve.cpp"
+    "${PROJECT_SOURCE_DIR}/src/rpcore/util/stage_fusion_planner.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/task_scheduler.cpp"
     "${PROJECT_SOURCE_DIR}/src/rpcore/util/rptextnode.cpp"
 )
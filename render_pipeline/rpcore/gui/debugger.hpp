@@ -47,6 +47,7 @@ class ExposureWidget;
 class FPSChart;
 class PixelInspector;
 class RenderModeSelector;
+class OverlayBatch;
 
 class RENDER_PIPELINE_DECL Debugger : public RPObject
 {
@@ -105,6 +106,9 @@ public:
 
     ErrorMessageDisplay* get_error_msg_handler() const;
 
+    /** Returns the batch of the stats overlay to read its draw and regeneration counters. */
+    const OverlayBatch* get_overlay_batch() const;
+
 private:
     RenderPipeline* pipeline;
     NodePath fullscreen_node;
@@ -129,7 +133,8 @@ private:
     bool debugger_visible;
     float gui_scale;
 
-    std::vector<std::unique_ptr<rpcore::TextNode>> debug_lines_;
+    std::unique_ptr<OverlayBatch> overlay_batch_;
+    std::vector<size_t> debug_lines_;
 };
 
 inline bool Debugger::is_gui_visible() const
@@ -142,4 +147,9 @@ inline ErrorMessageDisplay* Debugger::get_error_msg_handler() const
     return error_msg_handler_.get();
 }
 
+inline const OverlayBatch* Debugger::get_overlay_batch() const
+{
+    return overlay_batch_.get();
+}
+
 }
@@ -0,0 +1,205 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <nodePath.h>
+#include <renderState.h>
+#include <texture.h>
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <render_pipeline/rpcore/rpobject.hpp>
+
+class TextFont;
+class GeomNode;
+
+namespace rpcore {
+
+/**
+ * Batched renderer for 2D text and sprites of the debugger overlay.
+ *
+ * Each item is laid out into quads only when its content changed, and the quads of
+ * all items in a layer are merged into one Geom per texture (glyph page of the
+ * shared font or sprite image). Thus, a layer costs one draw per atlas page
+ * instead of one node per label.
+ *
+ * Items are positioned in the space of the parent node (x right, z up).
+ * Changes are applied in update(), and the counters can be read without a window.
+ */
+class RENDER_PIPELINE_DECL OverlayBatch : public RPObject
+{
+public:
+    using ItemHandle = size_t;
+
+    enum class Align
+    {
+        left = 0,
+        right,
+        center,
+    };
+
+    /** Quad with (left, bottom, right, top) dimensions and texcoords. */
+    struct Quad
+    {
+        LVecBase4f dimensions;
+        LVecBase4f texcoords;
+        LColorf color;
+    };
+
+    /** Metrics of a glyph in font units. @a state is used as the batch key. */
+    struct Glyph
+    {
+        LVecBase4f dimensions;
+        LVecBase4f texcoords;
+        float advance;
+        bool has_quad;
+        CPT(RenderState) state;
+    };
+
+    using GlyphLookup = std::function<bool(int character, Glyph& glyph)>;
+    using BatchQuad = std::pair<CPT(RenderState), Quad>;
+
+    /**
+     * Lay out the text into quads. Lines are separated by '\n', and each line is
+     * aligned at @p pos independently. @p size is the scale from font units.
+     *
+     * @return  The number of glyphs which have a quad.
+     */
+    static size_t layout_text(const std::wstring& text, const GlyphLookup& lookup, float line_height,
+        Align align, const LVecBase2f& pos, float size, const LColorf& color, std::vector<BatchQuad>& out);
+
+    /** Count the distinct batch keys of the quads, that is, the number of draws. */
+    static size_t count_batches(const std::vector<BatchQuad>& quads);
+
+public:
+    /** Create the batch under @p parent using @p font for all text items. */
+    OverlayBatch(NodePath parent, TextFont* font);
+    ~OverlayBatch();
+
+    NodePath get_np() const;
+
+    ItemHandle add_text(const std::string& text, const LVecBase2f& pos, float size,
+        const LColorf& color=LColorf(1), Align align=Align::left, int layer=0);
+
+    ItemHandle add_sprite(Texture* texture, const LVecBase2f& pos, const LVecBase2f& size,
+        const LColorf& color=LColorf(1), int layer=0);
+
+    void remove_item(ItemHandle handle);
+
+    /** Set the text. This does nothing if the text is not changed. */
+    void set_text(ItemHandle handle, const std::string& text);
+    const std::string& get_text(ItemHandle handle) const;
+
+    void set_pos(ItemHandle handle, const LVecBase2f& pos);
+    void set_size(ItemHandle handle, float size);
+    void set_color(ItemHandle handle, const LColorf& color);
+    void set_visible(ItemHandle handle, bool visible);
+
+    /** Re-layout the dirty items and rebuild the geometry of the dirty layers. */
+    void update();
+
+    /** Number of Geoms which are submitted, that is, draws per frame. */
+    size_t get_num_draw_calls() const;
+
+    /** Number of item layouts since the last reset_counters(). */
+    size_t get_num_item_regenerations() const;
+
+    /** Number of layer geometry rebuilds since the last reset_counters(). */
+    size_t get_num_layer_regenerations() const;
+
+    /** Number of set_text() calls skipped because the text was not changed. */
+    size_t get_num_skipped_updates() const;
+
+    void reset_counters();
+
+private:
+    struct Item
+    {
+        bool alive;
+        bool visible;
+        bool dirty;
+        int layer;
+        std::string text;
+        PT(Texture) texture;
+        LVecBase2f pos;
+        LVecBase2f size;
+        LColorf color;
+        Align align;
+        std::vector<BatchQuad> quads;
+    };
+
+    struct Layer
+    {
+        NodePath np;
+        PT(GeomNode) node;
+        bool dirty = true;
+    };
+
+    ItemHandle add_item(Item&& item);
+    Item& get_item(ItemHandle handle);
+    Layer& get_layer(int layer);
+    void mark_dirty(Item& item);
+    void layout_item(Item& item);
+    void rebuild_layer(int layer_index, Layer& layer);
+
+    NodePath root_;
+    TextFont* font_;
+    GlyphLookup lookup_;
+
+    std::vector<Item> items_;
+    std::map<int, Layer> layers_;
+
+    size_t num_draw_calls_ = 0;
+    size_t num_item_regenerations_ = 0;
+    size_t num_layer_regenerations_ = 0;
+    size_t num_skipped_updates_ = 0;
+};
+
+// ************************************************************************************************
+
+inline NodePath OverlayBatch::get_np() const
+{
+    return root_;
+}
+
+inline size_t OverlayBatch::get_num_draw_calls() const
+{
+    return num_draw_calls_;
+}
+
+inline size_t OverlayBatch::get_num_item_regenerations() const
+{
+    return num_item_regenerations_;
+}
+
+inline size_t OverlayBatch::get_num_layer_regenerations() const
+{
+    return num_layer_regenerations_;
+}
+
+inline size_t OverlayBatch::get_num_skipped_updates() const
+{
+    return num_skipped_updates_;
+}
+
+}
@@ -24,7 +24,10 @@
 
 #include <texture.h>
 
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 #include <utility>
 
 #include <render_pipeline/rpcore/config.hpp>
@@ -42,49 +45,122 @@ class RENDER_PIPELINE_DECL Image
 public:
     using ComponentFormatType = std::pair<Texture::ComponentType, Texture::Format>;
 
+    /** @deprecated Use Format and get_format_info(). */
     static const std::unordered_map<std::string, ComponentFormatType> FORMAT_MAPPING;
 
-    // All registered images
-    static std::vector<Image*> REGISTERED_IMAGES;
+    /** Supported component formats. */
+    enum class Format : int
+    {
+        R11G11B10 = 0,
+        RGBA8,
+        RGBA16,
+        RGBA32,
+        R8,
+        R8UI,
+        R16,
+        R16UI,
+        R32,
+        R32I,
+
+        COUNT
+    };
+
+    struct FormatInfo
+    {
+        const char* name;
+        Texture::ComponentType component_type;
+        Texture::Format format;
+        int bytes_per_texel;
+    };
+
+    static const FormatInfo& get_format_info(Format format);
+
+    /** Find the format from the name (ex, "RGBA16"). Return false if not supported. */
+    static bool parse_format(const std::string& name, Format& format);
+
+    /**
+     * Registered images. These are thread-safe and replace REGISTERED_IMAGES.
+     * Each image keeps its slot, and removal leaves an empty slot, so it is O(1) and
+     * the images stay in the order of creation. Empty slots are compacted in batches.
+     */
+    ///@{
+    static size_t get_num_registered_images();
+
+    /** Sum of estimated sizes of all registered images. */
+    static size_t get_registered_images_size();
+
+    /**
+     * Registered image in a snapshot. This holds the texture, so the snapshot is valid
+     * even if the image is destroyed by another thread.
+     */
+    struct RegisteredImage
+    {
+        PT(Texture) texture;
+        int sort;
+        size_t size_in_bytes;
+    };
+
+    /** Return a snapshot of the registered images in the order of creation. */
+    static std::vector<RegisteredImage> get_registered_images();
+    ///@}
 
     /** Creates a new buffer texture. */
     static std::unique_ptr<Image> create_buffer(const std::string& name, int size, const std::string& component_format);
+    static std::unique_ptr<Image> create_buffer(const std::string& name, int size, Format format);
 
     /** Creates a new 1x1 R32I texture to be used as an atomic counter. */
     static std::unique_ptr<Image> create_counter(const std::string& name);
 
     /** Creates a new 2D texture. */
     static std::unique_ptr<Image> create_2d(const std::string& name, int w, int h, const std::string& component_format);
+    static std::unique_ptr<Image> create_2d(const std::string& name, int w, int h, Format format);
 
     /** Creates a new 2D-array texture. */
     static std::unique_ptr<Image> create_2d_array(const std::string& name, int w, int h, int slices, const std::string& component_format);
+    static std::unique_ptr<Image> create_2d_array(const std::string& name, int w, int h, int slices, Format format);
 
     /** Creates a new 3D texture. */
     static std::unique_ptr<Image> create_3d(const std::string& name, int w, int h, int slices, const std::string& component_format);
+    static std::unique_ptr<Image> create_3d(const std::string& name, int w, int h, int slices, Format format);
 
     /** Creates a new cubemap */
     static std::unique_ptr<Image> create_cube(const std::string& name, int size, const std::string& component_format);
+    static std::unique_ptr<Image> create_cube(const std::string& name, int size, Format format);
 
     /** Creates a new cubemap. */
     static std::unique_ptr<Image> create_cube_array(const std::string& name, int size, int num_cubemaps, const std::string& component_format);
+    static std::unique_ptr<Image> create_cube_array(const std::string& name, int size, int num_cubemaps, Format format);
 
     static const ComponentFormatType& convert_texture_format(const std::string& comp_type);
 
     Image(const std::string& name);
+    Image(const Image&) = delete;
+
     ~Image();
 
+    Image& operator=(const Image&) = delete;
+
     void setup_buffer(int size, const std::string& component_format);
+    void setup_buffer(int size, Format format);
     void setup_counter();
     void setup_2d(int w, int h, const std::string& component_format);
+    void setup_2d(int w, int h, Format format);
     void setup_2d_array(int w, int h, int slices, const std::string& component_format);
+    void setup_2d_array(int w, int h, int slices, Format format);
     void setup_3d(int w, int h, int slices, const std::string& component_format);
+    void setup_3d(int w, int h, int slices, Format format);
     void setup_cube(int size, const std::string& component_format);
+    void setup_cube(int size, Format format);
     void setup_cube_array(int size, int num_cubemaps, const std::string& component_format);
+    void setup_cube_array(int size, int num_cubemaps, Format format);
 
     int get_sort() const;
 
     Texture* get_texture() const;
 
+    /** Estimated size in bytes, which is computed in setup and resizing. */
+    size_t get_size_in_bytes() const;
+
     void set_clear_color(const LColor& color);
     void clear_image();
 
@@ -100,6 +176,18 @@ public:
     void set_wrap_w(Texture::WrapMode wrap);
 
 private:
+    static Format to_format(const std::string& component_format);
+    void update_size_in_bytes();
+
+    static std::mutex registry_mutex_;
+    static std::vector<Image*> registry_;
+    static size_t registry_count_;
+    static std::atomic<size_t> registry_size_;
+
+    size_t registry_slot_;
+    Format format_ = Format::COUNT;
+    size_t size_in_bytes_ = 0;
+
     int sort_;
     PT(Texture) texture_;
 };
@@ -116,6 +204,11 @@ inline Texture* Image::get_texture() const
     return texture_;
 }
 
+inline size_t Image::get_size_in_bytes() const
+{
+    return size_in_bytes_;
+}
+
 inline void Image::set_clear_color(const LColor& color)
 {
     texture_->set_clear_color(color);
@@ -129,16 +222,19 @@ inline void Image::clear_image()
 inline void Image::set_x_size(int x_size)
 {
     texture_->set_x_size(x_size);
+    update_size_in_bytes();
 }
 
 inline void Image::set_y_size(int y_size)
 {
     texture_->set_y_size(y_size);
+    update_size_in_bytes();
 }
 
 inline void Image::set_z_size(int z_size)
 {
     texture_->set_z_size(z_size);
+    update_size_in_bytes();
 }
 
 inline void Image::set_minfilter(Texture::FilterType filter)
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include <lvecBase2.h>
 #include <pta_int.h>
 
@@ -34,6 +36,7 @@ class RPLight;
 class InternalLightManager;
 class ShadowManager;
 class GPUCommandQueue;
+class LightCommandBuffer;
 class Image;
 
 class FlagUsedCellsStage;
@@ -85,6 +88,31 @@ public:
     /** Removes a light. */
     void remove_light(RPLight* light);
 
+    /**
+     * Queues a light to be added at the start of the next update. Unlike
+     * add_light, this can be called from any thread.
+     */
+    void queue_add_light(PT(RPLight) light);
+
+    /** Queues a light to be removed at the start of the next update. Thread-safe. */
+    void queue_remove_light(PT(RPLight) light);
+
+    /**
+     * Queues a function which changes properties of a light. The function
+     * runs on the main thread during the next update, so it may call any
+     * RPLight setter. Thread-safe.
+     */
+    void queue_light_update(PT(RPLight) light, std::function<void(RPLight*)> func);
+
+    /** Returns the amount of queued light commands which are not applied yet. */
+    size_t get_num_queued_light_commands() const;
+
+    /**
+     * Applies all queued light commands in submission order. This is called
+     * by update, and returns the amount of applied commands.
+     */
+    size_t commit_queued_lights();
+
     void update();
 
     /** Reloads all assigned shaders. */
@@ -119,6 +147,10 @@ public:
 
     GPUCommandQueue* get_cmd_queue() const;
 
+    const InternalLightManager* get_internal_mgr() const;
+
+    const ShadowManager* get_shadow_mgr() const;
+
 private:
     RenderPipeline& pipeline_;
     LVecBase2i tile_size_;
@@ -126,6 +158,7 @@ private:
     std::unique_ptr<InternalLightManager> internal_mgr_;
     std::unique_ptr<ShadowManager> shadow_manager_;
     std::unique_ptr<GPUCommandQueue> cmd_queue_;
+    std::unique_ptr<LightCommandBuffer> light_cmd_buffer_;
 
     std::unique_ptr<Image> img_light_data_;
     std::unique_ptr<Image> img_source_data_;
@@ -150,4 +183,14 @@ inline GPUCommandQueue* LightManager::get_cmd_queue() const
     return cmd_queue_.get();
 }
 
+inline const ShadowManager* LightManager::get_shadow_mgr() const
+{
+    return shadow_manager_.get();
+}
+
+inline const InternalLightManager* LightManager::get_internal_mgr() const
+{
+    return internal_mgr_.get();
+}
+
 }
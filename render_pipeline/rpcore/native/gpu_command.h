@@ -61,6 +61,7 @@ class GPUCommand
             CMD_remove_light = 2,
             CMD_store_source = 3,
             CMD_remove_sources = 4,
+            CMD_store_light_delta = 5,
 
             CMD_type_count,
         };
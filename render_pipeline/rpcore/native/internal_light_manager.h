@@ -35,6 +35,8 @@
 #include "pointer_slot_storage.h"
 #include "gpu_command_list.h"
 
+#include "render_pipeline/rpcore/util/light_data_codec.hpp"
+
 #define MAX_LIGHT_COUNT 65535
 #define MAX_SHADOW_SOURCES 2048
 
@@ -77,6 +79,10 @@ class InternalLightManager {
 
         inline void set_command_list(GPUCommandList *cmd_list);
 
+        inline void set_compact_light_updates(bool enabled);
+        inline bool get_compact_light_updates() const;
+        MAKE_PROPERTY(compact_light_updates, get_compact_light_updates, set_compact_light_updates);
+
     protected:
         void gpu_update_light(RPLight* light);
         void gpu_update_source(ShadowSource* source);
@@ -88,6 +94,7 @@ class InternalLightManager {
 
         void update_lights();
         void update_shadow_sources();
+        void flush_light_updates();
 
         GPUCommandList* _cmd_list;
         ShadowManager* _shadow_manager;
@@ -97,6 +104,10 @@ class InternalLightManager {
 
         LPoint3 _camera_pos;
         PN_stdfloat _shadow_update_distance;
+
+        bool _compact_light_updates;
+        LightDataCodec::DeltaEncoder _light_encoder;
+        PTA_uchar _light_command_data;
 };
 
 }
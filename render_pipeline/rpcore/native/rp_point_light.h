@@ -41,6 +41,16 @@ namespace rpcore {
 class RENDER_PIPELINE_DECL RPPointLight  : public RPLight
 {
     PUBLISHED:
+        /**
+         * Layout of the shadow sources. SM_cube renders six 90 degree faces,
+         * SM_tetrahedral covers the sphere with four wide faces, saving two
+         * cull and draw passes per light at the cost of some resolution.
+         */
+        enum ShadowMode {
+            SM_cube = 0,
+            SM_tetrahedral = 1,
+        };
+
         RPPointLight();
 
         inline void set_radius(float radius);
@@ -51,6 +61,15 @@ class RENDER_PIPELINE_DECL RPPointLight  : public RPLight
         inline float get_inner_radius() const;
         MAKE_PROPERTY(inner_radius, get_inner_radius, set_inner_radius);
 
+        inline void set_shadow_mode(ShadowMode mode);
+        inline ShadowMode get_shadow_mode() const;
+        MAKE_PROPERTY(shadow_mode, get_shadow_mode, set_shadow_mode);
+
+        static size_t get_num_shadow_faces(ShadowMode mode);
+        static float get_shadow_face_fov(ShadowMode mode);
+        static const LVecBase3f& get_shadow_face_direction(ShadowMode mode, size_t face);
+        static size_t find_shadow_face(ShadowMode mode, const LVecBase3f& direction);
+
     public:
         virtual void write_to_command(GPUCommand &cmd);
         virtual void update_shadow_sources();
@@ -59,6 +78,7 @@ class RENDER_PIPELINE_DECL RPPointLight  : public RPLight
     protected:
         float _radius;
         float _inner_radius;
+        ShadowMode _shadow_mode;
 };
 
 }
@@ -70,6 +70,7 @@ class ShadowManager  : public ReferenceCount
 
     public:
         inline bool add_update(const ShadowSource* source);
+        inline const pvector<LMatrix4f>& get_updated_mvps() const;
 
     private:
         size_t _max_updates;
@@ -86,6 +87,7 @@ class ShadowManager  : public ReferenceCount
 
         typedef pvector<const ShadowSource*> UpdateQueue;
         UpdateQueue _queued_updates;
+        pvector<LMatrix4f> _updated_mvps;
 };
 
 }
@@ -48,11 +48,16 @@ class TaskScheduler;
 class MountManager;
 class TagStateManager;
 class LightManager;
+class TemporalManager;
 class RPLight;
 class DayTimeManager;
 class IESProfileLoader;
 class PluginManager;
 class Debugger;
+class OcclusionCuller;
+class FramePacer;
+class DynamicResolutionController;
+class ShaderVariantManifest;
 
 class RENDER_PIPELINE_DECL RenderPipeline : public RPObject
 {
@@ -142,6 +147,14 @@ public:
 
     void remove_light(RPLight* light);
 
+    /**
+     * Thread-safe variants of add_light and remove_light. The change is
+     * deferred and committed at the start of the next light update.
+     */
+    void queue_add_light(RPLight* light);
+
+    void queue_remove_light(RPLight* light);
+
     /**
      * Loads an IES profile from a given filename and returns a handle which
      * can be used to set an ies profile on a light.
@@ -214,11 +227,24 @@ public:
     StageManager* get_stage_mgr() const;
     TagStateManager* get_tag_mgr() const;
     LightManager* get_light_mgr() const;
+    TemporalManager* get_temporal_mgr() const;
     PluginManager* get_plugin_mgr() const;
     TaskScheduler* get_task_scheduler() const;
     DayTimeManager* get_daytime_mgr() const;
     Debugger* get_debugger() const;
 
+    /** Return OcclusionCuller if `pipeline.occlusion_culling` is enabled. Otherwise, nullptr. */
+    OcclusionCuller* get_occlusion_culler() const;
+
+    /** Return FramePacer if `pipeline.frame_pacing` is enabled. Otherwise, nullptr. */
+    FramePacer* get_frame_pacer() const;
+
+    /** Return DynamicResolutionController if `pipeline.dynamic_resolution` is enabled. Otherwise, nullptr. */
+    DynamicResolutionController* get_dynamic_resolution_controller() const;
+
+    /** Return ShaderVariantManifest if `pipeline.shader_variant_manifest` is enabled. Otherwise, nullptr. */
+    ShaderVariantManifest* get_shader_variant_manifest() const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl_;
@@ -65,6 +65,17 @@ public:
         std::shared_ptr<GroupedInputBlock>>>;
     using DefinesType = std::unordered_map<std::string, std::string>;
 
+    /**
+     * Per-pixel function of a point-wise stage. The include file defines
+     * `vec3 name(vec3 scene_color, vec2 texcoord)`, which returns the result
+     * of the stage for the ShadedScene color of the pixel.
+     */
+    struct PointwiseFunction
+    {
+        Filename include;
+        std::string name;
+    };
+
     RenderStage(RenderPipeline& pipeline, boost::string_view stage_id);
     RenderStage(const RenderStage&) = delete;
     RenderStage(RenderStage&&);
@@ -82,6 +93,15 @@ public:
 
     virtual DefinesType get_produced_defines() const;
 
+    /**
+     * Return the per-pixel function if this stage is point-wise. Otherwise, the name is empty.
+     *
+     * A point-wise stage reads only the same pixel of "ShadedScene", writes "ShadedScene"
+     * with a single screen-sized target and produces nothing else. StageManager merges
+     * adjacent point-wise stages into the target of the last one of them.
+     */
+    virtual PointwiseFunction get_pointwise_function() const;
+
     virtual void* downcast() = 0;
     virtual const void* downcast() const = 0;
 
@@ -101,6 +121,33 @@ public:
 
     bool get_disabled() const;
 
+    /**
+     * Stage which renders this stage after the fusion, or nullptr.
+     * Shader inputs of this stage and of its targets are also set to the host.
+     * This has to be set before the stage is created.
+     */
+    RenderStage* get_fusion_host() const;
+    void set_fusion_host(RenderStage* host);
+
+    /**
+     * Whether this stage is in a group of fused stages, as fused stage or as host.
+     * Changing the activity of a fused stage rebuilds the pass of the group.
+     */
+    bool get_fused() const;
+    void set_fused(bool fused);
+
+    /**
+     * Moves this fused stage into its host after the host is created. The shader inputs set so
+     * far are sent to the host, and the own targets are removed.
+     */
+    void attach_to_fusion_host();
+
+    /** Sets the shader on all targets of this stage. */
+    void set_targets_shader(const Shader* shader);
+
+    /** Sets the activity of all targets without changing the activity of the stage. */
+    void set_targets_active(bool state);
+
     /**
      * Create target and store it to RenderStage::targets.
      */
@@ -137,6 +184,9 @@ protected:
 
     PT(Shader) get_shader_handle(const Filename& path, const std::vector<Filename>& args, bool stereo_post = false, bool use_post_gs = false) const;
 
+    /** Returns the path of the given file in the shader directory of the plugin. */
+    Filename get_plugin_shader_path(const Filename& path) const;
+
     RenderPipeline& pipeline_;
     bool disabled_ = false;
 
@@ -144,6 +194,13 @@ private:
     std::unordered_map<std::string, std::unique_ptr<RenderTarget>> targets_;
     const std::string stage_id_;
     bool active_ = true;
+
+    void forward_to_fusion_host(const ShaderInput& inp);
+
+    RenderStage* fusion_host_ = nullptr;
+    bool fused_ = false;
+    bool attached_to_fusion_host_ = false;
+    std::vector<ShaderInput> fusion_inputs_;
 };
 
 // ************************************************************************************************
@@ -163,6 +220,26 @@ inline bool RenderStage::get_disabled() const
     return disabled_;
 }
 
+inline RenderStage* RenderStage::get_fusion_host() const
+{
+    return fusion_host_;
+}
+
+inline void RenderStage::set_fusion_host(RenderStage* host)
+{
+    fusion_host_ = host;
+}
+
+inline bool RenderStage::get_fused() const
+{
+    return fused_;
+}
+
+inline void RenderStage::set_fused(bool fused)
+{
+    fused_ = fused;
+}
+
 inline const std::unordered_map<std::string, std::unique_ptr<RenderTarget>>& RenderStage::get_targets() const
 {
     return targets_;
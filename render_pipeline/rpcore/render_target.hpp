@@ -25,6 +25,7 @@
 #include <graphicsOutput.h>
 #include <texture.h>
 
+#include <functional>
 #include <unordered_map>
 #include <vector>
 
@@ -126,6 +127,12 @@ public:
     /** Sets a shader input available to the target. */
     void set_shader_input(const ShaderInput& inp, bool override_input=false);
 
+    /**
+     * Calls @p func with every shader input set to this target, also after the target is removed.
+     * This is used to move the inputs of a fused stage to its host.
+     */
+    void set_shader_input_forward(std::function<void(const ShaderInput&)> func);
+
     void set_shader(const Shader* sha);
 
     GraphicsBuffer* get_internal_buffer() const;
@@ -70,7 +70,10 @@ public:
     void add_input_blocks(const std::shared_ptr<SimpleInputBlock>& input_block);
     void add_input_blocks(const std::shared_ptr<GroupedInputBlock>& input_block);
 
-    /** Setups the stages. */
+    /**
+     * Setups the stages. If `pipeline.stage_fusion` is enabled, adjacent
+     * point-wise stages are rendered in one pass by the last of them.
+     */
     void setup();
 
     /**
@@ -83,6 +86,13 @@ public:
      */
     void update();
 
+    /**
+     * Rebuilds the pass of the fused group of @p stage after the activity of a
+     * stage in the group changed. The pass renders only the active stages, and
+     * it is disabled if no stage is active.
+     */
+    void update_fused_pass(RenderStage* stage);
+
     /**
      * Method to get called when the window got resized.
      * Propagates the resize event to all registered stages.
@@ -0,0 +1,284 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <lmatrix.h>
+
+#include <deque>
+#include <vector>
+
+#include <render_pipeline/rpcore/image.hpp>
+
+class NodePath;
+class Lens;
+
+namespace rpcore {
+
+/**
+ * Shared bookkeeping for temporal techniques (TAA, temporal upscaling, resolve of SSR and AO, ...).
+ *
+ * This owns the sub-pixel jitter sequence of the main camera, a short history of the view and
+ * projection matrices, and a pool of ping-pong history textures which plugins request by format.
+ * The manager is updated once per frame before the plugins, so get_jitter_index() and the matrices
+ * are those of the frame being rendered.
+ *
+ * Matrices use the row vector convention of Panda3D and only the main (mono) view is tracked.
+ */
+class RENDER_PIPELINE_DECL TemporalManager : public RPObject
+{
+public:
+    /** Camera state of one frame. */
+    struct FrameData
+    {
+        uint64_t frame_index = 0;
+        LMatrix4f view_mat = LMatrix4f::ident_mat();
+        LMatrix4f proj_mat = LMatrix4f::ident_mat();
+        LMatrix4f view_proj_mat = LMatrix4f::ident_mat();
+        LMatrix4f view_proj_mat_no_jitter = LMatrix4f::ident_mat();
+
+        /** Jitter in NDC units which is included in @a proj_mat. */
+        LVecBase2f jitter = LVecBase2f(0.0f);
+    };
+
+    /**
+     * Two textures which are swapped every frame.
+     * The current one is written by the plugin and the previous one holds the last frame.
+     */
+    class RENDER_PIPELINE_DECL HistoryBuffer
+    {
+    public:
+        Texture* get_current() const;
+        Texture* get_previous() const;
+
+        Image::Format get_format() const;
+
+        /** Requested size. -1 means the render resolution. */
+        const LVecBase2i& get_requested_size() const;
+
+        /** Return false until the previous texture has been written once (ex, after creation or resize). */
+        bool has_history() const;
+
+    private:
+        friend class TemporalManager;
+
+        std::unique_ptr<Image> images_[2];
+        int current_ = 0;
+        Image::Format format_;
+        LVecBase2i requested_size_;
+        bool has_history_ = false;
+        size_t num_frames_ = 0;
+        bool in_use_ = false;
+    };
+
+public:
+    /** Return the @p index -th element (starting from 1) of the Halton sequence with @p base. */
+    static float halton(int index, int base);
+
+    /** Generate @p count points in [0, 1)^2 from the Halton sequence. */
+    static std::vector<LVecBase2f> generate_halton_sequence(size_t count, int base_x=2, int base_y=3);
+
+    /** Convert a film offset of Lens to the jitter in NDC units. */
+    static LVecBase2f film_offset_to_ndc(const LVecBase2f& film_offset, const LVecBase2f& film_size);
+
+    /** Remove the NDC translation of @p ndc_jitter from the projection matrix. */
+    static LMatrix4f remove_jitter(const LMatrix4f& proj_mat, const LVecBase2f& ndc_jitter);
+
+public:
+    TemporalManager();
+    TemporalManager(const TemporalManager&) = delete;
+
+    ~TemporalManager();
+
+    TemporalManager& operator=(const TemporalManager&) = delete;
+
+    /**
+     * Set the jitter sequence in the film offset units of Lens.
+     * Only one technique can own the jitter, so this overrides the sequence of others.
+     * An empty sequence disables the jitter.
+     */
+    void set_jitter_sequence(std::vector<LVecBase2f> sequence);
+    const std::vector<LVecBase2f>& get_jitter_sequence() const;
+
+    /** Scale of the jitter sequence (ex, jitter amount setting of a plugin). */
+    void set_jitter_scale(float scale);
+    float get_jitter_scale() const;
+
+    /** Index of the jitter of the current frame. */
+    size_t get_jitter_index() const;
+
+    /** Scaled jitter of the current frame in film offset units. */
+    LVecBase2f get_current_jitter() const;
+
+    /** Move to the next jitter of the sequence. */
+    void advance_jitter();
+
+    /** Set the number of frames kept in the matrix history. At least 2. */
+    void set_history_length(size_t length);
+    size_t get_history_length() const;
+
+    /** Camera movement in world units which is treated as a cut and invalidates the history. 0 disables it. */
+    void set_camera_cut_distance(float distance);
+    float get_camera_cut_distance() const;
+
+    /** Record the matrices of a new frame. @p proj_mat includes @p ndc_jitter. */
+    void begin_frame(const LMatrix4f& view_mat, const LMatrix4f& proj_mat, const LVecBase2f& ndc_jitter);
+
+    /** Return the frame data @p age frames ago. The oldest valid frame is returned if it is too old. */
+    const FrameData& get_frame(size_t age) const;
+    const FrameData& get_current_frame() const;
+    const FrameData& get_previous_frame() const;
+
+    /** Number of frames in the history since the last invalidation, including the current one. */
+    size_t get_num_valid_frames() const;
+
+    /** Return true if the previous frame can be used for reprojection. */
+    bool is_history_valid() const;
+
+    /** Drop the history (ex, on a teleport of the camera). History buffers are marked as empty. */
+    void invalidate_history();
+
+    /**
+     * Return the matrix which transforms the clip space of the current frame to the clip space
+     * of the previous frame without jitter.
+     */
+    LMatrix4f get_reprojection_mat() const;
+
+    /**
+     * Request ping-pong history textures. Released buffers with the same format and size are reused.
+     * @param   size    Size of the textures. -1 in a component means the render resolution.
+     */
+    HistoryBuffer* acquire_history(Image::Format format, const LVecBase2i& size=LVecBase2i(-1));
+    void release_history(HistoryBuffer* buffer);
+
+    size_t get_num_history_buffers() const;
+    size_t get_history_memory_size() const;
+
+    /** Apply the jitter to @p lens, record the matrices of @p camera and swap the history buffers. */
+    void update(const NodePath& camera, Lens* lens);
+
+    /** Resize the history buffers which follow the render resolution. */
+    void handle_window_resize();
+
+private:
+    void resize_buffer(HistoryBuffer& buffer) const;
+
+    std::vector<LVecBase2f> jitter_sequence_;
+    float jitter_scale_ = 1.0f;
+    size_t jitter_index_ = 0;
+    bool jitter_applied_ = false;
+
+    std::deque<FrameData> frames_;
+    size_t history_length_ = 2;
+    size_t num_valid_frames_ = 0;
+    uint64_t frame_counter_ = 0;
+    float camera_cut_distance_ = 0.0f;
+
+    std::vector<std::unique_ptr<HistoryBuffer>> buffers_;
+};
+
+// ************************************************************************************************
+
+inline Texture* TemporalManager::HistoryBuffer::get_current() const
+{
+    return images_[current_]->get_texture();
+}
+
+inline Texture* TemporalManager::HistoryBuffer::get_previous() const
+{
+    return images_[1 - current_]->get_texture();
+}
+
+inline Image::Format TemporalManager::HistoryBuffer::get_format() const
+{
+    return format_;
+}
+
+inline const LVecBase2i& TemporalManager::HistoryBuffer::get_requested_size() const
+{
+    return requested_size_;
+}
+
+inline bool TemporalManager::HistoryBuffer::has_history() const
+{
+    return has_history_;
+}
+
+inline const std::vector<LVecBase2f>& TemporalManager::get_jitter_sequence() const
+{
+    return jitter_sequence_;
+}
+
+inline void TemporalManager::set_jitter_scale(float scale)
+{
+    jitter_scale_ = scale;
+}
+
+inline float TemporalManager::get_jitter_scale() const
+{
+    return jitter_scale_;
+}
+
+inline size_t TemporalManager::get_jitter_index() const
+{
+    return jitter_index_;
+}
+
+inline size_t TemporalManager::get_history_length() const
+{
+    return history_length_;
+}
+
+inline void TemporalManager::set_camera_cut_distance(float distance)
+{
+    camera_cut_distance_ = distance;
+}
+
+inline float TemporalManager::get_camera_cut_distance() const
+{
+    return camera_cut_distance_;
+}
+
+inline const TemporalManager::FrameData& TemporalManager::get_current_frame() const
+{
+    return get_frame(0);
+}
+
+inline const TemporalManager::FrameData& TemporalManager::get_previous_frame() const
+{
+    return get_frame(1);
+}
+
+inline size_t TemporalManager::get_num_valid_frames() const
+{
+    return num_valid_frames_;
+}
+
+inline bool TemporalManager::is_history_valid() const
+{
+    return num_valid_frames_ >= 2;
+}
+
+inline size_t TemporalManager::get_num_history_buffers() const
+{
+    return buffers_.size();
+}
+
+}
@@ -22,54 +22,135 @@
 
 #pragma once
 
-#include <memory>
-#include <string>
+#include <lvecBase2.h>
+#include <lvecBase3.h>
+#include <lvecBase4.h>
+#include <pta_LVecBase3.h>
 
 #include <render_pipeline/rpcore/rpobject.hpp>
 
 class Texture;
-class Shader;
 
 namespace rpcore {
 
+class RenderPipeline;
 class RenderStage;
+class RenderTarget;
 
 /**
- * Class for creating bilateral upscale targets, with features like filling
- * invalid pixels.
+ * Reduced resolution rendering of a stage with a depth-aware bilateral upscale.
+ *
+ * The stage renders into the source target of this class, which has a reduced size
+ * depending on the mode, and its shader gets the full resolution pixel of each texel with
+ * get_reduced_full_coord() in "includes/reduced_resolution.inc.glsl".
+ * The upscale target reconstructs the full resolution image, weighting the rendered
+ * neighbors by the depth and normal similarity with the GBuffer.
+ *
+ * In checkerboard mode, half of the pixels in a checker pattern are rendered,
+ * and the pattern alternates every frame (see update()).
+ *
+ * The static functions are the CPU reference of "reduced_resolution_upscale.frag.glsl".
  */
-class RPCPP_DECL BilateralUpscaler: public RPObject
+class RENDER_PIPELINE_DECL BilateralUpscaler : public RPObject
 {
 public:
-    // Controls how many entries to process in one row.Needs to match the
-    // definition in the fillin shader
-    static const int ROW_WIDTH = 512;
+    enum class Mode : int
+    {
+        full = 0,
+        half,
+        quarter,
+        checkerboard,
+    };
+
+    /** Texel of the source image which is used for a full resolution pixel. */
+    struct Tap
+    {
+        LVecBase2i source_coord;
+
+        /** Full resolution pixel which the texel was rendered for. */
+        LVecBase2i full_coord;
+    };
+
+    static bool parse_mode(const std::string& name, Mode& mode);
+    static const char* get_mode_name(Mode mode);
+
+    /**
+     * Read the mode of the stage from `pipeline.stage_resolution.<stage id>`.
+     * @p fallback is used if the setting is missing or invalid.
+     */
+    static Mode get_stage_mode(const RenderPipeline& pipeline, const std::string& stage_id, Mode fallback);
+
+    /** Size constraint of the source target for RenderTarget::set_size. */
+    static LVecBase2i get_size_constraint(Mode mode);
+
+    /** Return the full resolution pixel which is rendered by @p source_coord. */
+    static LVecBase2i get_full_coord(Mode mode, const LVecBase2i& source_coord, int parity);
+
+    /**
+     * Collect the texels used for the full resolution pixel @p coord.
+     *
+     * @return  1 if the pixel is rendered directly, otherwise 4.
+     */
+    static int get_taps(Mode mode, const LVecBase2i& coord, const LVecBase2i& full_size, int parity, Tap taps[4]);
+
+    /**
+     * Weight of a tap.
+     * @param   upscale_weights     x: max depth difference, y: max normal difference.
+     */
+    static float compute_weight(float center_depth, const LVecBase3f& center_normal,
+        float sample_depth, const LVecBase3f& sample_normal, const LVecBase2f& upscale_weights);
 
     /**
-     * Creates a new upscaler with the given name. Percentage controls
-     * the maximum amount of invalid pixels which can be processed, for example
-     * a value of 0.05 means that 5% of all pixels may be invalid.
+     * Upscale @p source on the CPU. @p depth, @p normals and @p result have @p full_size,
+     * and @p source has the size of the source target for @p full_size.
      */
-    BilateralUpscaler(RenderStage& parent_stage, bool halfres=false, Texture* source_tex=nullptr, const std::string& name="", float percentage=0.05f, bool stereo=false);
+    static void upscale(Mode mode, int parity, const LVecBase2i& full_size, const float* depth,
+        const LVecBase3f* normals, const LVecBase4f* source, const LVecBase2f& upscale_weights,
+        LVecBase4f* result);
+
+public:
+    BilateralUpscaler(RenderStage& stage, Mode mode, const LVecBase2f& upscale_weights=LVecBase2f(0.001f), bool stereo=false);
     ~BilateralUpscaler();
 
-    /** Returns the final upscaled texture. */
-    Texture* result_tex() const;
+    Mode get_mode() const;
+
+    /**
+     * Create the source target and the upscale target. The source target is returned,
+     * and its shader should be set by the stage.
+     */
+    RenderTarget* create(const std::string& name, const LVecBase4i& color_bits);
 
-    /** Sets all required shaders. */
-    void set_shaders(Shader* upscale_shader, Shader* fillin_shader);
+    RenderTarget* get_source_target() const;
 
-    /** Adapts the targets to the current resolution. */
-    void set_dimensions();
+    /** Returns the final upscaled texture. In full mode, this is the texture of the source target. */
+    Texture* get_result_tex() const;
 
-    /** Updates all targets and buffers. */
-    void update();
+    void reload_shaders();
 
-    void set_layer(int layer);
+    /** Alternate the checkerboard pattern. */
+    void update();
 
 private:
-    struct Impl;
-    std::unique_ptr<Impl> impl_;
+    RenderStage& stage_;
+    const Mode mode_;
+    const LVecBase2f upscale_weights_;
+    const bool stereo_;
+
+    PTA_LVecBase3i params_;
+    RenderTarget* source_target_ = nullptr;
+    RenderTarget* upscale_target_ = nullptr;
 };
 
+// ************************************************************************************************
+
+inline BilateralUpscaler::Mode BilateralUpscaler::get_mode() const
+{
+    return mode_;
+}
+
+inline RenderTarget* BilateralUpscaler::get_source_target() const
+{
+    return source_target_;
+}
+
 }
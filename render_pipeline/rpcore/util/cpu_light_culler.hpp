@@ -0,0 +1,256 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <luse.h>
+
+#include <array>
+#include <vector>
+
+#include <render_pipeline/rpcore/rpobject.hpp>
+
+class Lens;
+
+namespace rpcore {
+
+class RenderPipeline;
+class InternalLightManager;
+
+/**
+ * CPU implementation of the clustered light culling.
+ *
+ * This does the same work as FlagUsedCellsStage, CollectUsedCellsStage and
+ * CullLightsStage (including the light class grouping), but on the CPU.
+ * It reads the packed light data in the layout of AllLightsData, so the result
+ * can be compared with the GPU result, or used without a graphics device.
+ *
+ * The culling of cells is distributed over multiple threads.
+ */
+class RENDER_PIPELINE_DECL CPULightCuller : public RPObject
+{
+public:
+    /** Light classes, which should be same with light_classification.inc.glsl. */
+    enum LightClass : int
+    {
+        LIGHT_CLS_INVALID = -1,
+        LIGHT_CLS_SPOT_NOSHADOW = 0,
+        LIGHT_CLS_POINT_NOSHADOW = 1,
+        LIGHT_CLS_SPOT_SHADOW = 2,
+        LIGHT_CLS_POINT_SHADOW = 3,
+
+        LIGHT_CLS_COUNT
+    };
+
+    /** Amount of floats for each light in AllLightsData (4 RGBA texels). */
+    static constexpr int LIGHT_DATA_STRIDE = 16;
+
+    /** The same values with `lighting.culling_*` settings. */
+    struct RENDER_PIPELINE_DECL Settings
+    {
+        /** Read the settings from pipeline.yaml of the pipeline. */
+        static Settings from_pipeline(const RenderPipeline& pipeline);
+
+        LVecBase2i tile_size = LVecBase2i(24, 16);
+        int num_slices = 32;
+        float max_distance = 500.0f;
+        int max_lights_per_cell = 64;
+    };
+
+    struct Cell
+    {
+        int x;
+        int y;
+        int slice;
+
+        /** Light indices grouped by light class, in the order of LightClass. */
+        std::vector<int> lights;
+
+        /** Amount of lights for each light class. */
+        std::array<int, LIGHT_CLS_COUNT> class_counts;
+    };
+
+public:
+    /**
+     * Packs all lights of the manager into the layout of AllLightsData.
+     *
+     * The result has `(get_max_light_index() + 1) * LIGHT_DATA_STRIDE` floats
+     * and empty slots are filled with zero.
+     */
+    static void pack_light_data(const InternalLightManager& mgr, std::vector<float>& light_data);
+
+    /** Returns the light class of the given light. It is the same with `classify_light` in GLSL. */
+    static LightClass classify_light(int light_type, bool casts_shadows);
+
+    /** Packs cell coordinates like the cells in CellListBuffer. */
+    static int pack_cell_data(int x, int y, int slice);
+
+    /**
+     * @param num_threads   The number of worker threads. 0 uses the number of hardware threads.
+     */
+    CPULightCuller(const Settings& settings, size_t num_threads = 0);
+
+    const Settings& get_settings() const;
+
+    void set_num_threads(size_t num_threads);
+    size_t get_num_threads() const;
+
+    /** Sets the render resolution. This resizes the cell grid. */
+    void set_resolution(const LVecBase2i& resolution);
+    const LVecBase2i& get_resolution() const;
+
+    /** Returns the amount of tiles on screen. It is the same with LightManager::get_num_tiles(). */
+    const LVecBase2i& get_num_tiles() const;
+
+    /**
+     * Sets the camera.
+     *
+     * @param view_mat  The transform matrix from world (render) to camera.
+     * @param lens      The lens of the camera.
+     */
+    void set_camera(const LMatrix4f& view_mat, const Lens* lens);
+
+    /**
+     * Sets the view matrix in z-up coordinates and the frustum directions in the
+     * order BL, BR, TL, TR. These are `view_mat_z_up` and `vs_frustum_directions` in MainSceneData.
+     */
+    void set_camera(const LMatrix4f& view_mat_z_up, const std::array<LVecBase3f, 4>& vs_frustum_directions);
+
+    /** Marks all cells as used. */
+    void flag_all_cells();
+
+    /**
+     * Marks the cells which are used by the given surface distances.
+     *
+     * This is the CPU version of FlagUsedCellsStage. @p surface_distances has
+     * `resolution.x * resolution.y` elements with row-major order from bottom-left,
+     * and each element is the distance from the camera to the surface. Negative values are skipped.
+     */
+    void flag_used_cells(const float* surface_distances);
+
+    /**
+     * Culls the lights for all flagged cells.
+     *
+     * @param light_data        Packed light data in the layout of AllLightsData.
+     * @param max_light_index   Maximum light index, which is same with `maxLightIndex` input.
+     */
+    void cull_lights(const float* light_data, int max_light_index);
+    void cull_lights(const std::vector<float>& light_data);
+
+    /** Returns the used cells. This is valid after cull_lights(). */
+    const std::vector<Cell>& get_cells() const;
+
+    /** Returns the index of the cell in get_cells(), or -1 if the cell is not used. */
+    int find_cell(int x, int y, int slice) const;
+
+    /** Returns the number of lights which are in the frustum at last culling. */
+    size_t get_num_frustum_lights() const;
+
+    /** Returns the total number of lights stored in all cells at last culling. */
+    size_t get_num_culled_lights() const;
+
+    /** Same with `get_slice_from_distance` in light_culling.inc.glsl. */
+    int get_slice_from_distance(float dist) const;
+
+    /** Same with `get_distance_from_slice` in light_culling.inc.glsl. */
+    float get_distance_from_slice(int slice) const;
+
+private:
+    struct Sphere
+    {
+        LVecBase3f pos;
+        float radius;
+    };
+
+    struct FrustumLight
+    {
+        int index;
+        LightClass light_class;
+        Sphere sphere;
+    };
+
+    int get_flag_index(int x, int y, int slice) const;
+
+    LVecBase3f get_light_position_view(const float* data) const;
+    bool get_representative_sphere(const float* data, const LVecBase3f& light_pos_view, Sphere& sphere) const;
+    LVecBase3f get_ray_direction(const LVecBase2f& dir, int cell_x, int cell_y) const;
+
+    void collect_frustum_lights(const float* light_data, int max_light_index);
+    void cull_cell(Cell& cell) const;
+
+    Settings settings_;
+    size_t num_threads_;
+
+    LVecBase2i resolution_ = LVecBase2i(0);
+    LVecBase2i num_tiles_ = LVecBase2i(0);
+
+    LMatrix4f view_mat_z_up_ = LMatrix4f::ident_mat();
+    std::array<LVecBase3f, 4> frustum_directions_;
+
+    std::vector<unsigned char> cell_flags_;
+    std::vector<Cell> cells_;
+    std::vector<int> cell_lookup_;
+    std::vector<FrustumLight> frustum_lights_;
+};
+
+// ************************************************************************************************
+
+inline const CPULightCuller::Settings& CPULightCuller::get_settings() const
+{
+    return settings_;
+}
+
+inline size_t CPULightCuller::get_num_threads() const
+{
+    return num_threads_;
+}
+
+inline const LVecBase2i& CPULightCuller::get_resolution() const
+{
+    return resolution_;
+}
+
+inline const LVecBase2i& CPULightCuller::get_num_tiles() const
+{
+    return num_tiles_;
+}
+
+inline const std::vector<CPULightCuller::Cell>& CPULightCuller::get_cells() const
+{
+    return cells_;
+}
+
+inline size_t CPULightCuller::get_num_frustum_lights() const
+{
+    return frustum_lights_.size();
+}
+
+inline int CPULightCuller::pack_cell_data(int x, int y, int slice)
+{
+    return (x & 0x3FF) | ((y & 0x3FF) << 10) | ((slice & 0x3FF) << 20);
+}
+
+inline void CPULightCuller::cull_lights(const std::vector<float>& light_data)
+{
+    cull_lights(light_data.data(), static_cast<int>(light_data.size() / LIGHT_DATA_STRIDE) - 1);
+}
+
+}
@@ -0,0 +1,149 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <render_pipeline/rpcore/rpobject.hpp>
+
+namespace rpcore {
+
+/**
+ * Policy of the dynamic resolution scaling.
+ *
+ * The controller is fed with one frame time per frame, and returns the scale
+ * of the render resolution relative to the native resolution. Because a change
+ * reallocates the screen-relative render targets, the scale is quantized to
+ * steps and changes at most once per cooldown period.
+ *
+ * - If the frame time is above the target for the decrease delay in a row, the
+ *   scale is lowered at once to the value which is expected to meet the target,
+ *   assuming the frame time is proportional to the pixel count. The smallest
+ *   frame time of the run is used, so a single spike neither triggers a drop
+ *   nor decides its size.
+ * - If the smoothed frame time stays below the target times the increase
+ *   threshold for the increase delay, the scale is raised by one step.
+ *
+ * Frames in the cooldown are ignored. The cooldown also starts at reset(),
+ * so the first frames after the creation, which compile shaders, are skipped.
+ *
+ * The class has no dependency on the pipeline, so it can be run on synthetic
+ * frame time traces.
+ */
+class RENDER_PIPELINE_DECL DynamicResolutionController : public RPObject
+{
+public:
+    DynamicResolutionController();
+
+    /** Set the frame time (in seconds) to meet. */
+    void set_target_frame_time(double seconds);
+    double get_target_frame_time() const;
+
+    void set_scale_range(float min_scale, float max_scale);
+    float get_min_scale() const;
+    float get_max_scale() const;
+
+    /** Set the quantization step of the scale. */
+    void set_scale_step(float step);
+    float get_scale_step() const;
+
+    /** Set the weight of the new frame time in the exponential moving average. */
+    void set_smoothing(double alpha);
+
+    /** Set the ratio to the target below which the scale may be raised. */
+    void set_increase_threshold(double ratio);
+
+    /** Set the number of frames in the increase threshold before the scale is raised. */
+    void set_increase_delay(int frames);
+
+    /** Set the number of frames in a row above the target before the scale is lowered. */
+    void set_decrease_delay(int frames);
+
+    /** Set the number of frames to ignore after a change, while the new targets settle. */
+    void set_cooldown(int frames);
+
+    /** Set the current scale without the policy, ex, at startup. */
+    void set_scale(float scale);
+    float get_scale() const;
+
+    /** Return the smoothed frame time. */
+    double get_average_frame_time() const;
+
+    /** Add the time of a frame. Return true if the scale was changed. */
+    bool add_frame_time(double seconds);
+
+    /** Forget the history and start the cooldown, ex, after a loading screen. */
+    void reset();
+
+private:
+    float quantize(float scale) const;
+
+    double target_frame_time_ = 1.0 / 60.0;
+    float min_scale_ = 0.5f;
+    float max_scale_ = 1.0f;
+    float scale_step_ = 0.05f;
+    double smoothing_ = 0.1;
+    double increase_threshold_ = 0.8;
+    int increase_delay_ = 60;
+    int decrease_delay_ = 3;
+    int cooldown_ = 30;
+
+    float scale_ = 1.0f;
+    double average_ = 0.0;
+    bool has_average_ = false;
+    int cooldown_left_ = 0;
+    int frames_below_ = 0;
+    int frames_above_ = 0;
+    double min_frame_time_above_ = 0.0;
+};
+
+// ************************************************************************************************
+
+inline double DynamicResolutionController::get_target_frame_time() const
+{
+    return target_frame_time_;
+}
+
+inline float DynamicResolutionController::get_min_scale() const
+{
+    return min_scale_;
+}
+
+inline float DynamicResolutionController::get_max_scale() const
+{
+    return max_scale_;
+}
+
+inline float DynamicResolutionController::get_scale_step() const
+{
+    return scale_step_;
+}
+
+inline float DynamicResolutionController::get_scale() const
+{
+    return scale_;
+}
+
+inline double DynamicResolutionController::get_average_frame_time() const
+{
+    return average_;
+}
+
+}
@@ -0,0 +1,367 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphicsOutput.h>
+#include <nodePath.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <render_pipeline/rpcore/rpobject.hpp>
+
+namespace rpcore {
+
+/**
+ * Frame pacing.
+ *
+ * FramePacer::end_frame() is called once at the end of each frame. It limits
+ * the number of frames in flight on the GPU, caps the frame rate by sleeping
+ * and then spin-waiting for the last part of the interval, and records the
+ * frame time in a histogram.
+ *
+ * The frames in flight are tracked with FramePacer::Fence. With N frames in
+ * flight, end_frame() of frame k waits until frame k + 1 - N is completed,
+ * so 1 means that the CPU and the GPU are synchronized at each frame.
+ *
+ * All timing goes through FramePacer::Clock, so the pacing logic can be driven
+ * by FramePacer::ManualClock instead of the system clock.
+ */
+class RENDER_PIPELINE_DECL FramePacer : public RPObject
+{
+public:
+    /** Time source of the pacer. */
+    class RENDER_PIPELINE_DECL Clock
+    {
+    public:
+        virtual ~Clock() = default;
+
+        /** Return monotonic time in seconds. */
+        virtual double get_time() = 0;
+
+        /** Block the thread for about @p seconds. This may oversleep. */
+        virtual void sleep(double seconds) = 0;
+
+        /** Called repeatedly while spin-waiting. */
+        virtual void yield() = 0;
+    };
+
+    /** Clock using std::chrono::steady_clock and std::this_thread. */
+    class RENDER_PIPELINE_DECL SystemClock : public Clock
+    {
+    public:
+        double get_time() final;
+        void sleep(double seconds) final;
+        void yield() final;
+    };
+
+    /**
+     * Clock which only advances when it is told to.
+     * sleep() advances by the requested time plus the oversleep, and yield() by the yield step.
+     */
+    class RENDER_PIPELINE_DECL ManualClock : public Clock
+    {
+    public:
+        double get_time() final;
+        void sleep(double seconds) final;
+        void yield() final;
+
+        void advance(double seconds);
+        void set_oversleep(double seconds);
+        void set_yield_step(double seconds);
+
+        int get_num_sleeps() const;
+        int get_num_yields() const;
+
+    private:
+        double time_ = 0.0;
+        double oversleep_ = 0.0;
+        double yield_step_ = 0.00001;
+        int num_sleeps_ = 0;
+        int num_yields_ = 0;
+    };
+
+    /** Marker of GPU progress for the frames-in-flight limit. */
+    class RENDER_PIPELINE_DECL Fence
+    {
+    public:
+        virtual ~Fence() = default;
+
+        /** Mark the GPU work of @p frame. This is called at the end of each frame. */
+        virtual void insert(uint64_t frame) = 0;
+
+        /** Return whether the GPU work of @p frame and all frames before it is completed. */
+        virtual bool is_completed(uint64_t frame) = 0;
+    };
+
+    /**
+     * Fence which draws the frame number into a 1x1 buffer and copies it to RAM.
+     *
+     * The buffer is rendered after the window, and the copy finishes when the GPU
+     * has finished the frame. The pacing task runs after igloop, so the number
+     * written in insert() is drawn in the next frame.
+     *
+     * The readback waits for the GPU on the draw thread. With the single-threaded
+     * pipeline, the draw is a part of the frame, so this synchronizes every frame.
+     */
+    class RENDER_PIPELINE_DECL ReadbackFence : public Fence
+    {
+    public:
+        ReadbackFence(GraphicsOutput* host);
+        ~ReadbackFence() override;
+
+        void insert(uint64_t frame) final;
+        bool is_completed(uint64_t frame) final;
+
+        bool is_valid() const;
+
+    private:
+        PT(GraphicsOutput) buffer_;
+        PT(Texture) texture_;
+        NodePath scene_;
+        NodePath card_;
+        uint64_t last_marker_ = 0;
+    };
+
+    /** Histogram of frame times with fixed-width buckets. */
+    class RENDER_PIPELINE_DECL FrameTimeHistogram
+    {
+    public:
+        /** Samples above @p bucket_width * @p num_buckets are counted in the last bucket. */
+        FrameTimeHistogram(double bucket_width = 0.0005, int num_buckets = 200);
+
+        void add(double frame_time);
+        void clear();
+
+        size_t get_num_samples() const;
+        double get_min() const;
+        double get_max() const;
+        double get_mean() const;
+
+        /** Return the upper edge of the bucket containing the @p percentile (0 - 100) sample. */
+        double get_percentile(double percentile) const;
+
+        double get_bucket_width() const;
+        const std::vector<size_t>& get_buckets() const;
+
+    private:
+        double bucket_width_;
+        std::vector<size_t> buckets_;
+        size_t num_samples_ = 0;
+        double min_ = 0.0;
+        double max_ = 0.0;
+        double sum_ = 0.0;
+    };
+
+public:
+    /** Create the pacer with @p clock, or SystemClock if it is nullptr. */
+    FramePacer(std::unique_ptr<Clock> clock = nullptr);
+    ~FramePacer();
+
+    Clock* get_clock() const;
+
+    /** Set the frame rate cap. Zero or less disables the cap. */
+    void set_target_frame_rate(double fps);
+    double get_target_frame_rate() const;
+
+    /** Set how long before the deadline the pacer stops sleeping and spins instead. */
+    void set_spin_time(double seconds);
+    double get_spin_time() const;
+
+    /** Set the fence for the frames-in-flight limit. nullptr disables the limit. */
+    void set_fence(std::unique_ptr<Fence> fence);
+    Fence* get_fence() const;
+
+    /** Set the maximum number of frames in flight. Zero or less disables the limit. */
+    void set_max_frames_in_flight(int count);
+    int get_max_frames_in_flight() const;
+
+    /**
+     * Set how long to wait for a fence at most. If the GPU stops drawing the fence,
+     * for example in a minimized window, the frame continues after this time.
+     */
+    void set_fence_timeout(double seconds);
+    double get_fence_timeout() const;
+
+    /** Wait for the frame limits and record the frame time. Call once per frame. */
+    void end_frame();
+
+    /** Forget the deadline and the previous frame, for example after a loading screen. */
+    void reset();
+
+    /** Number of end_frame() calls since the creation. */
+    uint64_t get_frame() const;
+
+    const FrameTimeHistogram& get_histogram() const;
+    FrameTimeHistogram& get_histogram();
+
+    /** Time of the last frame, including the waiting. */
+    double get_last_frame_time() const;
+
+    /** Time spent waiting for the deadline in the last frame. */
+    double get_last_wait_time() const;
+
+    /** Time spent waiting for the GPU in the last frame. This is a part of the rendering cost. */
+    double get_last_fence_wait_time() const;
+
+    /** Number of fence waits which ended by the timeout. */
+    size_t get_num_fence_timeouts() const;
+
+private:
+    void wait_until(double time);
+    void wait_for_fence(uint64_t frame);
+
+    std::unique_ptr<Clock> clock_;
+    std::unique_ptr<Fence> fence_;
+    FrameTimeHistogram histogram_;
+
+    double target_frame_time_ = 0.0;
+    double spin_time_ = 0.002;
+    int max_frames_in_flight_ = 0;
+    double fence_timeout_ = 0.1;
+
+    uint64_t frame_ = 0;
+    double last_fence_wait_time_ = 0.0;
+    size_t num_fence_timeouts_ = 0;
+
+    bool has_last_time_ = false;
+    double last_time_ = 0.0;
+    bool has_deadline_ = false;
+    double deadline_ = 0.0;
+    double last_frame_time_ = 0.0;
+    double last_wait_time_ = 0.0;
+};
+
+// ************************************************************************************************
+
+inline int FramePacer::ManualClock::get_num_sleeps() const
+{
+    return num_sleeps_;
+}
+
+inline int FramePacer::ManualClock::get_num_yields() const
+{
+    return num_yields_;
+}
+
+inline size_t FramePacer::FrameTimeHistogram::get_num_samples() const
+{
+    return num_samples_;
+}
+
+inline double FramePacer::FrameTimeHistogram::get_min() const
+{
+    return min_;
+}
+
+inline double FramePacer::FrameTimeHistogram::get_max() const
+{
+    return max_;
+}
+
+inline double FramePacer::FrameTimeHistogram::get_mean() const
+{
+    return num_samples_ == 0 ? 0.0 : sum_ / num_samples_;
+}
+
+inline double FramePacer::FrameTimeHistogram::get_bucket_width() const
+{
+    return bucket_width_;
+}
+
+inline const std::vector<size_t>& FramePacer::FrameTimeHistogram::get_buckets() const
+{
+    return buckets_;
+}
+
+inline bool FramePacer::ReadbackFence::is_valid() const
+{
+    return buffer_ != nullptr;
+}
+
+inline FramePacer::Clock* FramePacer::get_clock() const
+{
+    return clock_.get();
+}
+
+inline FramePacer::Fence* FramePacer::get_fence() const
+{
+    return fence_.get();
+}
+
+inline int FramePacer::get_max_frames_in_flight() const
+{
+    return max_frames_in_flight_;
+}
+
+inline double FramePacer::get_fence_timeout() const
+{
+    return fence_timeout_;
+}
+
+inline uint64_t FramePacer::get_frame() const
+{
+    return frame_;
+}
+
+inline double FramePacer::get_target_frame_rate() const
+{
+    return target_frame_time_ > 0.0 ? 1.0 / target_frame_time_ : 0.0;
+}
+
+inline double FramePacer::get_spin_time() const
+{
+    return spin_time_;
+}
+
+inline const FramePacer::FrameTimeHistogram& FramePacer::get_histogram() const
+{
+    return histogram_;
+}
+
+inline FramePacer::FrameTimeHistogram& FramePacer::get_histogram()
+{
+    return histogram_;
+}
+
+inline double FramePacer::get_last_frame_time() const
+{
+    return last_frame_time_;
+}
+
+inline double FramePacer::get_last_wait_time() const
+{
+    return last_wait_time_;
+}
+
+inline double FramePacer::get_last_fence_wait_time() const
+{
+    return last_fence_wait_time_;
+}
+
+inline size_t FramePacer::get_num_fence_timeouts() const
+{
+    return num_fence_timeouts_;
+}
+
+}
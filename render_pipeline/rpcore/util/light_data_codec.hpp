@@ -0,0 +1,134 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <luse.h>
+
+#include <array>
+#include <vector>
+
+#include <render_pipeline/rpcore/config.hpp>
+
+namespace rpcore {
+
+/**
+ * Compact encoding of the light data and delta encoding of its updates.
+ *
+ * A light of AllLightsData has 16 floats (see CPULightCuller::pack_light_data).
+ * The compact light stores the same data in 7 words (28 bytes):
+ *
+ *   - word 0: light type (4 bits), IES profile + 1 (12 bits), shadow source index + 1 (16 bits)
+ *   - word 1-3: position (float)
+ *   - word 4: color (RGB9E5 shared exponent)
+ *   - word 5: radius (half), inner radius of point light or cos(fov) of spot light (half)
+ *   - word 6: direction of spot light (octahedral, 2x 16-bit snorm),
+ *             or shadow mode of point light (RPPointLight::ShadowMode)
+ *
+ * The delta stream stores only the changed words of each light. Each entry starts
+ * with a header word (slot in low 16 bits, mask of changed words in bits 16-22,
+ * removal flag in bit 23), followed by the changed words.
+ */
+class RENDER_PIPELINE_DECL LightDataCodec
+{
+public:
+    static constexpr int LIGHT_DATA_STRIDE = 16;
+    static constexpr int COMPACT_LIGHT_WORDS = 7;
+
+    static constexpr uint32_t DELTA_SLOT_MASK = 0xFFFF;
+    static constexpr int DELTA_WORDS_SHIFT = 16;
+    static constexpr uint32_t DELTA_ALL_WORDS = (1u << COMPACT_LIGHT_WORDS) - 1;
+    static constexpr uint32_t DELTA_REMOVE_BIT = 1u << 23;
+
+    using CompactLight = std::array<uint32_t, COMPACT_LIGHT_WORDS>;
+
+    /** Encodes delta stream from the light data of every frame. */
+    class RENDER_PIPELINE_DECL DeltaEncoder
+    {
+    public:
+        /** Add the changed words of the light in @p slot. @p record has LIGHT_DATA_STRIDE floats. */
+        void update(int slot, const float* record);
+
+        /** Add removal of the light in @p slot. */
+        void remove(int slot);
+
+        /**
+         * Compare all lights in the packed light data, which has LIGHT_DATA_STRIDE floats per slot.
+         * Slots with empty type are removed.
+         */
+        void update_all(const std::vector<float>& light_data);
+
+        const std::vector<uint32_t>& get_stream() const;
+        size_t get_num_entries() const;
+
+        /** Clear the stream after uploading it. The previous lights are kept. */
+        void clear_stream();
+
+        /** Forget all lights, so that next update writes all words. */
+        void reset();
+
+    private:
+        void add_entry(int slot, const CompactLight& light);
+
+        std::vector<CompactLight> lights_;
+        std::vector<bool> present_;
+        std::vector<uint32_t> stream_;
+        size_t num_entries_ = 0;
+    };
+
+    static CompactLight encode(const float* record);
+    static void decode(const CompactLight& light, float* record);
+
+    /**
+     * Apply the delta stream to the lights.
+     * @return false if the stream is malformed.
+     */
+    static bool apply_delta(const std::vector<uint32_t>& stream, std::vector<CompactLight>& lights, std::vector<bool>& present);
+
+    static uint16_t encode_half(float value);
+    static float decode_half(uint16_t value);
+
+    static uint32_t encode_rgb9e5(const LVecBase3f& color);
+    static LVecBase3f decode_rgb9e5(uint32_t packed);
+
+    static uint32_t encode_octahedral(const LVecBase3f& dir);
+    static LVecBase3f decode_octahedral(uint32_t packed);
+};
+
+// ************************************************************************************************
+
+inline const std::vector<uint32_t>& LightDataCodec::DeltaEncoder::get_stream() const
+{
+    return stream_;
+}
+
+inline size_t LightDataCodec::DeltaEncoder::get_num_entries() const
+{
+    return num_entries_;
+}
+
+inline void LightDataCodec::DeltaEncoder::clear_stream()
+{
+    stream_.clear();
+    num_entries_ = 0;
+}
+
+}
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <luse.h>
+#include <filename.h>
 
 #include <render_pipeline/rpcore/config.hpp>
 
@@ -44,6 +45,15 @@ class RENDER_PIPELINE_DECL MovementController
 public:
     using MotionPathType = std::vector<std::pair<LVecBase3, LVecBase3>>;
 
+    /** Camera state of a recorded frame. Time is in seconds from the start of recording. */
+    struct RecordedFrame
+    {
+        float time;
+        LVecBase3f pos;
+        LVecBase3f hpr;
+    };
+    using RecordedPathType = std::vector<RecordedFrame>;
+
 public:
     MovementController(rppanda::ShowBase* showbase);
 
@@ -95,6 +105,40 @@ public:
     /** Plays a motion path from the given set of points. */
     void play_motion_path(const MotionPathType& points, float point_duration=1.2f);
 
+    /** Starts recording the camera position, orientation and frame time every frame. */
+    void start_recording();
+
+    /** Stops recording. The recorded frames are kept until next recording. */
+    void stop_recording();
+
+    bool is_recording() const;
+
+    const RecordedPathType& get_recorded_path() const;
+
+    /**
+     * Plays a recorded path without mouse and keyboard input.
+     *
+     * If @p fixed_timestep is positive, the global clock runs in non-real-time mode
+     * and advances by the timestep every frame, so that the same frames are rendered
+     * on every run. Otherwise, the path is played in real time.
+     * Frame time statistics are printed when the playback is finished.
+     */
+    void play_recorded_path(const RecordedPathType& path, double fixed_timestep=0.0);
+
+    /** Stops playback of a recorded path and returns to interactive control. */
+    void stop_recorded_path();
+
+    bool is_playing_recorded_path() const;
+
+    /** Saves the path to a binary file: a small header and 28 bytes per frame. */
+    static bool save_recorded_path(const Filename& path, const RecordedPathType& frames);
+
+    /** Loads the path saved by save_recorded_path. */
+    static bool load_recorded_path(const Filename& path, RecordedPathType& frames);
+
+    /** Interpolates the camera state at @p time. The path should not be empty. */
+    static void sample_recorded_path(const RecordedPathType& frames, float time, LPoint3f& pos, LQuaternionf& quat);
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl_;
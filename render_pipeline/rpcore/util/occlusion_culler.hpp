@@ -0,0 +1,231 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <nodePath.h>
+#include <bitMask.h>
+
+#include <vector>
+
+#include <render_pipeline/rpcore/rpobject.hpp>
+
+class Lens;
+
+namespace rpcore {
+
+/**
+ * Occlusion culling with a hierarchical depth buffer (hi-Z).
+ *
+ * Registered occluders are rasterized into a small depth buffer on the CPU, and
+ * the bounds of registered occludees are tested against the max-depth pyramid of it.
+ * Occluded nodes are hidden from the camera mask of the tested pass, so that
+ * GBufferStage or the shadow cameras do not draw them.
+ *
+ * A depth buffer read back from the GPU can be used instead of the occluders.
+ * In this case, the bounds are projected with the view-projection matrix that
+ * the depth buffer was rendered with (ex, the previous frame).
+ *
+ * Limitations: the pipeline does not read back the depth pyramid of DownscaleZStage,
+ * so only the registered occluders hide geometry unless set_depth_buffer() is fed by
+ * the application. Shadow passes share one camera mask, so a node is hidden from the
+ * shadows only when it is occluded in every tested shadow view. This is why
+ * "pipeline.occlusion_culling" is disabled by default.
+ */
+class RENDER_PIPELINE_DECL OcclusionCuller : public RPObject
+{
+public:
+    /** Depth pyramid where each texel stores the farthest depth of its footprint. */
+    class RENDER_PIPELINE_DECL DepthPyramid
+    {
+    public:
+        /** Build levels from the depth buffer. Depth is in [0, 1] and 0 is nearest. */
+        void build(const float* depth, int width, int height);
+
+        int get_num_levels() const;
+        const LVecBase2i& get_size(int level) const;
+        float get_depth(int level, int x, int y) const;
+
+        /**
+         * Return the farthest depth in the rectangle [x0, x1] x [y0, y1] in pixels of level 0.
+         * The level is chosen so that the rectangle covers at most 2x2 texels.
+         */
+        float get_max_depth(float x0, float y0, float x1, float y1) const;
+
+    private:
+        std::vector<LVecBase2i> sizes_;
+        std::vector<std::vector<float>> levels_;
+    };
+
+    /** Depth-only triangle rasterizer for occluders. This keeps the nearest depth. */
+    class RENDER_PIPELINE_DECL SoftwareRasterizer
+    {
+    public:
+        void clear(int width, int height);
+
+        /**
+         * Rasterize triangles transformed by @p mvp (row vector convention of Panda3D).
+         * Triangles crossing the near plane are skipped, so the result stays conservative.
+         */
+        void rasterize(const LMatrix4f& mvp, const std::vector<LPoint3f>& vertices, const std::vector<int>& indices);
+
+        int get_width() const;
+        int get_height() const;
+        const std::vector<float>& get_depth() const;
+
+    private:
+        int width_ = 0;
+        int height_ = 0;
+        std::vector<float> depth_;
+    };
+
+public:
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    /** Set the resolution of the occluder depth buffer. */
+    void set_resolution(int width, int height);
+    const LVecBase2i& get_resolution() const;
+
+    /** Add triangles of the all GeomNodes under @p np as occluder. Use low-poly proxies. */
+    void add_occluder(NodePath np);
+    void remove_occluder(NodePath np);
+
+    /** Add a node which will be hidden when it is occluded. */
+    void add_occludee(NodePath np);
+    void remove_occludee(NodePath np);
+
+    /** Rasterize the occluders with the world to clip matrix and build the pyramid. */
+    void render_occluders(const LMatrix4f& view_proj);
+
+    /** Build the pyramid from a depth buffer rendered with @p view_proj. */
+    void set_depth_buffer(const float* depth, int width, int height, const LMatrix4f& view_proj);
+
+    const DepthPyramid& get_pyramid() const;
+
+    /** Return true if the world space box is hidden by the current pyramid. */
+    bool is_occluded(const LPoint3f& bmin, const LPoint3f& bmax) const;
+
+    /**
+     * Culling of a frame consists of begin_cull(), test_view() for each view, and end_cull().
+     * A node is hidden from a mask only if it is occluded in all views tested with the mask.
+     */
+    ///@{
+    void begin_cull();
+    void test_view(const BitMask32& mask);
+    void end_cull();
+    ///@}
+
+    /** Cull for the main camera: render occluders from the camera and test with @p mask. */
+    void cull_camera(const NodePath& camera, const Lens* lens, const BitMask32& mask);
+
+    size_t get_num_occludees() const;
+    size_t get_num_occluded() const;
+
+    /** Show all nodes hidden by this culler. */
+    void show_all();
+
+private:
+    struct Occluder
+    {
+        NodePath np;
+        std::vector<LPoint3f> vertices;
+        std::vector<int> indices;
+    };
+
+    struct Occludee
+    {
+        NodePath np;
+        LPoint3f world_min;
+        LPoint3f world_max;
+        bool has_bounds;
+        BitMask32 visible;
+        BitMask32 hidden;
+    };
+
+    static bool compute_world_bounds(const NodePath& np, LPoint3f& bmin, LPoint3f& bmax);
+
+    LVecBase2i resolution_ = LVecBase2i(320, 180);
+
+    std::vector<Occluder> occluders_;
+    std::vector<Occludee> occludees_;
+
+    SoftwareRasterizer rasterizer_;
+    DepthPyramid pyramid_;
+    LMatrix4f view_proj_ = LMatrix4f::ident_mat();
+
+    BitMask32 tested_masks_;
+    size_t num_occluded_ = 0;
+};
+
+// ************************************************************************************************
+
+inline int OcclusionCuller::DepthPyramid::get_num_levels() const
+{
+    return static_cast<int>(levels_.size());
+}
+
+inline const LVecBase2i& OcclusionCuller::DepthPyramid::get_size(int level) const
+{
+    return sizes_[level];
+}
+
+inline float OcclusionCuller::DepthPyramid::get_depth(int level, int x, int y) const
+{
+    return levels_[level][y * sizes_[level][0] + x];
+}
+
+inline int OcclusionCuller::SoftwareRasterizer::get_width() const
+{
+    return width_;
+}
+
+inline int OcclusionCuller::SoftwareRasterizer::get_height() const
+{
+    return height_;
+}
+
+inline const std::vector<float>& OcclusionCuller::SoftwareRasterizer::get_depth() const
+{
+    return depth_;
+}
+
+inline const LVecBase2i& OcclusionCuller::get_resolution() const
+{
+    return resolution_;
+}
+
+inline const OcclusionCuller::DepthPyramid& OcclusionCuller::get_pyramid() const
+{
+    return pyramid_;
+}
+
+inline size_t OcclusionCuller::get_num_occludees() const
+{
+    return occludees_.size();
+}
+
+inline size_t OcclusionCuller::get_num_occluded() const
+{
+    return num_occluded_;
+}
+
+}
@@ -71,6 +71,9 @@ public:
     DisplayRegion* get_region() const;
     NodePath get_node() const;
 
+    /** Return the fullscreen geometry, which has the shader inputs of the target. */
+    NodePath get_geom_node() const;
+
 private:
     void init_function_pointers();
     void make_fullscreen_tri();
@@ -102,4 +105,9 @@ inline NodePath PostProcessRegion::get_node() const
     return node;
 }
 
+inline NodePath PostProcessRegion::get_geom_node() const
+{
+    return geom_np_;
+}
+
 }
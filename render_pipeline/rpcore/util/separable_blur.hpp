@@ -0,0 +1,151 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <nodePath.h>
+#include <pta_float.h>
+#include <pta_LVecBase2.h>
+
+#include <vector>
+
+#include <render_pipeline/rpcore/image.hpp>
+
+class Texture;
+class ComputeNode;
+
+namespace rpcore {
+
+class RenderStage;
+class RenderTarget;
+
+/**
+ * Depth and normal aware separable blur in compute dispatches.
+ *
+ * Each iteration consists of a horizontal and a vertical pass of
+ * "separable_blur.compute.glsl". A work group caches a segment of a row (or column)
+ * in shared memory, so a pass reads each texel once instead of once per tap.
+ * All passes are dispatched from a single 1x1 target of the stage, instead of
+ * two screen-sized targets per iteration, and ping-pong between two images.
+ *
+ * The blur uses "DownscaledDepth" and "GBuffer", so the stage has to require these pipes.
+ */
+class RENDER_PIPELINE_DECL SeparableBlur : public RPObject
+{
+public:
+    /** Pixels along the blur direction per work group. This has to match the shader. */
+    static constexpr int GROUP_SIZE = 128;
+
+    /** Maximum of radius times pixel stretch. This has to match the shader. */
+    static constexpr int MAX_SPAN = 32;
+
+    /** Maximum number of kernel weights (radius + 1). This has to match the shader. */
+    static constexpr int MAX_KERNEL_SIZE = 17;
+
+    /**
+     * Generate the normalized Gaussian weights, starting from the center.
+     * The result is the same as `gaussian_weights_<size>` in "gaussian_weights.inc.glsl".
+     */
+    static std::vector<float> generate_gaussian_weights(int size);
+
+    /**
+     * Weight of a tap after the depth and normal rejection.
+     * @param   factors     x: normal factor, y: depth factor.
+     */
+    static float compute_bilateral_weight(float kernel_weight, const LVecBase3f& center_normal, float center_depth,
+        const LVecBase3f& sample_normal, float sample_depth, const LVecBase2f& factors);
+
+    /** Number of work groups of a pass on an image with @p size. */
+    static LVecBase3i get_dispatch_size(const LVecBase2i& size, bool horizontal);
+
+public:
+    SeparableBlur(RenderStage& stage, const std::string& name, Image::Format format);
+    ~SeparableBlur();
+
+    /** Set the number of weights (radius + 1). */
+    void set_kernel_size(int size);
+    int get_kernel_size() const;
+
+    /** Set the distance between the taps in pixels. */
+    void set_pixel_stretch(int stretch);
+    int get_pixel_stretch() const;
+
+    void set_iterations(int iterations);
+    int get_iterations() const;
+
+    /** Set the normal and depth factors of the rejection. This can be changed every frame. */
+    void set_factors(float normal_factor, float depth_factor);
+
+    /** Create the target and images, which blur @p source_tex. Call in RenderStage::create. */
+    void create(Texture* source_tex);
+
+    Texture* get_result_tex() const;
+
+    void reload_shaders();
+
+    /** Resize the images to the render resolution. Call in RenderStage::set_dimensions. */
+    void set_dimensions();
+
+private:
+    RenderStage& stage_;
+    const std::string name_;
+    const Image::Format format_;
+
+    int kernel_size_ = 7;
+    int pixel_stretch_ = 1;
+    int iterations_ = 1;
+
+    RenderTarget* target_ = nullptr;
+    std::unique_ptr<Image> images_[2];
+    std::vector<PT(ComputeNode)> passes_;
+    std::vector<NodePath> pass_nps_;
+
+    PTA_float weights_;
+    PTA_LVecBase2f factors_;
+};
+
+// ************************************************************************************************
+
+inline int SeparableBlur::get_kernel_size() const
+{
+    return kernel_size_;
+}
+
+inline int SeparableBlur::get_pixel_stretch() const
+{
+    return pixel_stretch_;
+}
+
+inline int SeparableBlur::get_iterations() const
+{
+    return iterations_;
+}
+
+inline void SeparableBlur::set_factors(float normal_factor, float depth_factor)
+{
+    factors_[0] = LVecBase2f(normal_factor, depth_factor);
+}
+
+inline Texture* SeparableBlur::get_result_tex() const
+{
+    return images_[1]->get_texture();
+}
+
+}
@@ -0,0 +1,130 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <filename.h>
+
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include <render_pipeline/rpcore/effect.hpp>
+
+class GraphicsStateGuardian;
+
+namespace rpcore {
+
+class RenderPipeline;
+
+/**
+ * Manifest of the shader variants requested by effects and stages.
+ *
+ * The variants of a session are recorded and merged into the manifest file,
+ * and the variants of the manifest can be loaded and prepared at startup,
+ * so that a new combination of effect options does not compile in the middle
+ * of the application. Variants which were requested but are not in the loaded
+ * manifest are reported.
+ */
+class RENDER_PIPELINE_DECL ShaderVariantManifest : public RPObject
+{
+public:
+    struct RENDER_PIPELINE_DECL Variant
+    {
+        std::string type;                       ///< "effect" or "stage"
+        std::vector<std::string> sources;       ///< effect file, or paths of the shader stages
+        std::map<std::string, bool> options;    ///< all options of an effect
+
+        /** Return a string which identifies the variant. */
+        std::string get_key() const;
+    };
+
+    static std::string serialize(const std::vector<Variant>& variants);
+
+    /** Parse the manifest. Invalid entries are skipped, and false is returned if the content is invalid. */
+    static bool parse(const std::string& content, std::vector<Variant>& variants);
+
+    /** Return the variants of @p current which are not in @p base. */
+    static std::vector<Variant> diff(const std::vector<Variant>& base, const std::vector<Variant>& current);
+
+    /** Return a human readable list of @p variants. */
+    static std::string make_report(const std::vector<Variant>& variants);
+
+public:
+    ShaderVariantManifest(const Filename& path="/$$rptemp/shader_variants.yaml");
+
+    const Filename& get_path() const;
+
+    /** Load the manifest file. Return false if it does not exist or is invalid. */
+    bool load();
+
+    /** Write the manifest merged with the recorded variants. */
+    bool save() const;
+
+    void record_effect(const Filename& filename, const Effect::OptionType& options);
+    void record_stage_shader(const std::vector<Filename>& paths);
+
+    const std::vector<Variant>& get_manifest_variants() const;
+    const std::vector<Variant>& get_recorded_variants() const;
+
+    /** Return the recorded variants which are not in the loaded manifest. */
+    std::vector<Variant> get_missing_variants() const;
+
+    /**
+     * Load the variants of the manifest and prepare their shaders on @p gsg.
+     * The shaders are compiled when the next frame is rendered.
+     *
+     * @return  The number of prepared shaders.
+     */
+    size_t prewarm(RenderPipeline& pipeline, GraphicsStateGuardian* gsg);
+
+private:
+    void record(Variant&& variant);
+
+    Filename path_;
+    std::vector<Variant> manifest_;
+    std::vector<Variant> recorded_;
+    std::unordered_set<std::string> recorded_keys_;
+    bool prewarming_ = false;
+};
+
+// ************************************************************************************************
+
+inline const Filename& ShaderVariantManifest::get_path() const
+{
+    return path_;
+}
+
+inline const std::vector<ShaderVariantManifest::Variant>& ShaderVariantManifest::get_manifest_variants() const
+{
+    return manifest_;
+}
+
+inline const std::vector<ShaderVariantManifest::Variant>& ShaderVariantManifest::get_recorded_variants() const
+{
+    return recorded_;
+}
+
+inline std::vector<ShaderVariantManifest::Variant> ShaderVariantManifest::get_missing_variants() const
+{
+    return diff(manifest_, recorded_);
+}
+
+}
@@ -0,0 +1,96 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <render_pipeline/rpcore/config.hpp>
+
+namespace rpcore {
+
+/**
+ * Decides which adjacent point-wise stages are merged into one pass.
+ *
+ * A stage can be fused if it is point-wise, active and reads the chain pipe
+ * (ShadedScene). Runs of such stages are split into groups of at most
+ * the max group size, and only groups with two or more stages are returned.
+ *
+ * This works on plain descriptions of the stages, so it does not need a GPU.
+ */
+class RENDER_PIPELINE_DECL StageFusionPlanner
+{
+public:
+    struct StageInfo
+    {
+        std::string id;
+        bool pointwise;
+        bool active;
+        std::vector<std::string> required_pipes;
+    };
+
+    /** Stages in [begin, end) of the list. The last one hosts the fused pass. */
+    struct Group
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    /** Include file and function name of a fused stage. */
+    struct Function
+    {
+        std::string include;
+        std::string name;
+    };
+
+public:
+    StageFusionPlanner(const std::string& chain_pipe = "ShadedScene", size_t max_group_size = 8);
+
+    const std::string& get_chain_pipe() const;
+    size_t get_max_group_size() const;
+
+    bool can_fuse(const StageInfo& stage) const;
+
+    /** Returns the groups of @p stages, which are in render order. */
+    std::vector<Group> plan(const std::vector<StageInfo>& stages) const;
+
+    /** Generates the fragment shader which applies @p functions in order on the chain pipe. */
+    std::string generate_fragment_shader(const std::vector<Function>& functions) const;
+
+private:
+    std::string chain_pipe_;
+    size_t max_group_size_;
+};
+
+// ************************************************************************************************
+
+inline const std::string& StageFusionPlanner::get_chain_pipe() const
+{
+    return chain_pipe_;
+}
+
+inline size_t StageFusionPlanner::get_max_group_size() const
+{
+    return max_group_size_;
+}
+
+}
@@ -41,6 +41,8 @@
 
 #include <cLerpNodePathInterval.h>
 
+#include <utility>
+
 #include <boost/optional.hpp>
 
 #include <render_pipeline/rpcore/config.hpp>
@@ -61,6 +63,36 @@ public:
         BlendType blend_type=BlendType::BT_no_blend, bool bake_in_start=true, bool fluid=false,
         NodePath other={});
 
+    /**
+     * These hide the setters of CLerpNodePathInterval to keep a copy of the lerp values
+     * for LerpIntervalBatch. Lerps configured through CLerpNodePathInterval directly
+     * must not be stepped while the batch is capturing.
+     */
+    ///@{
+    void set_start_pos(const LVecBase3& pos);
+    void set_end_pos(const LVecBase3& pos);
+    void set_start_hpr(const LVecBase3& hpr);
+    void set_end_hpr(const LVecBase3& hpr);
+    void set_start_quat(const LQuaternion& quat);
+    void set_end_quat(const LQuaternion& quat);
+    void set_start_scale(const LVecBase3& scale);
+    void set_start_scale(PN_stdfloat scale);
+    void set_end_scale(const LVecBase3& scale);
+    void set_end_scale(PN_stdfloat scale);
+    void set_start_shear(const LVecBase3& shear);
+    void set_end_shear(const LVecBase3& shear);
+    template <class... Args> void set_end_color(Args&&... args);
+    template <class... Args> void set_end_color_scale(Args&&... args);
+    template <class... Args> void set_end_tex_offset(Args&&... args);
+    template <class... Args> void set_end_tex_rotate(Args&&... args);
+    template <class... Args> void set_end_tex_scale(Args&&... args);
+    ///@}
+
+    /** Return true if this lerp can be deferred to LerpIntervalBatch. */
+    bool is_batchable() const;
+
+    void priv_step(double t) override;
+
 public:
     static TypeHandle get_class_type();
     static void init_type();
@@ -68,18 +100,163 @@ public:
     TypeHandle force_init_type() override;
 
 private:
+    friend class LerpIntervalBatch;
+
+    enum BatchFlags: unsigned int
+    {
+        BF_end_pos = 0x0001,
+        BF_end_hpr = 0x0002,
+        BF_end_quat = 0x0004,
+        BF_end_scale = 0x0008,
+        BF_end_shear = 0x0010,
+        BF_end_other = 0x0020,      // color, color scale, texture transform
+
+        BF_start_pos = 0x0100,
+        BF_start_hpr = 0x0200,
+        BF_start_quat = 0x0400,
+        BF_start_scale = 0x0800,
+        BF_start_shear = 0x1000,
+    };
+
     static TypeHandle type_handle_;
+
+    unsigned int batch_flags_ = 0;
+    bool bake_in_start_;
+    bool fluid_;
+
+    LVecBase3 batch_start_pos_;
+    LVecBase3 batch_end_pos_;
+    LVecBase3 batch_start_hpr_;
+    LVecBase3 batch_end_hpr_;
+    LVecBase3 batch_start_scale_;
+    LVecBase3 batch_end_scale_;
+    LVecBase3 batch_start_shear_;
+    LVecBase3 batch_end_shear_;
 };
 
 inline LerpNodePathInterval::LerpNodePathInterval(NodePath nodepath, const boost::optional<std::string>& name, double duration,
     BlendType blend_type, bool bake_in_start, bool fluid,
     NodePath other): CLerpNodePathInterval(
         name ? name.value() : (get_class_type().get_name() + "-" + std::to_string(lerp_node_path_num)),
-        duration, blend_type, bake_in_start, fluid, nodepath, other)
+        duration, blend_type, bake_in_start, fluid, nodepath, other),
+    bake_in_start_(bake_in_start), fluid_(fluid)
 {
     ++lerp_node_path_num;
 }
 
+inline void LerpNodePathInterval::set_start_pos(const LVecBase3& pos)
+{
+    batch_start_pos_ = pos;
+    batch_flags_ |= BF_start_pos;
+    CLerpNodePathInterval::set_start_pos(pos);
+}
+
+inline void LerpNodePathInterval::set_end_pos(const LVecBase3& pos)
+{
+    batch_end_pos_ = pos;
+    batch_flags_ |= BF_end_pos;
+    CLerpNodePathInterval::set_end_pos(pos);
+}
+
+inline void LerpNodePathInterval::set_start_hpr(const LVecBase3& hpr)
+{
+    batch_start_hpr_ = hpr;
+    batch_flags_ = (batch_flags_ & ~BF_start_quat) | BF_start_hpr;
+    CLerpNodePathInterval::set_start_hpr(hpr);
+}
+
+inline void LerpNodePathInterval::set_end_hpr(const LVecBase3& hpr)
+{
+    batch_end_hpr_ = hpr;
+    batch_flags_ = (batch_flags_ & ~BF_end_quat) | BF_end_hpr;
+    CLerpNodePathInterval::set_end_hpr(hpr);
+}
+
+inline void LerpNodePathInterval::set_start_quat(const LQuaternion& quat)
+{
+    batch_flags_ = (batch_flags_ & ~BF_start_hpr) | BF_start_quat;
+    CLerpNodePathInterval::set_start_quat(quat);
+}
+
+inline void LerpNodePathInterval::set_end_quat(const LQuaternion& quat)
+{
+    batch_flags_ = (batch_flags_ & ~BF_end_hpr) | BF_end_quat;
+    CLerpNodePathInterval::set_end_quat(quat);
+}
+
+inline void LerpNodePathInterval::set_start_scale(const LVecBase3& scale)
+{
+    batch_start_scale_ = scale;
+    batch_flags_ |= BF_start_scale;
+    CLerpNodePathInterval::set_start_scale(scale);
+}
+
+inline void LerpNodePathInterval::set_start_scale(PN_stdfloat scale)
+{
+    set_start_scale(LVecBase3(scale, scale, scale));
+}
+
+inline void LerpNodePathInterval::set_end_scale(const LVecBase3& scale)
+{
+    batch_end_scale_ = scale;
+    batch_flags_ |= BF_end_scale;
+    CLerpNodePathInterval::set_end_scale(scale);
+}
+
+inline void LerpNodePathInterval::set_end_scale(PN_stdfloat scale)
+{
+    set_end_scale(LVecBase3(scale, scale, scale));
+}
+
+inline void LerpNodePathInterval::set_start_shear(const LVecBase3& shear)
+{
+    batch_start_shear_ = shear;
+    batch_flags_ |= BF_start_shear;
+    CLerpNodePathInterval::set_start_shear(shear);
+}
+
+inline void LerpNodePathInterval::set_end_shear(const LVecBase3& shear)
+{
+    batch_end_shear_ = shear;
+    batch_flags_ |= BF_end_shear;
+    CLerpNodePathInterval::set_end_shear(shear);
+}
+
+template <class... Args>
+void LerpNodePathInterval::set_end_color(Args&&... args)
+{
+    batch_flags_ |= BF_end_other;
+    CLerpNodePathInterval::set_end_color(std::forward<Args>(args)...);
+}
+
+template <class... Args>
+void LerpNodePathInterval::set_end_color_scale(Args&&... args)
+{
+    batch_flags_ |= BF_end_other;
+    CLerpNodePathInterval::set_end_color_scale(std::forward<Args>(args)...);
+}
+
+template <class... Args>
+void LerpNodePathInterval::set_end_tex_offset(Args&&... args)
+{
+    batch_flags_ |= BF_end_other;
+    CLerpNodePathInterval::set_end_tex_offset(std::forward<Args>(args)...);
+}
+
+template <class... Args>
+void LerpNodePathInterval::set_end_tex_rotate(Args&&... args)
+{
+    batch_flags_ |= BF_end_other;
+    CLerpNodePathInterval::set_end_tex_rotate(std::forward<Args>(args)...);
+}
+
+template <class... Args>
+void LerpNodePathInterval::set_end_tex_scale(Args&&... args)
+{
+    batch_flags_ |= BF_end_other;
+    CLerpNodePathInterval::set_end_tex_scale(std::forward<Args>(args)...);
+}
+
 inline TypeHandle LerpNodePathInterval::get_class_type()
 {
     return type_handle_;
@@ -0,0 +1,124 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <nodePath.h>
+#include <cIntervalManager.h>
+
+#include <array>
+#include <vector>
+#include <unordered_set>
+
+#include <render_pipeline/rpcore/config.hpp>
+
+namespace rppanda {
+
+class LerpNodePathInterval;
+
+/**
+ * Deferred evaluator for LerpNodePathInterval.
+ *
+ * While capturing, batchable lerps only record their blend value in priv_step().
+ * flush() then evaluates every recorded lerp in one structure-of-arrays pass
+ * and applies the transforms in the order the intervals were stepped, using the
+ * same NodePath setters as CLerpNodePathInterval.
+ *
+ * Nothing may observe a node between a deferred step and its flush. So capturing only
+ * starts when every interval of the manager is a LerpNodePathInterval (directly or in a
+ * CMetaInterval), and a lerp which is stepped by CLerpNodePathInterval flushes the pending
+ * lerps before it runs. Events of the intervals are handled after the interval step.
+ *
+ * ShowBase brackets the interval manager step with begin_capture() / end_capture()
+ * when "lerp-interval-batch" is enabled (default: false).
+ */
+class RENDER_PIPELINE_DECL LerpIntervalBatch
+{
+public:
+    static LerpIntervalBatch* get_global_ptr();
+
+    /** Value of "lerp-interval-batch" config variable. */
+    static bool is_enabled();
+
+    /**
+     * Return true if stepping @p ival cannot observe the nodes of deferred lerps,
+     * that is, @p ival is a LerpNodePathInterval or a CMetaInterval of those only.
+     */
+    static bool is_independent(CInterval* ival);
+
+    LerpIntervalBatch();
+    LerpIntervalBatch(const LerpIntervalBatch&) = delete;
+
+    LerpIntervalBatch& operator=(const LerpIntervalBatch&) = delete;
+
+    /**
+     * Start deferring batchable lerps stepped by @p manager.
+     * Does nothing if batching is disabled or any interval of @p manager is not independent.
+     */
+    void begin_capture(CIntervalManager* manager=CIntervalManager::get_global_ptr());
+
+    /** Evaluate and apply pending lerps, and stop deferring. */
+    void end_capture();
+
+    /** Evaluate and apply pending lerps. */
+    void flush();
+
+    bool is_capturing() const;
+
+    size_t get_num_pending() const;
+
+    /**
+     * Record @p ival with blend value @p d.
+     * This is called from LerpNodePathInterval::priv_step() while capturing.
+     */
+    void queue(LerpNodePathInterval* ival, double d);
+
+private:
+    static constexpr size_t CHANNEL_COUNT = 12;
+
+    void evaluate();
+    void apply();
+
+    bool capturing_ = false;
+
+    std::vector<PT(LerpNodePathInterval)> intervals_;
+    std::unordered_set<PandaNode*> pending_nodes_;
+
+    // structure of arrays: pos, hpr, scale, shear channels of each pending lerp.
+    std::vector<PN_stdfloat> blend_;
+    std::array<std::vector<PN_stdfloat>, CHANNEL_COUNT> start_;
+    std::array<std::vector<PN_stdfloat>, CHANNEL_COUNT> delta_;
+    std::array<std::vector<PN_stdfloat>, CHANNEL_COUNT> result_;
+};
+
+// ************************************************************************************************
+
+inline bool LerpIntervalBatch::is_capturing() const
+{
+    return capturing_;
+}
+
+inline size_t LerpIntervalBatch::get_num_pending() const
+{
+    return intervals_.size();
+}
+
+}
@@ -212,6 +212,12 @@ public:
     void disable();
 
 private:
+    /** Remove the sound from the tracked object. Returns false if the sound is not attached. */
+    bool remove_sound_from_object(AudioSound* sound);
+
+    /** Compute the automatic velocity of the tracked object. */
+    LVecBase3 compute_object_velocity(const NodePath& node_path) const;
+
     AudioManager* audio_manager_;
     NodePath listener_target_;
     NodePath root_;
@@ -220,6 +226,9 @@ private:
 
     std::unordered_map<AudioSound*, boost::optional<LVecBase3>> vel_dict_;
     std::map<WeakNodePath, std::vector<AudioSound*>> sound_dict_;
+
+    // reverse index of sound_dict_
+    std::unordered_map<AudioSound*, WeakNodePath> object_dict_;
 };
 
 // ************************************************************************************************
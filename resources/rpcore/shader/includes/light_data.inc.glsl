@@ -76,6 +76,11 @@ float get_pointlight_inner_radius(LightData data) {
     return data.Data2.z;
 }
 
+// Extracts the shadow mode of a point light, see PL_SHADOW_MODE_*
+int get_pointlight_shadow_mode(LightData data) {
+    return gpu_cq_unpack_int_from_float(data.Data2.w);
+}
+
 /*
 
 Spot Light Dataset
@@ -55,6 +55,21 @@ int get_pointlight_source_offs(vec3 direction) {
     return direction.z >= 0.0 ? 4 : 5;
 }
 
+// Selects the face whose direction is closest, the face directions are the
+// vertices of a regular tetrahedron, see RPPointLight::find_shadow_face
+int get_pointlight_tetrahedral_source_offs(vec3 direction) {
+    vec4 d = vec4(
+        direction.x + direction.y + direction.z,
+        direction.x - direction.y - direction.z,
+        -direction.x + direction.y - direction.z,
+        -direction.x - direction.y + direction.z);
+    int face = 0;
+    if (d.y > d[face]) face = 1;
+    if (d.z > d[face]) face = 2;
+    if (d.w > d[face]) face = 3;
+    return face;
+}
+
 // Processes a spot light
 vec3 process_spotlight(Material m, LightData light_data, vec3 view_vector, float shadow_factor) {
     const vec3 transmittance = vec3(1); // <-- TODO
@@ -267,7 +282,9 @@ vec3 shade_material_from_tile_buffer(Material m, ivec3 tile) {
         // Get shadow factor
         int source_index = get_shadow_source_index(light_data);
         vec3 v2l = normalize(m.position - get_light_position(light_data));
-        source_index += get_pointlight_source_offs(v2l);
+        source_index += get_pointlight_shadow_mode(light_data) == PL_SHADOW_MODE_TETRAHEDRAL ?
+            get_pointlight_tetrahedral_source_offs(v2l) :
+            get_pointlight_source_offs(v2l);
 
         SourceData source_data = read_source_data(ShadowSourceData, source_index * 5);
         float shadow_factor = filter_shadowmap(m, source_data, v2l);
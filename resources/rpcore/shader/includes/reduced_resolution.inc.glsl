@@ -0,0 +1,50 @@
+/**
+ *
+ * RenderPipeline
+ *
+ * Copyright (c) 2014-2016 tobspr <tobias.springer1@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+// Parameters of BilateralUpscaler.
+// x: Divisor of the resolution, y: 1 for checkerboard rendering,
+// z: Checkerboard parity of the current frame
+uniform ivec3 reducedResolutionParams;
+
+// Returns the full resolution pixel which is rendered by a texel of the
+// reduced resolution target
+ivec2 get_reduced_full_coord(ivec2 source_coord) {
+    if (reducedResolutionParams.y != 0) {
+        int offset = (source_coord.y + reducedResolutionParams.z) & 1;
+        return ivec2(source_coord.x * 2 + offset, source_coord.y);
+    }
+    return source_coord * reducedResolutionParams.x;
+}
+
+// Returns whether a full resolution pixel is rendered in checkerboard mode
+bool is_checkerboard_rendered(ivec2 coord) {
+    return ((coord.x + coord.y + reducedResolutionParams.z) & 1) == 0;
+}
+
+// Same as get_half_texcoord(), but for any reduced resolution mode
+#define get_reduced_texcoord() vec2((get_reduced_full_coord(ivec2(gl_FragCoord.xy)) + 0.5) / SCREEN_SIZE)
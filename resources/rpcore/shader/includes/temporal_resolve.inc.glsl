@@ -114,6 +114,14 @@ vec4 clip_aabb(vec3 aabb_min, vec3 aabb_max, vec4 p, vec4 q)
 }
 
 
+// Shared disocclusion test: weight of the history sample, which goes to zero when
+// the reprojected surface position is farther than the distance-scaled tolerance.
+float get_temporal_rejection_weight(vec3 curr_pos, vec3 last_pos, vec3 camera_pos) {
+    float max_distance = RS_DISTANCE_SCALE * distance(curr_pos, camera_pos) / 10.0;
+    float weight = 1.0 - saturate(distance(curr_pos, last_pos) / max_distance);
+    return weight * (1 - 1.0 / RS_KEEP_GOOD_DURATION);
+}
+
 #if RS_USE_POSITION_TECHNIQUE
     #if STEREO_MODE
         uniform sampler2DArray Previous_SceneDepth;
@@ -160,16 +168,12 @@ vec4 resolve_temporal(sampler2D current_tex, sampler2D last_tex, vec2 curr_coord
 #endif
 
             // Weight by distance
-            float max_distance = RS_DISTANCE_SCALE;
 #if STEREO_MODE
-            max_distance *= distance(curr_pos, MainSceneData.stereo_camera_pos[view_index]) / 10.0;
+            float weight = get_temporal_rejection_weight(curr_pos, last_pos, MainSceneData.stereo_camera_pos[view_index]);
 #else
-            max_distance *= distance(curr_pos, MainSceneData.camera_pos) / 10.0;
+            float weight = get_temporal_rejection_weight(curr_pos, last_pos, MainSceneData.camera_pos);
 #endif
 
-            float weight = 1.0 - saturate(distance(curr_pos, last_pos) / max_distance);
-            weight *= 1 - 1.0 / RS_KEEP_GOOD_DURATION;
-
 #if STEREO_MODE
             vec4 last_m = textureLod(last_tex, vec3(last_coord, view_index), 0);
 #else
@@ -0,0 +1,51 @@
+/**
+ *
+ * RenderPipeline
+ *
+ * Copyright (c) 2014-2016 tobspr <tobias.springer1@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+// Weighted blended order-independent transparency
+// (McGuire and Bavoil, "Weighted Blended Order-Independent Transparency", 2013).
+// Keep this in sync with ForwardStage::compute_oit_weight of the forward_shading plugin.
+
+// Weight of a fragment, from the distance to the camera and its coverage.
+float get_oit_weight(float view_depth, float alpha) {
+    float d5 = view_depth / 5.0;
+    float d200 = view_depth / 200.0;
+    float d200_2 = d200 * d200;
+    float weight = 10.0 / (1e-5 + d5 * d5 + d200_2 * d200_2 * d200_2);
+    return alpha * clamp(weight, 1e-2, 3e3);
+}
+
+// The revealage is the product of (1 - alpha). It is accumulated as sum of
+// -log(1 - alpha), so that both targets use the same additive blending.
+float get_oit_revealage_term(float alpha) {
+    return -log(max(1.0 - alpha, 1e-4));
+}
+
+// Revealage from the accumulated terms
+float get_oit_revealage(float revealage_sum) {
+    return exp(-revealage_sum);
+}
@@ -29,7 +29,7 @@
 #pragma include "render_pipeline_base.inc.glsl"
 
 uniform samplerBuffer CommandQueue;
-uniform writeonly imageBuffer RESTRICT LightData;
+layout(rgba16f) uniform imageBuffer RESTRICT LightData;
 uniform writeonly imageBuffer RESTRICT SourceData;
 uniform int commandCount;
 
@@ -54,6 +54,37 @@ vec4 read_vec4(inout int stack_ptr) {
         );
 }
 
+// Reads a 16 bit unsigned integer, which is always stored as float value
+uint read_uint16(inout int stack_ptr) {
+    return uint(read_float(stack_ptr));
+}
+
+// Reads a word of the compact light data, stored as two 16 bit integers
+uint read_split_word(inout int stack_ptr) {
+    uint lo = read_uint16(stack_ptr);
+    uint hi = read_uint16(stack_ptr);
+    return lo | (hi << 16u);
+}
+
+// Decodes a color stored as RGB9E5, see LightDataCodec::decode_rgb9e5
+vec3 decode_rgb9e5(uint packed) {
+    float scale = exp2(float(int(packed >> 27u) - 15 - 9));
+    return vec3(
+        float(packed & 0x1FFu),
+        float((packed >> 9u) & 0x1FFu),
+        float((packed >> 18u) & 0x1FFu)) * scale;
+}
+
+// Decodes an octahedral direction, see LightDataCodec::decode_octahedral
+vec3 decode_octahedral(uint packed) {
+    vec2 v = unpackSnorm2x16(packed);
+    float z = 1.0 - abs(v.x) - abs(v.y);
+    if (z < 0.0) {
+        v = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(vec3(v, z));
+}
+
 void main() {
 
     // Store a pointer to the current stack index, its passed as a handle to all
@@ -99,6 +130,73 @@ void main() {
                 break;
             }
 
+            // Store changed words of lights, see LightDataCodec and
+            // InternalLightManager::flush_light_updates
+            case CMD_store_light_delta: {
+                int num_entries = read_int(stack_ptr);
+
+                for (int entry = 0; entry < num_entries; ++entry) {
+                    // The header is stored as a single integer
+                    uint header = uint(read_float(stack_ptr));
+                    int offs = int(header & 0xFFFFu) * 4;
+                    uint mask = (header >> 16u) & 0x7Fu;
+
+                    if ((header & (1u << 23u)) != 0u) {
+                        for (int i = 0; i < 4; ++i) {
+                            imageStore(LightData, offs + i, vec4(0));
+                        }
+                        continue;
+                    }
+
+                    vec4 data[4];
+                    for (int i = 0; i < 4; ++i) {
+                        data[i] = mask == 0x7Fu ? vec4(0) : imageLoad(LightData, offs + i);
+                    }
+
+                    // Type, IES profile and shadow source
+                    if ((mask & 1u) != 0u) {
+                        uint word = read_split_word(stack_ptr);
+                        data[0].x = float(word & 0xFu);
+                        data[0].y = float(int((word >> 4u) & 0xFFFu) - 1);
+                        data[0].z = float(int(word >> 16u) - 1);
+                    }
+
+                    // Position
+                    if ((mask & 2u) != 0u) data[0].w = read_float(stack_ptr);
+                    if ((mask & 4u) != 0u) data[1].x = read_float(stack_ptr);
+                    if ((mask & 8u) != 0u) data[1].y = read_float(stack_ptr);
+
+                    // Color
+                    if ((mask & 16u) != 0u) {
+                        vec3 color = decode_rgb9e5(read_split_word(stack_ptr));
+                        data[1].zw = color.xy;
+                        data[2].x = color.z;
+                    }
+
+                    // Radius, and inner radius or fov
+                    if ((mask & 32u) != 0u) {
+                        data[2].yz = unpackHalf2x16(read_split_word(stack_ptr));
+                    }
+
+                    // Spot light direction, or point light shadow mode
+                    if ((mask & 64u) != 0u) {
+                        uint word = read_split_word(stack_ptr);
+                        if (int(data[0].x) == LT_SPOT_LIGHT) {
+                            vec3 direction = decode_octahedral(word);
+                            data[2].w = direction.x;
+                            data[3].xy = direction.yz;
+                        } else if (int(data[0].x) == LT_POINT_LIGHT) {
+                            data[2].w = float(word);
+                        }
+                    }
+
+                    for (int i = 0; i < 4; ++i) {
+                        imageStore(LightData, offs + i, data[i]);
+                    }
+                }
+                break;
+            }
+
             // Store Source
             case CMD_store_source: {
 
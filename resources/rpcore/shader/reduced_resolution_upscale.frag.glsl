@@ -0,0 +1,122 @@
+/**
+ *
+ * RenderPipeline
+ *
+ * Copyright (c) 2014-2016 tobspr <tobias.springer1@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#version 430
+
+// Shader which upscales the reduced resolution image of BilateralUpscaler to
+// full resolution, respecting the normals and depth.
+// The weights must match BilateralUpscaler::compute_weight on the CPU.
+
+#pragma optionNV (unroll all)
+
+#pragma include "render_pipeline_base.inc.glsl"
+#pragma include "includes/gbuffer.inc.glsl"
+#pragma include "includes/reduced_resolution.inc.glsl"
+
+// x: Max depth difference, y: Max normal difference
+uniform vec2 upscaleWeights;
+#if STEREO_MODE
+uniform sampler2DArray SourceTex;
+#else
+uniform sampler2D SourceTex;
+#endif
+uniform GBufferData GBuffer;
+
+out vec4 result;
+
+#if STEREO_MODE
+    #define fetch_source(coord) texelFetch(SourceTex, ivec3(coord, gl_Layer), 0)
+    #define fetch_depth(coord) get_gbuffer_depth(GBuffer, coord, gl_Layer)
+    #define fetch_normal(coord) get_gbuffer_normal(GBuffer, coord, gl_Layer)
+#else
+    #define fetch_source(coord) texelFetch(SourceTex, coord, 0)
+    #define fetch_depth(coord) get_gbuffer_depth(GBuffer, coord)
+    #define fetch_normal(coord) get_gbuffer_normal(GBuffer, coord)
+#endif
+
+float get_upscale_weight(float mid_depth, vec3 mid_nrm, ivec2 full_coord) {
+    float depth_diff = abs(fetch_depth(full_coord) - mid_depth) / upscaleWeights.x;
+    float nrm_diff = max(0, dot(fetch_normal(full_coord), mid_nrm));
+    return (1.0 - saturate(depth_diff)) * pow(nrm_diff, 1.0 / upscaleWeights.y);
+}
+
+void main() {
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+    ivec2 screen_size = ivec2(SCREEN_SIZE);
+
+    ivec2 source_coords[4];
+    ivec2 full_coords[4];
+
+    if (reducedResolutionParams.y != 0) {
+        // Checkerboard: the pixel itself or its 4 direct neighbors are rendered.
+        // On the border, the neighbors are mirrored to keep the parity.
+        if (is_checkerboard_rendered(coord)) {
+            result = fetch_source(ivec2(coord.x / 2, coord.y));
+            return;
+        }
+
+        int x0 = coord.x - 1 < 0 ? coord.x + 1 : coord.x - 1;
+        int x1 = coord.x + 1 >= screen_size.x ? coord.x - 1 : coord.x + 1;
+        int y0 = coord.y - 1 < 0 ? coord.y + 1 : coord.y - 1;
+        int y1 = coord.y + 1 >= screen_size.y ? coord.y - 1 : coord.y + 1;
+
+        full_coords[0] = ivec2(x0, coord.y);
+        full_coords[1] = ivec2(x1, coord.y);
+        full_coords[2] = ivec2(coord.x, y0);
+        full_coords[3] = ivec2(coord.x, y1);
+        for (int i = 0; i < 4; ++i) {
+            source_coords[i] = ivec2(full_coords[i].x / 2, full_coords[i].y);
+        }
+    } else {
+        // 2x2 texels around the pixel
+        int divisor = reducedResolutionParams.x;
+        ivec2 source_max = (screen_size + divisor - 1) / divisor - 1;
+        ivec2 base = coord / divisor;
+        for (int i = 0; i < 4; ++i) {
+            source_coords[i] = min(base + ivec2(i & 1, i >> 1), source_max);
+            full_coords[i] = source_coords[i] * divisor;
+        }
+    }
+
+    float mid_depth = fetch_depth(coord);
+    vec3 mid_nrm = fetch_normal(coord);
+
+    float weights = 0.0;
+    vec4 accum = vec4(0);
+    for (int i = 0; i < 4; ++i) {
+        float weight = get_upscale_weight(mid_depth, mid_nrm, full_coords[i]);
+        accum += fetch_source(source_coords[i]) * weight;
+        weights += weight;
+    }
+
+    if (weights < 1e-5) {
+        // When no sample was valid, take the first sample - this is still
+        // better than invalid pixels
+        result = fetch_source(source_coords[0]);
+    } else {
+        result = accum / weights;
+    }
+}
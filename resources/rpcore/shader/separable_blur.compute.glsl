@@ -0,0 +1,113 @@
+/**
+ *
+ * RenderPipeline
+ *
+ * Copyright (c) 2014-2016 tobspr <tobias.springer1@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#version 430
+
+// Depth and normal aware separable blur, see SeparableBlur.
+// A work group blurs BLUR_GROUP_SIZE pixels of a row (or column). The values,
+// normals and depths of the segment and its borders are cached in shared
+// memory, so each texel is fetched once per pass.
+
+#pragma optionNV (unroll all)
+
+#pragma include "render_pipeline_base.inc.glsl"
+#pragma include "includes/gbuffer.inc.glsl"
+
+// These have to match SeparableBlur
+#define BLUR_GROUP_SIZE 128
+#define BLUR_MAX_SPAN 32
+#define BLUR_MAX_KERNEL_SIZE 17
+
+layout(local_size_x = BLUR_GROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+uniform ivec2 blur_direction;
+uniform int blur_radius;
+uniform int pixel_stretch;
+uniform float blur_weights[BLUR_MAX_KERNEL_SIZE];
+
+// x: Normal factor, y: Depth factor
+uniform vec2 blur_factors;
+
+uniform sampler2D SourceTex;
+uniform sampler2D DownscaledDepth;
+uniform GBufferData GBuffer;
+uniform writeonly image2D DestTex;
+
+#define CACHE_SIZE (BLUR_GROUP_SIZE + 2 * BLUR_MAX_SPAN)
+shared vec4 cached_values[CACHE_SIZE];
+shared vec4 cached_geometry[CACHE_SIZE];
+
+void main() {
+    ivec2 size = imageSize(DestTex);
+    bool horizontal = blur_direction.x != 0;
+    int line_length = horizontal ? size.x : size.y;
+    int group_start = int(gl_WorkGroupID.x) * BLUR_GROUP_SIZE;
+    int line = int(gl_WorkGroupID.y);
+    int span = blur_radius * pixel_stretch;
+
+    // Load the segment and the span on both sides, clamped to the border
+    for (int i = int(gl_LocalInvocationID.x); i < BLUR_GROUP_SIZE + 2 * span; i += BLUR_GROUP_SIZE) {
+        int along = clamp(group_start - span + i, 0, line_length - 1);
+        ivec2 load_coord = horizontal ? ivec2(along, line) : ivec2(line, along);
+        vec2 texcoord = (load_coord + 0.5) / vec2(size);
+        cached_values[i] = texelFetch(SourceTex, load_coord, 0);
+        cached_geometry[i] = vec4(
+            get_gbuffer_normal(GBuffer, texcoord),
+            textureLod(DownscaledDepth, texcoord, 0).x);
+    }
+
+    barrier();
+
+    int along = group_start + int(gl_LocalInvocationID.x);
+    if (along >= line_length) {
+        return;
+    }
+
+    int center = int(gl_LocalInvocationID.x) + span;
+    vec3 pixel_nrm = cached_geometry[center].xyz;
+    float pixel_depth = cached_geometry[center].w;
+
+    vec4 accum = vec4(0);
+    float accum_w = 0.0;
+
+    // Must match SeparableBlur::compute_bilateral_weight
+    for (int i = -blur_radius; i <= blur_radius; ++i) {
+        int index = center + i * pixel_stretch;
+        vec4 geometry = cached_geometry[index];
+
+        float weight = blur_weights[abs(i)];
+        weight *= 1.0 - saturate(blur_factors.x * distance(geometry.xyz, pixel_nrm));
+        weight *= 1.0 - saturate(blur_factors.y * abs(geometry.w - pixel_depth) * 3);
+
+        accum += cached_values[index] * weight;
+        accum_w += weight;
+    }
+
+    accum /= max(0.04, accum_w);
+
+    ivec2 coord = horizontal ? ivec2(along, line) : ivec2(line, along);
+    imageStore(DestTex, coord, accum);
+}
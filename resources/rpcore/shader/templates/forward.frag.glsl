@@ -70,14 +70,41 @@ uniform sampler2DArray ShadedScene;
 uniform sampler2D ShadedScene;
 #endif
 
+#if IN_FORWARD_OIT_SHADER
+    #pragma include "includes/weighted_oit.inc.glsl"
+
+    #if STEREO_MODE
+    uniform sampler2DArray SceneDepth;
+    #else
+    uniform sampler2D SceneDepth;
+    #endif
+#endif
+
 %inout%
 
-layout(location = 0) out vec4 color_result;
+#if IN_FORWARD_OIT_SHADER
+    // Accumulated premultiplied color and coverage, and revealage term
+    layout(location = 0) out vec4 color_result;
+    layout(location = 1) out vec4 revealage_result;
+#else
+    layout(location = 0) out vec4 color_result;
+#endif
 
 void main() {
 
     %main_begin%
 
+    #if IN_FORWARD_OIT_SHADER
+        // The weighted blended pass has no depth buffer of the scene, so hide
+        // the fragments behind the deferred scene here.
+        #if STEREO_MODE
+            float scene_depth = textureLod(SceneDepth, vec3(get_texcoord(), gl_Layer), 0).x;
+        #else
+            float scene_depth = textureLod(SceneDepth, get_texcoord(), 0).x;
+        #endif
+        if (gl_FragCoord.z > scene_depth) discard;
+    #endif
+
     MaterialBaseInput mInput = get_input_from_p3d(p3d_Material);
 
     vec2 texcoord = vOutput.texcoord;
@@ -170,10 +197,11 @@ void main() {
     Material m_out = emulate_gbuffer_pass(m, vOutput.position);
 
     #if STEREO_MODE
-        vec3 view_dir = normalize(m_out.position - MainSceneData.stereo_camera_pos[gl_Layer]);
+        vec3 view_dir_unnormalized = m_out.position - MainSceneData.stereo_camera_pos[gl_Layer];
     #else
-        vec3 view_dir = normalize(m_out.position - MainSceneData.camera_pos);
+        vec3 view_dir_unnormalized = m_out.position - MainSceneData.camera_pos;
     #endif
+    vec3 view_dir = normalize(view_dir_unnormalized);
     vec3 color = vec3(0);
 
     float alpha = m_out.shading_model_param0 == 2 ? sampled_diffuse.w : m_out.shading_model_param0;
@@ -187,8 +215,14 @@ void main() {
 
     alpha = mix(alpha, 1.0, ambient.fresnel);
 
+    #if IN_FORWARD_OIT_SHADER
+        // Order independent, so the objects of this pass are not sorted
+        float view_dist = length(view_dir_unnormalized);
+        color_result = vec4(color * alpha, alpha) * get_oit_weight(view_dist, alpha);
+        revealage_result = vec4(get_oit_revealage_term(alpha));
+
     // Refraction (experimental)
-    #if 0
+    #elif 0
         vec3 refracted_vector_view = refract(view_dir, m_out.normal, 1.04);
         float refraction_dist = 0.5;
         vec3 refraction_dest = m_out.position + refracted_vector_view * refraction_dist;
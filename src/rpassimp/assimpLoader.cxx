@@ -15,6 +15,10 @@
 
 #include <regex>
 #include <numeric>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstring>
 
 #include "geomNode.h"
 #include "luse.h"
@@ -67,6 +71,141 @@ struct BoneWeight
 
 typedef pvector<BoneWeight> BoneWeightList;
 
+/**
+ * Read-only stream buffer on the memory of an embedded texture, so that the
+ * decoders read it without copying.
+ */
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+    MemoryStreamBuf(const char *data, size_t size)
+    {
+        char *begin = const_cast<char *>(data);
+        setg(begin, begin, begin + size);
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+    {
+        if (!(which & std::ios_base::in))
+            return pos_type(off_type(-1));
+
+        char *target = nullptr;
+        if (dir == std::ios_base::beg)
+            target = eback() + off;
+        else if (dir == std::ios_base::cur)
+            target = gptr() + off;
+        else
+            target = egptr() + off;
+
+        if (target < eback() || target > egptr())
+            return pos_type(off_type(-1));
+
+        setg(eback(), target, egptr());
+        return pos_type(target - eback());
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+    {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+/**
+ * Returns the index of the key at or before the time.  Keys are sorted by time.
+ */
+template <class KeyType>
+static unsigned int find_key(const KeyType *keys, unsigned int num_keys, double time)
+{
+    const KeyType *found = std::upper_bound(keys, keys + num_keys, time, [](double t, const KeyType &key) {
+        return t < key.mTime;
+    });
+    return found == keys ? 0 : static_cast<unsigned int>(found - keys - 1);
+}
+
+/**
+ * Returns the interpolation factor of the time between the key and the next key.
+ * Times within a small fraction of the key interval snap to the key, so that
+ * evenly spaced keys are reproduced exactly.
+ */
+template <class KeyType>
+static double get_key_factor(const KeyType *keys, unsigned int num_keys, unsigned int index, double time)
+{
+    if (index + 1 >= num_keys || time <= keys[index].mTime)
+        return 0;
+
+    const double interval = keys[index + 1].mTime - keys[index].mTime;
+    if (interval <= 0)
+        return 0;
+
+    const double factor = (time - keys[index].mTime) / interval;
+    if (factor < 1e-5)
+        return 0;
+    if (factor > 1 - 1e-5)
+        return 1;
+    return factor;
+}
+
+static aiVector3D sample_vector_keys(const aiVectorKey *keys, unsigned int num_keys, double time)
+{
+    const unsigned int index = find_key(keys, num_keys, time);
+    const double factor = get_key_factor(keys, num_keys, index, time);
+    if (factor == 0)
+        return keys[index].mValue;
+    if (factor == 1)
+        return keys[index + 1].mValue;
+
+    const aiVector3D &a = keys[index].mValue;
+    const aiVector3D &b = keys[index + 1].mValue;
+    return a + (b - a) * static_cast<ai_real>(factor);
+}
+
+static aiQuaternion sample_quat_keys(const aiQuatKey *keys, unsigned int num_keys, double time)
+{
+    const unsigned int index = find_key(keys, num_keys, time);
+    const double factor = get_key_factor(keys, num_keys, index, time);
+    if (factor == 0)
+        return keys[index].mValue;
+    if (factor == 1)
+        return keys[index + 1].mValue;
+
+    aiQuaternion out;
+    aiQuaternion::Interpolate(out, keys[index].mValue, keys[index + 1].mValue, static_cast<ai_real>(factor));
+    return out.Normalize();
+}
+
+/**
+ * Returns true if the values have the same bits, so that -0 and 0 differ.
+ */
+static bool is_same_sample(PN_stdfloat a, PN_stdfloat b)
+{
+    return std::memcmp(&a, &b, sizeof(PN_stdfloat)) == 0;
+}
+
+/**
+ * Converts the samples of a component into a table.  With assimp-compress-anim,
+ * a constant track is stored as one value, or as an empty table if the value is
+ * the default one of the channel.  Values are compared by bits, so the tables
+ * give the same matrices as the uncompressed ones.
+ */
+static PTA_stdfloat make_anim_table(const pvector<PN_stdfloat> &samples, PN_stdfloat default_value)
+{
+    if (assimp_compress_anim && !samples.empty() &&
+        std::all_of(samples.begin() + 1, samples.end(), [&](PN_stdfloat v) { return is_same_sample(v, samples[0]); })) {
+        if (is_same_sample(samples[0], default_value)) {
+            return PTA_stdfloat();
+        }
+
+        PTA_stdfloat table = PTA_stdfloat::empty_array(1);
+        table[0] = samples[0];
+        return table;
+    }
+
+    PTA_stdfloat table = PTA_stdfloat::empty_array(samples.size());
+    std::copy(samples.begin(), samples.end(), table.begin());
+    return table;
+}
+
 AssimpLoader::AssimpLoader() : _error(false), _geoms(nullptr)
 {
     PandaLogger::set_default();
@@ -151,6 +290,12 @@ bool AssimpLoader::read(const Filename &filename)
     }
 
     _error = false;
+
+    _node_index.clear();
+    if (_scene->mRootNode != nullptr) {
+        index_nodes(*_scene->mRootNode);
+    }
+
     return true;
 }
 
@@ -166,9 +311,7 @@ void AssimpLoader::build_graph()
 
     // Import all of the embedded textures first.
     _textures = new PT(Texture)[_scene->mNumTextures];
-    for (size_t i = 0; i < _scene->mNumTextures; ++i) {
-        load_texture(i);
-    }
+    load_textures();
 
     // Then the materials.
     _mat_states = new CPT(RenderState)[_scene->mNumMaterials];
@@ -176,6 +319,16 @@ void AssimpLoader::build_graph()
         load_material(i);
     }
 
+    // Index the animation channels by node name.  If a node has several
+    // channels, the last one is used.
+    _anim_channels.resize(_scene->mNumAnimations);
+    for (size_t i = 0; i < _scene->mNumAnimations; ++i) {
+        const aiAnimation &anim = *_scene->mAnimations[i];
+        for (size_t j = 0; j < anim.mNumChannels; ++j) {
+            _anim_channels[i][anim.mChannels[j]->mNodeName.C_Str()] = anim.mChannels[j];
+        }
+    }
+
     // And then the meshes.
     _geoms = new PT(Geom)[_scene->mNumMeshes];
     _geom_matindices = new unsigned int[_scene->mNumMeshes];
@@ -197,28 +350,127 @@ void AssimpLoader::build_graph()
     delete[] _mat_states;
     delete[] _geoms;
     delete[] _geom_matindices;
+
+    _anim_channels.clear();
+    _anim_bundles.clear();
+    _bones.clear();
+    _skeleton_roots.clear();
+}
+
+void AssimpLoader::index_nodes(const aiNode &node)
+{
+    // Keep the first node in depth-first order like the recursive search.
+    _node_index.emplace(std::string(node.mName.data, node.mName.length), &node);
+    for (size_t i = 0; i < node.mNumChildren; ++i) {
+        index_nodes(*node.mChildren[i]);
+    }
+}
+
+const aiNode *AssimpLoader::find_node(const aiString &name) const
+{
+    auto found = _node_index.find(std::string(name.data, name.length));
+    return found != _node_index.end() ? found->second : nullptr;
+}
+
+bool AssimpLoader::is_bone(const aiNode *node) const
+{
+    return node && _bones.find(node) != _bones.end();
 }
 
-const aiNode *AssimpLoader::find_node(const aiNode &root, const aiString &name)
+void AssimpLoader::add_bone(const aiNode *node)
 {
-    const aiNode* node = nullptr;
+    if (_bones.insert(node).second) {
+        _skeleton_roots.clear();
+    }
+}
 
-    if (root.mName == name) {
-        return &root;
+const aiNode *AssimpLoader::get_skeleton_root(const aiNode *node)
+{
+    auto found = _skeleton_roots.find(node);
+    if (found != _skeleton_roots.end()) {
+        return found->second;
+    }
+
+    const aiNode *root = node;
+    while (root->mParent && is_bone(root->mParent)) {
+        root = root->mParent;
+    }
+
+    _skeleton_roots.emplace(node, root);
+    return root;
+}
+
+void AssimpLoader::load_textures()
+{
+    const size_t num_textures = _scene->mNumTextures;
+
+    // Only the images are decoded on the workers.  Creating Panda3D objects
+    // is not safe on other threads, so the Textures are created here after
+    // the workers are done.
+    pvector<PNMImage> images(num_textures);
+    pvector<unsigned char> decoded(num_textures, 0);
+
+    size_t num_threads = assimp_texture_threads > 0 ? static_cast<size_t>(assimp_texture_threads) :
+        (std::max)(1u, std::thread::hardware_concurrency());
+    num_threads = (std::min)(num_threads, num_textures);
+
+    if (num_threads <= 1) {
+        for (size_t i = 0; i < num_textures; ++i) {
+            decoded[i] = decode_texture(i, images[i]);
+        }
     }
     else {
-        for (size_t i = 0; i < root.mNumChildren; ++i) {
-            node = find_node(*root.mChildren[i], name);
-            if (node) {
-                return node;
-            }
+        // Initialize the registry of the image types before the workers use it.
+        PNMFileTypeRegistry::get_global_ptr();
+
+        // Textures have various sizes, so workers take the next one when done.
+        std::atomic<size_t> next_index(0);
+        std::vector<std::thread> workers;
+        workers.reserve(num_threads);
+        for (size_t t = 0; t < num_threads; ++t) {
+            workers.emplace_back([this, &next_index, &images, &decoded, num_textures]() {
+                for (size_t i = next_index++; i < num_textures; i = next_index++) {
+                    decoded[i] = decode_texture(i, images[i]);
+                }
+            });
         }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+
+    for (size_t i = 0; i < num_textures; ++i) {
+        load_texture(i, decoded[i] ? &images[i] : nullptr);
+    }
+}
+
+bool AssimpLoader::decode_texture(size_t index, PNMImage &image) const
+{
+    const aiTexture &tex = *_scene->mTextures[index];
+
+    // Raw textures are copied, and DDS is read into the Texture directly.
+    if (tex.mHeight != 0 || strncmp(tex.achFormatHint, "dds", 3) == 0)
+        return false;
+
+    const PNMFileTypeRegistry *reg = PNMFileTypeRegistry::get_global_ptr();
+    PNMFileType *ftype;
+
+    // Work around a bug in Assimp, it sometimes writes jp instead of jpg
+    if (strncmp(tex.achFormatHint, "jp\0", 3) == 0)
+    {
+        ftype = reg->get_type_from_extension("jpg");
+    }
+    else
+    {
+        ftype = reg->get_type_from_extension(tex.achFormatHint);
     }
 
-    return nullptr;
+    MemoryStreamBuf buf(reinterpret_cast<const char *>(tex.pcData), tex.mWidth);
+    std::istream str(&buf);
+    return image.read(str, "", ftype);
 }
 
-void AssimpLoader::load_texture(size_t index)
+void AssimpLoader::load_texture(size_t index, const PNMImage *image)
 {
     const aiTexture &tex = *_scene->mTextures[index];
 
@@ -229,37 +481,20 @@ void AssimpLoader::load_texture(size_t index)
         // Compressed texture.
         rpassimp_cat.debug()
             << "Reading embedded compressed texture with format " << tex.achFormatHint << " and size " << tex.mWidth << std::endl;
-        stringstream str;
-        str.write((char*)tex.pcData, tex.mWidth);
 
         if (strncmp(tex.achFormatHint, "dds", 3) == 0)
         {
+            MemoryStreamBuf buf(reinterpret_cast<const char *>(tex.pcData), tex.mWidth);
+            std::istream str(&buf);
             ptex->read_dds(str);
         }
+        else if (image)
+        {
+            ptex->load(*image);
+        }
         else
         {
-            const PNMFileTypeRegistry *reg = PNMFileTypeRegistry::get_global_ptr();
-            PNMFileType *ftype;
-            PNMImage img;
-
-            // Work around a bug in Assimp, it sometimes writes jp instead of jpg
-            if (strncmp(tex.achFormatHint, "jp\0", 3) == 0)
-            {
-                ftype = reg->get_type_from_extension("jpg");
-            }
-            else
-            {
-                ftype = reg->get_type_from_extension(tex.achFormatHint);
-            }
-
-            if (img.read(str, "", ftype))
-            {
-                ptex->load(img);
-            }
-            else
-            {
-                ptex = nullptr;
-            }
+            ptex = nullptr;
         }
     }
     else
@@ -270,15 +505,10 @@ void AssimpLoader::load_texture(size_t index)
         ptex->setup_2d_texture(tex.mWidth, tex.mHeight, Texture::T_unsigned_byte, Texture::F_rgba);
         PTA_uchar data = ptex->modify_ram_image();
 
-        size_t p = 0;
-        for (size_t i = 0; i < tex.mWidth * tex.mHeight; ++i)
-        {
-            const aiTexel &texel = tex.pcData[i];
-            data[p++] = texel.b;
-            data[p++] = texel.g;
-            data[p++] = texel.r;
-            data[p++] = texel.a;
-        }
+        // aiTexel is laid out as BGRA, which is the order of Panda3D RAM
+        // images, so the texels are copied as they are.
+        static_assert(sizeof(aiTexel) == 4, "aiTexel must be packed BGRA8.");
+        std::memcpy(data.v().data(), tex.pcData, size_t(tex.mWidth) * tex.mHeight * sizeof(aiTexel));
     }
 
     // ostringstream path; path << "tmp" << index << ".png";
@@ -540,74 +770,138 @@ void AssimpLoader::create_joint(Character *character, CharacterJointBundle *bund
         << "Creating joint for: " << node.mName.C_Str() << std::endl;
 
     for (size_t i = 0; i < node.mNumChildren; ++i) {
-        if (_bonemap.find(node.mChildren[i]->mName.C_Str()) != _bonemap.end()) {
+        if (is_bone(node.mChildren[i])) {
             create_joint(character, bundle, joint, *node.mChildren[i]);
         }
     }
 }
 
-void AssimpLoader::create_anim_channel(const aiAnimation &anim, AnimBundle *bundle, AnimGroup *parent, const aiNode &node)
+void AssimpLoader::collect_joints(const aiNode &node, pvector<const aiNode *> &joints) const
+{
+    joints.push_back(&node);
+    for (size_t i = 0; i < node.mNumChildren; ++i) {
+        if (is_bone(node.mChildren[i])) {
+            collect_joints(*node.mChildren[i], joints);
+        }
+    }
+}
+
+AnimBundle *AssimpLoader::get_anim_bundle(size_t anim_index, const pvector<const aiNode *> &roots, const std::string &name)
+{
+    // Key on all joints, because a later mesh with the same roots may have
+    // added bones which the cached bundle does not have channels for.
+    auto key = std::make_pair(anim_index, pvector<const aiNode *>());
+    for (const aiNode *root: roots) {
+        collect_joints(*root, key.second);
+    }
+
+    auto found = _anim_bundles.find(key);
+    if (found != _anim_bundles.end()) {
+        return found->second;
+    }
+
+    const aiAnimation &ai_anim = *_scene->mAnimations[anim_index];
+
+    // Assimp uses 25 ticks per second if the file does not specify it.
+    const double ticks_per_second = ai_anim.mTicksPerSecond > 0 ? ai_anim.mTicksPerSecond : 25.0;
+    const double duration = ai_anim.mDuration / ticks_per_second;
+
+    unsigned int max_keys = 0;
+    for (size_t j = 0; j < ai_anim.mNumChannels; ++j) {
+        const aiNodeAnim &channel = *ai_anim.mChannels[j];
+        max_keys = (std::max)({ max_keys, channel.mNumPositionKeys, channel.mNumRotationKeys, channel.mNumScalingKeys });
+    }
+
+    double fps = assimp_anim_fps;
+    if (fps <= 0 && duration > 0 && max_keys > 1) {
+        fps = (max_keys - 1) / duration;
+    }
+
+    int frames = 1;
+    if (fps > 0 && duration > 0) {
+        frames = static_cast<int>(std::floor(duration * fps + 0.5)) + 1;
+    }
+    else {
+        fps = 24;
+    }
+
+    rpassimp_cat.debug()
+        << "Converting animation (" << ai_anim.mName.C_Str() << "): FPS " << fps << ", Frames " << frames << std::endl;
+
+    PT(AnimBundle) bundle = new AnimBundle(name, static_cast<PN_stdfloat>(fps), frames);
+    PT(AnimGroup) skeleton = new AnimGroup(bundle, "<skeleton>");
+
+    for (const aiNode *root: roots) {
+        create_anim_channel(_anim_channels[anim_index], ticks_per_second / fps, bundle, skeleton, *root);
+    }
+
+    _anim_bundles[key] = bundle;
+    return bundle;
+}
+
+void AssimpLoader::create_anim_channel(const ChannelMap &channels, double ticks_per_frame, AnimBundle *bundle, AnimGroup *parent, const aiNode &node)
 {
     PT(AnimChannelMatrixXfmTable) group = new AnimChannelMatrixXfmTable(parent, node.mName.C_Str());
 
     // See if there is a channel for this node
-    aiNodeAnim *node_anim = nullptr;
-    for (size_t i = 0; i < anim.mNumChannels; ++i) {
-        if (anim.mChannels[i]->mNodeName == node.mName) {
-            node_anim = anim.mChannels[i];
-        }
-    }
+    auto found = channels.find(node.mName.C_Str());
+    const aiNodeAnim *node_anim = found != channels.end() ? found->second : nullptr;
 
     if (node_anim)
     {
         rpassimp_cat.debug()
             << "Found channel for node: " << node.mName.C_Str() << std::endl;
-        // rpassimp_cat.debug() << "Num Position Keys " <<
-        // node_anim->mNumPositionKeys << std::endl; rpassimp_cat.debug() << "Num
-        // Rotation Keys " << node_anim->mNumRotationKeys << std::endl;
-        // rpassimp_cat.debug() << "Num Scaling Keys " << node_anim->mNumScalingKeys
-        // << std::endl;
-
-        // Convert positions
-        PTA_stdfloat tablex = PTA_stdfloat::empty_array(node_anim->mNumPositionKeys);
-        PTA_stdfloat tabley = PTA_stdfloat::empty_array(node_anim->mNumPositionKeys);
-        PTA_stdfloat tablez = PTA_stdfloat::empty_array(node_anim->mNumPositionKeys);
-        for (size_t i = 0; i < node_anim->mNumPositionKeys; ++i) {
-            tablex[i] = node_anim->mPositionKeys[i].mValue.x;
-            tabley[i] = node_anim->mPositionKeys[i].mValue.y;
-            tablez[i] = node_anim->mPositionKeys[i].mValue.z;
+
+        // Resample all components to the frames of the bundle.
+        const int frames = bundle->get_num_frames();
+        pvector<PN_stdfloat> samples[9];
+        for (auto& component: samples) {
+            component.resize(frames);
+        }
+
+        for (int f = 0; f < frames; ++f) {
+            const double time = f * ticks_per_frame;
+
+            if (node_anim->mNumPositionKeys > 0) {
+                const aiVector3D pos = sample_vector_keys(node_anim->mPositionKeys, node_anim->mNumPositionKeys, time);
+                samples[0][f] = pos.x;
+                samples[1][f] = pos.y;
+                samples[2][f] = pos.z;
+            }
+
+            if (node_anim->mNumRotationKeys > 0) {
+                const aiQuaternion ai_quat = sample_quat_keys(node_anim->mRotationKeys, node_anim->mNumRotationKeys, time);
+                const LVecBase3 hpr = LQuaternion(ai_quat.w, ai_quat.x, ai_quat.y, ai_quat.z).get_hpr();
+                samples[3][f] = hpr.get_x();
+                samples[4][f] = hpr.get_y();
+                samples[5][f] = hpr.get_z();
+            }
+
+            if (node_anim->mNumScalingKeys > 0) {
+                const aiVector3D scale = sample_vector_keys(node_anim->mScalingKeys, node_anim->mNumScalingKeys, time);
+                samples[6][f] = scale.x;
+                samples[7][f] = scale.y;
+                samples[8][f] = scale.z;
+            }
+        }
+
+        if (node_anim->mNumPositionKeys > 0) {
+            group->set_table('x', make_anim_table(samples[0], 0));
+            group->set_table('y', make_anim_table(samples[1], 0));
+            group->set_table('z', make_anim_table(samples[2], 0));
         }
-        group->set_table('x', tablex);
-        group->set_table('y', tabley);
-        group->set_table('z', tablez);
-
-        // Convert rotations
-        PTA_stdfloat tableh = PTA_stdfloat::empty_array(node_anim->mNumRotationKeys);
-        PTA_stdfloat tablep = PTA_stdfloat::empty_array(node_anim->mNumRotationKeys);
-        PTA_stdfloat tabler = PTA_stdfloat::empty_array(node_anim->mNumRotationKeys);
-        for (size_t i = 0; i < node_anim->mNumRotationKeys; ++i) {
-            aiQuaternion ai_quat = node_anim->mRotationKeys[i].mValue;
-            LVecBase3 hpr = LQuaternion(ai_quat.w, ai_quat.x, ai_quat.y, ai_quat.z).get_hpr();
-            tableh[i] = hpr.get_x();
-            tablep[i] = hpr.get_y();
-            tabler[i] = hpr.get_z();
+
+        if (node_anim->mNumRotationKeys > 0) {
+            group->set_table('h', make_anim_table(samples[3], 0));
+            group->set_table('p', make_anim_table(samples[4], 0));
+            group->set_table('r', make_anim_table(samples[5], 0));
         }
-        group->set_table('h', tableh);
-        group->set_table('p', tablep);
-        group->set_table('r', tabler);
-
-        // Convert scales
-        PTA_stdfloat tablei = PTA_stdfloat::empty_array(node_anim->mNumScalingKeys);
-        PTA_stdfloat tablej = PTA_stdfloat::empty_array(node_anim->mNumScalingKeys);
-        PTA_stdfloat tablek = PTA_stdfloat::empty_array(node_anim->mNumScalingKeys);
-        for (size_t i = 0; i < node_anim->mNumScalingKeys; ++i) {
-            tablei[i] = node_anim->mScalingKeys[i].mValue.x;
-            tablej[i] = node_anim->mScalingKeys[i].mValue.y;
-            tablek[i] = node_anim->mScalingKeys[i].mValue.z;
+
+        if (node_anim->mNumScalingKeys > 0) {
+            group->set_table('i', make_anim_table(samples[6], 1));
+            group->set_table('j', make_anim_table(samples[7], 1));
+            group->set_table('k', make_anim_table(samples[8], 1));
         }
-        group->set_table('i', tablei);
-        group->set_table('j', tablej);
-        group->set_table('k', tablek);
     }
     else
     {
@@ -615,8 +909,8 @@ void AssimpLoader::create_anim_channel(const aiAnimation &anim, AnimBundle *bund
     }
 
     for (size_t i = 0; i < node.mNumChildren; ++i) {
-        if (_bonemap.find(node.mChildren[i]->mName.C_Str()) != _bonemap.end()) {
-            create_anim_channel(anim, bundle, group, *node.mChildren[i]);
+        if (is_bone(node.mChildren[i])) {
+            create_anim_channel(channels, ticks_per_frame, bundle, group, *node.mChildren[i]);
         }
     }
 }
@@ -631,11 +925,16 @@ void AssimpLoader::load_mesh(size_t index)
         rpassimp_cat.debug()
             << "Creating character for " << mesh.mName.C_Str() << std::endl;
 
-        // Find and add all bone nodes to the bone map
+        // Find and add all bone nodes to the bone set
         for (size_t i = 0; i < mesh.mNumBones; ++i) {
             const aiBone &bone = *mesh.mBones[i];
-            const aiNode *node = find_node(*_scene->mRootNode, bone.mName);
-            _bonemap[bone.mName.C_Str()] = node;
+            if (const aiNode *node = find_node(bone.mName)) {
+                add_bone(node);
+            }
+            else {
+                rpassimp_cat.warning()
+                    << "Could not find node for bone: " << bone.mName.C_Str() << std::endl;
+            }
         }
 
         // Now create a character from the bones
@@ -646,12 +945,14 @@ void AssimpLoader::load_mesh(size_t index)
         for (size_t i = 0; i < mesh.mNumBones; ++i) {
             const aiBone &bone = *mesh.mBones[i];
 
-            // Find the root bone node
-            const aiNode *root = _bonemap[bone.mName.C_Str()];
-            while (root->mParent && _bonemap.find(root->mParent->mName.C_Str()) != _bonemap.end()) {
-                root = root->mParent;
+            const aiNode *node = find_node(bone.mName);
+            if (!node) {
+                continue;
             }
 
+            // Find the root bone node
+            const aiNode *root = get_skeleton_root(node);
+
             // Don't process this root if we already have a joint for it
             if (character->find_joint(root->mName.C_Str())) {
                 continue;
@@ -714,64 +1015,53 @@ void AssimpLoader::load_mesh(size_t index)
     tb_aformat->add_column(InternalName::make("transform_blend"), 1, Geom::NT_uint16, Geom::C_index);
 
     // Check to see if we need to convert any animations
-    for (size_t i = 0; i < _scene->mNumAnimations; ++i) {
-        aiAnimation &ai_anim = *_scene->mAnimations[i];
-        bool convert_anim = false;
+    if (character) {
+        // Find the root bones of the skeleton
+        pvector<const aiNode *> roots;
+        for (size_t i = 0; i < mesh.mNumBones; ++i) {
+            const aiBone &bone = *mesh.mBones[i];
 
-        rpassimp_cat.debug()
-            << "Checking to see if anim (" << ai_anim.mName.C_Str() << ") matches character (" << mesh.mName.C_Str() << ")\n";
-        for (size_t j = 0; j < ai_anim.mNumChannels; ++j) {
-            rpassimp_cat.debug()
-                << "Searching for " << ai_anim.mChannels[j]->mNodeName.C_Str() << " in bone map" << std::endl;
-            if (_bonemap.find(ai_anim.mChannels[j]->mNodeName.C_Str()) != _bonemap.end()) {
-                convert_anim = true;
-                break;
+            const aiNode *node = find_node(bone.mName);
+            if (!node) {
+                continue;
+            }
+
+            const aiNode *root = get_skeleton_root(node);
+
+            // Only convert root nodes
+            if (root == node) {
+                roots.push_back(root);
             }
         }
 
-        if (convert_anim) {
+        for (size_t i = 0; i < _scene->mNumAnimations; ++i) {
+            const aiAnimation &ai_anim = *_scene->mAnimations[i];
+
             rpassimp_cat.debug()
-                << "Found animation (" << ai_anim.mName.C_Str() << ") for character (" << mesh.mName.C_Str() << ")\n";
+                << "Checking to see if anim (" << ai_anim.mName.C_Str() << ") matches character (" << mesh.mName.C_Str() << ")\n";
 
-            // Now create the animation
-            unsigned int frames = 0;
+            bool convert_anim = false;
             for (size_t j = 0; j < ai_anim.mNumChannels; ++j) {
-                if (ai_anim.mChannels[j]->mNumPositionKeys > frames) {
-                    frames = ai_anim.mChannels[j]->mNumPositionKeys;
-                }
-                if (ai_anim.mChannels[j]->mNumRotationKeys > frames) {
-                    frames = ai_anim.mChannels[j]->mNumRotationKeys;
-                }
-                if (ai_anim.mChannels[j]->mNumScalingKeys > frames) {
-                    frames = ai_anim.mChannels[j]->mNumScalingKeys;
+                if (is_bone(find_node(ai_anim.mChannels[j]->mNodeName))) {
+                    convert_anim = true;
+                    break;
                 }
             }
-            PN_stdfloat fps = frames / (ai_anim.mTicksPerSecond * ai_anim.mDuration);
-            rpassimp_cat.debug()
-                << "FPS " << fps << std::endl;
-            rpassimp_cat.debug()
-                << "Frames " << frames << std::endl;
-
-            PT(AnimBundle) bundle = new AnimBundle(mesh.mName.C_Str(), fps, frames);
-            PT(AnimGroup) skeleton = new AnimGroup(bundle, "<skeleton>");
 
-            for (size_t i = 0; i < mesh.mNumBones; ++i) {
-                const aiBone &bone = *mesh.mBones[i];
+            if (!convert_anim || roots.empty()) {
+                continue;
+            }
 
-                // Find the root bone node
-                const aiNode *root = _bonemap[bone.mName.C_Str()];
-                while (root->mParent && _bonemap.find(root->mParent->mName.C_Str()) != _bonemap.end()) {
-                    root = root->mParent;
-                }
+            rpassimp_cat.debug()
+                << "Found animation (" << ai_anim.mName.C_Str() << ") for character (" << mesh.mName.C_Str() << ")\n";
 
-                // Only convert root nodes
-                if (root->mName == bone.mName) {
-                    create_anim_channel(ai_anim, bundle, skeleton, *root);
+            // Meshes sharing the skeleton share the converted bundle.
+            AnimBundle *bundle = get_anim_bundle(i, roots, mesh.mName.C_Str());
 
-                    // Attach the animation to the character node
-                    PT(AnimBundleNode) bundle_node = new AnimBundleNode(bone.mName.C_Str(), bundle);
-                    character->add_child(bundle_node);
-                }
+            // Attach the animation to the character node
+            for (const aiNode *root: roots) {
+                PT(AnimBundleNode) bundle_node = new AnimBundleNode(root->mName.C_Str(), bundle);
+                character->add_child(bundle_node);
             }
         }
     }
@@ -980,7 +1270,7 @@ void AssimpLoader::load_node(const aiNode &node, PandaNode *parent)
     PT(Character) character;
 
     // Skip nodes we've converted to joints
-    if (_bonemap.find(node.mName.C_Str()) != _bonemap.end()) {
+    if (is_bone(&node)) {
         return;
     }
 
@@ -17,6 +17,10 @@
 #include "modelRoot.h"
 #include "texture.h"
 #include "pmap.h"
+#include "pvector.h"
+
+#include <unordered_map>
+#include <unordered_set>
 
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
@@ -26,6 +30,7 @@ class CharacterJointBundle;
 class PartGroup;
 class AnimBundle;
 class AnimGroup;
+class PNMImage;
 
 namespace rpassimp {
 
@@ -34,8 +39,12 @@ struct char_cmp {
     return strcmp(a,b) < 0;
   }
 };
-typedef pmap<const char *, const aiNode *, char_cmp> BoneMap;
+typedef std::unordered_map<std::string, const aiNode *> NodeIndex;
+typedef std::unordered_set<const aiNode *> BoneSet;
+typedef std::unordered_map<const aiNode *, const aiNode *> SkeletonRootMap;
 typedef pmap<const char *, PT(Character), char_cmp> CharacterMap;
+typedef std::unordered_map<std::string, const aiNodeAnim *> ChannelMap;
+typedef pmap<std::pair<size_t, pvector<const aiNode *>>, PT(AnimBundle)> AnimBundleMap;
 
 /**
  * Class that interfaces with Assimp and builds Panda nodes to represent the
@@ -79,18 +88,63 @@ private:
     CPT(RenderState) *_mat_states;
     PT(Geom) *_geoms;
     unsigned int *_geom_matindices;
-    BoneMap _bonemap;
+    // Nodes by name, indexed once after reading, and the bone nodes found so
+    // far.  Bones are compared by node, so names are only hashed when a bone
+    // is looked up.
+    NodeIndex _node_index;
+    BoneSet _bones;
+    SkeletonRootMap _skeleton_roots;
     CharacterMap _charmap;
 
+    // Channels of each animation by node name, and the bundles converted for
+    // each pair of animation and joint set.  The joints of a root grow when a
+    // later mesh adds bones, so the roots alone do not identify the skeleton.
+    pvector<ChannelMap> _anim_channels;
+    AnimBundleMap _anim_bundles;
+
+    /**
+     * Adds the node and its children to the name index.
+     */
+    void index_nodes(const aiNode &node);
+
     /**
      * Finds a node by name.
      */
-    const aiNode *find_node(const aiNode &root, const aiString &name);
+    const aiNode *find_node(const aiString &name) const;
+
+    /**
+     * Returns true if the node is converted to a joint.
+     */
+    bool is_bone(const aiNode *node) const;
+
+    /**
+     * Adds the node as bone, which invalidates the cached skeleton roots.
+     */
+    void add_bone(const aiNode *node);
+
+    /**
+     * Returns the top-most bone among the bone ancestors of the node.
+     */
+    const aiNode *get_skeleton_root(const aiNode *node);
+
+    /**
+     * Decodes the embedded images on the worker threads, and converts all
+     * embedded textures on the calling thread.
+     */
+    void load_textures();
+
+    /**
+     * Decodes a compressed aiTexture, except DDS, into the image.  This does
+     * not create Panda3D objects, so it is safe to call concurrently for
+     * different indices.
+     */
+    bool decode_texture(size_t index, PNMImage &image) const;
 
     /**
-     * Converts an aiTexture into a Texture.
+     * Converts an aiTexture into a Texture.  The image is the one decoded by
+     * decode_texture(), or nullptr if it is not decoded.
      */
-    void load_texture(size_t index);
+    void load_texture(size_t index, const PNMImage *image);
 
     /**
      * Converts an aiMaterial into a RenderState.
@@ -108,9 +162,21 @@ private:
     void create_joint(Character *character, CharacterJointBundle *bundle, PartGroup *parent, const aiNode &node);
 
     /**
-     * Creates a AnimChannelMatrixXfmTable from an aiNodeAnim
+     * Appends the node and its bone descendants in the order of create_joint.
+     */
+    void collect_joints(const aiNode &node, pvector<const aiNode *> &joints) const;
+
+    /**
+     * Returns the AnimBundle of the animation for the skeleton having the roots.
+     * The animation is converted only once per set of joints.
+     */
+    AnimBundle *get_anim_bundle(size_t anim_index, const pvector<const aiNode *> &roots, const std::string &name);
+
+    /**
+     * Creates a AnimChannelMatrixXfmTable from an aiNodeAnim, resampled to the
+     * frame rate of the bundle.
      */
-    void create_anim_channel(const aiAnimation &anim, AnimBundle *bundle, AnimGroup *parent, const aiNode &node);
+    void create_anim_channel(const ChannelMap &channels, double ticks_per_frame, AnimBundle *bundle, AnimGroup *parent, const aiNode &node);
 
     /**
      * Converts an aiMesh into a Geom.
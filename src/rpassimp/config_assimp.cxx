@@ -82,6 +82,23 @@ ConfigVariableDouble assimp_smooth_normal_angle
         "normals. Note that you may need to clear the model-cache after "
         "changing this."));
 
+ConfigVariableDouble assimp_anim_fps
+("assimp-anim-fps", 0.0,
+    PRC_DESC("The frame rate which animations are resampled to.  If this is 0, "
+        "the rate of the channel having the most keys is used, so evenly "
+        "spaced keys are kept as they are."));
+
+ConfigVariableBool assimp_compress_anim
+("assimp-compress-anim", false,
+    PRC_DESC("Set this true to store constant animation tracks as a single "
+        "value, or as nothing if the value is the default one.  This only "
+        "saves memory, and the animation is the same as without it."));
+
+ConfigVariableInt assimp_texture_threads
+("assimp-texture-threads", 0,
+    PRC_DESC("The number of threads decoding embedded textures.  If this is 0, "
+        "the number of hardware threads is used."));
+
 ConfigureFn(config_rpassimp)
 {
     static bool initialized = false;
@@ -16,6 +16,7 @@
 #include <notifyCategoryProxy.h>
 #include <configVariableBool.h>
 #include "configVariableDouble.h"
+#include <configVariableInt.h>
 
 NotifyCategoryDeclNoExport(rpassimp);
 
@@ -29,3 +30,6 @@ extern ConfigVariableBool assimp_optimize_graph;
 extern ConfigVariableBool assimp_flip_winding_order;
 extern ConfigVariableBool assimp_gen_normals;
 extern ConfigVariableDouble assimp_smooth_normal_angle;
+extern ConfigVariableDouble assimp_anim_fps;
+extern ConfigVariableBool assimp_compress_anim;
+extern ConfigVariableInt assimp_texture_threads;
@@ -38,6 +38,7 @@
 #include "render_pipeline/rpcore/globals.hpp"
 #include "render_pipeline/rpcore/loader.hpp"
 #include "render_pipeline/rpcore/stage_manager.hpp"
+#include "render_pipeline/rpcore/util/shader_variant_manifest.hpp"
 
 #include "rplibs/yaml.hpp"
 
@@ -397,11 +398,19 @@ std::string Effect::Impl::process_shader_template(Effect& self, const Filename&
     // Write the constructed shader and load it back
     const std::string& temp_path = std::string("/$$rptemp/$$effect-") + cache_key + ".glsl";
 
+    std::string content;
+    for (const auto& shader_content: parsed_lines)
+        content += shader_content + "\n";
+
+    // Keep the file if it is not changed, then Shader::load returns the
+    // shader which is already loaded (ex, by ShaderVariantManifest::prewarm).
+    if (rppanda::isfile(temp_path) && VirtualFileSystem::get_global_ptr()->read_file(temp_path, true) == content)
+        return temp_path;
+
     try
     {
         auto file = rppanda::open_write_file(temp_path, false, true);
-        for (const auto& shader_content: parsed_lines)
-            *file << shader_content << std::endl;
+        *file << content;
     }
     catch (const std::exception& err)
     {
@@ -417,6 +426,9 @@ std::shared_ptr<Effect> Effect::load(RenderPipeline& pipeline, const Filename& f
 {
     const std::string& effect_hash = Impl::generate_hash(filename, options);
 
+    if (ShaderVariantManifest* manifest = pipeline.get_shader_variant_manifest())
+        manifest->record_effect(filename, options);
+
     auto found = Impl::global_cache_.find(effect_hash);
     if (found != Impl::global_cache_.end())
         return found->second;
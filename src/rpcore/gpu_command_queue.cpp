@@ -70,7 +70,7 @@ void GPUCommandQueue::register_input(CPT_InternalName key, Texture* val)
 
 void GPUCommandQueue::register_defines()
 {
-    static_assert(GPUCommand::CommandType::CMD_type_count == 5, "GPUCommand::CommandType count is not the same with defined value");
+    static_assert(GPUCommand::CommandType::CMD_type_count == 6, "GPUCommand::CommandType count is not the same with defined value");
 
     auto& defines = pipeline_.get_stage_mgr()->get_defines();
     defines["CMD_invalid"] = std::to_string(GPUCommand::CommandType::CMD_invalid);
@@ -78,6 +78,7 @@ void GPUCommandQueue::register_defines()
     defines["CMD_remove_light"] = std::to_string(GPUCommand::CommandType::CMD_remove_light);
     defines["CMD_store_source"] = std::to_string(GPUCommand::CommandType::CMD_store_source);
     defines["CMD_remove_sources"] = std::to_string(GPUCommand::CommandType::CMD_remove_sources);
+    defines["CMD_store_light_delta"] = std::to_string(GPUCommand::CommandType::CMD_store_light_delta);
     defines["GPU_CMD_INT_AS_FLOAT"] = std::string(GPUCommand::get_uses_integer_packing() ? "1": "0");
 }
 
@@ -72,10 +72,11 @@ std::vector<BufferViewer::EntryType> BufferViewer::get_entries() const
     std::vector<BufferViewer::EntryType> entries;
 
     for (const auto& target: RenderTarget::REGISTERED_TARGETS)
-        entries.push_back({target, EntryID::RENDER_TARGET});
+        entries.push_back({EntryID::RENDER_TARGET, target->get_sort().value(), target, nullptr});
 
-    for (const auto& image: Image::REGISTERED_IMAGES)
-        entries.push_back({image, EntryID::TEXTURE});
+    // the snapshot keeps the textures, because images can be destroyed on loader threads.
+    for (const auto& image: Image::get_registered_images())
+        entries.push_back({EntryID::TEXTURE, image.sort, nullptr, image.texture});
 
     return entries;
 }
@@ -85,26 +86,17 @@ std::pair<size_t, int> BufferViewer::get_stage_information() const
     int count = 0;
     size_t memory = 0;
 
-    const auto& entries = get_entries();
-    for (const auto& entry: entries)
+    // images keep their sizes in the registry.
+    memory += Image::get_registered_images_size();
+    count += static_cast<int>(Image::get_num_registered_images());
+
+    for (const auto& target: RenderTarget::REGISTERED_TARGETS)
     {
-        if (entry.second == EntryID::TEXTURE)
+        for (const auto& id_target: target->get_targets())
         {
-            memory += reinterpret_cast<Image*>(entry.first)->get_texture()->estimate_texture_memory();
+            memory += id_target.second->estimate_texture_memory();
             ++count;
         }
-        else if (entry.second == EntryID::RENDER_TARGET)
-        {
-            for (const auto& id_target: reinterpret_cast<RenderTarget*>(entry.first)->get_targets())
-            {
-                memory += id_target.second->estimate_texture_memory();
-                ++count;
-            }
-        }
-        else
-        {
-            warn(fmt::format("Unknown type: {}", static_cast<int>(entry.second)));
-        }
     }
 
     return {memory, count};
@@ -172,32 +164,24 @@ void BufferViewer::perform_update()
     // Collect texture stages
     _stages.clear();
     auto entries = get_entries();
-    std::sort(entries.begin(), entries.end(), [&](const EntryType& lhs, const EntryType& rhs) {
-        const int lhs_sort = lhs.second == EntryID::RENDER_TARGET ?
-            reinterpret_cast<RenderTarget*>(lhs.first)->get_sort().value() :
-            reinterpret_cast<Image*>(lhs.first)->get_sort();
-
-        const int rhs_sort = rhs.second == EntryID::RENDER_TARGET ?
-            reinterpret_cast<RenderTarget*>(rhs.first)->get_sort().value() :
-            reinterpret_cast<Image*>(rhs.first)->get_sort();
-
-        return lhs_sort < rhs_sort;
+    std::sort(entries.begin(), entries.end(), [](const EntryType& lhs, const EntryType& rhs) {
+        return lhs.sort < rhs.sort;
     });
 
     for (const auto& entry: entries)
     {
-        switch (entry.second)
+        switch (entry.id)
         {
         case EntryID::TEXTURE:
             {
                 if (_display_images)
-                    _stages.push_back({reinterpret_cast<Image*>(entry.first)->get_texture(), entry.second});
+                    _stages.push_back({entry.texture, entry.id});
                 break;
             }
         case EntryID::RENDER_TARGET:
             {
-                for (const auto& key_val: reinterpret_cast<RenderTarget*>(entry.first)->get_targets())
-                    _stages.push_back({key_val.second.p(), entry.second});
+                for (const auto& key_val: entry.target->get_targets())
+                    _stages.push_back({key_val.second, entry.id});
                 break;
             }
         default:
@@ -238,7 +222,7 @@ void BufferViewer::render_stages()
     // Iterate over all stages
     for (const auto& stage_tex_id: _stages)
     {
-        Texture* stage_tex = stage_tex_id.first;
+        Texture* stage_tex = stage_tex_id.first.p();
 
         if (processed.find(stage_tex) != processed.end())
             continue;
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <texture.h>
+
 #include <render_pipeline/rpcore/gui/draggable_window.hpp>
 
 namespace rppanda {
@@ -33,6 +35,7 @@ namespace rpcore {
 
 class TexturePreview;
 class RenderStage;
+class RenderTarget;
 class LabeledCheckbox;
 
 /** This class provides a view into the buffers to inspect them . */
@@ -45,7 +48,17 @@ class BufferViewer : public DraggableWindow
     };
 
 public:
-    using EntryType = std::pair<void*, EntryID>;
+    struct EntryType
+    {
+        EntryID id;
+        int sort;
+
+        /** Valid for EntryID::RENDER_TARGET. */
+        RenderTarget* target;
+
+        /** Valid for EntryID::TEXTURE. */
+        PT(Texture) texture;
+    };
 
     BufferViewer(NodePath parent);
     ~BufferViewer() override;
@@ -92,7 +105,7 @@ private:
     NodePath _content_node;
     std::unique_ptr<LabeledCheckbox> _chb_show_images;
 
-    std::vector<std::pair<Texture*, EntryID>> _stages;
+    std::vector<std::pair<PT(Texture), EntryID>> _stages;
     std::unique_ptr<TexturePreview> _tex_preview;
 
     std::vector<PT(rppanda::DirectFrame)> frame_hovers_;
@@ -39,6 +39,7 @@
 #include "render_pipeline/rpcore/render_pipeline.hpp"
 #include "render_pipeline/rpcore/image.hpp"
 #include "render_pipeline/rpcore/gui/sprite.hpp"
+#include "render_pipeline/rpcore/gui/overlay_batch.hpp"
 #include "render_pipeline/rpcore/gui/error_message_display.hpp"
 #include "render_pipeline/rpcore/render_target.hpp"
 #include "render_pipeline/rpcore/util/task_scheduler.hpp"
@@ -146,17 +147,21 @@ void Debugger::create_stats()
     overlay_node = Globals::base->get_aspect_2d().attach_new_node("Overlay");
     debug_lines_.clear();
 
+    // all lines share one batch, so they are drawn with one Geom per glyph page
+    overlay_batch_ = std::make_unique<OverlayBatch>(overlay_node, TextNode::load_font());
+
+    const float text_size = TextNode::Default::pixel_size * 2.0f / static_cast<float>(Globals::native_resolution.get_y());
     const int num_lines = is_advanced_info_used() ? 6 : 1;
     for (int k = 0; k < num_lines; ++k)
     {
-        debug_lines_.push_back(std::make_unique<TextNode>(
-            overlay_node,
-            TextNode::Default::pixel_size,
-            LVecBase2(0, -k * 0.046f),
-            LVecBase3(0.7, 1, 1),
-            "right"));
+        debug_lines_.push_back(overlay_batch_->add_text(
+            "",
+            LVecBase2f(0, -k * 0.046f),
+            text_size,
+            LColorf(0.7f, 1, 1, 1),
+            OverlayBatch::Align::right));
     }
-    debug_lines_[0]->set_color(LColor(1, 1, 0, 1));
+    overlay_batch_->set_color(debug_lines_[0], LColorf(1, 1, 0, 1));
 }
 
 void Debugger::create_hints()
@@ -217,10 +222,10 @@ void Debugger::handle_window_resize()
     //      (Globals.native_resolution.y // self.gui_scale - 118 - 40))
     //}
 
-    for (const auto& text: debug_lines_)
-    {
-        text->set_pixel_size(16 * (std::max)(0.8f, gui_scale));
-    }
+    const float text_size = 16 * (std::max)(0.8f, gui_scale) * 2.0f / static_cast<float>(Globals::native_resolution.get_y());
+    for (const auto& handle: debug_lines_)
+        overlay_batch_->set_size(handle, text_size);
+    overlay_batch_->update();
 
     buffer_viewer_->center_on_screen();
     pipe_viewer_->center_on_screen();
@@ -327,17 +332,20 @@ void Debugger::toggle_keybindings_visible()
 AsyncTask::DoneStatus Debugger::update_stats(rppanda::FunctionalTask* task)
 {
     const auto& clock = Globals::clock;
-    debug_lines_[0]->set_text(fmt::format("{:3.1f} fps  |  {:3.2f} ms  |  {:3.2f} ms max",
+    overlay_batch_->set_text(debug_lines_[0], fmt::format("{:3.1f} fps  |  {:3.2f} ms  |  {:3.2f} ms max",
         clock->get_average_frame_rate(),
         (1000.0 / (std::max)(0.001, clock->get_average_frame_rate())),
         (clock->get_max_frame_duration() * 1000.0)));
 
     if (!is_advanced_info_used())
+    {
+        overlay_batch_->update();
         return task ? AsyncTask::DS_again : AsyncTask::DS_done;
+    }
 
     const auto& light_mgr = pipeline->get_light_mgr();
 
-    debug_lines_[1]->set_text(fmt::format(
+    overlay_batch_->set_text(debug_lines_[1], fmt::format(
         "{:4d} states |  {:4d} transforms |  {:4d} cmds |  {:4d} lights |  {:4d} shadow |  {:5.1f}% atlas usage",
 
         RenderState::get_num_states(),
@@ -369,12 +377,12 @@ AsyncTask::DoneStatus Debugger::update_stats(rppanda::FunctionalTask* task)
         }
     }
 
-    debug_lines_[2]->set_text(fmt::format(
+    overlay_batch_->set_text(debug_lines_[2], fmt::format(
         "Internal:  {:3.0f} MB VRAM  |  {:5d} img |  {:5d} tex |  "
         "{:5d} fbos |  {:3d} plugins |  {:2d}  views  ({:2d} active)",
 
         (tex_memory_count.first / (1024.0f*1024.0f)),
-        Image::REGISTERED_IMAGES.size(),
+        Image::get_num_registered_images(),
         tex_memory_count.second,
         RenderTarget::REGISTERED_TARGETS.size(),
         pipeline->get_plugin_mgr()->get_enabled_plugins().size(),
@@ -388,7 +396,7 @@ AsyncTask::DoneStatus Debugger::update_stats(rppanda::FunctionalTask* task)
     for (int k = 0; k < tex_count; ++k)
         scene_tex_size += texture_collection.get_texture(k)->estimate_texture_memory();
 
-    debug_lines_[3]->set_text(fmt::format(
+    overlay_batch_->set_text(debug_lines_[3], fmt::format(
         "Scene:   {:4.0f} MB VRAM |  {:3d} tex |  {:4d} geoms |  {:4d} nodes |  {:7d} vertices",
 
         (scene_tex_size / (1024.0*1024.0)),
@@ -408,7 +416,7 @@ AsyncTask::DoneStatus Debugger::update_stats(rppanda::FunctionalTask* task)
     const NodePath& render = Globals::base->get_render();
     const LPoint3& camera_global_pos = camera.get_pos(render);
 
-    debug_lines_[4]->set_text(fmt::format(
+    overlay_batch_->set_text(debug_lines_[4], fmt::format(
         "Time: {} ({:1.3f}) |  Sun  {:0.2f} {:0.2f} {:0.2f} |  X {:4.2f}  Y {:4.2f}  Z {:4.2f} |  {:2d} tasks |  scheduled: {:2d}",
 
         pipeline->get_daytime_mgr()->get_formatted_time(),
@@ -458,7 +466,8 @@ AsyncTask::DoneStatus Debugger::update_stats(rppanda::FunctionalTask* task)
         Globals::resolution.get_y(),
         light_mgr->get_num_tiles().get_x(),
         light_mgr->get_num_tiles().get_y());
-    debug_lines_[5]->set_text(debug_lines_5_text);
+    overlay_batch_->set_text(debug_lines_[5], debug_lines_5_text);
+    overlay_batch_->update();
 
     return task ? AsyncTask::DS_again : AsyncTask::DS_done;
 }
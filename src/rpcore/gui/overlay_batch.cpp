@@ -0,0 +1,392 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "render_pipeline/rpcore/gui/overlay_batch.hpp"
+
+#include <geomNode.h>
+#include <geomTriangles.h>
+#include <geomVertexWriter.h>
+#include <textFont.h>
+#include <textGlyph.h>
+#include <textEncoder.h>
+#include <textureAttrib.h>
+#include <transparencyAttrib.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace rpcore {
+
+size_t OverlayBatch::layout_text(const std::wstring& text, const GlyphLookup& lookup, float line_height,
+    Align align, const LVecBase2f& pos, float size, const LColorf& color, std::vector<BatchQuad>& out)
+{
+    size_t num_quads = 0;
+    std::vector<Glyph> line_glyphs;
+    float z = pos[1];
+
+    size_t line_begin = 0;
+    while (line_begin <= text.size())
+    {
+        size_t line_end = text.find(L'\n', line_begin);
+        if (line_end == std::wstring::npos)
+            line_end = text.size();
+
+        // collect glyphs first to align the line
+        line_glyphs.clear();
+        float width = 0;
+        for (size_t k = line_begin; k < line_end; ++k)
+        {
+            Glyph glyph;
+            if (!lookup(static_cast<int>(text[k]), glyph))
+                continue;
+            width += glyph.advance;
+            line_glyphs.push_back(glyph);
+        }
+
+        float x = pos[0];
+        if (align == Align::right)
+            x -= width * size;
+        else if (align == Align::center)
+            x -= width * size * 0.5f;
+
+        float pen = 0;
+        for (const auto& glyph: line_glyphs)
+        {
+            if (glyph.has_quad)
+            {
+                Quad quad;
+                quad.dimensions = LVecBase4f(
+                    x + (pen + glyph.dimensions[0]) * size,
+                    z + glyph.dimensions[1] * size,
+                    x + (pen + glyph.dimensions[2]) * size,
+                    z + glyph.dimensions[3] * size);
+                quad.texcoords = glyph.texcoords;
+                quad.color = color;
+                out.emplace_back(glyph.state, quad);
+                ++num_quads;
+            }
+            pen += glyph.advance;
+        }
+
+        z -= line_height * size;
+        line_begin = line_end + 1;
+    }
+
+    return num_quads;
+}
+
+size_t OverlayBatch::count_batches(const std::vector<BatchQuad>& quads)
+{
+    std::vector<const RenderState*> keys;
+    for (const auto& quad: quads)
+    {
+        if (std::find(keys.begin(), keys.end(), quad.first.p()) == keys.end())
+            keys.push_back(quad.first.p());
+    }
+    return keys.size();
+}
+
+// ************************************************************************************************
+
+OverlayBatch::OverlayBatch(NodePath parent, TextFont* font): RPObject("OverlayBatch"), font_(font)
+{
+    root_ = parent.attach_new_node("OverlayBatch");
+    root_.set_transparency(TransparencyAttrib::M_alpha);
+    root_.set_depth_test(false);
+    root_.set_depth_write(false);
+
+    lookup_ = [this](int character, Glyph& glyph) {
+        if (!font_)
+            return false;
+
+        // spaces do not have a glyph in DynamicTextFont
+        if (character == ' ')
+        {
+            glyph.has_quad = false;
+            glyph.advance = static_cast<float>(font_->get_space_advance());
+            return true;
+        }
+
+        CPT(TextGlyph) text_glyph;
+        if (!font_->get_glyph(character, text_glyph) || !text_glyph)
+            return false;
+
+        LVecBase4 dimensions;
+        LVecBase4 texcoords;
+        glyph.has_quad = text_glyph->get_quad(dimensions, texcoords);
+        glyph.dimensions = LCAST(float, dimensions);
+        glyph.texcoords = LCAST(float, texcoords);
+        glyph.advance = static_cast<float>(text_glyph->get_advance());
+        glyph.state = text_glyph->get_state();
+        return true;
+    };
+}
+
+OverlayBatch::~OverlayBatch()
+{
+    root_.remove_node();
+}
+
+OverlayBatch::ItemHandle OverlayBatch::add_text(const std::string& text, const LVecBase2f& pos, float size,
+    const LColorf& color, Align align, int layer)
+{
+    Item item;
+    item.text = text;
+    item.pos = pos;
+    item.size = LVecBase2f(size);
+    item.color = color;
+    item.align = align;
+    item.layer = layer;
+    return add_item(std::move(item));
+}
+
+OverlayBatch::ItemHandle OverlayBatch::add_sprite(Texture* texture, const LVecBase2f& pos, const LVecBase2f& size,
+    const LColorf& color, int layer)
+{
+    Item item;
+    item.texture = texture;
+    item.pos = pos;
+    item.size = size;
+    item.color = color;
+    item.align = Align::left;
+    item.layer = layer;
+    return add_item(std::move(item));
+}
+
+void OverlayBatch::remove_item(ItemHandle handle)
+{
+    Item& item = get_item(handle);
+    item.alive = false;
+    item.quads.clear();
+    item.texture.clear();
+    get_layer(item.layer).dirty = true;
+}
+
+void OverlayBatch::set_text(ItemHandle handle, const std::string& text)
+{
+    Item& item = get_item(handle);
+    if (item.text == text)
+    {
+        ++num_skipped_updates_;
+        return;
+    }
+    item.text = text;
+    mark_dirty(item);
+}
+
+const std::string& OverlayBatch::get_text(ItemHandle handle) const
+{
+    return items_.at(handle).text;
+}
+
+void OverlayBatch::set_pos(ItemHandle handle, const LVecBase2f& pos)
+{
+    Item& item = get_item(handle);
+    if (item.pos == pos)
+        return;
+    item.pos = pos;
+    mark_dirty(item);
+}
+
+void OverlayBatch::set_size(ItemHandle handle, float size)
+{
+    Item& item = get_item(handle);
+    if (item.size == LVecBase2f(size))
+        return;
+    item.size = LVecBase2f(size);
+    mark_dirty(item);
+}
+
+void OverlayBatch::set_color(ItemHandle handle, const LColorf& color)
+{
+    Item& item = get_item(handle);
+    if (item.color == color)
+        return;
+    item.color = color;
+    mark_dirty(item);
+}
+
+void OverlayBatch::set_visible(ItemHandle handle, bool visible)
+{
+    Item& item = get_item(handle);
+    if (item.visible == visible)
+        return;
+    item.visible = visible;
+
+    // quads are kept, so only the layer is rebuilt
+    get_layer(item.layer).dirty = true;
+}
+
+void OverlayBatch::update()
+{
+    for (auto& item: items_)
+    {
+        if (!item.alive || !item.dirty)
+            continue;
+        layout_item(item);
+        item.dirty = false;
+        ++num_item_regenerations_;
+    }
+
+    num_draw_calls_ = 0;
+    for (auto& layer: layers_)
+    {
+        if (layer.second.dirty)
+            rebuild_layer(layer.first, layer.second);
+        num_draw_calls_ += layer.second.node->get_num_geoms();
+    }
+}
+
+void OverlayBatch::reset_counters()
+{
+    num_item_regenerations_ = 0;
+    num_layer_regenerations_ = 0;
+    num_skipped_updates_ = 0;
+}
+
+OverlayBatch::ItemHandle OverlayBatch::add_item(Item&& item)
+{
+    item.alive = true;
+    item.visible = true;
+    item.dirty = true;
+    get_layer(item.layer).dirty = true;
+    items_.push_back(std::move(item));
+    return items_.size() - 1;
+}
+
+OverlayBatch::Item& OverlayBatch::get_item(ItemHandle handle)
+{
+    return items_.at(handle);
+}
+
+OverlayBatch::Layer& OverlayBatch::get_layer(int layer_index)
+{
+    auto found = layers_.find(layer_index);
+    if (found != layers_.end())
+        return found->second;
+
+    Layer& layer = layers_[layer_index];
+    layer.node = new GeomNode("OverlayLayer" + std::to_string(layer_index));
+    layer.np = root_.attach_new_node(layer.node);
+    layer.np.set_bin("fixed", layer_index);
+    return layer;
+}
+
+void OverlayBatch::mark_dirty(Item& item)
+{
+    item.dirty = true;
+    get_layer(item.layer).dirty = true;
+}
+
+void OverlayBatch::layout_item(Item& item)
+{
+    item.quads.clear();
+
+    if (item.texture)
+    {
+        // sprites are positioned at the top left corner like Sprite
+        Quad quad;
+        quad.dimensions = LVecBase4f(item.pos[0], item.pos[1] - item.size[1], item.pos[0] + item.size[0], item.pos[1]);
+        quad.texcoords = LVecBase4f(0, 0, 1, 1);
+        quad.color = item.color;
+        item.quads.emplace_back(RenderState::make(TextureAttrib::make(item.texture)), quad);
+        return;
+    }
+
+    if (!font_ || item.text.empty())
+        return;
+
+    layout_text(TextEncoder::decode_text(item.text, TextEncoder::get_default_encoding()), lookup_,
+        static_cast<float>(font_->get_line_height()), item.align, item.pos, item.size[0], item.color, item.quads);
+}
+
+void OverlayBatch::rebuild_layer(int layer_index, Layer& layer)
+{
+    // group quads by the state, keeping the order of the first appearance
+    std::vector<CPT(RenderState)> states;
+    std::vector<std::vector<const Quad*>> groups;
+    std::unordered_map<const RenderState*, size_t> group_indices;
+    for (const auto& item: items_)
+    {
+        if (!item.alive || !item.visible || item.layer != layer_index)
+            continue;
+
+        for (const auto& quad: item.quads)
+        {
+            auto result = group_indices.emplace(quad.first.p(), groups.size());
+            if (result.second)
+            {
+                states.push_back(quad.first);
+                groups.emplace_back();
+            }
+            groups[result.first->second].push_back(&quad.second);
+        }
+    }
+
+    layer.node->remove_all_geoms();
+    for (size_t k = 0, k_end = groups.size(); k < k_end; ++k)
+    {
+        const auto& quads = groups[k];
+
+        PT(GeomVertexData) vdata = new GeomVertexData("overlay", GeomVertexFormat::get_v3c4t2(), Geom::UH_static);
+        vdata->unclean_set_num_rows(static_cast<int>(quads.size() * 4));
+
+        GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+        GeomVertexWriter color(vdata, InternalName::get_color());
+        GeomVertexWriter texcoord(vdata, InternalName::get_texcoord());
+
+        PT(GeomTriangles) triangles = new GeomTriangles(Geom::UH_static);
+        if (quads.size() * 4 > 0xffff)
+            triangles->set_index_type(GeomEnums::NT_uint32);
+
+        int row = 0;
+        for (const Quad* quad: quads)
+        {
+            const LVecBase4f& dim = quad->dimensions;
+            const LVecBase4f& uv = quad->texcoords;
+
+            vertex.add_data3f(dim[0], 0, dim[1]);
+            vertex.add_data3f(dim[2], 0, dim[1]);
+            vertex.add_data3f(dim[2], 0, dim[3]);
+            vertex.add_data3f(dim[0], 0, dim[3]);
+
+            texcoord.add_data2f(uv[0], uv[1]);
+            texcoord.add_data2f(uv[2], uv[1]);
+            texcoord.add_data2f(uv[2], uv[3]);
+            texcoord.add_data2f(uv[0], uv[3]);
+
+            for (int v = 0; v < 4; ++v)
+                color.add_data4f(quad->color);
+
+            triangles->add_vertices(row, row + 1, row + 2);
+            triangles->add_vertices(row, row + 2, row + 3);
+            row += 4;
+        }
+
+        PT(Geom) geom = new Geom(vdata);
+        geom->add_primitive(triangles);
+        layer.node->add_geom(geom, states[k]);
+    }
+
+    layer.dirty = false;
+    ++num_layer_regenerations_;
+}
+
+}
@@ -74,20 +74,25 @@ TextNode::TextNode(
     impl_->nodepath_ = parent.attach_new_node(node);
     impl_->nodepath_.set_pos(pos.get_x(), 0, pos.get_y());
 
+    node->set_font(load_font(font, pixel_size));
+    set_pixel_size(pixel_size);
+
+    impl_->node_ = node;
+}
+
+TextNode::~TextNode() = default;
+
+TextFont* TextNode::load_font(const std::string& font, float pixel_size)
+{
     DynamicTextFont* dfont = DCAST(DynamicTextFont, RPLoader::load_font(font));
     //dfont->set_outline(LColor(0, 0, 0, 0.78), 1.6, 0.37);
     dfont->set_outline(LColor(0, 0, 0, 1), 1.6, 0.37);
     dfont->set_scale_factor(1.0);
     dfont->set_texture_margin(static_cast<int>(pixel_size / 4.0 * 2.0));
     dfont->set_bg(LColor(0, 0, 0, 0));
-    node->set_font(dfont);
-    set_pixel_size(pixel_size);
-
-    impl_->node_ = node;
+    return dfont;
 }
 
-TextNode::~TextNode() = default;
-
 NodePath TextNode::get_np() const
 {
     return impl_->nodepath_;
@@ -100,7 +105,10 @@ std::string TextNode::get_text() const
 
 void TextNode::set_text(const std::string& text)
 {
-    return impl_->node_->set_text(text);
+    // ::TextNode regenerates the geometry even if the text is same.
+    if (impl_->node_->get_text() == text)
+        return;
+    impl_->node_->set_text(text);
 }
 
 LColor TextNode::get_color() const
@@ -26,6 +26,8 @@
 
 #include <render_pipeline/rpcore/rpobject.hpp>
 
+class TextFont;
+
 namespace rpcore {
 
 /**
@@ -57,13 +59,16 @@ public:
         const std::string& text = {});
     ~TextNode();
 
+    /** Loads the font and sets up the outline and the margin for the pixel size. */
+    static TextFont* load_font(const std::string& font=Default::font, float pixel_size=Default::pixel_size);
+
     /** Returns the node path of the text. */
     NodePath get_np() const;
 
     /** Returns the current text. */
     std::string get_text() const;
 
-    /** Sets the current text. */
+    /** Sets the current text. This does nothing if the text is not changed. */
     void set_text(const std::string& text);
 
     /** Returns the current text color. */
@@ -22,139 +22,316 @@
 
 #include "render_pipeline/rpcore/image.hpp"
 
+#include <cstring>
+
 #include "render_pipeline/rpcore/render_target.hpp"
 
 namespace rpcore {
 
-const std::unordered_map<std::string, Image::ComponentFormatType> Image::FORMAT_MAPPING = {
-    { "R11G11B10",  { Texture::T_float, Texture::F_r11_g11_b10 } },
-    { "RGBA8",      { Texture::T_unsigned_byte, Texture::F_rgba8 } },
-    { "RGBA16",     { Texture::T_float, Texture::F_rgba16 } },
-    { "RGBA32",     { Texture::T_float, Texture::F_rgba32 } },
-    { "R8",         { Texture::T_unsigned_byte, Texture::F_red } },
-    { "R8UI",       { Texture::T_unsigned_byte, Texture::F_red } },
-    { "R16",        { Texture::T_float, Texture::F_r16 } },
-    { "R16UI",      { Texture::T_unsigned_short, Texture::F_r16i } },
-    { "R32",        { Texture::T_float, Texture::F_r32 } },
-    { "R32I",       { Texture::T_int, Texture::F_r32i } },
+// ordered by Image::Format
+static constexpr Image::FormatInfo FORMAT_TABLE[] = {
+    { "R11G11B10",  Texture::T_float, Texture::F_r11_g11_b10, 4 },
+    { "RGBA8",      Texture::T_unsigned_byte, Texture::F_rgba8, 4 },
+    { "RGBA16",     Texture::T_float, Texture::F_rgba16, 8 },
+    { "RGBA32",     Texture::T_float, Texture::F_rgba32, 16 },
+    { "R8",         Texture::T_unsigned_byte, Texture::F_red, 1 },
+    { "R8UI",       Texture::T_unsigned_byte, Texture::F_red, 1 },
+    { "R16",        Texture::T_float, Texture::F_r16, 2 },
+    { "R16UI",      Texture::T_unsigned_short, Texture::F_r16i, 2 },
+    { "R32",        Texture::T_float, Texture::F_r32, 4 },
+    { "R32I",       Texture::T_int, Texture::F_r32i, 4 },
 };
 
-std::vector<Image*> Image::REGISTERED_IMAGES;
+static_assert(sizeof(FORMAT_TABLE) / sizeof(FORMAT_TABLE[0]) == static_cast<size_t>(Image::Format::COUNT),
+    "FORMAT_TABLE does not match with Image::Format");
+
+static std::unordered_map<std::string, Image::ComponentFormatType> make_format_mapping()
+{
+    std::unordered_map<std::string, Image::ComponentFormatType> mapping;
+    for (const auto& info: FORMAT_TABLE)
+        mapping.emplace(info.name, Image::ComponentFormatType(info.component_type, info.format));
+    return mapping;
+}
+
+const std::unordered_map<std::string, Image::ComponentFormatType> Image::FORMAT_MAPPING = make_format_mapping();
+
+std::mutex Image::registry_mutex_;
+std::vector<Image*> Image::registry_;
+size_t Image::registry_count_ = 0;
+std::atomic<size_t> Image::registry_size_(0);
+
+const Image::FormatInfo& Image::get_format_info(Format format)
+{
+    return FORMAT_TABLE[static_cast<int>(format)];
+}
+
+bool Image::parse_format(const std::string& name, Format& format)
+{
+    for (int k = 0; k < static_cast<int>(Format::COUNT); ++k)
+    {
+        if (std::strcmp(FORMAT_TABLE[k].name, name.c_str()) == 0)
+        {
+            format = static_cast<Format>(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+Image::Format Image::to_format(const std::string& component_format)
+{
+    Format format;
+    if (!parse_format(component_format, format))
+    {
+        RPObject::global_error("Image", std::string("Unsupported texture component format: ") + component_format);
+        throw std::out_of_range("Unsupported texture component format: " + component_format);
+    }
+    return format;
+}
+
+const Image::ComponentFormatType& Image::convert_texture_format(const std::string& comp_type)
+{
+    to_format(comp_type);
+    return FORMAT_MAPPING.at(comp_type);
+}
+
+size_t Image::get_num_registered_images()
+{
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    return registry_count_;
+}
+
+size_t Image::get_registered_images_size()
+{
+    return registry_size_.load();
+}
+
+std::vector<Image::RegisteredImage> Image::get_registered_images()
+{
+    std::vector<RegisteredImage> images;
+
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    images.reserve(registry_count_);
+    for (const Image* image: registry_)
+    {
+        if (image)
+            images.push_back({ image->texture_, image->sort_, image->size_in_bytes_ });
+    }
+    return images;
+}
 
 std::unique_ptr<Image> Image::create_buffer(const std::string& name, int size, const std::string& component_format)
+{
+    return create_buffer(name, size, to_format(component_format));
+}
+
+std::unique_ptr<Image> Image::create_buffer(const std::string& name, int size, Format format)
 {
     auto img = std::make_unique<Image>("ImgBuffer-" + name);
-    img->setup_buffer(size, component_format);
+    img->setup_buffer(size, format);
     return img;
 }
 
 void Image::setup_buffer(int size, const std::string& component_format)
 {
-    const auto& comp_type_format = convert_texture_format(component_format);
-    texture_->setup_buffer_texture(size, comp_type_format.first, comp_type_format.second, GeomEnums::UH_static);
+    setup_buffer(size, to_format(component_format));
+}
+
+void Image::setup_buffer(int size, Format format)
+{
+    const FormatInfo& info = get_format_info(format);
+    texture_->setup_buffer_texture(size, info.component_type, info.format, GeomEnums::UH_static);
+    format_ = format;
+    update_size_in_bytes();
 }
 
 std::unique_ptr<Image> Image::create_counter(const std::string& name)
 {
-    return Image::create_buffer(name, 1, "R32I");
+    return Image::create_buffer(name, 1, Format::R32I);
 }
 
 void Image::setup_counter()
 {
-    Image::setup_buffer(1, "R32I");
+    Image::setup_buffer(1, Format::R32I);
 }
 
 std::unique_ptr<Image> Image::create_2d(const std::string& name, int w, int h, const std::string& component_format)
+{
+    return create_2d(name, w, h, to_format(component_format));
+}
+
+std::unique_ptr<Image> Image::create_2d(const std::string& name, int w, int h, Format format)
 {
     auto img = std::make_unique<Image>("Img2D-" + name);
-    img->setup_2d(w, h, component_format);
+    img->setup_2d(w, h, format);
     return img;
 }
 
 void Image::setup_2d(int w, int h, const std::string& component_format)
 {
-    const auto& comp_type_format = convert_texture_format(component_format);
-    texture_->setup_2d_texture(w, h, comp_type_format.first, comp_type_format.second);
+    setup_2d(w, h, to_format(component_format));
+}
+
+void Image::setup_2d(int w, int h, Format format)
+{
+    const FormatInfo& info = get_format_info(format);
+    texture_->setup_2d_texture(w, h, info.component_type, info.format);
+    format_ = format;
+    update_size_in_bytes();
 }
 
 std::unique_ptr<Image> Image::create_2d_array(const std::string& name, int w, int h, int slices, const std::string& component_format)
+{
+    return create_2d_array(name, w, h, slices, to_format(component_format));
+}
+
+std::unique_ptr<Image> Image::create_2d_array(const std::string& name, int w, int h, int slices, Format format)
 {
     auto img = std::make_unique<Image>(std::string("Img2DArr-") + name);
-    img->setup_2d_array(w, h, slices, component_format);
+    img->setup_2d_array(w, h, slices, format);
     return img;
 }
 
 void Image::setup_2d_array(int w, int h, int slices, const std::string& component_format)
 {
-    const auto& comp_type_format = convert_texture_format(component_format);
-    texture_->setup_2d_texture_array(w, h, slices, comp_type_format.first, comp_type_format.second);
+    setup_2d_array(w, h, slices, to_format(component_format));
+}
+
+void Image::setup_2d_array(int w, int h, int slices, Format format)
+{
+    const FormatInfo& info = get_format_info(format);
+    texture_->setup_2d_texture_array(w, h, slices, info.component_type, info.format);
+    format_ = format;
+    update_size_in_bytes();
 }
 
 std::unique_ptr<Image> Image::create_3d(const std::string& name, int w, int h, int slices, const std::string& component_format)
+{
+    return create_3d(name, w, h, slices, to_format(component_format));
+}
+
+std::unique_ptr<Image> Image::create_3d(const std::string& name, int w, int h, int slices, Format format)
 {
     auto img = std::make_unique<Image>(std::string("Img3D-") + name);
-    img->setup_3d(w, h, slices, component_format);
+    img->setup_3d(w, h, slices, format);
     return img;
 }
 
 void Image::setup_3d(int w, int h, int slices, const std::string& component_format)
 {
-    const auto& comp_type_format = convert_texture_format(component_format);
-    texture_->setup_3d_texture(w, h, slices, comp_type_format.first, comp_type_format.second);
+    setup_3d(w, h, slices, to_format(component_format));
+}
+
+void Image::setup_3d(int w, int h, int slices, Format format)
+{
+    const FormatInfo& info = get_format_info(format);
+    texture_->setup_3d_texture(w, h, slices, info.component_type, info.format);
+    format_ = format;
+    update_size_in_bytes();
 }
 
 std::unique_ptr<Image> Image::create_cube(const std::string& name, int size, const std::string& component_format)
+{
+    return create_cube(name, size, to_format(component_format));
+}
+
+std::unique_ptr<Image> Image::create_cube(const std::string& name, int size, Format format)
 {
     auto img = std::make_unique<Image>(std::string("ImgCube-") + name);
-    img->setup_cube(size, component_format);
+    img->setup_cube(size, format);
     return img;
 }
 
 void Image::setup_cube(int size, const std::string& component_format)
 {
-    const auto& comp_type_format = convert_texture_format(component_format);
-    texture_->setup_cube_map(size, comp_type_format.first, comp_type_format.second);
+    setup_cube(size, to_format(component_format));
+}
+
+void Image::setup_cube(int size, Format format)
+{
+    const FormatInfo& info = get_format_info(format);
+    texture_->setup_cube_map(size, info.component_type, info.format);
+    format_ = format;
+    update_size_in_bytes();
 }
 
 std::unique_ptr<Image> Image::create_cube_array(const std::string& name, int size, int num_cubemaps, const std::string& component_format)
+{
+    return create_cube_array(name, size, num_cubemaps, to_format(component_format));
+}
+
+std::unique_ptr<Image> Image::create_cube_array(const std::string& name, int size, int num_cubemaps, Format format)
 {
     auto img = std::make_unique<Image>(std::string("ImgCubeArr-") + name);
-    img->setup_cube_array(size, num_cubemaps, component_format);
+    img->setup_cube_array(size, num_cubemaps, format);
     return img;
 }
 
 void Image::setup_cube_array(int size, int num_cubemaps, const std::string& component_format)
 {
-    const auto& comp_type_format = convert_texture_format(component_format);
-    texture_->setup_cube_map_array(size, num_cubemaps, comp_type_format.first, comp_type_format.second);
+    setup_cube_array(size, num_cubemaps, to_format(component_format));
 }
 
-const Image::ComponentFormatType& Image::convert_texture_format(const std::string& comp_type)
+void Image::setup_cube_array(int size, int num_cubemaps, Format format)
 {
-    try
-    {
-        return FORMAT_MAPPING.at(comp_type);
-    }
-    catch (const std::out_of_range& err)
-    {
-        RPObject::global_error("Image", std::string("Unsupported texture component format: ") + comp_type);
-        throw err;
-    }
+    const FormatInfo& info = get_format_info(format);
+    texture_->setup_cube_map_array(size, num_cubemaps, info.component_type, info.format);
+    format_ = format;
+    update_size_in_bytes();
 }
 
 Image::Image(const std::string& name): texture_(Texture::make_texture())
 {
     texture_->set_name(name);
-
-    Image::REGISTERED_IMAGES.push_back(this);
     texture_->set_clear_color(0);
     texture_->clear_image();
     sort_ = RenderTarget::CURRENT_SORT;
+
+    // register after initialization, because the snapshot reads the members.
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    registry_slot_ = registry_.size();
+    registry_.push_back(this);
+    ++registry_count_;
 }
 
 Image::~Image()
 {
-    Image::REGISTERED_IMAGES.erase(std::find(Image::REGISTERED_IMAGES.begin(), Image::REGISTERED_IMAGES.end(), this));
+    registry_size_ -= size_in_bytes_;
+
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    registry_[registry_slot_] = nullptr;
+    --registry_count_;
+
+    // compact when half of the slots are empty, keeping the order of creation.
+    if (registry_count_ * 2 > registry_.size())
+        return;
+
+    size_t count = 0;
+    for (Image* image: registry_)
+    {
+        if (!image)
+            continue;
+        image->registry_slot_ = count;
+        registry_[count++] = image;
+    }
+    registry_.resize(count);
+}
+
+void Image::update_size_in_bytes()
+{
+    size_t size = 0;
+    if (format_ != Format::COUNT)
+    {
+        // z size is 6 for cubemap and 6 * count for cubemap array.
+        size = static_cast<size_t>(texture_->get_x_size()) * texture_->get_y_size() * texture_->get_z_size() *
+            get_format_info(format_).bytes_per_texel;
+    }
+
+    registry_size_ += size;
+    registry_size_ -= size_in_bytes_;
+
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    size_in_bytes_ = size;
 }
 
 }
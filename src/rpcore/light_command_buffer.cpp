@@ -0,0 +1,79 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "rpcore/light_command_buffer.hpp"
+
+namespace rpcore {
+
+LightCommandBuffer::~LightCommandBuffer()
+{
+    // drop pending commands without applying them
+    Command* cmd = head_.exchange(nullptr, std::memory_order_acquire);
+    while (cmd)
+    {
+        Command* next = cmd->next;
+        delete cmd;
+        cmd = next;
+    }
+}
+
+void LightCommandBuffer::push_add(PT(RPLight) light)
+{
+    push(new Command{ CommandType::ADD, light, UpdateFunction(), nullptr });
+}
+
+void LightCommandBuffer::push_remove(PT(RPLight) light)
+{
+    push(new Command{ CommandType::REMOVE, light, UpdateFunction(), nullptr });
+}
+
+void LightCommandBuffer::push_update(PT(RPLight) light, UpdateFunction func)
+{
+    push(new Command{ CommandType::UPDATE, light, std::move(func), nullptr });
+}
+
+void LightCommandBuffer::push(Command* cmd)
+{
+    num_pending_.fetch_add(1, std::memory_order_relaxed);
+
+    cmd->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(cmd->next, cmd, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+LightCommandBuffer::Command* LightCommandBuffer::take_all()
+{
+    Command* cmd = head_.exchange(nullptr, std::memory_order_acquire);
+
+    // the stack is LIFO, so reverse it to restore the submission order
+    Command* reversed = nullptr;
+    while (cmd)
+    {
+        Command* next = cmd->next;
+        cmd->next = reversed;
+        reversed = cmd;
+        cmd = next;
+    }
+    return reversed;
+}
+
+}
@@ -0,0 +1,121 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+#include <pointerTo.h>
+
+#include <render_pipeline/rpcore/native/rp_light.h>
+
+namespace rpcore {
+
+/**
+ * Lock-free multi-producer, single-consumer queue of light commands.
+ *
+ * Any thread may push add, remove or update commands. The commands are kept
+ * in an intrusive stack, which the consumer detaches in one atomic exchange
+ * and replays in submission order. Because the consumer never pops single
+ * nodes, the stack is not subject to the ABA problem.
+ */
+class LightCommandBuffer
+{
+public:
+    using UpdateFunction = std::function<void(RPLight*)>;
+
+    enum class CommandType
+    {
+        ADD,
+        REMOVE,
+        UPDATE,
+    };
+
+    struct Command
+    {
+        CommandType type;
+        PT(RPLight) light;
+        UpdateFunction update_function;
+        Command* next;
+    };
+
+public:
+    LightCommandBuffer() = default;
+    LightCommandBuffer(const LightCommandBuffer&) = delete;
+    ~LightCommandBuffer();
+
+    LightCommandBuffer& operator=(const LightCommandBuffer&) = delete;
+
+    /** Queues a light to be attached. Thread-safe. */
+    void push_add(PT(RPLight) light);
+
+    /** Queues a light to be detached. Thread-safe. */
+    void push_remove(PT(RPLight) light);
+
+    /** Queues a function which modifies light properties on the consumer thread. Thread-safe. */
+    void push_update(PT(RPLight) light, UpdateFunction func);
+
+    /** Returns the number of commands pushed but not drained yet. */
+    size_t get_num_pending() const;
+
+    /**
+     * Takes all pending commands and calls @p handler for each of them, in
+     * the order in which they were pushed. Must only be called from a single
+     * consumer thread. Returns the number of processed commands.
+     */
+    template <class Handler>
+    size_t drain(Handler&& handler);
+
+private:
+    void push(Command* cmd);
+
+    /** Detaches all pending commands and returns them in FIFO order. */
+    Command* take_all();
+
+    std::atomic<Command*> head_{ nullptr };
+    std::atomic<size_t> num_pending_{ 0 };
+};
+
+// ************************************************************************************************
+inline size_t LightCommandBuffer::get_num_pending() const
+{
+    return num_pending_.load(std::memory_order_relaxed);
+}
+
+template <class Handler>
+size_t LightCommandBuffer::drain(Handler&& handler)
+{
+    size_t count = 0;
+    Command* cmd = take_all();
+    while (cmd)
+    {
+        Command* next = cmd->next;
+        handler(*cmd);
+        delete cmd;
+        cmd = next;
+        ++count;
+    }
+    num_pending_.fetch_sub(count, std::memory_order_relaxed);
+    return count;
+}
+
+}
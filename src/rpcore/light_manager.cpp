@@ -38,11 +38,14 @@
 #include "render_pipeline/rpcore/native/rp_point_light.h"
 
 #include "rpcore/gpu_command_queue.hpp"
+#include "rpcore/light_command_buffer.hpp"
 
 namespace rpcore {
 
 LightManager::LightManager(RenderPipeline& pipeline): RPObject("LightManager"), pipeline_(pipeline)
 {
+    light_cmd_buffer_ = std::make_unique<LightCommandBuffer>();
+
     compute_tile_size();
     init_internal_manager();
     init_command_queue();
@@ -103,8 +106,56 @@ void LightManager::remove_light(RPLight* light)
     pta_max_light_index_[0] = internal_mgr_->get_max_light_index();
 }
 
+void LightManager::queue_add_light(PT(RPLight) light)
+{
+    light_cmd_buffer_->push_add(light);
+}
+
+void LightManager::queue_remove_light(PT(RPLight) light)
+{
+    light_cmd_buffer_->push_remove(light);
+}
+
+void LightManager::queue_light_update(PT(RPLight) light, std::function<void(RPLight*)> func)
+{
+    light_cmd_buffer_->push_update(light, std::move(func));
+}
+
+size_t LightManager::get_num_queued_light_commands() const
+{
+    return light_cmd_buffer_->get_num_pending();
+}
+
+size_t LightManager::commit_queued_lights()
+{
+    const size_t count = light_cmd_buffer_->drain([this](LightCommandBuffer::Command& cmd) {
+        switch (cmd.type)
+        {
+        case LightCommandBuffer::CommandType::ADD:
+            internal_mgr_->add_light(cmd.light);
+            break;
+
+        case LightCommandBuffer::CommandType::REMOVE:
+            internal_mgr_->remove_light(cmd.light);
+            break;
+
+        case LightCommandBuffer::CommandType::UPDATE:
+            if (cmd.update_function)
+                cmd.update_function(cmd.light);
+            break;
+        }
+    });
+
+    if (count > 0)
+        pta_max_light_index_[0] = internal_mgr_->get_max_light_index();
+
+    return count;
+}
+
 void LightManager::update()
 {
+    commit_queued_lights();
+
     internal_mgr_->set_camera_pos(Globals::base->get_cam().get_pos(Globals::base->get_render()));
     internal_mgr_->update();
     shadow_manager_->update();
@@ -157,6 +208,7 @@ void LightManager::init_internal_manager()
 {
     internal_mgr_ = std::make_unique<InternalLightManager>();
     internal_mgr_->set_shadow_update_distance(pipeline_.get_setting<float>("shadows.max_update_distance"));
+    internal_mgr_->set_compact_light_updates(pipeline_.get_setting<bool>("lighting.compact_light_updates", false));
 
     // Storage for the Lights
     const int per_light_vec4s = 4;
@@ -219,6 +271,9 @@ void LightManager::init_defines()
     defines["LT_EMPTY"] = std::to_string(RPPointLight::LightType::LT_empty);
     defines["LT_POINT_LIGHT"] = std::to_string(RPPointLight::LightType::LT_point_light);
     defines["LT_SPOT_LIGHT"] = std::to_string(RPPointLight::LightType::LT_spot_light);
+
+    defines["PL_SHADOW_MODE_CUBE"] = std::to_string(RPPointLight::SM_cube);
+    defines["PL_SHADOW_MODE_TETRAHEDRAL"] = std::to_string(RPPointLight::SM_tetrahedral);
 }
 
 }
@@ -28,6 +28,7 @@
 #include "render_pipeline/rpcore/native/internal_light_manager.h"
 
 #include <algorithm>
+#include <cstring>
 
 NotifyCategoryDef(lightmgr, "");
 
@@ -44,6 +45,8 @@ InternalLightManager::InternalLightManager() {
     _shadow_update_distance = 100.0f;
     _cmd_list = nullptr;
     _shadow_manager = nullptr;
+    _compact_light_updates = false;
+    _light_command_data = PTA_uchar::empty_array(GPU_COMMAND_ENTRIES * sizeof(float));
 }
 
 /**
@@ -254,6 +257,10 @@ void InternalLightManager::gpu_remove_consecutive_sources(ShadowSource *first_so
 void InternalLightManager::gpu_remove_light(RPLight* light) {
     nassertv(_cmd_list != nullptr);  // No command list set yet
     nassertv(light->has_slot());  // Light has no slot!
+    if (_compact_light_updates) {
+        _light_encoder.remove(light->get_slot());
+        return;
+    }
     GPUCommand cmd_remove(GPUCommand::CMD_remove_light);
     cmd_remove.push_int(light->get_slot());
     _cmd_list->add_command(cmd_remove);
@@ -277,6 +284,15 @@ void InternalLightManager::gpu_update_light(RPLight* light) {
     cmd_update.push_int(light->get_slot());
     light->write_to_command(cmd_update);
     light->set_needs_update(false);
+
+    if (_compact_light_updates) {
+        // The light data starts after the command type and the slot, the
+        // same way the command processor reads it.
+        cmd_update.write_to(_light_command_data, 0);
+        const float* record = reinterpret_cast<const float*>(_light_command_data.p()) + 2;
+        _light_encoder.update(light->get_slot(), record);
+        return;
+    }
     _cmd_list->add_command(cmd_update);
 }
 
@@ -422,6 +438,75 @@ void InternalLightManager::update_shadow_sources() {
     }
 }
 
+/**
+ * @brief Internal method to emit the collected light updates
+ * @details This packs the delta stream of the light encoder into
+ *   CMD_store_light_delta commands and clears the stream afterwards. Entries
+ *   are never split between two commands.
+ *
+ *   The command buffer stores floats, and integers are converted to floats
+ *   as well, so a word of the compact light can not be stored directly. The
+ *   header is stored as integer (it only uses 24 bits), the position words
+ *   as float, and all other words as two 16 bit integers, low half first.
+ *
+ *   Layout of the command: type, entry count, entries.
+ */
+void InternalLightManager::flush_light_updates() {
+    nassertv(_cmd_list != nullptr);  // No command list set yet
+
+    const std::vector<uint32_t>& stream = _light_encoder.get_stream();
+    const size_t max_entry_floats = GPU_COMMAND_ENTRIES - 2;
+
+    std::vector<float> entry_floats;
+    std::vector<float> command_floats;
+    int num_entries = 0;
+
+    size_t k = 0;
+    while (k < stream.size() || num_entries > 0) {
+        entry_floats.clear();
+        if (k < stream.size()) {
+            const uint32_t header = stream[k++];
+            const uint32_t mask = (header >> LightDataCodec::DELTA_WORDS_SHIFT) & LightDataCodec::DELTA_ALL_WORDS;
+            entry_floats.push_back(static_cast<float>(header));
+            for (int w = 0; w < LightDataCodec::COMPACT_LIGHT_WORDS; ++w) {
+                if (!(mask & (1u << w))) {
+                    continue;
+                }
+                nassertv(k < stream.size()); // Malformed stream
+                const uint32_t word = stream[k++];
+                if (w >= 1 && w <= 3) {
+                    float position;
+                    memcpy(&position, &word, sizeof(position));
+                    entry_floats.push_back(position);
+                } else {
+                    entry_floats.push_back(static_cast<float>(word & 0xFFFF));
+                    entry_floats.push_back(static_cast<float>(word >> 16));
+                }
+            }
+        }
+
+        // Emit the command when the entry does not fit anymore, or when the
+        // stream is done.
+        if (entry_floats.empty() || command_floats.size() + entry_floats.size() > max_entry_floats) {
+            GPUCommand cmd_delta(GPUCommand::CMD_store_light_delta);
+            cmd_delta.push_int(num_entries);
+            for (float v : command_floats) {
+                cmd_delta.push_float(v);
+            }
+            _cmd_list->add_command(cmd_delta);
+            command_floats.clear();
+            num_entries = 0;
+        }
+
+        command_floats.insert(command_floats.end(), entry_floats.begin(), entry_floats.end());
+        if (!entry_floats.empty()) {
+            ++num_entries;
+        }
+    }
+
+    _light_encoder.clear_stream();
+}
+
 /**
  * @brief Main update method
  * @details This is the main update method of the InternalLightManager. It
@@ -436,6 +521,10 @@ void InternalLightManager::update() {
 
     update_lights();
     update_shadow_sources();
+
+    if (_compact_light_updates) {
+        flush_light_updates();
+    }
 }
 
 }
@@ -31,30 +31,6 @@
 
 #include <Eigen/Dense>
 
-/**
- * @brief Internal method to generate a set of equations
- * @details This generates a set of equations into a given equation system.
- *   Based on a given start point and end point, it inserts an equation to the
- *   system which will, when solved, solve the following equation:
- *   vec * <SOLVED-TRANSFORM> = expected
- *
- * @param eq_system The equation system
- * @param eq_results The target result vector of the equation system
- * @param vec The actual vector to be transformed
- * @param expected The expected output of the transformation
- * @param offset The index of the equation
- */
-void generate_equations(Eigen::MatrixXf &eq_system, Eigen::VectorXf &eq_results, const LVector4f &vec, LVector4f expected, size_t offset) {
-    size_t write_offset = offset * 4;
-    for (size_t row = 0; row < 4; ++row) {
-        float expected_coeff = expected.get_cell(row);
-        size_t col_offset = row * 4;
-        for (size_t col = 0; col < 4; ++col) {
-            eq_system(write_offset, col_offset + col) = vec.get_cell(col);
-        }
-        eq_results(write_offset++) = expected_coeff;
-    }
-}
 /**
  * @brief Finds a projection mat arround the given set of points.
  * @details This methods finds a projection matrix which projects the given set
@@ -82,35 +58,49 @@ LMatrix4f PSSMHelper::find_projection_mat(
             const LVector4f &far_ll,
             const LVector4f &far_lr)
 {
-    // We have 8*4 = 32 equations, which require 16 coefficients each
-    Eigen::MatrixXf equation_system(32, 16);
-    Eigen::VectorXf equation_results(32);
-    equation_system.fill(0);
+    // Output component k of a point is the dot product of the point with column k
+    // of the matrix, so it only depends on the 4 coefficients of that column.
+    // The 32x16 system is therefore block diagonal with the same 8x4 block for
+    // every component, whatever the expected values are. Thus, we solve the 8x4
+    // least squares problem for all 4 components at once, using fixed size
+    // matrices so that nothing is allocated on the heap.
+    const LVector4f* points[8] = {
+        &near_ul, &near_ur, &near_ll, &near_lr,
+        &far_ul, &far_ur, &far_ll, &far_lr,
+    };
 
-    // Generate the equations
-    size_t offset = 0;
-    generate_equations(equation_system, equation_results, near_ul, LVector4f(-1,  1, 0, 1), offset++);
-    generate_equations(equation_system, equation_results, near_ur, LVector4f( 1,  1, 0, 1), offset++);
-    generate_equations(equation_system, equation_results, near_ll, LVector4f(-1, -1, 0, 1), offset++);
-    generate_equations(equation_system, equation_results, near_lr, LVector4f( 1, -1, 0, 1), offset++);
+    static const float expected_points[8][4] = {
+        {-1,  1, 0, 1},
+        { 1,  1, 0, 1},
+        {-1, -1, 0, 1},
+        { 1, -1, 0, 1},
+        {-1,  1, 1, 1},
+        { 1,  1, 1, 1},
+        {-1, -1, 1, 1},
+        { 1, -1, 1, 1},
+    };
 
-    generate_equations(equation_system, equation_results, far_ul,  LVector4f(-1,  1, 1, 1), offset++);
-    generate_equations(equation_system, equation_results, far_ur,  LVector4f( 1,  1, 1, 1), offset++);
-    generate_equations(equation_system, equation_results, far_ll,  LVector4f(-1, -1, 1, 1), offset++);
-    generate_equations(equation_system, equation_results, far_lr,  LVector4f( 1, -1, 1, 1), offset++);
+    Eigen::Matrix<float, 8, 4> equation_system;
+    Eigen::Matrix<float, 8, 4> equation_results;
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            equation_system(row, col) = points[row]->get_cell(col);
+            equation_results(row, col) = expected_points[row][col];
+        }
+    }
 
     // Solve the equation system
-    Eigen::VectorXf solved_system = equation_system.colPivHouseholderQr().solve(equation_results);
+    const Eigen::Matrix<float, 4, 4> solved_system = equation_system.colPivHouseholderQr().solve(equation_results);
 
-    // Construct result matrix and return it. We also need to transpose the matrix.
+    // Column k of the solution transforms the points to the component k, which is
+    // the row vector convention of Panda3D, so no transpose is required.
     LMatrix4f result(
-            solved_system(0), solved_system(4), solved_system(8),  solved_system(12),
-            solved_system(1), solved_system(5), solved_system(9),  solved_system(13),
-            solved_system(2), solved_system(6), solved_system(10), solved_system(14),
-            solved_system(3), solved_system(7), solved_system(11), solved_system(15)
+            solved_system(0, 0), solved_system(0, 1), solved_system(0, 2), solved_system(0, 3),
+            solved_system(1, 0), solved_system(1, 1), solved_system(1, 2), solved_system(1, 3),
+            solved_system(2, 0), solved_system(2, 1), solved_system(2, 2), solved_system(2, 3),
+            solved_system(3, 0), solved_system(3, 1), solved_system(3, 2), solved_system(3, 3)
         );
     return result;
 }
 
-
 #endif // RP_REQ_PSSM_HELPER
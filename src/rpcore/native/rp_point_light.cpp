@@ -27,8 +27,33 @@
 
 #include "render_pipeline/rpcore/native/rp_point_light.h"
 
+#include <limits>
+
 namespace rpcore {
 
+namespace {
+
+const LVecBase3f cube_directions[6] = {
+    LVecBase3f( 1,  0,  0),
+    LVecBase3f(-1,  0,  0),
+    LVecBase3f( 0,  1,  0),
+    LVecBase3f( 0, -1,  0),
+    LVecBase3f( 0,  0,  1),
+    LVecBase3f( 0,  0, -1)
+};
+
+// Vertices of a regular tetrahedron, this has to match
+// get_pointlight_tetrahedral_source_offs in lighting_pipeline.inc.glsl
+const float tetra_comp = 0.57735027f;
+const LVecBase3f tetrahedral_directions[4] = {
+    LVecBase3f( tetra_comp,  tetra_comp,  tetra_comp),
+    LVecBase3f( tetra_comp, -tetra_comp, -tetra_comp),
+    LVecBase3f(-tetra_comp,  tetra_comp, -tetra_comp),
+    LVecBase3f(-tetra_comp, -tetra_comp,  tetra_comp)
+};
+
+}
+
 /**
  * @brief Constructs a new point light
  * @details This contructs a new point light with default settings. By default
@@ -38,6 +63,7 @@ namespace rpcore {
 RPPointLight::RPPointLight() : RPLight(RPLight::LT_point_light) {
     _radius = 10.0;
     _inner_radius = 0.01;
+    _shadow_mode = SM_cube;
 }
 
 /**
@@ -51,17 +77,86 @@ void RPPointLight::write_to_command(GPUCommand &cmd) {
     RPLight::write_to_command(cmd);
     cmd.push_float(_radius);
     cmd.push_float(_inner_radius);
+    cmd.push_int(_shadow_mode);
+}
+
+/**
+ * @brief Returns the amount of shadow sources of a shadow mode
+ * @details This returns how many shadow sources (and thus shadow passes) a
+ *   point light with the given shadow mode uses.
+ *
+ * @param mode Shadow mode
+ * @return Amount of faces, 6 for SM_cube and 4 for SM_tetrahedral
+ */
+size_t RPPointLight::get_num_shadow_faces(ShadowMode mode) {
+    return mode == SM_tetrahedral ? 4 : 6;
+}
+
+/**
+ * @brief Returns the field of view of each face of a shadow mode
+ * @details This returns the field of view used for each shadow source. The
+ *   fov is slightly increased to prevent artifacts at the face transitions.
+ *
+ *   For SM_tetrahedral, every point of a faces region is at most
+ *   acos(1/3) (~70.53 degrees) away from the face direction, so a square
+ *   frustum of twice that angle covers the whole region.
+ *
+ * @param mode Shadow mode
+ * @return Field of view in degrees
+ */
+float RPPointLight::get_shadow_face_fov(ShadowMode mode) {
+    return mode == SM_tetrahedral ? 141.06f + 3.0f : 90.0f + 3.0f;
+}
+
+/**
+ * @brief Returns the direction of a shadow face
+ * @details This returns the (normalized) view direction of the shadow source
+ *   with the given index.
+ *
+ * @param mode Shadow mode
+ * @param face Index of the face, has to be less than get_num_shadow_faces(mode)
+ * @return Face direction
+ */
+const LVecBase3f& RPPointLight::get_shadow_face_direction(ShadowMode mode, size_t face) {
+    nassertr(face < get_num_shadow_faces(mode), cube_directions[0]);
+    return mode == SM_tetrahedral ? tetrahedral_directions[face] : cube_directions[face];
+}
+
+/**
+ * @brief Finds the shadow face covering a direction
+ * @details This returns the index of the shadow source which covers the given
+ *   light-to-surface direction. This mirrors the face selection done in the
+ *   lighting shader, and is the face whose direction is closest to the given
+ *   direction.
+ *
+ * @param mode Shadow mode
+ * @param direction Direction from the light to the surface, does not need to
+ *   be normalized
+ * @return Index of the face
+ */
+size_t RPPointLight::find_shadow_face(ShadowMode mode, const LVecBase3f& direction) {
+    size_t best_face = 0;
+    float best_dot = -std::numeric_limits<float>::infinity();
+    for (size_t i = 0, i_end = get_num_shadow_faces(mode); i < i_end; ++i) {
+        const float d = get_shadow_face_direction(mode, i).dot(direction);
+        if (d > best_dot) {
+            best_dot = d;
+            best_face = i;
+        }
+    }
+    return best_face;
 }
 
 /**
  * @brief Inits the shadow sources of the light
- * @details This inits all required shadow sources for the point light.
+ * @details This inits all required shadow sources for the point light. This
+ *   creates one source per face of the current shadow mode.
  * @see RPLight::init_shadow_sources
  */
 void RPPointLight::init_shadow_sources() {
     nassertv(_shadow_sources.size() == 0);
-    // Create 6 shadow sources, one for each direction
-    for(size_t i = 0; i < 6; ++i) {
+    // Create one shadow source for each face direction
+    for (size_t i = 0, i_end = get_num_shadow_faces(_shadow_mode); i < i_end; ++i) {
         _shadow_sources.push_back(std::make_unique<ShadowSource>());
     }
 }
@@ -72,21 +167,11 @@ void RPPointLight::init_shadow_sources() {
  * @see RPLight::update_shadow_sources
  */
 void RPPointLight::update_shadow_sources() {
-    static const LVecBase3f directions[6] = {
-        LVecBase3f( 1,  0,  0),
-        LVecBase3f(-1,  0,  0),
-        LVecBase3f( 0,  1,  0),
-        LVecBase3f( 0, -1,  0),
-        LVecBase3f( 0,  0,  1),
-        LVecBase3f( 0,  0, -1)
-    };
-
-    // Increase fov to prevent artifacts at the shadow map transitions
-    const float fov = 90.0f + 3.0f;
+    const float fov = get_shadow_face_fov(_shadow_mode);
     for (size_t i = 0, i_end = _shadow_sources.size(); i < i_end; ++i) {
         _shadow_sources[i]->set_resolution(get_shadow_map_resolution());
-        _shadow_sources[i]->set_perspective_lens(fov, _near_plane, _radius,
-                                                _position, directions[i]);
+        _shadow_sources[i]->set_perspective_lens(fov, _near_plane, _radius, _position,
+                                                get_shadow_face_direction(_shadow_mode, i));
     }
 }
 
@@ -125,6 +125,8 @@ void ShadowManager::update() {
         _display_regions[i]->set_active(false);
     }
 
+    _updated_mvps.clear();
+
     // Iterate over all queued updates
     for (size_t i = 0, i_end=_queued_updates.size(); i < i_end; ++i) {
         const ShadowSource* source = _queued_updates[i];
@@ -135,6 +137,7 @@ void ShadowManager::update() {
 
         // Set the view projection matrix
         DCAST(MatrixLens, _cameras[i]->get_lens())->set_user_mat(source->get_mvp());
+        _updated_mvps.push_back(source->get_mvp());
 
         // Optional: Show the camera frustum for debugging
         // _cameras[i]->show_frustum();
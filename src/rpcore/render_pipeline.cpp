@@ -37,6 +37,7 @@
 #include <spotlight.h>
 #include <materialAttrib.h>
 #include <geomTristrips.h>
+#include <clockObject.h>
 
 #include <boost/dll/runtime_symbol_info.hpp>
 
@@ -50,8 +51,13 @@
 #include "render_pipeline/rpcore/stage_manager.hpp"
 #include "render_pipeline/rpcore/mount_manager.hpp"
 #include "render_pipeline/rpcore/light_manager.hpp"
+#include "render_pipeline/rpcore/temporal_manager.hpp"
 #include "render_pipeline/rpcore/util/task_scheduler.hpp"
 #include "render_pipeline/rpcore/util/basic_effects.hpp"
+#include "render_pipeline/rpcore/util/occlusion_culler.hpp"
+#include "render_pipeline/rpcore/util/frame_pacer.hpp"
+#include "render_pipeline/rpcore/util/dynamic_resolution_controller.hpp"
+#include "render_pipeline/rpcore/util/shader_variant_manifest.hpp"
 #include "render_pipeline/rpcore/pluginbase/day_manager.hpp"
 #include "render_pipeline/rpcore/pluginbase/manager.hpp"
 #include "render_pipeline/rpcore/image.hpp"
@@ -70,6 +76,7 @@
 #include "render_pipeline/rpcore/native/tag_state_manager.h"
 #include "render_pipeline/rpcore/native/rp_point_light.h"
 #include "render_pipeline/rpcore/native/rp_spot_light.h"
+#include "render_pipeline/rpcore/native/shadow_manager.h"
 
 #include "rpplugins/env_probes/include/rpplugins/env_probes/env_probes_plugin.hpp"
 
@@ -98,6 +105,15 @@ public:
     /** Update task which gets called before the rendering, and updates all managers. */
     AsyncTask::DoneStatus manager_update_task(rppanda::FunctionalTask* task);
 
+    /** Hides occluded objects from the main camera and the shadow cameras. */
+    AsyncTask::DoneStatus occlusion_cull_task(rppanda::FunctionalTask* task);
+
+    /** Adjusts the render resolution from the time of the last frame. */
+    AsyncTask::DoneStatus dynamic_resolution_task(rppanda::FunctionalTask* task);
+
+    /** Waits for the frame limits at the end of the frame. */
+    AsyncTask::DoneStatus frame_pacing_task(rppanda::FunctionalTask* task);
+
     /**
      * Updates the commonly used inputs each frame. This is a seperate
      * task to be able view detailed performance information in pstats, since
@@ -231,6 +247,7 @@ public:
     void clear_effect(NodePath& nodepath);
 
     void handle_window_resize();
+    void handle_resolution_change();
 
     template <class T>
     T get_setting(const std::string& setting_path) const;
@@ -262,8 +279,14 @@ public:
     std::unique_ptr<MountManager> mount_mgr_;
     std::unique_ptr<StageManager> stage_mgr_;
     std::unique_ptr<LightManager> light_mgr_;
+    std::unique_ptr<TemporalManager> temporal_mgr_;
     std::unique_ptr<DayTimeManager> daytime_mgr_;
     std::unique_ptr<IESProfileLoader> ies_loader_;
+    std::unique_ptr<OcclusionCuller> occlusion_culler_;
+    bool occlusion_cull_shadows_ = false;
+    std::unique_ptr<FramePacer> frame_pacer_;
+    std::unique_ptr<DynamicResolutionController> dynamic_resolution_;
+    std::unique_ptr<ShaderVariantManifest> variant_manifest_;
 };
 
 RenderPipeline::Impl::Impl(RenderPipeline& self): self_(self)
@@ -274,11 +297,27 @@ RenderPipeline::Impl::~Impl()
 {
     self_.debug("Destructing RenderPipeline");
 
+    if (variant_manifest_)
+    {
+        const auto& missing = variant_manifest_->get_missing_variants();
+        if (!missing.empty())
+        {
+            self_.warn(fmt::format("{} shader variants were not in the manifest:\n{}", missing.size(),
+                ShaderVariantManifest::make_report(missing)));
+        }
+        variant_manifest_->save();
+        variant_manifest_.reset();
+    }
+
+    dynamic_resolution_.reset();
+    frame_pacer_.reset();
+    occlusion_culler_.reset();
     common_resources_.reset();
     ies_loader_.reset();
     daytime_mgr_.reset();
     stage_mgr_.reset();
     light_mgr_.reset();
+    temporal_mgr_.reset();
     tag_mgr_.reset();
     task_scheduler_.reset();
     debugger_.reset();
@@ -401,6 +440,7 @@ AsyncTask::DoneStatus RenderPipeline::Impl::manager_update_task(rppanda::Functio
         debugger_->update();
     daytime_mgr_->update();
     light_mgr_->update();
+    temporal_mgr_->update(Globals::base->get_cam(), Globals::base->get_cam_lens());
 
     if (rpcore::Globals::clock->get_frame_count() == 10)
     {
@@ -411,6 +451,50 @@ AsyncTask::DoneStatus RenderPipeline::Impl::manager_update_task(rppanda::Functio
     return AsyncTask::DS_cont;
 }
 
+AsyncTask::DoneStatus RenderPipeline::Impl::occlusion_cull_task(rppanda::FunctionalTask* task)
+{
+    NodePath cam = Globals::base->get_cam();
+
+    occlusion_culler_->begin_cull();
+    occlusion_culler_->cull_camera(cam, Globals::base->get_cam_lens(), DCAST(Camera, cam.node())->get_camera_mask());
+    if (occlusion_cull_shadows_)
+    {
+        const BitMask32 shadow_mask = tag_mgr_->get_mask("shadow");
+        for (const auto& mvp: light_mgr_->get_shadow_mgr()->get_updated_mvps())
+        {
+            occlusion_culler_->render_occluders(mvp);
+            occlusion_culler_->test_view(shadow_mask);
+        }
+    }
+    occlusion_culler_->end_cull();
+
+    return AsyncTask::DS_cont;
+}
+
+AsyncTask::DoneStatus RenderPipeline::Impl::dynamic_resolution_task(rppanda::FunctionalTask* task)
+{
+    // the time waited by the frame pacer is not rendering cost
+    double frame_time = ClockObject::get_global_clock()->get_dt();
+    if (frame_pacer_)
+        frame_time = (std::max)(frame_time - frame_pacer_->get_last_wait_time(), 0.0);
+
+    if (dynamic_resolution_->add_frame_time(frame_time))
+    {
+        const auto last_resolution = Globals::resolution;
+        compute_render_resolution();
+        if (Globals::resolution != last_resolution)
+            handle_resolution_change();
+    }
+
+    return AsyncTask::DS_cont;
+}
+
+AsyncTask::DoneStatus RenderPipeline::Impl::frame_pacing_task(rppanda::FunctionalTask* task)
+{
+    frame_pacer_->end_frame();
+    return AsyncTask::DS_cont;
+}
+
 AsyncTask::DoneStatus RenderPipeline::Impl::update_inputs_and_stages(rppanda::FunctionalTask* task)
 {
     common_resources_->update();
@@ -532,6 +616,10 @@ bool RenderPipeline::Impl::create(rppanda::ShowBase* base, PandaFramework* frame
 
     set_default_effect();
 
+    // compile the variants of the previous sessions while the loading screen is shown.
+    if (variant_manifest_ && self_.get_setting<bool>("pipeline.shader_variant_prewarm", true))
+        variant_manifest_->prewarm(self_, showbase_->get_win()->get_gsg());
+
     // Measure how long it took to initialize everything, and also store
     // when we finished, so we can measure how long it took to render the
     // first frame (where the shaders are actually compiled)
@@ -556,14 +644,64 @@ void RenderPipeline::Impl::create_managers()
 {
     self_.trace("Creating managers ...");
 
+    // shaders are loaded from the creation of the managers.
+    if (self_.get_setting<bool>("pipeline.shader_variant_manifest", false))
+    {
+        variant_manifest_ = std::make_unique<ShaderVariantManifest>();
+        variant_manifest_->load();
+    }
+
     task_scheduler_ = std::make_unique<TaskScheduler>();
     tag_mgr_ = std::make_unique<TagStateManager>(Globals::base->get_cam());
     plugin_mgr_ = std::make_unique<PluginManager>(self_);
     stage_mgr_ = std::make_unique<StageManager>(self_);
     light_mgr_ = std::make_unique<LightManager>(self_);
+    temporal_mgr_ = std::make_unique<TemporalManager>();
     daytime_mgr_ = std::make_unique<DayTimeManager>(self_);
     ies_loader_ = std::make_unique<IESProfileLoader>(self_);
     common_resources_ = std::make_unique<CommonResources>(self_);
+
+    if (self_.get_setting<bool>("pipeline.occlusion_culling", false))
+    {
+        occlusion_culler_ = std::make_unique<OcclusionCuller>();
+        occlusion_culler_->set_resolution(
+            self_.get_setting<int>("pipeline.occlusion_culling_width", 320),
+            self_.get_setting<int>("pipeline.occlusion_culling_height", 180));
+        occlusion_cull_shadows_ = self_.get_setting<bool>("pipeline.occlusion_culling_shadows", false);
+    }
+
+    if (self_.get_setting<bool>("pipeline.frame_pacing", false))
+    {
+        frame_pacer_ = std::make_unique<FramePacer>();
+        frame_pacer_->set_target_frame_rate(self_.get_setting<double>("pipeline.max_frame_rate", 0.0));
+        frame_pacer_->set_spin_time(self_.get_setting<double>("pipeline.frame_pacing_spin_time", 0.002));
+
+        const int max_frames_in_flight = self_.get_setting<int>("pipeline.max_frames_in_flight", 0);
+        if (max_frames_in_flight > 0)
+        {
+            auto fence = std::make_unique<FramePacer::ReadbackFence>(showbase_->get_win());
+            if (fence->is_valid())
+            {
+                frame_pacer_->set_fence(std::move(fence));
+                frame_pacer_->set_max_frames_in_flight(max_frames_in_flight);
+            }
+        }
+    }
+
+    const float resolution_scale = self_.get_setting<float>("pipeline.resolution_scale", 1.0f);
+    if (self_.get_setting<bool>("pipeline.dynamic_resolution", false) && resolution_scale != 0)
+    {
+        dynamic_resolution_ = std::make_unique<DynamicResolutionController>();
+        dynamic_resolution_->set_target_frame_time(1.0 / self_.get_setting<double>("pipeline.dynamic_resolution_target_fps", 60.0));
+        dynamic_resolution_->set_scale_range(
+            self_.get_setting<float>("pipeline.dynamic_resolution_min_scale", 0.5f),
+            resolution_scale);
+        dynamic_resolution_->set_scale_step(self_.get_setting<float>("pipeline.dynamic_resolution_step", 0.05f));
+        dynamic_resolution_->set_cooldown(self_.get_setting<int>("pipeline.dynamic_resolution_cooldown", 30));
+        dynamic_resolution_->set_decrease_delay(self_.get_setting<int>("pipeline.dynamic_resolution_decrease_delay", 3));
+        dynamic_resolution_->set_scale(resolution_scale);
+    }
+
     init_common_stages();
 }
 
@@ -681,7 +819,10 @@ void RenderPipeline::Impl::adjust_lens_setting()
 
 void RenderPipeline::Impl::compute_render_resolution()
 {
-    const float scale_factor = self_.get_setting<float>("pipeline.resolution_scale", 1.0f);
+    float scale_factor = self_.get_setting<float>("pipeline.resolution_scale", 1.0f);
+    if (dynamic_resolution_ && scale_factor != 0)
+        scale_factor = dynamic_resolution_->get_scale();
+
     int resolution_width;
     int resolution_height;
 
@@ -747,12 +888,24 @@ bool RenderPipeline::Impl::init_showbase(rppanda::ShowBase* base, PandaFramework
 
 void RenderPipeline::Impl::init_bindings()
 {
+    // before the managers, so a resize is applied to the whole frame.
+    if (dynamic_resolution_)
+        showbase_->add_task(std::bind(&Impl::dynamic_resolution_task, this, std::placeholders::_1), "RP_DynamicResolution", 8);
+
     showbase_->add_task(std::bind(&Impl::manager_update_task, this, std::placeholders::_1), "RP_UpdateManagers", 10);
     showbase_->add_task(std::bind(&Impl::plugin_pre_render_update, this, std::placeholders::_1), "RP_Plugin_BeforeRender", 12);
     showbase_->add_task(std::bind(&Impl::update_inputs_and_stages, this, std::placeholders::_1), "RP_UpdateInputsAndStages", 18);
 
+    // after the tasks moving objects, such as intervals and collisions.
+    if (occlusion_culler_)
+        showbase_->add_task(std::bind(&Impl::occlusion_cull_task, this, std::placeholders::_1), "RP_OcclusionCulling", 45);
+
     // igloop has 50 sorting value.
     showbase_->add_task(std::bind(&Impl::plugin_post_render_update, this, std::placeholders::_1), "RP_Plugin_AfterRender", 55);
+
+    // after all the other tasks of the frame, including audio_loop (60).
+    if (frame_pacer_)
+        showbase_->add_task(std::bind(&Impl::frame_pacing_task, this, std::placeholders::_1), "RP_FramePacing", 70);
     showbase_->get_task_mgr()->do_method_later(0.5f, std::bind(&Impl::clear_state_cache, this, std::placeholders::_1), "RP_ClearStateCache");
     showbase_->accept("window-event", [this](const Event* ev) { handle_window_event(ev); });
 }
@@ -819,7 +972,7 @@ void RenderPipeline::Impl::init_common_stages()
     internal_stages_.push_back(std::move(combine_velocity_stage));
 
     // Add an upscale/downscale stage in case we render at a different resolution
-    if (!ConfigVariableBool("win-fixed-size", false) || Globals::resolution != Globals::native_resolution)
+    if (!ConfigVariableBool("win-fixed-size", false) || Globals::resolution != Globals::native_resolution || dynamic_resolution_)
     {
         auto upscale_stage = std::make_unique<UpscaleStage>(self_);
         stage_mgr_->add_stage(upscale_stage.get());
@@ -847,13 +1000,21 @@ NodePath RenderPipeline::Impl::create_default_skybox(float size)
 }
 
 void RenderPipeline::Impl::handle_window_resize()
+{
+    handle_resolution_change();
+    if (debugger_)
+        debugger_->handle_window_resize();
+}
+
+void RenderPipeline::Impl::handle_resolution_change()
 {
     adjust_lens_setting();
 
+    // The light culling grid, the histories and the targets which follow the resolution are resized.
+    // Targets with a fixed size are kept, because RenderTarget::consider_resize() skips them.
     light_mgr_->compute_tile_size();
+    temporal_mgr_->handle_window_resize();
     stage_mgr_->handle_window_resize();
-    if (debugger_)
-        debugger_->handle_window_resize();
     plugin_mgr_->on_window_resized();
 }
 
@@ -1036,6 +1197,16 @@ void RenderPipeline::remove_light(RPLight* light)
     impl_->light_mgr_->remove_light(light);
 }
 
+void RenderPipeline::queue_add_light(RPLight* light)
+{
+    impl_->light_mgr_->queue_add_light(light);
+}
+
+void RenderPipeline::queue_remove_light(RPLight* light)
+{
+    impl_->light_mgr_->queue_remove_light(light);
+}
+
 size_t RenderPipeline::load_ies_profile(const Filename& filename)
 {
     return impl_->ies_loader_->load(filename);
@@ -1351,4 +1522,29 @@ Debugger* RenderPipeline::get_debugger() const
     return impl_->debugger_.get();
 }
 
+TemporalManager* RenderPipeline::get_temporal_mgr() const
+{
+    return impl_->temporal_mgr_.get();
+}
+
+OcclusionCuller* RenderPipeline::get_occlusion_culler() const
+{
+    return impl_->occlusion_culler_.get();
+}
+
+FramePacer* RenderPipeline::get_frame_pacer() const
+{
+    return impl_->frame_pacer_.get();
+}
+
+DynamicResolutionController* RenderPipeline::get_dynamic_resolution_controller() const
+{
+    return impl_->dynamic_resolution_.get();
+}
+
+ShaderVariantManifest* RenderPipeline::get_shader_variant_manifest() const
+{
+    return impl_->variant_manifest_.get();
+}
+
 }
@@ -36,6 +36,7 @@
 #include "render_pipeline/rpcore/stage_manager.hpp"
 #include "render_pipeline/rpcore/image.hpp"
 #include "render_pipeline/rpcore/util/shader_input_blocks.hpp"
+#include "render_pipeline/rpcore/util/shader_variant_manifest.hpp"
 #include "render_pipeline/rppanda/showbase/showbase.hpp"
 
 namespace rpcore {
@@ -63,20 +64,60 @@ RenderStage::DefinesType RenderStage::get_produced_defines() const
     return {};
 }
 
+RenderStage::PointwiseFunction RenderStage::get_pointwise_function() const
+{
+    return {};
+}
+
 void RenderStage::set_shader_input(const ShaderInput& inp)
 {
+    // targets of a fused stage forward the input to the host
     for (const auto& target: targets_)
         target.second->set_shader_input(inp);
 }
 
+void RenderStage::attach_to_fusion_host()
+{
+    if (!fusion_host_ || attached_to_fusion_host_)
+        return;
+
+    attached_to_fusion_host_ = true;
+    for (const auto& inp: fusion_inputs_)
+        fusion_host_->set_shader_input(inp);
+    fusion_inputs_.clear();
+
+    // the host renders this stage, so free the buffers of the own targets
+    for (const auto& target: targets_)
+        target.second->remove();
+}
+
+void RenderStage::set_targets_shader(const Shader* shader)
+{
+    for (const auto& target: targets_)
+        target.second->set_shader(shader);
+}
+
+void RenderStage::set_targets_active(bool state)
+{
+    for (const auto& target: targets_)
+        target.second->set_active(state);
+}
+
 void RenderStage::set_active(bool state)
 {
-    if (active_ != state)
+    if (active_ == state)
+        return;
+
+    active_ = state;
+
+    // the pass of a fused group renders all active stages of the group
+    if (fused_)
     {
-        active_ = state;
-        for (const auto& target: targets_)
-            target.second->set_active(active_);
+        pipeline_.get_stage_mgr()->update_fused_pass(this);
+        return;
     }
+
+    set_targets_active(active_);
 }
 
 RenderTarget* RenderStage::create_target(boost::string_view name)
@@ -89,7 +130,10 @@ RenderTarget* RenderStage::create_target(boost::string_view name)
         return nullptr;
     }
 
-    return targets_.emplace(target_name, std::make_unique<RenderTarget>(target_name)).first->second.get();
+    RenderTarget* target = targets_.emplace(target_name, std::make_unique<RenderTarget>(target_name)).first->second.get();
+    if (fusion_host_)
+        target->set_shader_input_forward([this](const ShaderInput& inp) { forward_to_fusion_host(inp); });
+    return target;
 }
 
 void RenderStage::remove_target(RenderTarget* target)
@@ -112,8 +156,7 @@ PT(Shader) RenderStage::load_shader(const std::vector<Filename>& args, bool ster
 
 PT(Shader) RenderStage::load_plugin_shader(const std::vector<Filename>& args, bool stereo_post, bool use_post_gs) const
 {
-    const Filename& shader_path = pipeline_.get_plugin_mgr()->get_instance(get_plugin_id())->get_shader_resource("");
-    return get_shader_handle(shader_path, args, stereo_post, use_post_gs);
+    return get_shader_handle(get_plugin_shader_path(""), args, stereo_post, use_post_gs);
 }
 
 void RenderStage::handle_window_resize()
@@ -174,7 +217,24 @@ PT(Shader) RenderStage::get_shader_handle(const Filename& base_path, const std::
         }
     }
 
+    if (ShaderVariantManifest* manifest = pipeline_.get_shader_variant_manifest())
+        manifest->record_stage_shader(path_args);
+
     return RPLoader::load_shader(path_args);
 }
 
+void RenderStage::forward_to_fusion_host(const ShaderInput& inp)
+{
+    // the host does not have targets before it is created
+    if (attached_to_fusion_host_)
+        fusion_host_->set_shader_input(inp);
+    else
+        fusion_inputs_.push_back(inp);
+}
+
+Filename RenderStage::get_plugin_shader_path(const Filename& path) const
+{
+    return pipeline_.get_plugin_mgr()->get_instance(get_plugin_id())->get_shader_resource(path);
+}
+
 }
@@ -81,6 +81,7 @@ public:
 
     boost::optional<int> sort_;
     std::unordered_map<std::string, PT(Texture)> targets_;
+    std::function<void(const ShaderInput&)> input_forward_;
     LVecBase4i color_bits_ = LVecBase4i(0, 0, 0, 0);
     int aux_bits_ = 8;
     int aux_count_ = 0;
@@ -111,6 +112,9 @@ void RenderTarget::Impl::initilize()
 
 void RenderTarget::Impl::set_active(bool flag)
 {
+    if (!internal_buffer_)
+        return;
+
     const int num_display_regions = internal_buffer_->get_num_display_regions();
     for (int k = 0; k < num_display_regions; k++)
         internal_buffer_->get_display_region(k)->set_active(flag);
@@ -590,10 +594,18 @@ bool RenderTarget::get_active() const
 
 void RenderTarget::set_shader_input(const ShaderInput& inp, bool override_input)
 {
-    if (impl_->create_default_region_)
+    if (impl_->input_forward_)
+        impl_->input_forward_(inp);
+
+    if (impl_->create_default_region_ && impl_->source_postprocess_region_)
         impl_->source_postprocess_region_->set_shader_input(inp, override_input);
 }
 
+void RenderTarget::set_shader_input_forward(std::function<void(const ShaderInput&)> func)
+{
+    impl_->input_forward_ = std::move(func);
+}
+
 void RenderTarget::set_shader(const Shader* sha)
 {
     if (!sha)
@@ -601,6 +613,11 @@ void RenderTarget::set_shader(const Shader* sha)
         error("shader must not be nullptr!");
         return;
     }
+
+    // removed target
+    if (!impl_->source_postprocess_region_)
+        return;
+
     impl_->source_postprocess_region_->set_shader(sha, 0);
 }
 
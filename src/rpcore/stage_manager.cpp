@@ -22,6 +22,7 @@
 
 #include "render_pipeline/rpcore/stage_manager.hpp"
 
+#include <algorithm>
 #include <regex>
 
 #include <boost/algorithm/string.hpp>
@@ -38,6 +39,7 @@
 #include "render_pipeline/rpcore/render_pipeline.hpp"
 #include "render_pipeline/rpcore/render_stage.hpp"
 #include "render_pipeline/rpcore/util/shader_input_blocks.hpp"
+#include "render_pipeline/rpcore/util/stage_fusion_planner.hpp"
 
 namespace rpcore {
 
@@ -51,6 +53,15 @@ public:
 
     void prepare_stages();
 
+    /**
+     * Finds adjacent point-wise stages and assigns the last stage of each
+     * group as fusion host of the others.
+     */
+    void plan_stage_fusion();
+
+    /** Generates and sets the shader of the fused pass for the active stages of the group. */
+    void apply_fused_shader(const std::vector<RenderStage*>& fused_stages);
+
     /** Sets all required pipes on a stage. */
     bool bind_pipes_to_stage(RenderStage* stage);
 
@@ -101,6 +112,12 @@ public:
     std::shared_ptr<UpdatePreviousPipesStage> prev_stage_;
 
     std::vector<std::string> stage_order_;
+
+    /** Fused stages in render order. The last stage of each group is the host. */
+    std::vector<std::vector<RenderStage*>> fused_groups_;
+
+    /** Whether the fused passes have shaders, which is after the first reload_shaders(). */
+    bool fused_shaders_loaded_ = false;
 };
 
 StageManager::Impl::Impl(StageManager& self, RenderPipeline& pipeline): self_(self), pipeline_(pipeline)
@@ -145,6 +162,79 @@ void StageManager::Impl::prepare_stages()
     });
 }
 
+void StageManager::Impl::plan_stage_fusion()
+{
+    fused_groups_.clear();
+
+    if (!pipeline_.get_setting<bool>("pipeline.stage_fusion", false))
+        return;
+
+    std::vector<StageFusionPlanner::StageInfo> infos;
+    infos.reserve(stages_.size());
+    for (const auto& stage: stages_)
+    {
+        infos.push_back(StageFusionPlanner::StageInfo{
+            stage->get_stage_id(),
+            !stage->get_pointwise_function().name.empty(),
+            stage->get_active(),
+            stage->get_required_pipes() });
+    }
+
+    const StageFusionPlanner planner;
+    for (const auto& group: planner.plan(infos))
+    {
+        std::vector<RenderStage*> fused_stages(stages_.begin() + group.begin, stages_.begin() + group.end);
+        RenderStage* host = fused_stages.back();
+
+        std::string names;
+        for (const auto& stage: fused_stages)
+        {
+            if (stage != host)
+                stage->set_fusion_host(host);
+            stage->set_fused(true);
+            names += (names.empty() ? "" : ", ") + stage->get_stage_id();
+        }
+
+        self_.debug(fmt::format("Fusing point-wise stages ({}) into {}", names, host->get_stage_id()));
+        fused_groups_.push_back(std::move(fused_stages));
+    }
+}
+
+void StageManager::Impl::apply_fused_shader(const std::vector<RenderStage*>& fused_stages)
+{
+    RenderStage* host = fused_stages.back();
+
+    // the file name has the active stages, so that a shader cached for another combination is not used
+    std::vector<StageFusionPlanner::Function> functions;
+    std::string active_mask;
+    for (const auto& stage: fused_stages)
+    {
+        active_mask += stage->get_active() ? '1' : '0';
+        if (!stage->get_active())
+            continue;
+
+        const auto& func = stage->get_pointwise_function();
+        functions.push_back(StageFusionPlanner::Function{ func.include.get_fullpath(), func.name });
+    }
+
+    host->set_targets_active(!functions.empty());
+    if (functions.empty())
+        return;
+
+    const std::string shader_path = "/$$rptemp/$$fused_" + host->get_stage_id() + "_" + active_mask + ".frag.glsl";
+    try
+    {
+        (*rppanda::open_write_file(shader_path, false, true)) << StageFusionPlanner().generate_fragment_shader(functions);
+    }
+    catch (const std::exception& err)
+    {
+        self_.error(fmt::format("Error writing fused shader of {}: {}", host->get_stage_id(), err.what()));
+        return;
+    }
+
+    host->set_targets_shader(host->load_shader({ shader_path }, pipeline_.is_stereo_mode()));
+}
+
 bool StageManager::Impl::bind_pipes_to_stage(RenderStage* stage)
 {
     const auto& required_pipes = stage->get_required_pipes();
@@ -435,6 +525,10 @@ void StageManager::setup()
     impl_->input_block_list_.clear();
 
     impl_->prepare_stages();
+    impl_->plan_stage_fusion();
+
+    // stages fused into a host which is not created yet
+    std::vector<RenderStage*> pending_fused_stages;
 
     for (auto&& stage: impl_->stages_)
     {
@@ -444,6 +538,22 @@ void StageManager::setup()
         trace(fmt::format("Stage ({}) handles window re-sizing.", stage->get_debug_name()));
         stage->handle_window_resize();
 
+        // Fused stages are rendered by the host, and their result is not registered. They are
+        // moved into the host when it exists, so that their inputs are forwarded to the host.
+        if (stage->get_fusion_host())
+        {
+            pending_fused_stages.push_back(stage);
+            continue;
+        }
+
+        for (const auto& fused_stage: pending_fused_stages)
+        {
+            fused_stage->attach_to_fusion_host();
+            impl_->bind_pipes_to_stage(fused_stage);
+            impl_->bind_inputs_to_stage(fused_stage);
+        }
+        pending_fused_stages.clear();
+
         // Rely on the methods to print an appropriate error message
         if (!impl_->bind_pipes_to_stage(stage))
             continue;
@@ -462,6 +572,9 @@ void StageManager::reload_shaders()
     write_autoconfig();
     for (const auto& stage: impl_->stages_)
         stage->reload_shaders();
+    for (const auto& fused_stages: impl_->fused_groups_)
+        impl_->apply_fused_shader(fused_stages);
+    impl_->fused_shaders_loaded_ = true;
 }
 
 void StageManager::update()
@@ -473,6 +586,22 @@ void StageManager::update()
     }
 }
 
+void StageManager::update_fused_pass(RenderStage* stage)
+{
+    // the passes get their shaders in reload_shaders()
+    if (!impl_->fused_shaders_loaded_)
+        return;
+
+    for (const auto& fused_stages: impl_->fused_groups_)
+    {
+        if (std::find(fused_stages.begin(), fused_stages.end(), stage) != fused_stages.end())
+        {
+            impl_->apply_fused_shader(fused_stages);
+            return;
+        }
+    }
+}
+
 void StageManager::handle_window_resize()
 {
     for (const auto& stage: impl_->stages_)
@@ -0,0 +1,281 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "render_pipeline/rpcore/temporal_manager.hpp"
+
+#include <nodePath.h>
+#include <lens.h>
+
+#include <algorithm>
+
+#include "render_pipeline/rpcore/globals.hpp"
+
+namespace rpcore {
+
+float TemporalManager::halton(int index, int base)
+{
+    float result = 0.0f;
+    float f = 1.0f;
+    while (index > 0)
+    {
+        f /= float(base);
+        result += f * float(index % base);
+        index /= base;
+    }
+    return result;
+}
+
+std::vector<LVecBase2f> TemporalManager::generate_halton_sequence(size_t count, int base_x, int base_y)
+{
+    std::vector<LVecBase2f> sequence;
+    sequence.reserve(count);
+
+    // skip the index 0 which is (0, 0) in all bases
+    for (size_t k = 1; k <= count; ++k)
+        sequence.push_back(LVecBase2f(halton(static_cast<int>(k), base_x), halton(static_cast<int>(k), base_y)));
+
+    return sequence;
+}
+
+LVecBase2f TemporalManager::film_offset_to_ndc(const LVecBase2f& film_offset, const LVecBase2f& film_size)
+{
+    // see: Lens::do_compute_film_mat
+    return LVecBase2f(-2.0f * film_offset[0] / film_size[0], -2.0f * film_offset[1] / film_size[1]);
+}
+
+LMatrix4f TemporalManager::remove_jitter(const LMatrix4f& proj_mat, const LVecBase2f& ndc_jitter)
+{
+    // the jitter is a translation of the clip space scaled by w
+    return proj_mat * LMatrix4f::translate_mat(-ndc_jitter[0], -ndc_jitter[1], 0.0f);
+}
+
+// ************************************************************************************************
+
+TemporalManager::TemporalManager(): RPObject("TemporalManager")
+{
+}
+
+TemporalManager::~TemporalManager() = default;
+
+void TemporalManager::set_jitter_sequence(std::vector<LVecBase2f> sequence)
+{
+    jitter_sequence_ = std::move(sequence);
+    jitter_index_ = 0;
+}
+
+LVecBase2f TemporalManager::get_current_jitter() const
+{
+    if (jitter_sequence_.empty())
+        return LVecBase2f(0.0f);
+    return jitter_sequence_[jitter_index_] * jitter_scale_;
+}
+
+void TemporalManager::advance_jitter()
+{
+    if (jitter_sequence_.empty())
+        return;
+
+    jitter_index_ += 1;
+    if (jitter_index_ >= jitter_sequence_.size())
+        jitter_index_ = 0;
+}
+
+void TemporalManager::set_history_length(size_t length)
+{
+    history_length_ = (std::max)(length, size_t(2));
+    while (frames_.size() > history_length_)
+        frames_.pop_back();
+    num_valid_frames_ = (std::min)(num_valid_frames_, frames_.size());
+}
+
+void TemporalManager::begin_frame(const LMatrix4f& view_mat, const LMatrix4f& proj_mat, const LVecBase2f& ndc_jitter)
+{
+    FrameData frame;
+    frame.frame_index = frame_counter_++;
+    frame.view_mat = view_mat;
+    frame.proj_mat = proj_mat;
+    frame.view_proj_mat = view_mat * proj_mat;
+    frame.view_proj_mat_no_jitter = view_mat * remove_jitter(proj_mat, ndc_jitter);
+    frame.jitter = ndc_jitter;
+
+    if (camera_cut_distance_ > 0 && num_valid_frames_ > 0)
+    {
+        // camera position is the translation of the inverse view matrix
+        const LPoint3f curr_pos = invert(view_mat).get_row3(3);
+        const LPoint3f last_pos = invert(frames_.front().view_mat).get_row3(3);
+        if ((curr_pos - last_pos).length() > camera_cut_distance_)
+        {
+            debug("Camera cut is detected. Invalidating temporal history.");
+            invalidate_history();
+        }
+    }
+
+    frames_.push_front(frame);
+    if (frames_.size() > history_length_)
+        frames_.pop_back();
+
+    num_valid_frames_ = (std::min)(num_valid_frames_ + 1, frames_.size());
+}
+
+const TemporalManager::FrameData& TemporalManager::get_frame(size_t age) const
+{
+    static const FrameData empty_frame;
+
+    if (frames_.empty())
+        return empty_frame;
+
+    const size_t oldest = num_valid_frames_ == 0 ? 0 : num_valid_frames_ - 1;
+    return frames_[(std::min)(age, oldest)];
+}
+
+void TemporalManager::invalidate_history()
+{
+    num_valid_frames_ = 0;
+    for (auto& buffer: buffers_)
+    {
+        buffer->has_history_ = false;
+        buffer->num_frames_ = 0;
+    }
+}
+
+LMatrix4f TemporalManager::get_reprojection_mat() const
+{
+    return invert(get_current_frame().view_proj_mat_no_jitter) * get_previous_frame().view_proj_mat_no_jitter;
+}
+
+TemporalManager::HistoryBuffer* TemporalManager::acquire_history(Image::Format format, const LVecBase2i& size)
+{
+    for (auto& buffer: buffers_)
+    {
+        if (!buffer->in_use_ && buffer->format_ == format && buffer->requested_size_ == size)
+        {
+            buffer->in_use_ = true;
+            buffer->has_history_ = false;
+            buffer->num_frames_ = 0;
+            return buffer.get();
+        }
+    }
+
+    const std::string name = "TemporalHistory" + std::to_string(buffers_.size());
+
+    auto buffer = std::make_unique<HistoryBuffer>();
+    buffer->format_ = format;
+    buffer->requested_size_ = size;
+    buffer->in_use_ = true;
+    buffer->images_[0] = Image::create_2d(name + "-A", 0, 0, format);
+    buffer->images_[1] = Image::create_2d(name + "-B", 0, 0, format);
+    for (auto& image: buffer->images_)
+    {
+        image->set_minfilter(SamplerState::FT_linear);
+        image->set_magfilter(SamplerState::FT_linear);
+        image->set_wrap_u(SamplerState::WM_clamp);
+        image->set_wrap_v(SamplerState::WM_clamp);
+    }
+    resize_buffer(*buffer);
+
+    trace("Created history buffer " + name);
+
+    buffers_.push_back(std::move(buffer));
+    return buffers_.back().get();
+}
+
+void TemporalManager::release_history(HistoryBuffer* buffer)
+{
+    if (!buffer)
+        return;
+
+    auto found = std::find_if(buffers_.begin(), buffers_.end(), [buffer](const std::unique_ptr<HistoryBuffer>& b) {
+        return b.get() == buffer;
+    });
+
+    if (found == buffers_.end())
+    {
+        error("History buffer is not owned by this manager.");
+        return;
+    }
+
+    buffer->in_use_ = false;
+}
+
+size_t TemporalManager::get_history_memory_size() const
+{
+    size_t size = 0;
+    for (const auto& buffer: buffers_)
+        size += buffer->images_[0]->get_size_in_bytes() + buffer->images_[1]->get_size_in_bytes();
+    return size;
+}
+
+void TemporalManager::update(const NodePath& camera, Lens* lens)
+{
+    advance_jitter();
+
+    LVecBase2f ndc_jitter(0.0f);
+    if (!jitter_sequence_.empty())
+    {
+        const LVecBase2f jitter = get_current_jitter();
+        lens->set_film_offset(LCAST(PN_stdfloat, jitter));
+        ndc_jitter = film_offset_to_ndc(jitter, LCAST(float, lens->get_film_size()));
+        jitter_applied_ = true;
+    }
+    else if (jitter_applied_)
+    {
+        lens->set_film_offset(LVecBase2(0));
+        jitter_applied_ = false;
+    }
+
+    begin_frame(
+        LCAST(float, Globals::render.get_transform(camera)->get_mat()),
+        LCAST(float, lens->get_projection_mat()),
+        ndc_jitter);
+
+    for (auto& buffer: buffers_)
+    {
+        if (!buffer->in_use_)
+            continue;
+
+        // the previous texture is written only if the buffer was used in the last frame
+        buffer->current_ = 1 - buffer->current_;
+        buffer->has_history_ = buffer->num_frames_ > 0;
+        ++buffer->num_frames_;
+    }
+}
+
+void TemporalManager::handle_window_resize()
+{
+    for (auto& buffer: buffers_)
+    {
+        resize_buffer(*buffer);
+        buffer->has_history_ = false;
+        buffer->num_frames_ = 0;
+    }
+}
+
+void TemporalManager::resize_buffer(HistoryBuffer& buffer) const
+{
+    const int w = buffer.requested_size_[0] < 0 ? Globals::resolution.get_x() : buffer.requested_size_[0];
+    const int h = buffer.requested_size_[1] < 0 ? Globals::resolution.get_y() : buffer.requested_size_[1];
+    for (auto& image: buffer.images_)
+    {
+        image->set_x_size(w);
+        image->set_y_size(h);
+    }
+}
+
+}
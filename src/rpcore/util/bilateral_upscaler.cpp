@@ -0,0 +1,261 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "render_pipeline/rpcore/util/bilateral_upscaler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "render_pipeline/rpcore/render_pipeline.hpp"
+#include "render_pipeline/rpcore/render_stage.hpp"
+#include "render_pipeline/rpcore/render_target.hpp"
+
+namespace rpcore {
+
+static int get_divisor(BilateralUpscaler::Mode mode)
+{
+    switch (mode)
+    {
+    case BilateralUpscaler::Mode::half:
+        return 2;
+    case BilateralUpscaler::Mode::quarter:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+bool BilateralUpscaler::parse_mode(const std::string& name, Mode& mode)
+{
+    for (Mode m: { Mode::full, Mode::half, Mode::quarter, Mode::checkerboard })
+    {
+        if (name == get_mode_name(m))
+        {
+            mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* BilateralUpscaler::get_mode_name(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::half:
+        return "half";
+    case Mode::quarter:
+        return "quarter";
+    case Mode::checkerboard:
+        return "checkerboard";
+    default:
+        return "full";
+    }
+}
+
+BilateralUpscaler::Mode BilateralUpscaler::get_stage_mode(const RenderPipeline& pipeline, const std::string& stage_id, Mode fallback)
+{
+    const std::string name = pipeline.get_setting<std::string>("pipeline.stage_resolution." + stage_id, get_mode_name(fallback));
+
+    Mode mode;
+    if (!parse_mode(name, mode))
+    {
+        global_error("BilateralUpscaler", "Invalid stage resolution '" + name + "' for " + stage_id);
+        return fallback;
+    }
+    return mode;
+}
+
+LVecBase2i BilateralUpscaler::get_size_constraint(Mode mode)
+{
+    if (mode == Mode::checkerboard)
+        return LVecBase2i(-2, -1);
+    return LVecBase2i(-get_divisor(mode));
+}
+
+LVecBase2i BilateralUpscaler::get_full_coord(Mode mode, const LVecBase2i& source_coord, int parity)
+{
+    if (mode == Mode::checkerboard)
+        return LVecBase2i(source_coord[0] * 2 + ((source_coord[1] + parity) & 1), source_coord[1]);
+    return source_coord * get_divisor(mode);
+}
+
+int BilateralUpscaler::get_taps(Mode mode, const LVecBase2i& coord, const LVecBase2i& full_size, int parity, Tap taps[4])
+{
+    if (mode == Mode::checkerboard)
+    {
+        if (((coord[0] + coord[1] + parity) & 1) == 0)
+        {
+            taps[0].source_coord = LVecBase2i(coord[0] / 2, coord[1]);
+            taps[0].full_coord = coord;
+            return 1;
+        }
+
+        // 4 direct neighbors are rendered. On the border, mirror them to keep the parity.
+        const int x0 = coord[0] - 1 < 0 ? coord[0] + 1 : coord[0] - 1;
+        const int x1 = coord[0] + 1 >= full_size[0] ? coord[0] - 1 : coord[0] + 1;
+        const int y0 = coord[1] - 1 < 0 ? coord[1] + 1 : coord[1] - 1;
+        const int y1 = coord[1] + 1 >= full_size[1] ? coord[1] - 1 : coord[1] + 1;
+
+        const LVecBase2i neighbors[4] = {
+            LVecBase2i(x0, coord[1]),
+            LVecBase2i(x1, coord[1]),
+            LVecBase2i(coord[0], y0),
+            LVecBase2i(coord[0], y1),
+        };
+        for (int k = 0; k < 4; ++k)
+        {
+            taps[k].source_coord = LVecBase2i(neighbors[k][0] / 2, neighbors[k][1]);
+            taps[k].full_coord = neighbors[k];
+        }
+        return 4;
+    }
+
+    const int divisor = get_divisor(mode);
+    if (divisor == 1)
+    {
+        taps[0].source_coord = coord;
+        taps[0].full_coord = coord;
+        return 1;
+    }
+
+    // 2x2 texels around the pixel, clamped to the source size
+    const LVecBase2i source_max(
+        (full_size[0] + divisor - 1) / divisor - 1,
+        (full_size[1] + divisor - 1) / divisor - 1);
+    const LVecBase2i base(coord[0] / divisor, coord[1] / divisor);
+    for (int k = 0; k < 4; ++k)
+    {
+        taps[k].source_coord = LVecBase2i(
+            (std::min)(base[0] + (k & 1), source_max[0]),
+            (std::min)(base[1] + (k >> 1), source_max[1]));
+        taps[k].full_coord = taps[k].source_coord * divisor;
+    }
+    return 4;
+}
+
+float BilateralUpscaler::compute_weight(float center_depth, const LVecBase3f& center_normal,
+    float sample_depth, const LVecBase3f& sample_normal, const LVecBase2f& upscale_weights)
+{
+    const float depth_diff = std::abs(sample_depth - center_depth) / upscale_weights[0];
+    const float nrm_diff = (std::max)(0.0f, sample_normal.dot(center_normal));
+    return (1.0f - (std::min)(depth_diff, 1.0f)) * std::pow(nrm_diff, 1.0f / upscale_weights[1]);
+}
+
+void BilateralUpscaler::upscale(Mode mode, int parity, const LVecBase2i& full_size, const float* depth,
+    const LVecBase3f* normals, const LVecBase4f* source, const LVecBase2f& upscale_weights,
+    LVecBase4f* result)
+{
+    const LVecBase2i constraint = get_size_constraint(mode);
+    const int source_width = (full_size[0] - constraint[0] - 1) / (-constraint[0]);
+
+    Tap taps[4];
+    for (int y = 0; y < full_size[1]; ++y)
+    {
+        for (int x = 0; x < full_size[0]; ++x)
+        {
+            const LVecBase2i coord(x, y);
+            const int num_taps = get_taps(mode, coord, full_size, parity, taps);
+            LVecBase4f& out = result[y * full_size[0] + x];
+
+            if (num_taps == 1)
+            {
+                out = source[taps[0].source_coord[1] * source_width + taps[0].source_coord[0]];
+                continue;
+            }
+
+            const int center = y * full_size[0] + x;
+            float weights = 0;
+            LVecBase4f accum(0.0f);
+            for (int k = 0; k < num_taps; ++k)
+            {
+                const int full_index = taps[k].full_coord[1] * full_size[0] + taps[k].full_coord[0];
+                const float weight = compute_weight(depth[center], normals[center],
+                    depth[full_index], normals[full_index], upscale_weights);
+                accum += source[taps[k].source_coord[1] * source_width + taps[k].source_coord[0]] * weight;
+                weights += weight;
+            }
+
+            // When no sample is valid, take the first sample
+            if (weights < 1e-5f)
+                out = source[taps[0].source_coord[1] * source_width + taps[0].source_coord[0]];
+            else
+                out = accum / weights;
+        }
+    }
+}
+
+// ************************************************************************************************
+
+BilateralUpscaler::BilateralUpscaler(RenderStage& stage, Mode mode, const LVecBase2f& upscale_weights, bool stereo):
+    RPObject("BilateralUpscaler"), stage_(stage), mode_(mode), upscale_weights_(upscale_weights), stereo_(stereo)
+{
+    params_ = PTA_LVecBase3i::empty_array(1);
+    params_[0] = LVecBase3i(get_divisor(mode), mode == Mode::checkerboard ? 1 : 0, 0);
+}
+
+BilateralUpscaler::~BilateralUpscaler() = default;
+
+RenderTarget* BilateralUpscaler::create(const std::string& name, const LVecBase4i& color_bits)
+{
+    debug(std::string("Rendering ") + stage_.get_stage_id() + " in " + get_mode_name(mode_) + " resolution");
+
+    source_target_ = stage_.create_target(name);
+    source_target_->set_size(get_size_constraint(mode_));
+    source_target_->add_color_attachment(color_bits);
+    if (stereo_)
+        source_target_->set_layers(2);
+    source_target_->prepare_buffer();
+    source_target_->set_shader_input(ShaderInput("reducedResolutionParams", params_));
+
+    if (mode_ == Mode::full)
+        return source_target_;
+
+    upscale_target_ = stage_.create_target("Upscale");
+    upscale_target_->add_color_attachment(color_bits);
+    if (stereo_)
+        upscale_target_->set_layers(2);
+    upscale_target_->prepare_buffer();
+
+    upscale_target_->set_shader_input(ShaderInput("SourceTex", source_target_->get_color_tex()));
+    upscale_target_->set_shader_input(ShaderInput("upscaleWeights", upscale_weights_));
+    upscale_target_->set_shader_input(ShaderInput("reducedResolutionParams", params_));
+
+    return source_target_;
+}
+
+Texture* BilateralUpscaler::get_result_tex() const
+{
+    return (upscale_target_ ? upscale_target_ : source_target_)->get_color_tex();
+}
+
+void BilateralUpscaler::reload_shaders()
+{
+    if (upscale_target_)
+        upscale_target_->set_shader(stage_.load_shader({"reduced_resolution_upscale.frag.glsl"}, stereo_));
+}
+
+void BilateralUpscaler::update()
+{
+    if (mode_ == Mode::checkerboard)
+        params_[0][2] = 1 - params_[0][2];
+}
+
+}
@@ -0,0 +1,408 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "render_pipeline/rpcore/util/cpu_light_culler.hpp"
+
+#include <lens.h>
+
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+
+#include "render_pipeline/rpcore/render_pipeline.hpp"
+#include "render_pipeline/rpcore/native/internal_light_manager.h"
+
+namespace rpcore {
+
+// Same values with light_culling.inc.glsl
+static constexpr float SLICE_EXP_FACTOR = 3.0f;
+static constexpr float CULL_BIAS = 1 + 0.01f;
+static constexpr float CELL_DISTANCE_BIAS = 0.05f;
+
+static const LVecBase2f ray_dirs[] = {
+    LVecBase2f(0, 0),
+    LVecBase2f(1.0f, 1.0f) * CULL_BIAS,
+    LVecBase2f(-1.0f, 1.0f) * CULL_BIAS,
+    LVecBase2f(1.0f, -1.0f) * CULL_BIAS,
+    LVecBase2f(-1.0f, -1.0f) * CULL_BIAS,
+};
+
+/** Same with `gpu_cq_unpack_int_from_float` in GLSL. */
+static int unpack_int(float v)
+{
+    if (GPUCommand::get_uses_integer_packing())
+    {
+        int result;
+        std::memcpy(&result, &v, sizeof(result));
+        return result;
+    }
+    else
+    {
+        return static_cast<int>(v);
+    }
+}
+
+/** @see ray_sphere_intersection in light_culling.inc.glsl */
+static bool viewspace_ray_sphere_distance_intersection(const LVecBase3f& sphere_pos, float sphere_radius,
+    const LVecBase3f& ray_dir, float tile_start, float tile_end)
+{
+    const LVecBase3f o_minus_c = -sphere_pos;
+    const float l_dot_o_minus_c = ray_dir.dot(o_minus_c);
+    const float root = l_dot_o_minus_c * l_dot_o_minus_c - o_minus_c.dot(o_minus_c) + sphere_radius * sphere_radius;
+    const float sqr_root = std::sqrt(std::abs(root));
+
+    const float min_dist = -l_dot_o_minus_c + sqr_root;
+    const float max_dist = -l_dot_o_minus_c - sqr_root;
+
+    return root > 0 && max_dist < tile_end && min_dist > tile_start;
+}
+
+CPULightCuller::Settings CPULightCuller::Settings::from_pipeline(const RenderPipeline& pipeline)
+{
+    Settings settings;
+    settings.tile_size = LVecBase2i(
+        pipeline.get_setting<int>("lighting.culling_grid_size_x"),
+        pipeline.get_setting<int>("lighting.culling_grid_size_y"));
+    settings.num_slices = pipeline.get_setting<int>("lighting.culling_grid_slices");
+    settings.max_distance = pipeline.get_setting<float>("lighting.culling_max_distance");
+    settings.max_lights_per_cell = pipeline.get_setting<int>("lighting.max_lights_per_cell");
+    return settings;
+}
+
+void CPULightCuller::pack_light_data(const InternalLightManager& mgr, std::vector<float>& light_data)
+{
+    const int max_light_index = mgr.get_max_light_index();
+    light_data.assign((std::max)(0, max_light_index + 1) * LIGHT_DATA_STRIDE, 0.0f);
+
+    // GPUCommand of CMD_store_light has command type and slot before the light data.
+    static constexpr size_t light_data_offset = 2;
+    PTA_uchar command_data = PTA_uchar::empty_array(GPU_COMMAND_ENTRIES * sizeof(float));
+    for (int k = 0; k <= max_light_index; ++k)
+    {
+        RPLight* light = mgr.get_light(k);
+        if (!light)
+            continue;
+
+        GPUCommand cmd(GPUCommand::CMD_store_light);
+        cmd.push_int(k);
+        light->write_to_command(cmd);
+        cmd.write_to(command_data, 0);
+
+        std::memcpy(light_data.data() + k * LIGHT_DATA_STRIDE,
+            reinterpret_cast<const float*>(command_data.p()) + light_data_offset,
+            LIGHT_DATA_STRIDE * sizeof(float));
+    }
+}
+
+CPULightCuller::LightClass CPULightCuller::classify_light(int light_type, bool casts_shadows)
+{
+    switch (light_type)
+    {
+    case RPLight::LT_spot_light:
+        return casts_shadows ? LIGHT_CLS_SPOT_SHADOW : LIGHT_CLS_SPOT_NOSHADOW;
+    case RPLight::LT_point_light:
+        return casts_shadows ? LIGHT_CLS_POINT_SHADOW : LIGHT_CLS_POINT_NOSHADOW;
+    default:
+        return LIGHT_CLS_INVALID;
+    }
+}
+
+CPULightCuller::CPULightCuller(const Settings& settings, size_t num_threads): RPObject("CPULightCuller"), settings_(settings)
+{
+    set_num_threads(num_threads);
+    frustum_directions_.fill(LVecBase3f(0, 0, -1));
+}
+
+void CPULightCuller::set_num_threads(size_t num_threads)
+{
+    if (num_threads == 0)
+        num_threads = (std::max)(1u, std::thread::hardware_concurrency());
+    num_threads_ = num_threads;
+}
+
+void CPULightCuller::set_resolution(const LVecBase2i& resolution)
+{
+    resolution_ = resolution;
+    num_tiles_ = LVecBase2i(
+        static_cast<int>(std::ceil(resolution.get_x() / static_cast<float>(settings_.tile_size.get_x()))),
+        static_cast<int>(std::ceil(resolution.get_y() / static_cast<float>(settings_.tile_size.get_y()))));
+
+    cell_flags_.assign(num_tiles_.get_x() * num_tiles_.get_y() * settings_.num_slices, 0);
+    cell_lookup_.assign(cell_flags_.size(), -1);
+    cells_.clear();
+}
+
+void CPULightCuller::set_camera(const LMatrix4f& view_mat, const Lens* lens)
+{
+    static const LVecBase2i points[4] ={ LVecBase2i(-1, -1), LVecBase2i(1, -1), LVecBase2i(-1, 1), LVecBase2i(1, 1) };
+
+    const LMatrix4f& zup_conversion = LMatrix4f::z_to_y_up_mat();
+    const LMatrix4f& inv_proj_mat = lens->get_projection_mat_inv();
+
+    std::array<LVecBase3f, 4> vs_frustum_directions;
+    for (size_t i = 0; i < std::extent<decltype(points)>::value; ++i)
+    {
+        const LVecBase4f& result = inv_proj_mat.xform(LVecBase4f(points[i][0], points[i][1], 1.0, 1.0));
+        vs_frustum_directions[i] = zup_conversion.xform(result).get_xyz().normalized();
+    }
+
+    set_camera(view_mat * zup_conversion, vs_frustum_directions);
+}
+
+void CPULightCuller::set_camera(const LMatrix4f& view_mat_z_up, const std::array<LVecBase3f, 4>& vs_frustum_directions)
+{
+    view_mat_z_up_ = view_mat_z_up;
+    frustum_directions_ = vs_frustum_directions;
+}
+
+void CPULightCuller::flag_all_cells()
+{
+    std::fill(cell_flags_.begin(), cell_flags_.end(), 1);
+}
+
+void CPULightCuller::flag_used_cells(const float* surface_distances)
+{
+    std::fill(cell_flags_.begin(), cell_flags_.end(), 0);
+
+    const int width = resolution_.get_x();
+    const int height = resolution_.get_y();
+    for (int y = 0; y < height; ++y)
+    {
+        const int tile_y = y / settings_.tile_size.get_y();
+        for (int x = 0; x < width; ++x)
+        {
+            const float dist = surface_distances[y * width + x];
+            if (dist < 0)
+                continue;
+
+            const int slice = get_slice_from_distance(dist);
+            if (slice >= settings_.num_slices)
+                continue;
+
+            cell_flags_[get_flag_index(x / settings_.tile_size.get_x(), tile_y, slice)] = 1;
+        }
+    }
+}
+
+void CPULightCuller::cull_lights(const float* light_data, int max_light_index)
+{
+    // collect used cells, like CollectUsedCellsStage
+    cells_.clear();
+    std::fill(cell_lookup_.begin(), cell_lookup_.end(), -1);
+    for (int slice = 0; slice < settings_.num_slices; ++slice)
+    {
+        for (int y = 0; y < num_tiles_.get_y(); ++y)
+        {
+            for (int x = 0; x < num_tiles_.get_x(); ++x)
+            {
+                const int flag_index = get_flag_index(x, y, slice);
+                if (!cell_flags_[flag_index])
+                    continue;
+
+                cell_lookup_[flag_index] = static_cast<int>(cells_.size());
+                cells_.push_back(Cell{ x, y, slice, {}, {} });
+            }
+        }
+    }
+
+    collect_frustum_lights(light_data, max_light_index);
+
+    const size_t num_cells = cells_.size();
+    const size_t num_threads = (std::min)(num_threads_, num_cells);
+    if (num_threads <= 1)
+    {
+        for (auto& cell: cells_)
+            cull_cell(cell);
+        return;
+    }
+
+    // interleave cells, because near cells usually have more lights.
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads);
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        workers.emplace_back([this, t, num_threads, num_cells]() {
+            for (size_t k = t; k < num_cells; k += num_threads)
+                cull_cell(cells_[k]);
+        });
+    }
+    for (auto& worker: workers)
+        worker.join();
+}
+
+int CPULightCuller::find_cell(int x, int y, int slice) const
+{
+    if (x < 0 || y < 0 || slice < 0 || x >= num_tiles_.get_x() || y >= num_tiles_.get_y() || slice >= settings_.num_slices)
+        return -1;
+    return cell_lookup_[get_flag_index(x, y, slice)];
+}
+
+size_t CPULightCuller::get_num_culled_lights() const
+{
+    size_t count = 0;
+    for (const auto& cell: cells_)
+        count += cell.lights.size();
+    return count;
+}
+
+int CPULightCuller::get_slice_from_distance(float dist) const
+{
+    const float flt_dist = dist / settings_.max_distance;
+    return static_cast<int>(std::log(flt_dist * SLICE_EXP_FACTOR + 1.0f) /
+        std::log(1.0f + SLICE_EXP_FACTOR) * settings_.num_slices);
+}
+
+float CPULightCuller::get_distance_from_slice(int slice) const
+{
+    const float flt_dist = slice / static_cast<float>(settings_.num_slices) * std::log(1.0f + SLICE_EXP_FACTOR);
+    const float flt_exp = (std::exp(flt_dist) - 1.0f) / SLICE_EXP_FACTOR;
+    return flt_exp * settings_.max_distance;
+}
+
+int CPULightCuller::get_flag_index(int x, int y, int slice) const
+{
+    return (slice * num_tiles_.get_y() + y) * num_tiles_.get_x() + x;
+}
+
+LVecBase3f CPULightCuller::get_light_position_view(const float* data) const
+{
+    // see light_data.inc.glsl for the layout.
+    return view_mat_z_up_.xform_point(LVecBase3f(data[3], data[4], data[5]));
+}
+
+bool CPULightCuller::get_representative_sphere(const float* data, const LVecBase3f& light_pos_view, Sphere& sphere) const
+{
+    switch (unpack_int(data[0]))
+    {
+    case RPLight::LT_point_light:
+    {
+        sphere.pos = light_pos_view;
+        sphere.radius = data[9] + data[10];
+        return true;
+    }
+
+    case RPLight::LT_spot_light:
+    {
+        const float cone_radius = data[9];
+        const float cone_fov = data[10];
+        const LVecBase3f direction_view = view_mat_z_up_.xform_vec(LVecBase3f(data[11], data[12], data[13])).normalized();
+
+        // Approximate the cone with a sphere
+        const float half_cone_radius = cone_radius * 0.5f;
+        const float hypotenuse = cone_radius / cone_fov;
+        const float opposite_side_sqr = (1.0f - cone_fov * cone_fov) * hypotenuse * hypotenuse;
+        sphere.pos = light_pos_view + direction_view * half_cone_radius;
+        sphere.radius = std::sqrt(opposite_side_sqr + half_cone_radius * half_cone_radius);
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+LVecBase3f CPULightCuller::get_ray_direction(const LVecBase2f& dir, int cell_x, int cell_y) const
+{
+    const LVecBase2f cell_pos(
+        (cell_x + dir[0] * 0.5f + 0.5f) / num_tiles_.get_x(),
+        (cell_y + dir[1] * 0.5f + 0.5f) / num_tiles_.get_y());
+
+    const LVecBase3f bottom = frustum_directions_[0] * (1 - cell_pos[0]) + frustum_directions_[1] * cell_pos[0];
+    const LVecBase3f top = frustum_directions_[2] * (1 - cell_pos[0]) + frustum_directions_[3] * cell_pos[0];
+    return (bottom * (1 - cell_pos[1]) + top * cell_pos[1]).normalized();
+}
+
+void CPULightCuller::collect_frustum_lights(const float* light_data, int max_light_index)
+{
+    // CPU version of view_frustum_cull.frag.glsl
+    const float max_light_dist_sq = settings_.max_distance * settings_.max_distance;
+
+    frustum_lights_.clear();
+    for (int k = 0; k <= max_light_index; ++k)
+    {
+        const float* data = light_data + k * LIGHT_DATA_STRIDE;
+        const int light_type = unpack_int(data[0]);
+        if (light_type < 1)
+            continue;
+
+        const LVecBase3f light_pos_view = get_light_position_view(data);
+
+        FrustumLight light;
+        if (!get_representative_sphere(data, light_pos_view, light.sphere))
+            continue;
+
+        if (light.sphere.pos.length_squared() - light.sphere.radius * light.sphere.radius > max_light_dist_sq)
+            continue;
+
+        light.index = k;
+        light.light_class = classify_light(light_type, unpack_int(data[2]) >= 0);
+
+        // This prevents invalid light culling for very distant small lights (same with GLSL).
+        // It is scaled by the light position, not by the sphere center which is moved for spot lights.
+        light.sphere.radius *= (std::max)(1.0f, light_pos_view.length() / 200.0f);
+
+        frustum_lights_.push_back(light);
+    }
+}
+
+void CPULightCuller::cull_cell(Cell& cell) const
+{
+    // CPU version of cull_lights.frag.glsl and group_lights.frag.glsl
+    const float min_distance = get_distance_from_slice(cell.slice) - CELL_DISTANCE_BIAS;
+    const float max_distance = get_distance_from_slice(cell.slice + 1) + CELL_DISTANCE_BIAS;
+
+    LVecBase3f local_ray_dirs[std::extent<decltype(ray_dirs)>::value];
+    for (size_t k = 0; k < std::extent<decltype(ray_dirs)>::value; ++k)
+        local_ray_dirs[k] = get_ray_direction(ray_dirs[k], cell.x, cell.y);
+
+    std::vector<const FrustumLight*> visible_lights;
+    for (const auto& light: frustum_lights_)
+    {
+        if (static_cast<int>(visible_lights.size()) >= settings_.max_lights_per_cell)
+            break;
+
+        for (const auto& ray_dir: local_ray_dirs)
+        {
+            if (viewspace_ray_sphere_distance_intersection(light.sphere.pos, light.sphere.radius, ray_dir, min_distance, max_distance))
+            {
+                visible_lights.push_back(&light);
+                break;
+            }
+        }
+    }
+
+    cell.lights.clear();
+    cell.lights.reserve(visible_lights.size());
+    cell.class_counts.fill(0);
+    for (int light_class = 0; light_class < LIGHT_CLS_COUNT; ++light_class)
+    {
+        for (const auto* light: visible_lights)
+        {
+            if (light->light_class != light_class)
+                continue;
+            cell.lights.push_back(light->index);
+            ++cell.class_counts[light_class];
+        }
+    }
+}
+
+}
@@ -0,0 +1,164 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "render_pipeline/rpcore/util/dynamic_resolution_controller.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rpcore {
+
+DynamicResolutionController::DynamicResolutionController(): RPObject("DynamicResolutionController")
+{
+    reset();
+}
+
+void DynamicResolutionController::set_target_frame_time(double seconds)
+{
+    target_frame_time_ = (std::max)(seconds, 1e-4);
+}
+
+void DynamicResolutionController::set_scale_range(float min_scale, float max_scale)
+{
+    min_scale_ = (std::max)(min_scale, 0.01f);
+    max_scale_ = (std::max)(max_scale, min_scale_);
+    scale_ = (std::min)((std::max)(scale_, min_scale_), max_scale_);
+}
+
+void DynamicResolutionController::set_scale_step(float step)
+{
+    scale_step_ = (std::max)(step, 0.0f);
+}
+
+void DynamicResolutionController::set_smoothing(double alpha)
+{
+    smoothing_ = (std::min)((std::max)(alpha, 0.001), 1.0);
+}
+
+void DynamicResolutionController::set_increase_threshold(double ratio)
+{
+    increase_threshold_ = ratio;
+}
+
+void DynamicResolutionController::set_increase_delay(int frames)
+{
+    increase_delay_ = (std::max)(frames, 1);
+}
+
+void DynamicResolutionController::set_decrease_delay(int frames)
+{
+    decrease_delay_ = (std::max)(frames, 1);
+}
+
+void DynamicResolutionController::set_cooldown(int frames)
+{
+    cooldown_ = (std::max)(frames, 0);
+    cooldown_left_ = (std::min)(cooldown_left_, cooldown_);
+}
+
+void DynamicResolutionController::set_scale(float scale)
+{
+    scale_ = (std::min)((std::max)(scale, min_scale_), max_scale_);
+    reset();
+}
+
+bool DynamicResolutionController::add_frame_time(double seconds)
+{
+    if (cooldown_left_ > 0)
+    {
+        --cooldown_left_;
+        return false;
+    }
+
+    if (has_average_)
+    {
+        average_ += (seconds - average_) * smoothing_;
+    }
+    else
+    {
+        average_ = seconds;
+        has_average_ = true;
+    }
+
+    float new_scale = scale_;
+    if (seconds > target_frame_time_)
+    {
+        min_frame_time_above_ = frames_above_ == 0 ? seconds : (std::min)(min_frame_time_above_, seconds);
+        if (++frames_above_ >= decrease_delay_)
+        {
+            // pixel count, and so the frame time, goes with the square of the scale
+            new_scale = quantize(scale_ * static_cast<float>(std::sqrt(target_frame_time_ / min_frame_time_above_)));
+            if (new_scale >= scale_)
+                new_scale = scale_ - scale_step_;
+        }
+        frames_below_ = 0;
+    }
+    else
+    {
+        frames_above_ = 0;
+        if (average_ < target_frame_time_ * increase_threshold_)
+        {
+            if (++frames_below_ >= increase_delay_)
+            {
+                new_scale = scale_ + scale_step_;
+                frames_below_ = 0;
+            }
+        }
+        else
+        {
+            frames_below_ = 0;
+        }
+    }
+
+    new_scale = (std::min)((std::max)(new_scale, min_scale_), max_scale_);
+    if (std::abs(new_scale - scale_) < 1e-4f)
+        return false;
+
+    trace("Resolution scale " + std::to_string(scale_) + " -> " + std::to_string(new_scale));
+
+    scale_ = new_scale;
+    cooldown_left_ = cooldown_;
+
+    // the history belongs to the old resolution
+    has_average_ = false;
+    frames_below_ = 0;
+    frames_above_ = 0;
+
+    return true;
+}
+
+void DynamicResolutionController::reset()
+{
+    average_ = 0.0;
+    has_average_ = false;
+    cooldown_left_ = cooldown_;
+    frames_below_ = 0;
+    frames_above_ = 0;
+}
+
+float DynamicResolutionController::quantize(float scale) const
+{
+    if (scale_step_ <= 0.0f)
+        return scale;
+    return std::floor(scale / scale_step_ + 1e-4f) * scale_step_;
+}
+
+}
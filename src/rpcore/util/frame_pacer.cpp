@@ -0,0 +1,344 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "render_pipeline/rpcore/util/frame_pacer.hpp"
+
+#include <cardMaker.h>
+#include <graphicsEngine.h>
+#include <orthographicLens.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace rpcore {
+
+double FramePacer::SystemClock::get_time()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FramePacer::SystemClock::sleep(double seconds)
+{
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+}
+
+void FramePacer::SystemClock::yield()
+{
+    std::this_thread::yield();
+}
+
+// ************************************************************************************************
+
+double FramePacer::ManualClock::get_time()
+{
+    return time_;
+}
+
+void FramePacer::ManualClock::sleep(double seconds)
+{
+    time_ += seconds + oversleep_;
+    ++num_sleeps_;
+}
+
+void FramePacer::ManualClock::yield()
+{
+    time_ += yield_step_;
+    ++num_yields_;
+}
+
+void FramePacer::ManualClock::advance(double seconds)
+{
+    time_ += seconds;
+}
+
+void FramePacer::ManualClock::set_oversleep(double seconds)
+{
+    oversleep_ = seconds;
+}
+
+void FramePacer::ManualClock::set_yield_step(double seconds)
+{
+    yield_step_ = seconds;
+}
+
+// ************************************************************************************************
+
+// frame numbers are drawn as 24 bits of RGB8.
+static constexpr uint32_t FENCE_MARKER_MASK = 0xFFFFFF;
+
+// after the window and the render targets.
+static constexpr int FENCE_BUFFER_SORT = 10000;
+
+FramePacer::ReadbackFence::ReadbackFence(GraphicsOutput* host)
+{
+    FrameBufferProperties buffer_props;
+    buffer_props.set_rgba_bits(8, 8, 8, 8);
+    buffer_props.set_depth_bits(0);
+    buffer_props.set_force_hardware(true);
+
+    WindowProperties window_props;
+    window_props.set_size(1, 1);
+
+    buffer_ = host->get_engine()->make_output(host->get_pipe(), "FramePacerFence", FENCE_BUFFER_SORT,
+        buffer_props, window_props, GraphicsPipe::BF_refuse_window, host->get_gsg(), host);
+    if (!buffer_)
+    {
+        RPObject::global_error("FramePacer", "Failed to create the fence buffer.");
+        return;
+    }
+
+    texture_ = new Texture("FramePacerFence");
+    buffer_->add_render_texture(texture_, GraphicsOutput::RTM_copy_ram, GraphicsOutput::RTP_color);
+
+    // The marker is the color of a card instead of the clear color,
+    // because the scene graph is pipelined with the frame in the threaded pipeline.
+    scene_ = NodePath("FramePacerFence");
+    CardMaker maker("FramePacerFenceCard");
+    maker.set_frame_fullscreen_quad();
+    card_ = scene_.attach_new_node(maker.generate());
+    card_.set_y(1.0f);
+    card_.set_color(0, 0, 0, 1);
+
+    PT(OrthographicLens) lens = new OrthographicLens;
+    lens->set_film_size(2, 2);
+    lens->set_near_far(0.1f, 10.0f);
+    NodePath camera = scene_.attach_new_node(new Camera("FramePacerFenceCamera", lens));
+    buffer_->make_display_region()->set_camera(camera);
+}
+
+FramePacer::ReadbackFence::~ReadbackFence()
+{
+    if (buffer_)
+        buffer_->get_engine()->remove_window(buffer_);
+}
+
+void FramePacer::ReadbackFence::insert(uint64_t frame)
+{
+    // igloop has already rendered this frame, so the marker is drawn with the next frame.
+    last_marker_ = frame + 1;
+
+    const uint32_t value = static_cast<uint32_t>(last_marker_) & FENCE_MARKER_MASK;
+    card_.set_color(
+        ((value >> 16) & 0xFF) / 255.0f,
+        ((value >> 8) & 0xFF) / 255.0f,
+        (value & 0xFF) / 255.0f,
+        1.0f);
+}
+
+bool FramePacer::ReadbackFence::is_completed(uint64_t frame)
+{
+    if (!texture_ || !texture_->has_ram_image() || texture_->get_num_components() < 3 ||
+        texture_->get_component_width() != 1)
+        return false;
+
+    // RAM images are in BGR(A) order.
+    CPTA_uchar image = texture_->get_ram_image();
+    if (image.size() < 3)
+        return false;
+    const uint32_t value = image[0] | (image[1] << 8) | (image[2] << 16);
+
+    // restore the upper bits from the last marker, which is never behind the drawn marker.
+    const uint64_t distance = (static_cast<uint32_t>(last_marker_) - value) & FENCE_MARKER_MASK;
+    if (distance > last_marker_)
+        return false;
+    return last_marker_ - distance >= frame;
+}
+
+// ************************************************************************************************
+
+FramePacer::FrameTimeHistogram::FrameTimeHistogram(double bucket_width, int num_buckets):
+    bucket_width_(bucket_width), buckets_(static_cast<size_t>((std::max)(num_buckets, 1)), 0)
+{
+}
+
+void FramePacer::FrameTimeHistogram::add(double frame_time)
+{
+    const double index = std::floor(frame_time / bucket_width_);
+    const size_t last = buckets_.size() - 1;
+    ++buckets_[index < 0.0 ? 0 : (index >= static_cast<double>(last) ? last : static_cast<size_t>(index))];
+
+    if (num_samples_ == 0)
+    {
+        min_ = frame_time;
+        max_ = frame_time;
+    }
+    else
+    {
+        min_ = (std::min)(min_, frame_time);
+        max_ = (std::max)(max_, frame_time);
+    }
+    sum_ += frame_time;
+    ++num_samples_;
+}
+
+void FramePacer::FrameTimeHistogram::clear()
+{
+    std::fill(buckets_.begin(), buckets_.end(), 0);
+    num_samples_ = 0;
+    min_ = 0.0;
+    max_ = 0.0;
+    sum_ = 0.0;
+}
+
+double FramePacer::FrameTimeHistogram::get_percentile(double percentile) const
+{
+    if (num_samples_ == 0)
+        return 0.0;
+
+    // rank of the sample (1-based) which the percentile refers to
+    const double clamped = (std::min)((std::max)(percentile, 0.0), 100.0);
+    const size_t rank = (std::max)(static_cast<size_t>(std::ceil(clamped / 100.0 * num_samples_)), size_t(1));
+
+    size_t count = 0;
+    for (size_t k = 0, k_end = buckets_.size(); k < k_end; ++k)
+    {
+        count += buckets_[k];
+        if (count >= rank)
+        {
+            // the overflow bucket has no upper edge
+            if (k + 1 == k_end)
+                return max_;
+            return (std::min)((k + 1) * bucket_width_, max_);
+        }
+    }
+
+    return max_;
+}
+
+// ************************************************************************************************
+
+FramePacer::FramePacer(std::unique_ptr<Clock> clock): RPObject("FramePacer"), clock_(std::move(clock))
+{
+    if (!clock_)
+        clock_ = std::make_unique<SystemClock>();
+}
+
+FramePacer::~FramePacer() = default;
+
+void FramePacer::set_target_frame_rate(double fps)
+{
+    target_frame_time_ = fps > 0.0 ? 1.0 / fps : 0.0;
+    has_deadline_ = false;
+}
+
+void FramePacer::set_spin_time(double seconds)
+{
+    spin_time_ = (std::max)(seconds, 0.0);
+}
+
+void FramePacer::set_fence(std::unique_ptr<Fence> fence)
+{
+    fence_ = std::move(fence);
+}
+
+void FramePacer::set_max_frames_in_flight(int count)
+{
+    max_frames_in_flight_ = (std::max)(count, 0);
+}
+
+void FramePacer::set_fence_timeout(double seconds)
+{
+    fence_timeout_ = (std::max)(seconds, 0.0);
+}
+
+void FramePacer::end_frame()
+{
+    const double begin_time = clock_->get_time();
+
+    // wait for the GPU before the cap, because the GPU time is a part of the frame time.
+    if (fence_ && max_frames_in_flight_ > 0)
+    {
+        fence_->insert(frame_);
+        if (frame_ + 1 >= static_cast<uint64_t>(max_frames_in_flight_))
+            wait_for_fence(frame_ + 1 - max_frames_in_flight_);
+    }
+    ++frame_;
+
+    const double fence_time = clock_->get_time();
+    last_fence_wait_time_ = fence_time - begin_time;
+
+    if (target_frame_time_ > 0.0 && has_deadline_)
+        wait_until(deadline_);
+
+    const double now = clock_->get_time();
+    last_wait_time_ = now - fence_time;
+
+    if (has_last_time_)
+    {
+        last_frame_time_ = now - last_time_;
+        histogram_.add(last_frame_time_);
+    }
+    last_time_ = now;
+    has_last_time_ = true;
+
+    if (target_frame_time_ > 0.0)
+    {
+        // keep the cadence, but do not try to catch up with frames which were missed
+        deadline_ = has_deadline_ ? deadline_ + target_frame_time_ : now + target_frame_time_;
+        if (deadline_ <= now)
+            deadline_ = now + target_frame_time_;
+        has_deadline_ = true;
+    }
+}
+
+void FramePacer::reset()
+{
+    has_last_time_ = false;
+    has_deadline_ = false;
+    last_frame_time_ = 0.0;
+    last_wait_time_ = 0.0;
+    last_fence_wait_time_ = 0.0;
+}
+
+void FramePacer::wait_until(double time)
+{
+    while (true)
+    {
+        const double remaining = time - clock_->get_time();
+        if (remaining <= 0.0)
+            break;
+
+        // sleep is coarse, so leave the last part of the interval to spinning
+        if (remaining > spin_time_)
+            clock_->sleep(remaining - spin_time_);
+        else
+            clock_->yield();
+    }
+}
+
+void FramePacer::wait_for_fence(uint64_t frame)
+{
+    // The remaining GPU time is unknown, so poll the fence without sleeping.
+    const double timeout = clock_->get_time() + fence_timeout_;
+    while (!fence_->is_completed(frame))
+    {
+        if (clock_->get_time() >= timeout)
+        {
+            ++num_fence_timeouts_;
+            break;
+        }
+        clock_->yield();
+    }
+}
+
+}
@@ -0,0 +1,414 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "render_pipeline/rpcore/util/light_data_codec.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "render_pipeline/rpcore/native/gpu_command.h"
+#include "render_pipeline/rpcore/native/rp_light.h"
+
+namespace rpcore {
+
+constexpr int LightDataCodec::LIGHT_DATA_STRIDE;
+constexpr int LightDataCodec::COMPACT_LIGHT_WORDS;
+constexpr uint32_t LightDataCodec::DELTA_SLOT_MASK;
+constexpr int LightDataCodec::DELTA_WORDS_SHIFT;
+constexpr uint32_t LightDataCodec::DELTA_ALL_WORDS;
+constexpr uint32_t LightDataCodec::DELTA_REMOVE_BIT;
+
+/** Same with `gpu_cq_unpack_int_from_float` in GLSL. */
+static int unpack_int(float v)
+{
+    if (GPUCommand::get_uses_integer_packing())
+    {
+        int result;
+        std::memcpy(&result, &v, sizeof(result));
+        return result;
+    }
+    else
+    {
+        return static_cast<int>(v);
+    }
+}
+
+/** Same with GPUCommand::push_int. */
+static float pack_int(int v)
+{
+    if (GPUCommand::get_uses_integer_packing())
+    {
+        float result;
+        std::memcpy(&result, &v, sizeof(result));
+        return result;
+    }
+    else
+    {
+        return static_cast<float>(v);
+    }
+}
+
+static uint32_t float_as_uint(float v)
+{
+    uint32_t result;
+    std::memcpy(&result, &v, sizeof(result));
+    return result;
+}
+
+static float uint_as_float(uint32_t v)
+{
+    float result;
+    std::memcpy(&result, &v, sizeof(result));
+    return result;
+}
+
+static float sign_not_zero(float v)
+{
+    return v >= 0.0f ? 1.0f : -1.0f;
+}
+
+static uint32_t encode_snorm16(float v)
+{
+    const float clamped = (std::min)(1.0f, (std::max)(-1.0f, v));
+    return static_cast<uint16_t>(static_cast<int16_t>(std::round(clamped * 32767.0f)));
+}
+
+static float decode_snorm16(uint32_t v)
+{
+    return (std::max)(-1.0f, static_cast<int16_t>(static_cast<uint16_t>(v)) / 32767.0f);
+}
+
+// ************************************************************************************************
+
+LightDataCodec::CompactLight LightDataCodec::encode(const float* record)
+{
+    const int light_type = unpack_int(record[0]);
+    const int ies_profile = unpack_int(record[1]);
+    const int shadow_source = unpack_int(record[2]);
+
+    CompactLight light;
+    light[0] = (static_cast<uint32_t>(light_type) & 0xF) |
+        ((static_cast<uint32_t>(ies_profile + 1) & 0xFFF) << 4) |
+        ((static_cast<uint32_t>(shadow_source + 1) & 0xFFFF) << 16);
+    light[1] = float_as_uint(record[3]);
+    light[2] = float_as_uint(record[4]);
+    light[3] = float_as_uint(record[5]);
+    light[4] = encode_rgb9e5(LVecBase3f(record[6], record[7], record[8]));
+    light[5] = encode_half(record[9]) | (static_cast<uint32_t>(encode_half(record[10])) << 16);
+    if (light_type == RPLight::LT_spot_light)
+        light[6] = encode_octahedral(LVecBase3f(record[11], record[12], record[13]));
+    else if (light_type == RPLight::LT_point_light)
+        light[6] = static_cast<uint32_t>(unpack_int(record[11]));
+    else
+        light[6] = 0;
+
+    return light;
+}
+
+void LightDataCodec::decode(const CompactLight& light, float* record)
+{
+    std::fill(record, record + LIGHT_DATA_STRIDE, 0.0f);
+
+    const int light_type = static_cast<int>(light[0] & 0xF);
+    record[0] = pack_int(light_type);
+    record[1] = pack_int(static_cast<int>((light[0] >> 4) & 0xFFF) - 1);
+    record[2] = pack_int(static_cast<int>((light[0] >> 16) & 0xFFFF) - 1);
+
+    record[3] = uint_as_float(light[1]);
+    record[4] = uint_as_float(light[2]);
+    record[5] = uint_as_float(light[3]);
+
+    const LVecBase3f color = decode_rgb9e5(light[4]);
+    record[6] = color[0];
+    record[7] = color[1];
+    record[8] = color[2];
+
+    record[9] = decode_half(static_cast<uint16_t>(light[5] & 0xFFFF));
+    record[10] = decode_half(static_cast<uint16_t>(light[5] >> 16));
+
+    if (light_type == RPLight::LT_spot_light)
+    {
+        const LVecBase3f dir = decode_octahedral(light[6]);
+        record[11] = dir[0];
+        record[12] = dir[1];
+        record[13] = dir[2];
+    }
+    else if (light_type == RPLight::LT_point_light)
+    {
+        record[11] = pack_int(static_cast<int>(light[6]));
+    }
+}
+
+bool LightDataCodec::apply_delta(const std::vector<uint32_t>& stream, std::vector<CompactLight>& lights, std::vector<bool>& present)
+{
+    for (size_t k = 0, k_end = stream.size(); k < k_end;)
+    {
+        const uint32_t header = stream[k++];
+        const size_t slot = header & DELTA_SLOT_MASK;
+        const uint32_t mask = (header >> DELTA_WORDS_SHIFT) & DELTA_ALL_WORDS;
+
+        if (slot >= lights.size())
+        {
+            lights.resize(slot + 1);
+            present.resize(slot + 1, false);
+        }
+
+        if (header & DELTA_REMOVE_BIT)
+        {
+            if (mask != 0)
+                return false;
+            present[slot] = false;
+            continue;
+        }
+
+        // new light should have all words.
+        if (!present[slot] && mask != DELTA_ALL_WORDS)
+            return false;
+
+        for (int w = 0; w < COMPACT_LIGHT_WORDS; ++w)
+        {
+            if (!(mask & (1u << w)))
+                continue;
+            if (k >= k_end)
+                return false;
+            lights[slot][w] = stream[k++];
+        }
+        present[slot] = true;
+    }
+
+    return true;
+}
+
+uint16_t LightDataCodec::encode_half(float value)
+{
+    const uint32_t bits = float_as_uint(value);
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const int float_exponent = static_cast<int>((bits >> 23) & 0xFF);
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    // infinity and NaN
+    if (float_exponent == 0xFF)
+        return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+
+    const int exponent = float_exponent - 127 + 15;
+    if (exponent >= 31)
+        return static_cast<uint16_t>(sign | 0x7C00);
+
+    // subnormal, rounded to nearest even
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+            return static_cast<uint16_t>(sign);
+
+        mantissa |= 0x800000;
+        const int shift = 14 - exponent;
+        uint32_t half_mantissa = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half_mantissa & 1)))
+            ++half_mantissa;
+        return static_cast<uint16_t>(sign | half_mantissa);
+    }
+
+    // rounded to nearest even. The carry goes to the exponent.
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        ++half;
+    return static_cast<uint16_t>(half);
+}
+
+float LightDataCodec::decode_half(uint16_t value)
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1F;
+    const uint32_t mantissa = value & 0x3FF;
+
+    if (exponent == 0)
+    {
+        const float result = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -result : result;
+    }
+    else if (exponent == 31)
+    {
+        return uint_as_float(sign | 0x7F800000 | (mantissa << 13));
+    }
+    else
+    {
+        return uint_as_float(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    }
+}
+
+uint32_t LightDataCodec::encode_rgb9e5(const LVecBase3f& color)
+{
+    // see EXT_texture_shared_exponent
+    static constexpr int MANTISSA_BITS = 9;
+    static constexpr int EXP_BIAS = 15;
+    static constexpr int MAX_EXP = 31;
+    static const float max_value = static_cast<float>((1 << MANTISSA_BITS) - 1) / (1 << MANTISSA_BITS) *
+        static_cast<float>(1 << (MAX_EXP - EXP_BIAS));
+
+    const float r = (std::min)(max_value, (std::max)(0.0f, color[0]));
+    const float g = (std::min)(max_value, (std::max)(0.0f, color[1]));
+    const float b = (std::min)(max_value, (std::max)(0.0f, color[2]));
+    const float max_c = (std::max)({ r, g, b });
+    if (max_c <= 0.0f)
+        return 0;
+
+    int shared_exp = (std::max)(-EXP_BIAS - 1, static_cast<int>(std::floor(std::log2(max_c)))) + 1 + EXP_BIAS;
+    const int max_s = static_cast<int>(std::floor(max_c / std::ldexp(1.0f, shared_exp - EXP_BIAS - MANTISSA_BITS) + 0.5f));
+    if (max_s == (1 << MANTISSA_BITS))
+        ++shared_exp;
+
+    const float scale = std::ldexp(1.0f, shared_exp - EXP_BIAS - MANTISSA_BITS);
+    const uint32_t rs = static_cast<uint32_t>(std::floor(r / scale + 0.5f));
+    const uint32_t gs = static_cast<uint32_t>(std::floor(g / scale + 0.5f));
+    const uint32_t bs = static_cast<uint32_t>(std::floor(b / scale + 0.5f));
+
+    return rs | (gs << 9) | (bs << 18) | (static_cast<uint32_t>(shared_exp) << 27);
+}
+
+LVecBase3f LightDataCodec::decode_rgb9e5(uint32_t packed)
+{
+    const int shared_exp = static_cast<int>(packed >> 27);
+    const float scale = std::ldexp(1.0f, shared_exp - 15 - 9);
+    return LVecBase3f(
+        (packed & 0x1FF) * scale,
+        ((packed >> 9) & 0x1FF) * scale,
+        ((packed >> 18) & 0x1FF) * scale);
+}
+
+uint32_t LightDataCodec::encode_octahedral(const LVecBase3f& dir)
+{
+    const float l1_norm = std::abs(dir[0]) + std::abs(dir[1]) + std::abs(dir[2]);
+    if (l1_norm <= 0.0f)
+        return encode_snorm16(0.0f) | (encode_snorm16(0.0f) << 16);
+
+    float x = dir[0] / l1_norm;
+    float y = dir[1] / l1_norm;
+    if (dir[2] < 0.0f)
+    {
+        const float folded_x = (1.0f - std::abs(y)) * sign_not_zero(x);
+        const float folded_y = (1.0f - std::abs(x)) * sign_not_zero(y);
+        x = folded_x;
+        y = folded_y;
+    }
+
+    return encode_snorm16(x) | (encode_snorm16(y) << 16);
+}
+
+LVecBase3f LightDataCodec::decode_octahedral(uint32_t packed)
+{
+    float x = decode_snorm16(packed & 0xFFFF);
+    float y = decode_snorm16(packed >> 16);
+    const float z = 1.0f - std::abs(x) - std::abs(y);
+    if (z < 0.0f)
+    {
+        const float unfolded_x = (1.0f - std::abs(y)) * sign_not_zero(x);
+        const float unfolded_y = (1.0f - std::abs(x)) * sign_not_zero(y);
+        x = unfolded_x;
+        y = unfolded_y;
+    }
+
+    return LVecBase3f(x, y, z).normalized();
+}
+
+// ************************************************************************************************
+
+void LightDataCodec::DeltaEncoder::update(int slot, const float* record)
+{
+    add_entry(slot, encode(record));
+}
+
+void LightDataCodec::DeltaEncoder::remove(int slot)
+{
+    if (slot < 0 || static_cast<size_t>(slot) >= present_.size() || !present_[slot])
+        return;
+
+    stream_.push_back(static_cast<uint32_t>(slot) | DELTA_REMOVE_BIT);
+    present_[slot] = false;
+    ++num_entries_;
+}
+
+void LightDataCodec::DeltaEncoder::update_all(const std::vector<float>& light_data)
+{
+    const size_t count = light_data.size() / LIGHT_DATA_STRIDE;
+    for (size_t slot = 0; slot < count; ++slot)
+    {
+        const float* record = light_data.data() + slot * LIGHT_DATA_STRIDE;
+        if (unpack_int(record[0]) == RPLight::LT_empty)
+            remove(static_cast<int>(slot));
+        else
+            update(static_cast<int>(slot), record);
+    }
+
+    for (size_t slot = count; slot < present_.size(); ++slot)
+        remove(static_cast<int>(slot));
+}
+
+void LightDataCodec::DeltaEncoder::reset()
+{
+    lights_.clear();
+    present_.clear();
+    clear_stream();
+}
+
+void LightDataCodec::DeltaEncoder::add_entry(int slot, const CompactLight& light)
+{
+    if (slot < 0 || static_cast<uint32_t>(slot) > DELTA_SLOT_MASK)
+        return;
+
+    if (static_cast<size_t>(slot) >= lights_.size())
+    {
+        lights_.resize(slot + 1);
+        present_.resize(slot + 1, false);
+    }
+
+    uint32_t mask = 0;
+    if (present_[slot])
+    {
+        for (int w = 0; w < COMPACT_LIGHT_WORDS; ++w)
+        {
+            if (lights_[slot][w] != light[w])
+                mask |= 1u << w;
+        }
+        if (mask == 0)
+            return;
+    }
+    else
+    {
+        mask = DELTA_ALL_WORDS;
+    }
+
+    stream_.push_back(static_cast<uint32_t>(slot) | (mask << DELTA_WORDS_SHIFT));
+    for (int w = 0; w < COMPACT_LIGHT_WORDS; ++w)
+    {
+        if (mask & (1u << w))
+            stream_.push_back(light[w]);
+    }
+
+    lights_[slot] = light;
+    present_[slot] = true;
+    ++num_entries_;
+}
+
+}
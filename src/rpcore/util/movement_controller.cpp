@@ -22,6 +22,8 @@
 
 #include "render_pipeline/rpcore/util/movement_controller.hpp"
 
+#include <algorithm>
+
 #include <fmt/format.h>
 
 #include <parametricCurveCollection.h>
@@ -31,13 +33,22 @@
 #include <graphicsWindow.h>
 #include <curveFitter.h>
 #include <mouseButton.h>
+#include <clockObject.h>
+#include <datagram.h>
+#include <datagramIterator.h>
+#include <virtualFileSystem.h>
 
+#include "render_pipeline/rpcore/rpobject.hpp"
 #include "render_pipeline/rppanda/showbase/showbase.hpp"
+#include "render_pipeline/rppanda/stdpy/file.hpp"
 #include "render_pipeline/rppanda/task/task_manager.hpp"
 #include "render_pipeline/rplibs/py_to_cpp.hpp"
 
 namespace rpcore {
 
+static constexpr uint32_t RECORDED_PATH_MAGIC = 0x50435052;        // "RPCP"
+static constexpr uint16_t RECORDED_PATH_VERSION = 1;
+
 class MovementController::Impl
 {
 public:
@@ -48,6 +59,12 @@ public:
 
     AsyncTask::DoneStatus camera_motion_update(MovementController* self);
 
+    AsyncTask::DoneStatus record_update(MovementController* self);
+    AsyncTask::DoneStatus recorded_path_update(MovementController* self);
+
+    void add_update_task(MovementController* self);
+    void finish_recorded_path(MovementController* self);
+
 public:
     rppanda::ShowBase* showbase_;
 
@@ -75,6 +92,20 @@ public:
     double curve_time_end_;
     double delta_time_sum_ = 0;
     double delta_time_count_;
+
+    PT(AsyncTask) record_task_;
+    double record_time_start_ = 0;
+    RecordedPathType recorded_path_;
+
+    PT(AsyncTask) playback_task_;
+    RecordedPathType playback_path_;
+    double playback_timestep_ = 0;
+    double playback_time_start_ = 0;
+    size_t playback_frame_ = 0;
+    ClockObject::Mode playback_clock_mode_ = ClockObject::M_normal;
+    double playback_clock_frame_rate_ = 0;
+    double playback_last_real_time_ = 0;
+    std::vector<double> playback_frame_times_;
 };
 
 AsyncTask::DoneStatus MovementController::Impl::update(MovementController* self)
@@ -164,9 +195,7 @@ AsyncTask::DoneStatus MovementController::Impl::camera_motion_update(MovementCon
         std::cout << fmt::format("Average frame time (ms): {:4.1f}", avg_ms * 1000.0) << std::endl;
         std::cout << fmt::format("Average frame rate: {:4.1f}", 1.0 / avg_ms) << std::endl;
 
-        update_task_ = showbase_->add_task([this, self](rppanda::FunctionalTask* task) {
-            return update(self);
-        }, "RP_UpdateMovementController", -50);
+        add_update_task(self);
         showbase_->get_render_2d().show();
         showbase_->get_aspect_2d().show();
 
@@ -189,6 +218,103 @@ AsyncTask::DoneStatus MovementController::Impl::camera_motion_update(MovementCon
     return AsyncTask::DS_cont;
 }
 
+AsyncTask::DoneStatus MovementController::Impl::record_update(MovementController* self)
+{
+    const NodePath& camera = showbase_->get_camera();
+
+    RecordedFrame frame;
+    frame.time = static_cast<float>(self->get_clock_obj()->get_frame_time() - record_time_start_);
+    frame.pos = LCAST(float, camera.get_pos());
+    frame.hpr = LCAST(float, camera.get_hpr());
+    recorded_path_.push_back(frame);
+
+    return AsyncTask::DS_cont;
+}
+
+AsyncTask::DoneStatus MovementController::Impl::recorded_path_update(MovementController* self)
+{
+    ClockObject* clock = self->get_clock_obj();
+
+    // fixed timestep uses frame count to be independent of the clock precision.
+    const double time = playback_timestep_ > 0
+        ? playback_frame_ * playback_timestep_
+        : clock->get_frame_time() - playback_time_start_;
+
+    if (playback_frame_ > 0)
+    {
+        const double real_time = clock->get_real_time();
+        playback_frame_times_.push_back(real_time - playback_last_real_time_);
+        playback_last_real_time_ = real_time;
+    }
+    else
+    {
+        playback_last_real_time_ = clock->get_real_time();
+    }
+
+    if (time > playback_path_.back().time)
+    {
+        finish_recorded_path(self);
+        return AsyncTask::DS_done;
+    }
+
+    LPoint3f pos;
+    LQuaternionf quat;
+    sample_recorded_path(playback_path_, static_cast<float>(time), pos, quat);
+    showbase_->get_camera().set_pos_quat(
+        LPoint3(pos[0], pos[1], pos[2]),
+        LQuaternion(quat[0], quat[1], quat[2], quat[3]));
+
+    ++playback_frame_;
+
+    return AsyncTask::DS_cont;
+}
+
+void MovementController::Impl::add_update_task(MovementController* self)
+{
+    update_task_ = showbase_->add_task([this, self](rppanda::FunctionalTask* task) {
+        return update(self);
+    }, "RP_UpdateMovementController", -50);
+}
+
+void MovementController::Impl::finish_recorded_path(MovementController* self)
+{
+    std::cout << "Recorded camera path finished" << std::endl;
+
+    // Print performance stats
+    if (!playback_frame_times_.empty())
+    {
+        std::vector<double> sorted_times = playback_frame_times_;
+        std::sort(sorted_times.begin(), sorted_times.end());
+
+        double sum = 0;
+        for (double t: sorted_times)
+            sum += t;
+        const double avg_ms = sum / sorted_times.size() * 1000.0;
+        const double p99_ms = sorted_times[(std::min)(sorted_times.size() - 1, sorted_times.size() * 99 / 100)] * 1000.0;
+
+        std::cout << fmt::format("Frames: {}", sorted_times.size()) << std::endl;
+        std::cout << fmt::format("Average frame time (ms): {:4.1f}", avg_ms) << std::endl;
+        std::cout << fmt::format("Min / Max frame time (ms): {:4.1f} / {:4.1f}", sorted_times.front() * 1000.0, sorted_times.back() * 1000.0) << std::endl;
+        std::cout << fmt::format("99th percentile frame time (ms): {:4.1f}", p99_ms) << std::endl;
+        std::cout << fmt::format("Average frame rate: {:4.1f}", 1000.0 / avg_ms) << std::endl;
+    }
+
+    if (playback_timestep_ > 0)
+    {
+        ClockObject* clock = self->get_clock_obj();
+        clock->set_mode(playback_clock_mode_);
+        clock->set_frame_rate(playback_clock_frame_rate_);
+    }
+
+    playback_task_.clear();
+    playback_path_.clear();
+    playback_frame_times_.clear();
+
+    add_update_task(self);
+    showbase_->get_render_2d().show();
+    showbase_->get_aspect_2d().show();
+}
+
 MovementController::Impl::Impl(rppanda::ShowBase* showbase): showbase_(showbase)
 {
 }
@@ -202,6 +328,10 @@ MovementController::~MovementController()
 {
     if (impl_->update_task_)
         impl_->update_task_->remove();
+    if (impl_->record_task_)
+        impl_->record_task_->remove();
+    if (impl_->playback_task_)
+        impl_->playback_task_->remove();
 }
 
 void MovementController::reset_to_initial()
@@ -251,6 +381,19 @@ void MovementController::setup()
     showbase->accept(KeyboardButton::f11().get_name(), [this](const Event*) { impl_->showbase_->get_win()->save_screenshot("screenshot.png"); });
     showbase->accept("j", [this](const Event*) { print_position(); });
 
+    // camera path recording
+    showbase->accept(KeyboardButton::f9().get_name(), [this](const Event*) {
+        if (is_recording())
+        {
+            stop_recording();
+            save_recorded_path("camera_path.rpcp", get_recorded_path());
+        }
+        else
+        {
+            start_recording();
+        }
+    });
+
     // mouse
     showbase->accept(MouseButton::one().get_name(), [this](const Event*) { set_mouse_enabled(true); });
     showbase->accept(MouseButton::one().get_name() + "-up", [this](const Event*) { set_mouse_enabled(false); });
@@ -277,9 +420,7 @@ void MovementController::setup()
     showbase->disable_mouse();
 
     // add ourself as an update task which gets executed very early before the rendering
-    impl_->update_task_ = showbase->add_task([this](rppanda::FunctionalTask* task) {
-        return impl_->update(this);
-    }, "RP_UpdateMovementController", -50);
+    impl_->add_update_task(this);
 
     // Hotkeys to connect to pstats and reset the initial position
     showbase->accept("1", [](const Event*) { PStatClient::connect(); });
@@ -314,8 +455,207 @@ void MovementController::play_motion_path(const MotionPathType& points, float po
     impl_->showbase_->add_task([this](rppanda::FunctionalTask* task) {
         return impl_->camera_motion_update(this);
     }, "RP_CameraMotionPath", -50);
-    impl_->update_task_->remove();
-    impl_->update_task_.clear();
+    if (impl_->update_task_)
+    {
+        impl_->update_task_->remove();
+        impl_->update_task_.clear();
+    }
+}
+
+void MovementController::start_recording()
+{
+    if (impl_->record_task_)
+        return;
+
+    impl_->recorded_path_.clear();
+    impl_->record_time_start_ = get_clock_obj()->get_frame_time();
+
+    // record after all tasks moving the camera, just before rendering
+    impl_->record_task_ = impl_->showbase_->add_task([this](rppanda::FunctionalTask* task) {
+        return impl_->record_update(this);
+    }, "RP_CameraPathRecord", 45);
+}
+
+void MovementController::stop_recording()
+{
+    if (!impl_->record_task_)
+        return;
+
+    impl_->record_task_->remove();
+    impl_->record_task_.clear();
+    std::cout << "Recorded " << impl_->recorded_path_.size() << " camera frames" << std::endl;
+}
+
+bool MovementController::is_recording() const
+{
+    return impl_->record_task_ != nullptr;
+}
+
+auto MovementController::get_recorded_path() const -> const RecordedPathType&
+{
+    return impl_->recorded_path_;
+}
+
+void MovementController::play_recorded_path(const RecordedPathType& path, double fixed_timestep)
+{
+    if (path.empty())
+    {
+        RPObject::global_error("MovementController", "Recorded camera path is empty.");
+        return;
+    }
+
+    if (impl_->playback_task_)
+        stop_recorded_path();
+
+    std::cout << "Starting recorded camera path with " << path.size() << " frames" << std::endl;
+
+    impl_->showbase_->get_render_2d().hide();
+    impl_->showbase_->get_aspect_2d().hide();
+
+    ClockObject* clock = get_clock_obj();
+    impl_->playback_path_ = path;
+    impl_->playback_timestep_ = fixed_timestep;
+    impl_->playback_time_start_ = clock->get_frame_time();
+    impl_->playback_frame_ = 0;
+    impl_->playback_frame_times_.clear();
+    impl_->playback_frame_times_.reserve(path.size());
+
+    if (fixed_timestep > 0)
+    {
+        impl_->playback_clock_mode_ = clock->get_mode();
+        impl_->playback_clock_frame_rate_ = clock->get_frame_rate();
+        clock->set_mode(ClockObject::M_non_real_time);
+        clock->set_frame_rate(1.0 / fixed_timestep);
+    }
+
+    impl_->playback_task_ = impl_->showbase_->add_task([this](rppanda::FunctionalTask* task) {
+        return impl_->recorded_path_update(this);
+    }, "RP_CameraPathPlayback", -50);
+
+    if (impl_->update_task_)
+    {
+        impl_->update_task_->remove();
+        impl_->update_task_.clear();
+    }
+}
+
+void MovementController::stop_recorded_path()
+{
+    if (!impl_->playback_task_)
+        return;
+
+    impl_->playback_task_->remove();
+    impl_->finish_recorded_path(this);
+}
+
+bool MovementController::is_playing_recorded_path() const
+{
+    return impl_->playback_task_ != nullptr;
+}
+
+bool MovementController::save_recorded_path(const Filename& path, const RecordedPathType& frames)
+{
+    Datagram dg;
+    dg.add_uint32(RECORDED_PATH_MAGIC);
+    dg.add_uint16(RECORDED_PATH_VERSION);
+    dg.add_uint32(static_cast<uint32_t>(frames.size()));
+    for (const auto& frame: frames)
+    {
+        dg.add_float32(frame.time);
+        for (int k = 0; k < 3; ++k)
+            dg.add_float32(frame.pos[k]);
+        for (int k = 0; k < 3; ++k)
+            dg.add_float32(frame.hpr[k]);
+    }
+
+    try
+    {
+        auto file = rppanda::open_write_file(Filename::binary_filename(path), false, true);
+        if (!file || !(*file))
+        {
+            RPObject::global_error("MovementController", "Failed to open " + path.to_os_generic() + " to write.");
+            return false;
+        }
+        file->write(reinterpret_cast<const char*>(dg.get_data()), dg.get_length());
+        return bool(*file);
+    }
+    catch (const std::exception& err)
+    {
+        RPObject::global_error("MovementController", std::string("Failed to write camera path: ") + err.what());
+        return false;
+    }
+}
+
+bool MovementController::load_recorded_path(const Filename& path, RecordedPathType& frames)
+{
+    std::string data;
+    if (!VirtualFileSystem::get_global_ptr()->read_file(Filename::binary_filename(path), data, true))
+    {
+        RPObject::global_error("MovementController", "Failed to read " + path.to_os_generic());
+        return false;
+    }
+
+    const size_t header_size = 4 + 2 + 4;
+    const size_t frame_size = 7 * 4;
+
+    Datagram dg(data);
+    DatagramIterator dgi(dg);
+    if (data.size() < header_size || dgi.get_uint32() != RECORDED_PATH_MAGIC || dgi.get_uint16() != RECORDED_PATH_VERSION)
+    {
+        RPObject::global_error("MovementController", path.to_os_generic() + " is not a camera path file.");
+        return false;
+    }
+
+    const size_t count = dgi.get_uint32();
+    if (dgi.get_remaining_size() != count * frame_size)
+    {
+        RPObject::global_error("MovementController", path.to_os_generic() + " is truncated.");
+        return false;
+    }
+
+    frames.resize(count);
+    for (auto& frame: frames)
+    {
+        frame.time = dgi.get_float32();
+        for (int k = 0; k < 3; ++k)
+            frame.pos[k] = dgi.get_float32();
+        for (int k = 0; k < 3; ++k)
+            frame.hpr[k] = dgi.get_float32();
+    }
+
+    return true;
+}
+
+void MovementController::sample_recorded_path(const RecordedPathType& frames, float time, LPoint3f& pos, LQuaternionf& quat)
+{
+    const auto upper = std::upper_bound(frames.begin(), frames.end(), time,
+        [](float t, const RecordedFrame& frame) { return t < frame.time; });
+
+    if (upper == frames.begin() || upper == frames.end())
+    {
+        const RecordedFrame& frame = upper == frames.begin() ? frames.front() : frames.back();
+        pos = frame.pos;
+        quat.set_hpr(frame.hpr);
+        return;
+    }
+
+    const RecordedFrame& prev = *(upper - 1);
+    const RecordedFrame& next = *upper;
+
+    const float duration = next.time - prev.time;
+    const float alpha = duration > 0 ? (time - prev.time) / duration : 1.0f;
+
+    pos = prev.pos + (next.pos - prev.pos) * alpha;
+
+    // normalized lerp on the shortest arc
+    LQuaternionf prev_quat;
+    LQuaternionf next_quat;
+    prev_quat.set_hpr(prev.hpr);
+    next_quat.set_hpr(next.hpr);
+    const LVecBase4f next_vec = prev_quat.dot(next_quat) < 0 ? -LVecBase4f(next_quat) : LVecBase4f(next_quat);
+    const LVecBase4f result = LVecBase4f(prev_quat) * (1.0f - alpha) + next_vec * alpha;
+    quat.set(result[0], result[1], result[2], result[3]);
+    quat.normalize();
 }
 
 void MovementController::set_initial_position(const LVecBase3& pos, const LVecBase3& target)
@@ -0,0 +1,442 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "render_pipeline/rpcore/util/occlusion_culler.hpp"
+
+#include <lens.h>
+#include <nodePathCollection.h>
+#include <geomNode.h>
+#include <geomPrimitive.h>
+#include <geomVertexReader.h>
+#include <boundingBox.h>
+#include <boundingSphere.h>
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+namespace rpcore {
+
+static constexpr float NEAR_W_EPSILON = 1e-5f;
+
+void OcclusionCuller::DepthPyramid::build(const float* depth, int width, int height)
+{
+    sizes_.clear();
+    levels_.clear();
+    if (width <= 0 || height <= 0)
+        return;
+
+    sizes_.push_back(LVecBase2i(width, height));
+    levels_.emplace_back(depth, depth + width * height);
+
+    // each level keeps the farthest depth of 2x2 texels. ceil of odd sizes keeps the last row and column.
+    while (width > 1 || height > 1)
+    {
+        const int next_width = (std::max)(1, (width + 1) / 2);
+        const int next_height = (std::max)(1, (height + 1) / 2);
+
+        const std::vector<float>& src = levels_.back();
+        std::vector<float> dst(next_width * next_height);
+        for (int y = 0; y < next_height; ++y)
+        {
+            const int y0 = (std::min)(y * 2, height - 1);
+            const int y1 = (std::min)(y * 2 + 1, height - 1);
+            for (int x = 0; x < next_width; ++x)
+            {
+                const int x0 = (std::min)(x * 2, width - 1);
+                const int x1 = (std::min)(x * 2 + 1, width - 1);
+                dst[y * next_width + x] = (std::max)(
+                    (std::max)(src[y0 * width + x0], src[y0 * width + x1]),
+                    (std::max)(src[y1 * width + x0], src[y1 * width + x1]));
+            }
+        }
+
+        width = next_width;
+        height = next_height;
+        sizes_.push_back(LVecBase2i(width, height));
+        levels_.push_back(std::move(dst));
+    }
+}
+
+float OcclusionCuller::DepthPyramid::get_max_depth(float x0, float y0, float x1, float y1) const
+{
+    if (levels_.empty())
+        return 1.0f;
+
+    const float extent = (std::max)(1.0f, (std::max)(x1 - x0, y1 - y0));
+    const int level = (std::min)(get_num_levels() - 1, static_cast<int>(std::ceil(std::log2(extent))));
+
+    const LVecBase2i& size = sizes_[level];
+    const float scale = 1.0f / static_cast<float>(1 << level);
+    const int tx0 = (std::max)(0, static_cast<int>(std::floor(x0 * scale)));
+    const int ty0 = (std::max)(0, static_cast<int>(std::floor(y0 * scale)));
+    const int tx1 = (std::min)(size[0] - 1, static_cast<int>(std::floor(x1 * scale)));
+    const int ty1 = (std::min)(size[1] - 1, static_cast<int>(std::floor(y1 * scale)));
+
+    float max_depth = 0.0f;
+    for (int y = ty0; y <= ty1; ++y)
+        for (int x = tx0; x <= tx1; ++x)
+            max_depth = (std::max)(max_depth, get_depth(level, x, y));
+    return max_depth;
+}
+
+// ************************************************************************************************
+
+void OcclusionCuller::SoftwareRasterizer::clear(int width, int height)
+{
+    width_ = width;
+    height_ = height;
+    depth_.assign(width * height, 1.0f);
+}
+
+void OcclusionCuller::SoftwareRasterizer::rasterize(const LMatrix4f& mvp, const std::vector<LPoint3f>& vertices, const std::vector<int>& indices)
+{
+    std::vector<LVecBase3f> screen(vertices.size());
+    std::vector<bool> valid(vertices.size());
+    for (size_t k = 0, k_end = vertices.size(); k < k_end; ++k)
+    {
+        const LVecBase4f clip = mvp.xform(LVecBase4f(vertices[k], 1.0f));
+        valid[k] = clip[3] > NEAR_W_EPSILON && clip[2] >= -clip[3];
+        if (!valid[k])
+            continue;
+
+        const float inv_w = 1.0f / clip[3];
+        screen[k] = LVecBase3f(
+            (clip[0] * inv_w * 0.5f + 0.5f) * width_,
+            (clip[1] * inv_w * 0.5f + 0.5f) * height_,
+            clip[2] * inv_w * 0.5f + 0.5f);
+    }
+
+    for (size_t k = 0, k_end = indices.size() / 3 * 3; k < k_end; k += 3)
+    {
+        const int i0 = indices[k];
+        const int i1 = indices[k + 1];
+        const int i2 = indices[k + 2];
+        if (!valid[i0] || !valid[i1] || !valid[i2])
+            continue;
+
+        const LVecBase3f& v0 = screen[i0];
+        const LVecBase3f& v1 = screen[i1];
+        const LVecBase3f& v2 = screen[i2];
+
+        const float area = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v1[1] - v0[1]) * (v2[0] - v0[0]);
+        if (std::abs(area) < 1e-8f)
+            continue;
+        const float inv_area = 1.0f / area;
+
+        const int min_x = (std::max)(0, static_cast<int>(std::floor((std::min)({ v0[0], v1[0], v2[0] }))));
+        const int min_y = (std::max)(0, static_cast<int>(std::floor((std::min)({ v0[1], v1[1], v2[1] }))));
+        const int max_x = (std::min)(width_ - 1, static_cast<int>(std::ceil((std::max)({ v0[0], v1[0], v2[0] }))));
+        const int max_y = (std::min)(height_ - 1, static_cast<int>(std::ceil((std::max)({ v0[1], v1[1], v2[1] }))));
+
+        for (int y = min_y; y <= max_y; ++y)
+        {
+            const float py = y + 0.5f;
+            for (int x = min_x; x <= max_x; ++x)
+            {
+                const float px = x + 0.5f;
+
+                // barycentric coordinates, normalized by the signed area for both windings.
+                const float w0 = ((v1[0] - px) * (v2[1] - py) - (v1[1] - py) * (v2[0] - px)) * inv_area;
+                const float w1 = ((v2[0] - px) * (v0[1] - py) - (v2[1] - py) * (v0[0] - px)) * inv_area;
+                const float w2 = 1.0f - w0 - w1;
+                if (w0 < 0 || w1 < 0 || w2 < 0)
+                    continue;
+
+                // z / w is linear in screen space.
+                const float z = w0 * v0[2] + w1 * v1[2] + w2 * v2[2];
+                if (z > 1.0f)
+                    continue;
+
+                float& dst = depth_[y * width_ + x];
+                dst = (std::min)(dst, z);
+            }
+        }
+    }
+}
+
+// ************************************************************************************************
+
+OcclusionCuller::OcclusionCuller(): RPObject("OcclusionCuller")
+{
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+    show_all();
+}
+
+void OcclusionCuller::set_resolution(int width, int height)
+{
+    resolution_ = LVecBase2i((std::max)(1, width), (std::max)(1, height));
+}
+
+void OcclusionCuller::add_occluder(NodePath np)
+{
+    if (np.is_empty())
+        return;
+
+    Occluder occluder;
+    occluder.np = np;
+
+    NodePathCollection geom_nps = np.find_all_matches("**/+GeomNode");
+    if (np.node()->is_geom_node())
+        geom_nps.add_path(np);
+
+    for (int i = 0, i_end = geom_nps.get_num_paths(); i < i_end; ++i)
+    {
+        const NodePath& geom_np = geom_nps.get_path(i);
+        const GeomNode* geom_node = DCAST(GeomNode, geom_np.node());
+        const LMatrix4f mat = LCAST(float, geom_np.get_transform(np)->get_mat());
+
+        for (int g = 0, g_end = geom_node->get_num_geoms(); g < g_end; ++g)
+        {
+            CPT(Geom) geom = geom_node->get_geom(g)->decompose();
+            CPT(GeomVertexData) vdata = geom->get_vertex_data();
+            if (!vdata->has_column(InternalName::get_vertex()))
+                continue;
+
+            const int base = static_cast<int>(occluder.vertices.size());
+            GeomVertexReader reader(vdata, InternalName::get_vertex());
+            while (!reader.is_at_end())
+                occluder.vertices.push_back(mat.xform_point(reader.get_data3f()));
+
+            for (int p = 0, p_end = geom->get_num_primitives(); p < p_end; ++p)
+            {
+                const GeomPrimitive* prim = geom->get_primitive(p);
+                if (prim->get_num_vertices_per_primitive() != 3)
+                    continue;
+
+                for (int v = 0, v_end = prim->get_num_vertices(); v < v_end; ++v)
+                    occluder.indices.push_back(base + prim->get_vertex(v));
+            }
+        }
+    }
+
+    if (occluder.indices.empty())
+    {
+        warn("Occluder (" + np.get_name() + ") has no triangles.");
+        return;
+    }
+
+    debug("Added occluder (" + np.get_name() + ") with " + std::to_string(occluder.indices.size() / 3) + " triangles.");
+    occluders_.push_back(std::move(occluder));
+}
+
+void OcclusionCuller::remove_occluder(NodePath np)
+{
+    occluders_.erase(std::remove_if(occluders_.begin(), occluders_.end(),
+        [&](const Occluder& occluder) { return occluder.np == np; }), occluders_.end());
+}
+
+void OcclusionCuller::add_occludee(NodePath np)
+{
+    if (np.is_empty())
+        return;
+
+    Occludee occludee;
+    occludee.np = np;
+    occludee.has_bounds = false;
+    occludees_.push_back(occludee);
+}
+
+void OcclusionCuller::remove_occludee(NodePath np)
+{
+    auto iter = std::find_if(occludees_.begin(), occludees_.end(), [&](const Occludee& occludee) { return occludee.np == np; });
+    if (iter == occludees_.end())
+        return;
+
+    if (!iter->hidden.is_zero())
+        iter->np.show(iter->hidden);
+    occludees_.erase(iter);
+}
+
+void OcclusionCuller::render_occluders(const LMatrix4f& view_proj)
+{
+    view_proj_ = view_proj;
+    rasterizer_.clear(resolution_[0], resolution_[1]);
+    for (const auto& occluder: occluders_)
+    {
+        if (occluder.np.is_empty() || occluder.np.is_hidden())
+            continue;
+
+        const LMatrix4f mvp = LCAST(float, occluder.np.get_net_transform()->get_mat()) * view_proj;
+        rasterizer_.rasterize(mvp, occluder.vertices, occluder.indices);
+    }
+    pyramid_.build(rasterizer_.get_depth().data(), rasterizer_.get_width(), rasterizer_.get_height());
+}
+
+void OcclusionCuller::set_depth_buffer(const float* depth, int width, int height, const LMatrix4f& view_proj)
+{
+    view_proj_ = view_proj;
+    pyramid_.build(depth, width, height);
+}
+
+bool OcclusionCuller::is_occluded(const LPoint3f& bmin, const LPoint3f& bmax) const
+{
+    if (pyramid_.get_num_levels() == 0)
+        return false;
+
+    const LVecBase2i& size = pyramid_.get_size(0);
+
+    float min_x = FLT_MAX;
+    float min_y = FLT_MAX;
+    float max_x = -FLT_MAX;
+    float max_y = -FLT_MAX;
+    float min_z = FLT_MAX;
+    for (int k = 0; k < 8; ++k)
+    {
+        const LVecBase4f corner(
+            (k & 1) ? bmax[0] : bmin[0],
+            (k & 2) ? bmax[1] : bmin[1],
+            (k & 4) ? bmax[2] : bmin[2],
+            1.0f);
+        const LVecBase4f clip = view_proj_.xform(corner);
+
+        // the box intersects the near plane.
+        if (clip[3] <= NEAR_W_EPSILON || clip[2] < -clip[3])
+            return false;
+
+        const float inv_w = 1.0f / clip[3];
+        const float x = (clip[0] * inv_w * 0.5f + 0.5f) * size[0];
+        const float y = (clip[1] * inv_w * 0.5f + 0.5f) * size[1];
+        min_x = (std::min)(min_x, x);
+        min_y = (std::min)(min_y, y);
+        max_x = (std::max)(max_x, x);
+        max_y = (std::max)(max_y, y);
+        min_z = (std::min)(min_z, clip[2] * inv_w * 0.5f + 0.5f);
+    }
+
+    // frustum culling is done by Panda3D. Do not touch the nodes outside of the view.
+    if (max_x < 0 || max_y < 0 || min_x > size[0] || min_y > size[1])
+        return false;
+
+    min_x = (std::max)(0.0f, min_x);
+    min_y = (std::max)(0.0f, min_y);
+    max_x = (std::min)(static_cast<float>(size[0] - 1), max_x);
+    max_y = (std::min)(static_cast<float>(size[1] - 1), max_y);
+
+    return min_z > pyramid_.get_max_depth(min_x, min_y, max_x, max_y);
+}
+
+void OcclusionCuller::begin_cull()
+{
+    tested_masks_.clear();
+    for (auto& occludee: occludees_)
+    {
+        occludee.visible.clear();
+        occludee.has_bounds = !occludee.np.is_empty() && compute_world_bounds(occludee.np, occludee.world_min, occludee.world_max);
+    }
+}
+
+void OcclusionCuller::test_view(const BitMask32& mask)
+{
+    tested_masks_ |= mask;
+    for (auto& occludee: occludees_)
+    {
+        if (!occludee.has_bounds || !is_occluded(occludee.world_min, occludee.world_max))
+            occludee.visible |= mask;
+    }
+}
+
+void OcclusionCuller::end_cull()
+{
+    num_occluded_ = 0;
+    for (auto& occludee: occludees_)
+    {
+        if (occludee.np.is_empty())
+            continue;
+
+        const BitMask32 occluded = tested_masks_ & ~occludee.visible;
+
+        // only show the masks which are hidden by this culler.
+        const BitMask32 to_show = occludee.hidden & ~occluded;
+        const BitMask32 to_hide = occluded & ~occludee.hidden;
+        if (!to_show.is_zero())
+            occludee.np.show(to_show);
+        if (!to_hide.is_zero())
+            occludee.np.hide(to_hide);
+
+        occludee.hidden = (occludee.hidden & ~tested_masks_) | occluded;
+        if (!occluded.is_zero())
+            ++num_occluded_;
+    }
+}
+
+void OcclusionCuller::cull_camera(const NodePath& camera, const Lens* lens, const BitMask32& mask)
+{
+    const LMatrix4f view_proj = LCAST(float, camera.get_net_transform()->get_inverse()->get_mat()) *
+        LCAST(float, lens->get_projection_mat());
+    render_occluders(view_proj);
+    test_view(mask);
+}
+
+void OcclusionCuller::show_all()
+{
+    for (auto& occludee: occludees_)
+    {
+        if (!occludee.np.is_empty() && !occludee.hidden.is_zero())
+            occludee.np.show(occludee.hidden);
+        occludee.hidden.clear();
+    }
+    num_occluded_ = 0;
+}
+
+bool OcclusionCuller::compute_world_bounds(const NodePath& np, LPoint3f& bmin, LPoint3f& bmax)
+{
+    CPT(BoundingVolume) bounds = np.node()->get_bounds();
+    if (bounds->is_empty() || bounds->is_infinite())
+        return false;
+
+    LPoint3f local_min;
+    LPoint3f local_max;
+    if (const BoundingBox* box = bounds->as_bounding_box())
+    {
+        local_min = LCAST(float, box->get_minq());
+        local_max = LCAST(float, box->get_maxq());
+    }
+    else if (const BoundingSphere* sphere = bounds->as_bounding_sphere())
+    {
+        const LVecBase3f radius(static_cast<float>(sphere->get_radius()));
+        local_min = LCAST(float, sphere->get_center()) - radius;
+        local_max = LCAST(float, sphere->get_center()) + radius;
+    }
+    else
+    {
+        return false;
+    }
+
+    const LMatrix4f mat = LCAST(float, np.get_net_transform()->get_mat());
+    bmin = LPoint3f(FLT_MAX);
+    bmax = LPoint3f(-FLT_MAX);
+    for (int k = 0; k < 8; ++k)
+    {
+        const LPoint3f corner = mat.xform_point(LPoint3f(
+            (k & 1) ? local_max[0] : local_min[0],
+            (k & 2) ? local_max[1] : local_min[1],
+            (k & 4) ? local_max[2] : local_min[2]));
+        bmin = bmin.fmin(corner);
+        bmax = bmax.fmax(corner);
+    }
+    return true;
+}
+
+}
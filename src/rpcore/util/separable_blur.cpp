@@ -0,0 +1,185 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "render_pipeline/rpcore/util/separable_blur.hpp"
+
+#include <computeNode.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "render_pipeline/rpcore/globals.hpp"
+#include "render_pipeline/rpcore/loader.hpp"
+#include "render_pipeline/rpcore/render_stage.hpp"
+#include "render_pipeline/rpcore/render_target.hpp"
+#include "render_pipeline/rpcore/util/post_process_region.hpp"
+
+namespace rpcore {
+
+std::vector<float> SeparableBlur::generate_gaussian_weights(int size)
+{
+    // sigma is 1 and the last weight is at 3 sigma
+    std::vector<float> weights(size);
+    double sum = 0;
+    for (int k = 0; k < size; ++k)
+    {
+        const double x = size > 1 ? k / double(size - 1) * 3.0 : 0.0;
+        weights[k] = static_cast<float>(std::exp(-(x * x) / 2.0));
+        sum += (k == 0 ? 1 : 2) * weights[k];
+    }
+
+    for (auto& w: weights)
+        w = static_cast<float>(w / sum);
+
+    return weights;
+}
+
+float SeparableBlur::compute_bilateral_weight(float kernel_weight, const LVecBase3f& center_normal, float center_depth,
+    const LVecBase3f& sample_normal, float sample_depth, const LVecBase2f& factors)
+{
+    const float normal_diff = (sample_normal - center_normal).length();
+    const float depth_diff = std::abs(sample_depth - center_depth) * 3.0f;
+
+    float weight = kernel_weight;
+    weight *= 1.0f - (std::min)((std::max)(factors[0] * normal_diff, 0.0f), 1.0f);
+    weight *= 1.0f - (std::min)((std::max)(factors[1] * depth_diff, 0.0f), 1.0f);
+    return weight;
+}
+
+LVecBase3i SeparableBlur::get_dispatch_size(const LVecBase2i& size, bool horizontal)
+{
+    const int length = horizontal ? size[0] : size[1];
+    const int lines = horizontal ? size[1] : size[0];
+    return LVecBase3i((length + GROUP_SIZE - 1) / GROUP_SIZE, lines, 1);
+}
+
+// ************************************************************************************************
+
+SeparableBlur::SeparableBlur(RenderStage& stage, const std::string& name, Image::Format format):
+    RPObject("SeparableBlur"), stage_(stage), name_(name), format_(format)
+{
+    weights_ = PTA_float::empty_array(MAX_KERNEL_SIZE);
+    factors_ = PTA_LVecBase2f::empty_array(1);
+    factors_[0] = LVecBase2f(1.0f);
+}
+
+SeparableBlur::~SeparableBlur()
+{
+    for (auto& np: pass_nps_)
+        np.remove_node();
+}
+
+void SeparableBlur::set_kernel_size(int size)
+{
+    kernel_size_ = (std::max)(1, (std::min)(size, MAX_KERNEL_SIZE));
+    if (kernel_size_ != size)
+        error("Kernel size " + std::to_string(size) + " is clamped to " + std::to_string(kernel_size_));
+}
+
+void SeparableBlur::set_pixel_stretch(int stretch)
+{
+    pixel_stretch_ = (std::max)(1, stretch);
+}
+
+void SeparableBlur::set_iterations(int iterations)
+{
+    iterations_ = (std::max)(1, iterations);
+}
+
+void SeparableBlur::create(Texture* source_tex)
+{
+    if ((kernel_size_ - 1) * pixel_stretch_ > MAX_SPAN)
+    {
+        error("Kernel span exceeds " + std::to_string(MAX_SPAN) + " pixels. Reducing pixel stretch.");
+        pixel_stretch_ = (std::max)(1, MAX_SPAN / (std::max)(1, kernel_size_ - 1));
+    }
+
+    const auto& weights = generate_gaussian_weights(kernel_size_);
+    std::copy(weights.begin(), weights.end(), weights_.begin());
+
+    // passes are dispatched while rendering this target in the order of the stage
+    target_ = stage_.create_target(name_);
+    target_->set_size(0);
+    target_->prepare_buffer(true);
+
+    target_->set_shader_input(ShaderInput("blur_weights", weights_));
+    target_->set_shader_input(ShaderInput("blur_radius", LVecBase4i(kernel_size_ - 1, 0, 0, 0)));
+    target_->set_shader_input(ShaderInput("pixel_stretch", LVecBase4i(pixel_stretch_, 0, 0, 0)));
+    target_->set_shader_input(ShaderInput("blur_factors", factors_));
+
+    for (int k = 0; k < 2; ++k)
+    {
+        images_[k] = Image::create_2d(stage_.get_stage_id() + "-" + name_ + (k == 0 ? "-H" : "-V"), 0, 0, format_);
+        images_[k]->set_minfilter(SamplerState::FT_linear);
+        images_[k]->set_magfilter(SamplerState::FT_linear);
+        images_[k]->set_wrap_u(SamplerState::WM_clamp);
+        images_[k]->set_wrap_v(SamplerState::WM_clamp);
+    }
+
+    NodePath parent = target_->get_postprocess_region()->get_geom_node();
+    Texture* current_tex = source_tex;
+    for (int i = 0; i < iterations_; ++i)
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            const bool horizontal = k == 0;
+
+            PT(ComputeNode) node = new ComputeNode(name_ + "-" + std::to_string(i) + (horizontal ? "-H" : "-V"));
+            node->add_dispatch(1, 1, 1);
+
+            NodePath np = parent.attach_new_node(node);
+            np.set_bin("fixed", static_cast<int>(passes_.size()));
+            np.set_shader_input("SourceTex", current_tex);
+            np.set_shader_input("DestTex", images_[k]->get_texture());
+            np.set_shader_input("blur_direction", horizontal ? LVecBase2i(1, 0) : LVecBase2i(0, 1));
+
+            current_tex = images_[k]->get_texture();
+            passes_.push_back(node);
+            pass_nps_.push_back(np);
+        }
+    }
+
+    set_dimensions();
+}
+
+void SeparableBlur::reload_shaders()
+{
+    PT(Shader) shader = RPLoader::load_shader({"/$$rp/shader/separable_blur.compute.glsl"});
+    for (auto& np: pass_nps_)
+        np.set_shader(shader);
+}
+
+void SeparableBlur::set_dimensions()
+{
+    if (!target_)
+        return;
+
+    const LVecBase2i size(Globals::resolution.get_x(), Globals::resolution.get_y());
+    for (auto& image: images_)
+    {
+        image->set_x_size(size[0]);
+        image->set_y_size(size[1]);
+    }
+
+    for (size_t k = 0, k_end = passes_.size(); k < k_end; ++k)
+        passes_[k]->set_dispatch(0, get_dispatch_size(size, k % 2 == 0));
+}
+
+}
@@ -0,0 +1,299 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "render_pipeline/rpcore/util/shader_variant_manifest.hpp"
+
+#include <algorithm>
+
+#include <graphicsStateGuardian.h>
+#include <virtualFileSystem.h>
+
+#include <boost/algorithm/string/join.hpp>
+
+#include <fmt/format.h>
+
+#include "render_pipeline/rppanda/stdpy/file.hpp"
+#include "render_pipeline/rpcore/loader.hpp"
+
+#include "rplibs/yaml.hpp"
+
+namespace rpcore {
+
+std::string ShaderVariantManifest::Variant::get_key() const
+{
+    std::vector<std::string> option_strings;
+    for (const auto& option: options)
+        option_strings.push_back(option.first + (option.second ? "=1" : "=0"));
+
+    return type + "|" + boost::algorithm::join(sources, ";") + "|" + boost::algorithm::join(option_strings, ",");
+}
+
+std::string ShaderVariantManifest::serialize(const std::vector<Variant>& variants)
+{
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "variants" << YAML::Value << YAML::BeginSeq;
+    for (const auto& variant: variants)
+    {
+        out << YAML::BeginMap;
+        out << YAML::Key << "type" << YAML::Value << variant.type;
+        out << YAML::Key << "sources" << YAML::Value << YAML::BeginSeq;
+        for (const auto& source: variant.sources)
+            out << source;
+        out << YAML::EndSeq;
+        if (!variant.options.empty())
+        {
+            out << YAML::Key << "options" << YAML::Value << YAML::Flow << YAML::BeginMap;
+            for (const auto& option: variant.options)
+                out << YAML::Key << option.first << YAML::Value << option.second;
+            out << YAML::EndMap;
+        }
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+    out << YAML::EndMap;
+
+    return std::string(out.c_str()) + "\n";
+}
+
+bool ShaderVariantManifest::parse(const std::string& content, std::vector<Variant>& variants)
+{
+    YAML::Node root;
+    try
+    {
+        root = YAML::Load(content);
+    }
+    catch (const YAML::Exception&)
+    {
+        return false;
+    }
+
+    if (!root.IsMap() || !root["variants"] || !root["variants"].IsSequence())
+        return false;
+
+    for (const auto& node: root["variants"])
+    {
+        try
+        {
+            Variant variant;
+            variant.type = node["type"].as<std::string>();
+            for (const auto& source: node["sources"])
+                variant.sources.push_back(source.as<std::string>());
+            if (node["options"])
+            {
+                for (const auto& option: node["options"])
+                    variant.options[option.first.as<std::string>()] = option.second.as<bool>();
+            }
+
+            if (!variant.type.empty() && !variant.sources.empty())
+                variants.push_back(std::move(variant));
+        }
+        catch (const YAML::Exception&)
+        {
+            // skip invalid entries
+        }
+    }
+
+    return true;
+}
+
+std::vector<ShaderVariantManifest::Variant> ShaderVariantManifest::diff(const std::vector<Variant>& base,
+    const std::vector<Variant>& current)
+{
+    std::unordered_set<std::string> base_keys;
+    for (const auto& variant: base)
+        base_keys.insert(variant.get_key());
+
+    std::vector<Variant> result;
+    for (const auto& variant: current)
+    {
+        if (base_keys.find(variant.get_key()) == base_keys.end())
+            result.push_back(variant);
+    }
+    return result;
+}
+
+std::string ShaderVariantManifest::make_report(const std::vector<Variant>& variants)
+{
+    std::string report;
+    for (const auto& variant: variants)
+    {
+        report += fmt::format("[{}] {}", variant.type, boost::algorithm::join(variant.sources, ", "));
+
+        // list the enabled options only, to keep the report short.
+        std::vector<std::string> enabled;
+        for (const auto& option: variant.options)
+        {
+            if (option.second)
+                enabled.push_back(option.first);
+        }
+        if (!enabled.empty())
+            report += " (" + boost::algorithm::join(enabled, ", ") + ")";
+        report += "\n";
+    }
+    return report;
+}
+
+// ************************************************************************************************
+
+ShaderVariantManifest::ShaderVariantManifest(const Filename& path): RPObject("ShaderVariantManifest"), path_(path)
+{
+}
+
+bool ShaderVariantManifest::load()
+{
+    manifest_.clear();
+
+    if (!rppanda::isfile(path_))
+        return false;
+
+    std::string content;
+    if (!VirtualFileSystem::get_global_ptr()->read_file(path_, content, true))
+        return false;
+
+    if (!parse(content, manifest_))
+    {
+        warn(fmt::format("Invalid shader variant manifest: {}", path_.get_fullpath()));
+        return false;
+    }
+
+    debug(fmt::format("Loaded {} shader variants from {}", manifest_.size(), path_.get_fullpath()));
+    return true;
+}
+
+bool ShaderVariantManifest::save() const
+{
+    std::vector<Variant> variants = manifest_;
+    for (auto&& variant: diff(manifest_, recorded_))
+        variants.push_back(std::move(variant));
+
+    try
+    {
+        (*rppanda::open_write_file(path_, false, true)) << serialize(variants);
+    }
+    catch (const std::exception& err)
+    {
+        error(fmt::format("Error writing shader variant manifest: {}", err.what()));
+        return false;
+    }
+    return true;
+}
+
+void ShaderVariantManifest::record_effect(const Filename& filename, const Effect::OptionType& options)
+{
+    Variant variant;
+    variant.type = "effect";
+    variant.sources.push_back(filename.get_fullpath());
+
+    // store all options, so that changes of default options do not change the variant.
+    for (const auto& option: Effect::get_default_options())
+        variant.options[option.first] = option.second;
+    for (const auto& option: options)
+        variant.options[option.first] = option.second;
+
+    record(std::move(variant));
+}
+
+void ShaderVariantManifest::record_stage_shader(const std::vector<Filename>& paths)
+{
+    Variant variant;
+    variant.type = "stage";
+    for (const auto& path: paths)
+    {
+        // generated shaders do not exist until they are generated again.
+        if (path.get_fullpath().find("/$$rptemp/") != std::string::npos)
+            return;
+        variant.sources.push_back(path.get_fullpath());
+    }
+
+    record(std::move(variant));
+}
+
+size_t ShaderVariantManifest::prewarm(RenderPipeline& pipeline, GraphicsStateGuardian* gsg)
+{
+    PreparedGraphicsObjects* prepared_objects = gsg->get_prepared_objects();
+    const auto& default_options = Effect::get_default_options();
+
+    prewarming_ = true;
+
+    size_t count = 0;
+    for (const auto& variant: manifest_)
+    {
+        if (!std::all_of(variant.sources.begin(), variant.sources.end(), [](const std::string& source) {
+            return source.empty() || rppanda::isfile(source);
+        }))
+        {
+            debug(fmt::format("Skip variant with missing files: {}", variant.get_key()));
+            continue;
+        }
+
+        if (variant.type == "effect")
+        {
+            // options of passes which are not added in this session are ignored.
+            Effect::OptionType options;
+            for (const auto& option: variant.options)
+            {
+                if (default_options.find(option.first) != default_options.end())
+                    options[option.first] = option.second;
+            }
+
+            auto effect = Effect::load(pipeline, variant.sources.front(), options);
+            if (!effect)
+                continue;
+
+            for (const auto& pass: Effect::get_passes())
+            {
+                if (!effect->get_option(Effect::pass_option_prefix + pass.id))
+                    continue;
+
+                if (Shader* shader = effect->get_shader_obj(pass.id))
+                {
+                    shader->prepare(prepared_objects);
+                    ++count;
+                }
+            }
+        }
+        else if (variant.type == "stage")
+        {
+            PT(Shader) shader = RPLoader::load_shader(std::vector<Filename>(variant.sources.begin(), variant.sources.end()));
+            if (shader)
+            {
+                shader->prepare(prepared_objects);
+                ++count;
+            }
+        }
+    }
+
+    prewarming_ = false;
+
+    debug(fmt::format("Prepared {} shaders of {} variants", count, manifest_.size()));
+    return count;
+}
+
+void ShaderVariantManifest::record(Variant&& variant)
+{
+    if (prewarming_)
+        return;
+
+    if (recorded_keys_.insert(variant.get_key()).second)
+        recorded_.push_back(std::move(variant));
+}
+
+}
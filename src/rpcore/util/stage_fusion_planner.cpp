@@ -0,0 +1,108 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "render_pipeline/rpcore/util/stage_fusion_planner.hpp"
+
+#include <algorithm>
+
+namespace rpcore {
+
+StageFusionPlanner::StageFusionPlanner(const std::string& chain_pipe, size_t max_group_size):
+    chain_pipe_(chain_pipe), max_group_size_((std::max)(max_group_size, size_t(2)))
+{
+}
+
+bool StageFusionPlanner::can_fuse(const StageInfo& stage) const
+{
+    if (!stage.pointwise || !stage.active)
+        return false;
+
+    return std::find(stage.required_pipes.begin(), stage.required_pipes.end(), chain_pipe_) != stage.required_pipes.end();
+}
+
+std::vector<StageFusionPlanner::Group> StageFusionPlanner::plan(const std::vector<StageInfo>& stages) const
+{
+    std::vector<Group> groups;
+
+    size_t k = 0;
+    const size_t k_end = stages.size();
+    while (k < k_end)
+    {
+        if (!can_fuse(stages[k]))
+        {
+            ++k;
+            continue;
+        }
+
+        size_t run_end = k + 1;
+        while (run_end < k_end && can_fuse(stages[run_end]))
+            ++run_end;
+
+        for (size_t begin = k; begin < run_end; begin += max_group_size_)
+        {
+            const size_t end = (std::min)(begin + max_group_size_, run_end);
+            if (end - begin >= 2)
+                groups.push_back(Group{ begin, end });
+        }
+
+        k = run_end;
+    }
+
+    return groups;
+}
+
+std::string StageFusionPlanner::generate_fragment_shader(const std::vector<Function>& functions) const
+{
+    std::string output = "#version 430\n\n";
+    output += "// Autogenerated by the render pipeline\n";
+    output += "// Do not edit! Your changes will be lost.\n\n";
+    output += "#define USE_TIME_OF_DAY 1\n";
+    output += "#pragma include \"render_pipeline_base.inc.glsl\"\n\n";
+
+    for (const auto& func: functions)
+        output += "#pragma include \"" + func.include + "\"\n";
+
+    output += "\n";
+    output += "#if STEREO_MODE\n";
+    output += "uniform sampler2DArray " + chain_pipe_ + ";\n";
+    output += "#else\n";
+    output += "uniform sampler2D " + chain_pipe_ + ";\n";
+    output += "#endif\n\n";
+    output += "out vec4 result;\n\n";
+    output += "void main() {\n";
+    output += "    vec2 texcoord = get_texcoord();\n";
+    output += "    #if STEREO_MODE\n";
+    output += "        vec3 scene_color = textureLod(" + chain_pipe_ + ", vec3(texcoord, gl_Layer), 0).xyz;\n";
+    output += "    #else\n";
+    output += "        vec3 scene_color = textureLod(" + chain_pipe_ + ", texcoord, 0).xyz;\n";
+    output += "    #endif\n\n";
+
+    for (const auto& func: functions)
+        output += "    scene_color = " + func.name + "(scene_color, texcoord);\n";
+
+    output += "\n";
+    output += "    result = vec4(scene_color, 1);\n";
+    output += "}\n";
+
+    return output;
+}
+
+}
@@ -37,6 +37,8 @@
 
 #include "render_pipeline/rppanda/interval/lerp_interval.hpp"
 
+#include "render_pipeline/rppanda/interval/lerp_interval_batch.hpp"
+
 namespace rppanda {
 
 int LerpNodePathInterval::lerp_node_path_num = 1;
@@ -49,4 +51,56 @@ TypeHandle LerpScaleInterval::type_handle_;
 TypeHandle LerpShearInterval::type_handle_;
 TypeHandle LerpPosHprInterval::type_handle_;
 
+bool LerpNodePathInterval::is_batchable() const
+{
+    if (!get_other().is_empty())
+        return false;
+
+    // quaternion slerp and non-transform properties are evaluated by CLerpNodePathInterval only.
+    if (batch_flags_ & (BF_end_quat | BF_start_quat | BF_end_other))
+        return false;
+
+    // the combinations which CLerpNodePathInterval applies with a single NodePath setter.
+    switch (batch_flags_ & (BF_end_pos | BF_end_hpr | BF_end_scale))
+    {
+    case 0:
+        if (!(batch_flags_ & BF_end_shear))
+            return false;
+        break;
+    case BF_end_pos:
+    case BF_end_hpr:
+    case BF_end_scale:
+    case BF_end_pos | BF_end_hpr:
+    case BF_end_hpr | BF_end_scale:
+    case BF_end_pos | BF_end_hpr | BF_end_scale:
+        break;
+    default:
+        return false;
+    }
+
+    // without start value, an unbaked lerp lerps from the previous value using the previous
+    // blend value of CLerpNodePathInterval, which is private. A baked lerp never reads it,
+    // so skipping its update in the deferred step cannot change later steps.
+    return bake_in_start_;
+}
+
+void LerpNodePathInterval::priv_step(double t)
+{
+    LerpIntervalBatch* batch = LerpIntervalBatch::get_global_ptr();
+    if (!batch->is_capturing())
+        return CLerpNodePathInterval::priv_step(t);
+
+    if (!is_batchable())
+    {
+        // this step reads and writes transforms directly, so apply the earlier lerps first.
+        batch->flush();
+        return CLerpNodePathInterval::priv_step(t);
+    }
+
+    check_started(get_class_type(), "priv_step");
+    _state = S_started;
+    batch->queue(this, compute_delta(t));
+    _curr_t = t;
+}
+
 }
@@ -0,0 +1,233 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "render_pipeline/rppanda/interval/lerp_interval_batch.hpp"
+
+#include <configVariableBool.h>
+#include <cMetaInterval.h>
+
+#include "render_pipeline/rppanda/interval/lerp_interval.hpp"
+
+namespace rppanda {
+
+LerpIntervalBatch* LerpIntervalBatch::get_global_ptr()
+{
+    static LerpIntervalBatch instance;
+    return &instance;
+}
+
+bool LerpIntervalBatch::is_enabled()
+{
+    static ConfigVariableBool lerp_interval_batch("lerp-interval-batch", false,
+        "Set true to evaluate transform lerps of the interval manager in a batch.");
+    return lerp_interval_batch.get_value();
+}
+
+bool LerpIntervalBatch::is_independent(CInterval* ival)
+{
+    if (ival->is_of_type(LerpNodePathInterval::get_class_type()))
+        return true;
+
+    if (!ival->is_of_type(CMetaInterval::get_class_type()))
+        return false;
+
+    CMetaInterval* meta = DCAST(CMetaInterval, ival);
+    for (int k = 0, k_end = meta->get_num_defs(); k < k_end; ++k)
+    {
+        switch (meta->get_def_type(k))
+        {
+        case CMetaInterval::DT_c_interval:
+            if (!is_independent(meta->get_c_interval(k)))
+                return false;
+            break;
+        case CMetaInterval::DT_push_level:
+        case CMetaInterval::DT_pop_level:
+            break;
+        default:
+            // external intervals are handled outside of the C++ step.
+            return false;
+        }
+    }
+
+    return true;
+}
+
+LerpIntervalBatch::LerpIntervalBatch() = default;
+
+void LerpIntervalBatch::begin_capture(CIntervalManager* manager)
+{
+    capturing_ = false;
+    if (!is_enabled())
+        return;
+
+    for (int k = 0, k_end = manager->get_max_index(); k < k_end; ++k)
+    {
+        CInterval* ival = manager->get_c_interval(k);
+        if (ival && !is_independent(ival))
+            return;
+    }
+
+    capturing_ = true;
+}
+
+void LerpIntervalBatch::end_capture()
+{
+    flush();
+    capturing_ = false;
+}
+
+void LerpIntervalBatch::queue(LerpNodePathInterval* ival, double d)
+{
+    using Flags = LerpNodePathInterval::BatchFlags;
+
+    NodePath node = ival->get_node();
+    const unsigned int flags = ival->batch_flags_;
+
+    const bool bake_pos = (flags & Flags::BF_end_pos) && !(flags & Flags::BF_start_pos);
+    const bool bake_hpr = (flags & Flags::BF_end_hpr) && !(flags & Flags::BF_start_hpr);
+    const bool bake_scale = (flags & Flags::BF_end_scale) && !(flags & Flags::BF_start_scale);
+    const bool bake_shear = (flags & Flags::BF_end_shear) && !(flags & Flags::BF_start_shear);
+    if (bake_pos || bake_hpr || bake_scale || bake_shear)
+    {
+        // the baked start value should include the lerps queued earlier on this node.
+        if (pending_nodes_.find(node.node()) != pending_nodes_.end())
+            flush();
+
+        CPT(TransformState) transform = node.get_transform();
+        if (bake_pos)
+            ival->set_start_pos(transform->get_pos());
+        if (bake_hpr)
+            ival->set_start_hpr(transform->get_hpr());
+        if (bake_scale)
+            ival->set_start_scale(transform->get_scale());
+        if (bake_shear)
+            ival->set_start_shear(transform->get_shear());
+    }
+
+    const unsigned int component_flags[] = { Flags::BF_end_pos, Flags::BF_end_hpr, Flags::BF_end_scale, Flags::BF_end_shear };
+    const LVecBase3* starts[] = { &ival->batch_start_pos_, &ival->batch_start_hpr_, &ival->batch_start_scale_, &ival->batch_start_shear_ };
+    const LVecBase3* ends[] = { &ival->batch_end_pos_, &ival->batch_end_hpr_, &ival->batch_end_scale_, &ival->batch_end_shear_ };
+
+    // CLerpNodePathInterval casts the blend value to PN_stdfloat before scaling the vector.
+    blend_.push_back(static_cast<PN_stdfloat>(d));
+    for (size_t k = 0; k < 4; ++k)
+    {
+        const bool used = (flags & component_flags[k]) != 0;
+        for (int c = 0; c < 3; ++c)
+        {
+            start_[k * 3 + c].push_back(used ? (*starts[k])[c] : PN_stdfloat(0));
+            delta_[k * 3 + c].push_back(used ? ((*ends[k])[c] - (*starts[k])[c]) : PN_stdfloat(0));
+        }
+    }
+
+    intervals_.push_back(ival);
+    pending_nodes_.insert(node.node());
+}
+
+void LerpIntervalBatch::flush()
+{
+    if (intervals_.empty())
+        return;
+
+    evaluate();
+    apply();
+
+    intervals_.clear();
+    pending_nodes_.clear();
+    blend_.clear();
+    for (size_t k = 0; k < CHANNEL_COUNT; ++k)
+    {
+        start_[k].clear();
+        delta_[k].clear();
+    }
+}
+
+void LerpIntervalBatch::evaluate()
+{
+    const size_t count = blend_.size();
+    const PN_stdfloat* blend = blend_.data();
+
+    // same operations as lerp_value() of CLerpNodePathInterval: start + d * (end - start)
+    // contiguous channels let the compiler vectorize this loop.
+    for (size_t k = 0; k < CHANNEL_COUNT; ++k)
+    {
+        result_[k].resize(count);
+
+        const PN_stdfloat* start = start_[k].data();
+        const PN_stdfloat* delta = delta_[k].data();
+        PN_stdfloat* result = result_[k].data();
+        for (size_t i = 0; i < count; ++i)
+            result[i] = start[i] + blend[i] * delta[i];
+    }
+}
+
+void LerpIntervalBatch::apply()
+{
+    using Flags = LerpNodePathInterval::BatchFlags;
+
+    for (size_t i = 0, i_end = intervals_.size(); i < i_end; ++i)
+    {
+        const LerpNodePathInterval* ival = intervals_[i];
+        NodePath node = ival->get_node();
+        const unsigned int flags = ival->batch_flags_;
+
+        const LPoint3 pos(result_[0][i], result_[1][i], result_[2][i]);
+        const LVecBase3 hpr(result_[3][i], result_[4][i], result_[5][i]);
+        const LVecBase3 scale(result_[6][i], result_[7][i], result_[8][i]);
+        const LVecBase3 shear(result_[9][i], result_[10][i], result_[11][i]);
+
+        // save this in case we want to restore it later.
+        CPT(TransformState) prev_transform = node.get_prev_transform();
+
+        switch (flags & (Flags::BF_end_pos | Flags::BF_end_hpr | Flags::BF_end_scale))
+        {
+        case Flags::BF_end_pos:
+            node.set_pos(pos);
+            break;
+        case Flags::BF_end_hpr:
+            node.set_hpr(hpr);
+            break;
+        case Flags::BF_end_scale:
+            node.set_scale(scale);
+            break;
+        case Flags::BF_end_pos | Flags::BF_end_hpr:
+            node.set_pos_hpr(pos, hpr);
+            break;
+        case Flags::BF_end_hpr | Flags::BF_end_scale:
+            node.set_hpr_scale(hpr, scale);
+            break;
+        case Flags::BF_end_pos | Flags::BF_end_hpr | Flags::BF_end_scale:
+            node.set_pos_hpr_scale(pos, hpr, scale);
+            break;
+        default:
+            break;
+        }
+
+        if (flags & Flags::BF_end_shear)
+            node.set_shear(shear);
+
+        // fluid lerp should not reset the previous transform.
+        if (ival->fluid_)
+            node.set_prev_transform(prev_transform);
+    }
+}
+
+}
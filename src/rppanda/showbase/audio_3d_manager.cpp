@@ -39,6 +39,8 @@
 
 #include <audioManager.h>
 
+#include <algorithm>
+
 #include "render_pipeline/rppanda/showbase/showbase.hpp"
 #include "render_pipeline/rppanda/task/task_manager.hpp"
 
@@ -130,24 +132,14 @@ LVecBase3 Audio3DManager::get_sound_velocity(AudioSound* sound)
         if (vel)
             return *vel;
 
-        for (auto&& sound_dict_pair : sound_dict_)
+        auto found_object = object_dict_.find(sound);
+        if (found_object != object_dict_.end())
         {
-            auto& sounds = sound_dict_pair.second;
-
-            auto found = std::find(sounds.begin(), sounds.end(), sound);
-            if (found != sounds.end())
-            {
-                auto& known_object = sound_dict_pair.first;
-                auto node_path = known_object.get_node_path();
-                if (!node_path)
-                {
-                    // The node has been deleted.
-                    sound_dict_.erase(known_object);
-                    continue;
-                }
+            auto node_path = found_object->second.get_node_path();
 
-                return node_path.get_pos_delta(root_) / ClockObject::get_global_clock()->get_dt();
-            }
+            // The node has been deleted, and it will be removed in update.
+            if (node_path)
+                return compute_object_velocity(node_path);
         }
     }
 
@@ -172,52 +164,18 @@ LVecBase3 Audio3DManager::get_listener_velocity() const
 
 bool Audio3DManager::attach_sound_to_object(AudioSound* sound, NodePath object)
 {
-    for (auto&& sound_dict_pair : sound_dict_)
-    {
-        auto& sounds = sound_dict_pair.second;
-
-        auto found = std::find(sounds.begin(), sounds.end(), sound);
-        if (found != sounds.end())
-        {
-            sounds.erase(found);
-            if (sounds.empty())
-            {
-                auto& known_object = sound_dict_pair.first;
-
-                // if there are no other sounds, don't track
-                // the object any more
-                sound_dict_.erase(known_object);
-            }
-        }
-    }
+    remove_sound_from_object(sound);
 
-    sound_dict_[WeakNodePath(object)].push_back(sound);
+    WeakNodePath known_object(object);
+    sound_dict_[known_object].push_back(sound);
+    object_dict_.emplace(sound, known_object);
 
     return true;
 }
 
 bool Audio3DManager::detach_sound(AudioSound* sound)
 {
-    for (auto&& sound_dict_pair : sound_dict_)
-    {
-        auto& sounds = sound_dict_pair.second;
-
-        auto found = std::find(sounds.begin(), sounds.end(), sound);
-        if (found != sounds.end())
-        {
-            sounds.erase(found);
-            if (sounds.empty())
-            {
-                auto& known_object = sound_dict_pair.first;
-
-                // if there are no other sounds, don't track
-                // the object any more
-                sound_dict_.erase(known_object);
-            }
-            return true;
-        }
-    }
-    return false;
+    return remove_sound_from_object(sound);
 }
 
 const std::vector<AudioSound*>& Audio3DManager::get_sounds_on_object(NodePath object) const
@@ -239,26 +197,45 @@ AsyncTask::DoneStatus Audio3DManager::update(AsyncTask* task)
     if (!audio_manager_->get_active())
         return AsyncTask::DoneStatus::DS_cont;
 
-    for (auto&& sound_dict_pair : sound_dict_)
+    for (auto iter = sound_dict_.begin(); iter != sound_dict_.end();)
     {
-        auto& known_object = sound_dict_pair.first;
-
-        auto node_path = known_object.get_node_path();
+        auto node_path = iter->first.get_node_path();
         if (!node_path)
         {
             // The node has been deleted.
-            sound_dict_.erase(known_object);
+            for (auto&& sound : iter->second)
+                object_dict_.erase(sound);
+            iter = sound_dict_.erase(iter);
             continue;
         }
 
-        auto& sounds = sound_dict_pair.second;
-        auto pos = node_path.get_pos(root_);
+        const auto& sounds = iter->second;
+        const auto pos = node_path.get_pos(root_);
+
+        // automatic velocity is shared by all sounds on the object.
+        boost::optional<LVecBase3> object_vel;
 
         for (auto&& sound : sounds)
         {
-            auto vel = get_sound_velocity(sound);
+            LVecBase3 vel(0);
+            auto found = vel_dict_.find(sound);
+            if (found != vel_dict_.end())
+            {
+                if (found->second)
+                {
+                    vel = *found->second;
+                }
+                else
+                {
+                    if (!object_vel)
+                        object_vel = compute_object_velocity(node_path);
+                    vel = *object_vel;
+                }
+            }
             sound->set_3d_attributes(pos[0], pos[1], pos[2], vel[0], vel[1], vel[2]);
         }
+
+        ++iter;
     }
 
     // Update the position of the listener based on the object
@@ -284,6 +261,35 @@ void Audio3DManager::disable()
     ShowBase::get_global_ptr()->get_task_mgr()->remove("Audio3DManager-updateTask");
     detach_listener();
     sound_dict_.clear();
+    object_dict_.clear();
+}
+
+bool Audio3DManager::remove_sound_from_object(AudioSound* sound)
+{
+    auto found_object = object_dict_.find(sound);
+    if (found_object == object_dict_.end())
+        return false;
+
+    auto found = sound_dict_.find(found_object->second);
+    object_dict_.erase(found_object);
+
+    if (found == sound_dict_.end())
+        return false;
+
+    auto& sounds = found->second;
+    sounds.erase(std::remove(sounds.begin(), sounds.end(), sound), sounds.end());
+
+    // if there are no other sounds, don't track
+    // the object any more
+    if (sounds.empty())
+        sound_dict_.erase(found);
+
+    return true;
+}
+
+LVecBase3 Audio3DManager::compute_object_velocity(const NodePath& node_path) const
+{
+    return node_path.get_pos_delta(root_) / ClockObject::get_global_clock()->get_dt();
 }
 
 }
@@ -50,6 +50,7 @@
 #include <buttonThrower.h>
 
 #include "render_pipeline/rppanda/showbase/sfx_player.hpp"
+#include "render_pipeline/rppanda/interval/lerp_interval_batch.hpp"
 #include "render_pipeline/rppanda/showbase/loader.hpp"
 #include "render_pipeline/rppanda/showbase/messenger.hpp"
 #include "render_pipeline/rppanda/task/task_manager.hpp"
@@ -185,7 +186,10 @@ ShowBase* ShowBase::Impl::global_ptr = nullptr;
 AsyncTask::DoneStatus ShowBase::Impl::ival_loop()
 {
     // Execute all intervals in the global ivalMgr.
+    LerpIntervalBatch* lerp_batch = LerpIntervalBatch::get_global_ptr();
+    lerp_batch->begin_capture();
     CIntervalManager::get_global_ptr()->step();
+    lerp_batch->end_capture();
     return AsyncTask::DS_cont;
 }
 
@@ -32,6 +32,7 @@
 #pragma include "includes/transforms.inc.glsl"
 #pragma include "includes/noise.inc.glsl"
 #pragma include "includes/sampling_sequences.inc.glsl"
+#pragma include "includes/reduced_resolution.inc.glsl"
 
 out float result;
 
@@ -60,7 +61,7 @@ void main() {
     vec2 screen_size = vec2(WINDOW_WIDTH, WINDOW_HEIGHT);
     vec2 pixel_size = vec2(1.0) / screen_size;
 
-    ivec2 coord = ivec2(gl_FragCoord.xy) * 2;
+    ivec2 coord = get_reduced_full_coord(ivec2(gl_FragCoord.xy));
     vec2 texcoord = (coord + 0.5) / SCREEN_SIZE;
 
     // Shader variables
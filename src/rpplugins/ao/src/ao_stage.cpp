@@ -43,28 +43,17 @@ void AOStage::create()
 {
     stereo_mode_ = pipeline_.is_stereo_mode();
 
-    target_ = create_target("Sample");
-    target_->set_size(-2);
-    target_->add_color_attachment(LVecBase4i(8, 0, 0, 0));
-    if (stereo_mode_)
-        target_->set_layers(2);
-    target_->prepare_buffer();
-
-    target_upscale_ = create_target("Upscale");
-    target_upscale_->add_color_attachment(LVecBase4i(8, 0, 0, 0));
-    if (stereo_mode_)
-        target_upscale_->set_layers(2);
-    target_upscale_->prepare_buffer();
-
-    target_upscale_->set_shader_input(ShaderInput("SourceTex", target_->get_color_tex()));
-    target_upscale_->set_shader_input(ShaderInput("upscaleWeights", LVecBase2f(0.001f, 0.001f)));
+    upscaler_ = std::make_unique<rpcore::BilateralUpscaler>(*this,
+        rpcore::BilateralUpscaler::get_stage_mode(pipeline_, get_stage_id(), rpcore::BilateralUpscaler::Mode::half),
+        LVecBase2f(0.001f, 0.001f), stereo_mode_);
+    target_ = upscaler_->create("Sample", LVecBase4i(8, 0, 0, 0));
 
     target_detail_ao_ = create_target("DetailAO");
     target_detail_ao_->add_color_attachment(LVecBase4i(8, 0, 0, 0));
     if (stereo_mode_)
         target_detail_ao_->set_layers(2);
     target_detail_ao_->prepare_buffer();
-    target_detail_ao_->set_shader_input(ShaderInput("AOResult", target_upscale_->get_color_tex()));
+    target_detail_ao_->set_shader_input(ShaderInput("AOResult", upscaler_->get_result_tex()));
 
     debug(std::string("Blur quality is ") + quality_);
 
@@ -92,6 +81,16 @@ void AOStage::create()
 
     Texture* current_tex = target_detail_ao_->get_color_tex();
 
+    if (use_compute_blur_ && !stereo_mode_)
+    {
+        blur_ = std::make_unique<rpcore::SeparableBlur>(*this, "Blur", rpcore::Image::Format::R8);
+        blur_->set_pixel_stretch(static_cast<int>(pixel_stretch));
+        blur_->set_iterations(blur_passes);
+        blur_->create(current_tex);
+        current_tex = blur_->get_result_tex();
+        blur_passes = 0;
+    }
+
     for (int i = 0; i < blur_passes; ++i)
     {
         auto target_blur_v = create_target(std::string("BlurV-") + std::to_string(i));
@@ -128,14 +127,21 @@ void AOStage::create()
     target_resolve_->set_shader_input(ShaderInput("CurrentTex", current_tex));
 }
 
+void AOStage::update()
+{
+    upscaler_->update();
+}
+
+void AOStage::set_dimensions()
+{
+    if (blur_)
+        blur_->set_dimensions();
+}
+
 void AOStage::reload_shaders()
 {
     target_->set_shader(load_plugin_shader({"ao_sample.frag.glsl"}, stereo_mode_));
-
-    if (stereo_mode_)
-        target_upscale_->set_shader(load_plugin_shader({"/$$rp/shader/bilateral_upscale_stereo.frag.glsl"}, stereo_mode_));
-    else
-        target_upscale_->set_shader(load_plugin_shader({"/$$rp/shader/bilateral_upscale.frag.glsl"}));
+    upscaler_->reload_shaders();
 
     PT(Shader) blur_shader;
     if (stereo_mode_)
@@ -144,6 +150,8 @@ void AOStage::reload_shaders()
         blur_shader = load_plugin_shader({"/$$rp/shader/bilateral_blur.frag.glsl"});
     for (auto&& target: blur_targets_)
         target->set_shader(blur_shader);
+    if (blur_)
+        blur_->reload_shaders();
     target_detail_ao_->set_shader(load_plugin_shader({"small_scale_ao.frag.glsl"}, stereo_mode_));
     target_resolve_->set_shader(load_plugin_shader({"resolve_ao.frag.glsl"}, stereo_mode_));
 }
@@ -23,6 +23,8 @@
 #pragma once
 
 #include <render_pipeline/rpcore/render_stage.hpp>
+#include <render_pipeline/rpcore/util/bilateral_upscaler.hpp>
+#include <render_pipeline/rpcore/util/separable_blur.hpp>
 
 namespace rpplugins {
 
@@ -38,9 +40,13 @@ public:
     RENDER_PIPELINE_STAGE_DOWNCAST();
 
     void create() final;
+    void update() final;
     void reload_shaders() final;
+    void set_dimensions() final;
 
     void set_quality(const std::string& quality);
+    void set_use_compute_blur(bool enable);
+    void set_blur_factors(float normal_factor, float depth_factor);
 
 private:
     virtual std::string get_plugin_id() const;
@@ -51,11 +57,13 @@ private:
     bool stereo_mode_ = false;
 
     std::string quality_;
+    bool use_compute_blur_ = false;
 
+    std::unique_ptr<rpcore::BilateralUpscaler> upscaler_;
     rpcore::RenderTarget* target_;
-    rpcore::RenderTarget* target_upscale_;
     rpcore::RenderTarget* target_detail_ao_;
     std::vector<rpcore::RenderTarget*> blur_targets_;
+    std::unique_ptr<rpcore::SeparableBlur> blur_;
     rpcore::RenderTarget* target_resolve_;
 };
 
@@ -74,4 +82,15 @@ inline void AOStage::set_quality(const std::string& quality)
     quality_ = quality;
 }
 
+inline void AOStage::set_use_compute_blur(bool enable)
+{
+    use_compute_blur_ = enable;
+}
+
+inline void AOStage::set_blur_factors(float normal_factor, float depth_factor)
+{
+    if (blur_)
+        blur_->set_factors(normal_factor, depth_factor);
+}
+
 }
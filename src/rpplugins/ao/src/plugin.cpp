@@ -49,11 +49,20 @@ void Plugin::on_stage_setup()
     auto stage = std::make_unique<AOStage>(pipeline_);
 
     stage->set_quality(get_setting<rpcore::EnumType>("blur_quality"));
+    stage->set_use_compute_blur(get_setting<rpcore::BoolType>("use_compute_blur"));
 
+    stage_ = stage.get();
     add_stage(std::move(stage));
 
     // Make the stages use our output
     rpcore::AmbientStage::get_global_required_pipes().push_back("AmbientOcclusion");
 }
 
+void Plugin::on_pre_render_update()
+{
+    stage_->set_blur_factors(
+        get_setting<rpcore::FloatType>("blur_normal_factor"),
+        get_setting<rpcore::FloatType>("blur_depth_factor"));
+}
+
 }
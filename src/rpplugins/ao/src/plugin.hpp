@@ -39,9 +39,12 @@ public:
     RENDER_PIPELINE_PLUGIN_DOWNCAST();
 
     void on_stage_setup() final;
+    void on_pre_render_update() final;
 
 private:
     static RequrieType require_plugins;
+
+    AOStage* stage_;
 };
 
 }
@@ -36,6 +36,7 @@
 #pragma include "includes/gbuffer.inc.glsl"
 #pragma include "includes/light_culling.inc.glsl"
 #pragma include "includes/noise.inc.glsl"
+#pragma include "includes/reduced_resolution.inc.glsl"
 
 uniform sampler3D Noise1;
 uniform sampler3D Noise2;
@@ -126,7 +127,7 @@ void main() {
     int num_samples = GET_SETTING(clouds, raymarch_steps);
     // int num_samples = 256;
 
-    vec2 texcoord = get_half_texcoord();
+    vec2 texcoord = get_reduced_texcoord();
     vec3 wind_offs = vec3(0.2, 0.3, 0) * 0.052 * MainSceneData.frame_time;
 
     vec3 pos = get_gbuffer_position(GBuffer, texcoord);
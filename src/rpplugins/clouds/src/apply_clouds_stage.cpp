@@ -22,6 +22,7 @@
 
 #include "apply_clouds_stage.hpp"
 
+#include <render_pipeline/rpcore/render_pipeline.hpp>
 #include <render_pipeline/rpcore/render_target.hpp>
 
 namespace rpplugins {
@@ -38,29 +39,27 @@ ApplyCloudsStage::ProduceType ApplyCloudsStage::get_produced_pipes() const
 
 void ApplyCloudsStage::create()
 {
-    _render_target = create_target("RaymarchVoxels");
-    _render_target->set_size(-2);
-    _render_target->add_color_attachment(16, true);
-    _render_target->prepare_buffer();
-
-    _upscale_target = create_target("UpscaleTarget");
-    _upscale_target->add_color_attachment(16, true);
-    _upscale_target->prepare_buffer();
-    _upscale_target->set_shader_input(ShaderInput("upscaleWeights", LVecBase2f(0.05, 0.2)));
-    _upscale_target->set_shader_input(ShaderInput("SourceTex", _render_target->get_color_tex()));
-
+    _upscaler = std::make_unique<rpcore::BilateralUpscaler>(*this,
+        rpcore::BilateralUpscaler::get_stage_mode(pipeline_, get_stage_id(), rpcore::BilateralUpscaler::Mode::half),
+        LVecBase2f(0.05f, 0.2f));
+    _render_target = _upscaler->create("RaymarchVoxels", LVecBase4i(16));
 
     _target_apply_clouds = create_target("MergeWithScene");
     _target_apply_clouds->add_color_attachment(16);
     _target_apply_clouds->prepare_buffer();
-    _target_apply_clouds->set_shader_input(ShaderInput("CloudsTex", _upscale_target->get_color_tex()));
+    _target_apply_clouds->set_shader_input(ShaderInput("CloudsTex", _upscaler->get_result_tex()));
+}
+
+void ApplyCloudsStage::update()
+{
+    _upscaler->update();
 }
 
 void ApplyCloudsStage::reload_shaders()
 {
     _target_apply_clouds->set_shader(load_plugin_shader({ "apply_clouds.frag.glsl" }));
     _render_target->set_shader(load_plugin_shader({ "render_clouds.frag.glsl" }));
-    _upscale_target->set_shader(load_plugin_shader({ "/$$rp/shader/bilateral_upscale.frag.glsl" }));
+    _upscaler->reload_shaders();
 }
 
 std::string ApplyCloudsStage::get_plugin_id() const
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <render_pipeline/rpcore/render_stage.hpp>
+#include <render_pipeline/rpcore/util/bilateral_upscaler.hpp>
 
 namespace rpplugins {
 
@@ -39,6 +40,7 @@ public:
     RENDER_PIPELINE_STAGE_DOWNCAST();
 
     void create() final;
+    void update() final;
     void reload_shaders() final;
 
 private:
@@ -47,8 +49,8 @@ private:
     static RequireType required_inputs;
     static RequireType required_pipes;
 
+    std::unique_ptr<rpcore::BilateralUpscaler> _upscaler;
     rpcore::RenderTarget* _render_target;
-    rpcore::RenderTarget* _upscale_target;
     rpcore::RenderTarget* _target_apply_clouds;
 };
 
@@ -0,0 +1,386 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noise_generator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include <fmt/format.h>
+
+#include <render_pipeline/rppanda/stdpy/file.hpp>
+
+namespace rpplugins {
+
+namespace {
+
+// gradients of the improved perlin noise, padded to 16 entries
+const float perlin_gradients[16][3] = {
+    { 1,  1,  0}, {-1,  1,  0}, { 1, -1,  0}, {-1, -1,  0},
+    { 1,  0,  1}, {-1,  0,  1}, { 1,  0, -1}, {-1,  0, -1},
+    { 0,  1,  1}, { 0, -1,  1}, { 0,  1, -1}, { 0, -1, -1},
+    { 1,  1,  0}, { 0, -1,  1}, {-1,  1,  0}, { 0, -1, -1},
+};
+
+// large enough to never be the nearest point, but finite
+constexpr float DROPPED_POINT = 1e9f;
+
+inline float hash_to_float(uint32_t h)
+{
+    // 24 bits to keep the conversion exact
+    return (h >> 8) * (1.0f / 16777216.0f);
+}
+
+inline int wrap(int x, int period)
+{
+    const int r = x % period;
+    return r < 0 ? r + period : r;
+}
+
+inline float fade(float t)
+{
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+inline float lerp(float a, float b, float t)
+{
+    return a + t * (b - a);
+}
+
+inline float gradient_dot(uint32_t h, float x, float y, float z)
+{
+    const float* g = perlin_gradients[h & 15];
+    return g[0] * x + g[1] * y + g[2] * z;
+}
+
+inline unsigned char to_unorm8(float v)
+{
+    return static_cast<unsigned char>((std::min)((std::max)(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+const CloudNoiseGenerator::WorleyLayer shape_layers[] = {
+    { 8, 0.7f, 2, 1},
+    { 8, 0.6f, 4, 2},
+    {16, 0.6f, 3, 3},
+    {32, 0.4f, 2, 4},
+};
+
+const CloudNoiseGenerator::WorleyLayer detail_layers[] = {
+    { 8, 0.6f, 3, 5},
+    { 8, 0.4f, 3, 6},
+    {16, 0.4f, 2, 7},
+};
+
+}
+
+uint32_t CloudNoiseGenerator::hash(uint32_t x, uint32_t y, uint32_t z, uint32_t seed)
+{
+    uint32_t h = seed ^ 0x9e3779b9u;
+    for (uint32_t v: {x, y, z})
+    {
+        h ^= v + 0x7feb352du + (h << 6) + (h >> 2);
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        h *= 0x846ca68bu;
+        h ^= h >> 16;
+    }
+    return h;
+}
+
+float CloudNoiseGenerator::perlin_noise(const LVecBase3f& p, int period, uint32_t seed)
+{
+    const float fx = std::floor(p[0]);
+    const float fy = std::floor(p[1]);
+    const float fz = std::floor(p[2]);
+
+    const int x0 = wrap(static_cast<int>(fx), period);
+    const int y0 = wrap(static_cast<int>(fy), period);
+    const int z0 = wrap(static_cast<int>(fz), period);
+    const int x1 = wrap(x0 + 1, period);
+    const int y1 = wrap(y0 + 1, period);
+    const int z1 = wrap(z0 + 1, period);
+
+    const float dx = p[0] - fx;
+    const float dy = p[1] - fy;
+    const float dz = p[2] - fz;
+
+    const float n000 = gradient_dot(hash(x0, y0, z0, seed), dx, dy, dz);
+    const float n100 = gradient_dot(hash(x1, y0, z0, seed), dx - 1, dy, dz);
+    const float n010 = gradient_dot(hash(x0, y1, z0, seed), dx, dy - 1, dz);
+    const float n110 = gradient_dot(hash(x1, y1, z0, seed), dx - 1, dy - 1, dz);
+    const float n001 = gradient_dot(hash(x0, y0, z1, seed), dx, dy, dz - 1);
+    const float n101 = gradient_dot(hash(x1, y0, z1, seed), dx - 1, dy, dz - 1);
+    const float n011 = gradient_dot(hash(x0, y1, z1, seed), dx, dy - 1, dz - 1);
+    const float n111 = gradient_dot(hash(x1, y1, z1, seed), dx - 1, dy - 1, dz - 1);
+
+    const float u = fade(dx);
+    const float v = fade(dy);
+    const float w = fade(dz);
+
+    return lerp(
+        lerp(lerp(n000, n100, u), lerp(n010, n110, u), v),
+        lerp(lerp(n001, n101, u), lerp(n011, n111, u), v),
+        w);
+}
+
+float CloudNoiseGenerator::perlin_fbm(const LVecBase3f& p, int period, int octaves, uint32_t seed)
+{
+    float v = 0;
+    float a = 0.5f;
+    LVecBase3f x = p * static_cast<float>(period);
+    for (int i = 0; i < octaves; ++i)
+    {
+        v += a * perlin_noise(x, period, seed + i);
+        x *= 2.0f;
+        period *= 2;
+        a *= 0.5f;
+    }
+    return v;
+}
+
+std::vector<LVecBase3f> CloudNoiseGenerator::compute_worley_points(const WorleyLayer& layer)
+{
+    const int n = layer.num_cells;
+    const float inv_n = 1.0f / n;
+
+    std::vector<LVecBase3f> points(n * n * n);
+    for (int z = 0; z < n; ++z)
+    {
+        for (int y = 0; y < n; ++y)
+        {
+            for (int x = 0; x < n; ++x)
+            {
+                LVecBase3f& point = points[(z * n + y) * n + x];
+                if (hash_to_float(hash(x, y, z, layer.seed * 4 + 3)) < layer.drop_rate)
+                {
+                    point.fill(DROPPED_POINT);
+                    continue;
+                }
+
+                point.set(
+                    (x + hash_to_float(hash(x, y, z, layer.seed * 4 + 0))) * inv_n,
+                    (y + hash_to_float(hash(x, y, z, layer.seed * 4 + 1))) * inv_n,
+                    (z + hash_to_float(hash(x, y, z, layer.seed * 4 + 2))) * inv_n);
+            }
+        }
+    }
+    return points;
+}
+
+float CloudNoiseGenerator::worley_noise(const LVecBase3f& p, int num_cells, const std::vector<LVecBase3f>& points)
+{
+    const int n = num_cells;
+    const LVecBase3f coord(p[0] - std::floor(p[0]), p[1] - std::floor(p[1]), p[2] - std::floor(p[2]));
+    const int cx = (std::min)(static_cast<int>(coord[0] * n), n - 1);
+    const int cy = (std::min)(static_cast<int>(coord[1] * n), n - 1);
+    const int cz = (std::min)(static_cast<int>(coord[2] * n), n - 1);
+
+    // each cell has its point inside, so the adjacent cells are enough.
+    float min_dist_sq = DROPPED_POINT;
+    for (int z = cz - 1; z <= cz + 1; ++z)
+    {
+        const int wz = wrap(z, n);
+        const float oz = static_cast<float>(z - wz) / n;
+        for (int y = cy - 1; y <= cy + 1; ++y)
+        {
+            const int wy = wrap(y, n);
+            const float oy = static_cast<float>(y - wy) / n;
+            for (int x = cx - 1; x <= cx + 1; ++x)
+            {
+                const int wx = wrap(x, n);
+                const float ox = static_cast<float>(x - wx) / n;
+
+                const LVecBase3f& point = points[(wz * n + wy) * n + wx];
+                const float dx = point[0] + ox - coord[0];
+                const float dy = point[1] + oy - coord[1];
+                const float dz = point[2] + oz - coord[2];
+                min_dist_sq = (std::min)(min_dist_sq, dx * dx + dy * dy + dz * dz);
+            }
+        }
+    }
+
+    // normalize with the diagonal of a cell
+    const float dist = std::sqrt(min_dist_sq) * n / std::sqrt(3.0f);
+    return (std::min)((std::max)(1.0f - dist, 0.0f), 1.0f);
+}
+
+float CloudNoiseGenerator::worley_fbm(const LVecBase3f& p, const WorleyLayer& layer, const std::vector<LVecBase3f>& points)
+{
+    static const LVecBase3f shift(0.354653f);
+
+    float v = 0;
+    float a = 0.5f;
+    LVecBase3f x = p;
+    for (int i = 0; i < layer.octaves; ++i)
+    {
+        v += a * worley_noise(x, layer.num_cells, points);
+        x = x * 2.0f + shift;
+        a *= 0.5f;
+    }
+    return v;
+}
+
+CloudNoiseGenerator::VolumeLayers CloudNoiseGenerator::create_volume_layers(VolumeType type, uint32_t seed)
+{
+    VolumeLayers result;
+    result.type = type;
+    result.perlin_seed = hash(0, 0, 0, seed);
+
+    if (type == VolumeType::shape)
+        result.layers.assign(std::begin(shape_layers), std::end(shape_layers));
+    else
+        result.layers.assign(std::begin(detail_layers), std::end(detail_layers));
+
+    for (auto& layer: result.layers)
+    {
+        layer.seed = hash(layer.seed, 0, 0, seed);
+        result.points.push_back(compute_worley_points(layer));
+    }
+
+    return result;
+}
+
+LVecBase4f CloudNoiseGenerator::sample_volume(const VolumeLayers& layers, const LVecBase3f& p)
+{
+    LVecBase4f values;
+    if (layers.type == VolumeType::shape)
+    {
+        // remap the perlin fbm into [worley / 2, 1]
+        const float perlin = perlin_fbm(p, 5, 6, layers.perlin_seed);
+        const float worley = worley_fbm(p, layers.layers[0], layers.points[0]);
+        const float new_min = worley * 0.5f;
+        values[0] = new_min + (perlin + 1.0f) * 0.5f * (1.0f - new_min);
+
+        for (int k = 1; k < 4; ++k)
+            values[k] = std::sqrt(worley_fbm(p, layers.layers[k], layers.points[k]));
+    }
+    else
+    {
+        for (int k = 0; k < 3; ++k)
+            values[k] = std::sqrt(worley_fbm(p, layers.layers[k], layers.points[k]));
+        values[3] = 1.0f;
+    }
+    return values;
+}
+
+std::vector<unsigned char> CloudNoiseGenerator::compute_volume(VolumeType type, int resolution, uint32_t seed, size_t num_threads)
+{
+    const VolumeLayers layers = create_volume_layers(type, seed);
+
+    const size_t res = static_cast<size_t>(resolution);
+    std::vector<unsigned char> data(res * res * res * 4);
+
+    // every voxel only depends on its coordinate, so the slices can be computed in any order.
+    auto compute_slice = [&](int z) {
+        const float inv_res = 1.0f / resolution;
+        for (int y = 0; y < resolution; ++y)
+        {
+            unsigned char* row = data.data() + ((z * res + y) * res) * 4;
+            for (int x = 0; x < resolution; ++x)
+            {
+                const LVecBase4f values = sample_volume(layers, LVecBase3f(x * inv_res, y * inv_res, z * inv_res));
+
+                // Panda3D stores the components as BGRA.
+                unsigned char* texel = row + x * 4;
+                texel[0] = to_unorm8(values[2]);
+                texel[1] = to_unorm8(values[1]);
+                texel[2] = to_unorm8(values[0]);
+                texel[3] = to_unorm8(values[3]);
+            }
+        }
+    };
+
+    if (num_threads == 0)
+        num_threads = (std::max)(1u, std::thread::hardware_concurrency());
+    num_threads = (std::min)(num_threads, res);
+
+    if (num_threads <= 1)
+    {
+        for (int z = 0; z < resolution; ++z)
+            compute_slice(z);
+        return data;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads);
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        workers.emplace_back([&compute_slice, t, num_threads, resolution]() {
+            for (int z = static_cast<int>(t); z < resolution; z += static_cast<int>(num_threads))
+                compute_slice(z);
+        });
+    }
+    for (auto& worker: workers)
+        worker.join();
+
+    return data;
+}
+
+// ************************************************************************************************
+
+CloudNoiseGenerator::CloudNoiseGenerator(uint32_t seed, size_t num_threads): RPObject("CloudNoiseGenerator"),
+    seed_(seed), num_threads_(num_threads)
+{
+}
+
+Filename CloudNoiseGenerator::get_cache_path(VolumeType type, int resolution) const
+{
+    // this file does not start with "$$", so it is kept when the pipeline cleans up the write path.
+    return fmt::format("/$$rptemp/clouds-{}-noise-r{}-s{}-v{}.txo",
+        type == VolumeType::shape ? "shape" : "detail", resolution, seed_, VERSION);
+}
+
+PT(Texture) CloudNoiseGenerator::get_volume(VolumeType type, int resolution)
+{
+    const Filename cache_path = get_cache_path(type, resolution);
+
+    if (rppanda::isfile(cache_path))
+    {
+        PT(Texture) tex = new Texture;
+        if (tex->read(cache_path) && tex->get_x_size() == resolution && tex->get_z_size() == resolution)
+        {
+            debug(fmt::format("Loaded cached noise volume '{}'", cache_path.get_fullpath()));
+            return tex;
+        }
+        warn(fmt::format("Failed to load cached noise volume '{}', regenerating it.", cache_path.get_fullpath()));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<unsigned char> data = compute_volume(type, resolution, seed_, num_threads_);
+    debug(fmt::format("Generated noise volume with {}^3 voxels in {} ms", resolution,
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()));
+
+    PT(Texture) tex = new Texture(type == VolumeType::shape ? "CloudShapeNoise" : "CloudDetailNoise");
+    tex->setup_3d_texture(resolution, resolution, resolution, Texture::T_unsigned_byte, Texture::F_rgba8);
+
+    PTA_uchar image = PTA_uchar::empty_array(data.size());
+    std::copy(data.begin(), data.end(), image.p());
+    tex->set_ram_image(image);
+
+    if (!tex->write(cache_path))
+        warn(fmt::format("Failed to write noise volume cache '{}'", cache_path.get_fullpath()));
+
+    return tex;
+}
+
+}
@@ -0,0 +1,133 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <texture.h>
+
+#include <vector>
+
+#include <render_pipeline/rpcore/rpobject.hpp>
+
+namespace rpplugins {
+
+/**
+ * Generator of the tileable 3D noise volumes for the clouds.
+ *
+ * The shape volume stores a Perlin-Worley noise in R and Worley FBMs of increasing
+ * frequency in GBA. The detail volume stores three Worley FBMs in RGB.
+ *
+ * The noise only uses integer hashes and basic float operations, so the result is
+ * deterministic for a given resolution and seed, regardless of the number of threads.
+ * Generated volumes are cached as txo files in the write path of the pipeline.
+ */
+class CloudNoiseGenerator : public rpcore::RPObject
+{
+public:
+    enum class VolumeType
+    {
+        shape = 0,
+        detail,
+    };
+
+    /** Parameters of a Worley FBM. */
+    struct WorleyLayer
+    {
+        int num_cells;
+        float drop_rate;
+        int octaves;
+        uint32_t seed;
+    };
+
+    /** Increase this when the output of the generator changes, to invalidate the caches. */
+    static constexpr int VERSION = 1;
+
+    /** Integer hash of a lattice point. */
+    static uint32_t hash(uint32_t x, uint32_t y, uint32_t z, uint32_t seed);
+
+    /** Gradient noise in about [-1, 1] which repeats every @p period units. */
+    static float perlin_noise(const LVecBase3f& p, int period, uint32_t seed);
+
+    /** FBM of perlin_noise. @p p is in [0, 1) and the first octave has @p period cells. */
+    static float perlin_fbm(const LVecBase3f& p, int period, int octaves, uint32_t seed);
+
+    /**
+     * Compute the feature point of each cell of a Worley layer.
+     * Dropped cells have a point at infinity.
+     */
+    static std::vector<LVecBase3f> compute_worley_points(const WorleyLayer& layer);
+
+    /** Inverted distance to the nearest feature point in [0, 1]. @p p is wrapped into [0, 1). */
+    static float worley_noise(const LVecBase3f& p, int num_cells, const std::vector<LVecBase3f>& points);
+
+    /** FBM of worley_noise with the points from compute_worley_points(). */
+    static float worley_fbm(const LVecBase3f& p, const WorleyLayer& layer, const std::vector<LVecBase3f>& points);
+
+    /** Layers and feature points of a volume, which are shared by all voxels. */
+    struct VolumeLayers
+    {
+        VolumeType type;
+        uint32_t perlin_seed;
+        std::vector<WorleyLayer> layers;
+        std::vector<std::vector<LVecBase3f>> points;
+    };
+
+    static VolumeLayers create_volume_layers(VolumeType type, uint32_t seed);
+
+    /** RGBA value of the volume at @p p in [0, 1]. The volume repeats with a period of 1. */
+    static LVecBase4f sample_volume(const VolumeLayers& layers, const LVecBase3f& p);
+
+    /**
+     * Compute the RGBA8 volume with @p resolution ^ 3 voxels on the CPU.
+     * The data is in the byte order of Panda3D (BGRA) and the slices are split over
+     * @p num_threads threads (0 means the hardware concurrency).
+     */
+    static std::vector<unsigned char> compute_volume(VolumeType type, int resolution, uint32_t seed, size_t num_threads=0);
+
+public:
+    CloudNoiseGenerator(uint32_t seed=0, size_t num_threads=0);
+
+    uint32_t get_seed() const;
+    void set_seed(uint32_t seed);
+
+    /** Get the cache path of the volume in the virtual file system. */
+    Filename get_cache_path(VolumeType type, int resolution) const;
+
+    /** Load the volume from the cache, or generate and cache it. */
+    PT(Texture) get_volume(VolumeType type, int resolution);
+
+private:
+    uint32_t seed_;
+    size_t num_threads_;
+};
+
+// ************************************************************************************************
+
+inline uint32_t CloudNoiseGenerator::get_seed() const
+{
+    return seed_;
+}
+
+inline void CloudNoiseGenerator::set_seed(uint32_t seed)
+{
+    seed_ = seed;
+}
+
+}
@@ -26,6 +26,8 @@
 
 #include <render_pipeline/rpcore/loader.hpp>
 
+#include "noise_generator.hpp"
+
 RENDER_PIPELINE_PLUGIN_CREATOR(rpplugins::Plugin)
 
 namespace rpplugins {
@@ -45,8 +47,21 @@ void Plugin::on_stage_setup()
 
 void Plugin::on_pipeline_created()
 {
+    PT(Texture) noise1;
+    PT(Texture) noise2;
+    if (get_setting<rpcore::BoolType>("procedural_noise"))
+    {
+        CloudNoiseGenerator generator(static_cast<uint32_t>(get_setting<rpcore::IntType>("noise_seed")));
+        noise1 = generator.get_volume(CloudNoiseGenerator::VolumeType::shape, get_setting<rpcore::IntType>("noise_resolution"));
+        noise2 = generator.get_volume(CloudNoiseGenerator::VolumeType::detail, get_setting<rpcore::IntType>("detail_noise_resolution"));
+    }
+    else
+    {
+        noise1 = rpcore::RPLoader::load_texture(get_resource("noise1-data.txo"));
+        noise2 = rpcore::RPLoader::load_texture(get_resource("noise2-data.txo"));
+    }
+
     // High-res noise
-    PT(Texture) noise1 = rpcore::RPLoader::load_texture(get_resource("noise1-data.txo"));
     noise1->set_wrap_u(SamplerState::WM_repeat);
     noise1->set_wrap_v(SamplerState::WM_repeat);
     noise1->set_wrap_w(SamplerState::WM_repeat);
@@ -54,7 +69,6 @@ void Plugin::on_pipeline_created()
     apply_stage_->set_shader_input(ShaderInput("Noise1", noise1));
 
     // Low-res noise
-    PT(Texture) noise2 = rpcore::RPLoader::load_texture(get_resource("noise2-data.txo"));
     noise2->set_wrap_u(SamplerState::WM_repeat);
     noise2->set_wrap_v(SamplerState::WM_repeat);
     noise2->set_wrap_w(SamplerState::WM_repeat);
@@ -28,46 +28,24 @@
 
 #define USE_TIME_OF_DAY 1
 #pragma include "render_pipeline_base.inc.glsl"
-#pragma include "includes/tonemapping.inc.glsl"
+#pragma include "apply_tonemap.inc.glsl"
 
 #if STEREO_MODE
 uniform sampler2DArray ShadedScene;
 #else
 uniform sampler2D ShadedScene;
 #endif
-uniform sampler3D ColorLUT;
 
 out vec4 result;
 
-vec3 apply_lut(vec3 color) {
-    // We have a gradient from 0.5 / lut_size to 1 - 0.5 / lut_size
-    // so we need to transform from 0 .. 1 to that gradient (hardcoded lut size for now)
-    const float lut_start = 0.5 / 64.0;
-    const float lut_end = 1.0 - lut_start;
-    color = color * (lut_end - lut_start) + lut_start;
-    return textureLod(ColorLUT, color, 0).xyz;
-}
-
 void main() {
     vec2 texcoord = get_texcoord();
 
-    #if !DEBUG_MODE
-        #if STEREO_MODE
-            vec3 scene_color = textureLod(ShadedScene, vec3(texcoord, gl_Layer), 0).xyz;
-        #else
-            vec3 scene_color = textureLod(ShadedScene, texcoord, 0).xyz;
-        #endif
-        scene_color = do_tonemapping(scene_color);
-        scene_color = apply_lut(scene_color);
+    #if STEREO_MODE
+        vec3 scene_color = textureLod(ShadedScene, vec3(texcoord, gl_Layer), 0).xyz;
     #else
-        #if STEREO_MODE
-            vec3 scene_color = textureLod(ShadedScene, vec3(texcoord, gl_Layer), 0).xyz;
-        #else
-            vec3 scene_color = textureLod(ShadedScene, texcoord, 0).xyz;
-        #endif
-    #endif // !DEBUG_MODE
-
-    scene_color = saturate(scene_color);
+        vec3 scene_color = textureLod(ShadedScene, texcoord, 0).xyz;
+    #endif
 
-    result = vec4(scene_color, 1);
+    result = vec4(apply_tonemap(scene_color, texcoord), 1);
 }
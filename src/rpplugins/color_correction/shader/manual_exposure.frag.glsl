@@ -28,7 +28,7 @@
 
 #define USE_TIME_OF_DAY 1
 #pragma include "render_pipeline_base.inc.glsl"
-#pragma include "includes/tonemapping.inc.glsl"
+#pragma include "manual_exposure.inc.glsl"
 
 #if STEREO_MODE
 uniform sampler2DArray ShadedScene;
@@ -38,20 +38,12 @@ uniform sampler2D ShadedScene;
 
 out vec3 result;
 
-// Applies manual camera parameters
-
 void main() {
     vec2 texcoord = get_texcoord();
 
-    float exposure_val = computeEV100(
-        TimeOfDay.color_correction.camera_aperture,
-        TimeOfDay.color_correction.camera_shutter,
-        TimeOfDay.color_correction.camera_iso);
-
-    float exposure = convertEV100ToExposure(exposure_val);
     #if STEREO_MODE
-        result = textureLod(ShadedScene, vec3(texcoord, gl_Layer), 0).xyz * exposure;
+        result = apply_manual_exposure(textureLod(ShadedScene, vec3(texcoord, gl_Layer), 0).xyz, texcoord);
     #else
-        result = textureLod(ShadedScene, texcoord, 0).xyz * exposure;
+        result = apply_manual_exposure(textureLod(ShadedScene, texcoord, 0).xyz, texcoord);
     #endif
 }
@@ -28,8 +28,7 @@
 
 #define USE_TIME_OF_DAY 1
 #pragma include "render_pipeline_base.inc.glsl"
-#pragma include "includes/transforms.inc.glsl"
-#pragma include "includes/noise.inc.glsl"
+#pragma include "post_fx.inc.glsl"
 
 #pragma include "chromatic_aberration.inc.glsl"
 
@@ -46,45 +45,16 @@ void main() {
 
     vec2 texcoord = get_texcoord();
 
-    #if !DEBUG_MODE
-
-        vec2 ccord = (texcoord - 0.5) * vec2(1.0, ASPECT_RATIO);
-        float vignette = 1 - saturate(length(ccord));
-
-        // Chromatic abberation
-        #if GET_SETTING(color_correction, use_chromatic_aberration)
-            vec3 scene_color = do_chromatic_aberration(ShadedScene, texcoord, 1-vignette);
-        #else
-            #if STEREO_MODE
-                vec3 scene_color = textureLod(ShadedScene, vec3(texcoord, gl_Layer), 0).xyz;
-            #else
-                vec3 scene_color = textureLod(ShadedScene, texcoord, 0).xyz;
-            #endif
-        #endif
-
-        // Compute film grain
-        float film_grain = grain(MainSceneData.frame_time);
-        vec3 blended_color = blend_soft_light(scene_color, vec3(film_grain));
-
-        // Blend film grain
-        float grain_factor = GET_SETTING(color_correction, film_grain_strength);
-        scene_color = mix(scene_color, blended_color, grain_factor);
-
-        // const float saturation = 0.00;
-        // scene_color = max(vec3(0), (scene_color - saturation) / (1 - saturation));
-
-        // Apply the vignette based on the vignette strength
-        scene_color *= mix(1.0, vignette, GET_SETTING(color_correction, vignette_strength));
-
-
+    // Chromatic abberation
+    #if !DEBUG_MODE && GET_SETTING(color_correction, use_chromatic_aberration)
+        vec3 scene_color = do_chromatic_aberration(ShadedScene, texcoord, 1 - get_vignette(texcoord));
     #else
         #if STEREO_MODE
             vec3 scene_color = textureLod(ShadedScene, vec3(texcoord, gl_Layer), 0).xyz;
         #else
             vec3 scene_color = textureLod(ShadedScene, texcoord, 0).xyz;
         #endif
-    #endif // !DEBUG_MODE
-
+    #endif
 
-    result = vec4(scene_color, 1);
+    result = vec4(apply_post_fx(scene_color, texcoord), 1);
 }
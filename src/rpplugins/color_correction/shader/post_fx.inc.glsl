@@ -0,0 +1,57 @@
+/**
+ *
+ * RenderPipeline
+ *
+ * Copyright (c) 2014-2016 tobspr <tobias.springer1@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#pragma include "includes/transforms.inc.glsl"
+#pragma include "includes/noise.inc.glsl"
+
+float get_vignette(vec2 texcoord) {
+    vec2 ccord = (texcoord - 0.5) * vec2(1.0, ASPECT_RATIO);
+    return 1 - saturate(length(ccord));
+}
+
+// Film grain and vignette. This is the point-wise part of the color correction
+// stage, used when chromatic aberration is disabled.
+vec3 apply_post_fx(vec3 scene_color, vec2 texcoord) {
+    #if !DEBUG_MODE
+        // Compute film grain
+        float film_grain = grain(MainSceneData.frame_time);
+        vec3 blended_color = blend_soft_light(scene_color, vec3(film_grain));
+
+        // Blend film grain
+        float grain_factor = GET_SETTING(color_correction, film_grain_strength);
+        scene_color = mix(scene_color, blended_color, grain_factor);
+
+        // const float saturation = 0.00;
+        // scene_color = max(vec3(0), (scene_color - saturation) / (1 - saturation));
+
+        // Apply the vignette based on the vignette strength
+        scene_color *= mix(1.0, get_vignette(texcoord), GET_SETTING(color_correction, vignette_strength));
+    #endif
+
+    return scene_color;
+}
@@ -37,6 +37,13 @@ ColorCorrectionStage::ProduceType ColorCorrectionStage::get_produced_pipes() con
     };
 }
 
+ColorCorrectionStage::PointwiseFunction ColorCorrectionStage::get_pointwise_function() const
+{
+    if (!pointwise_)
+        return {};
+    return { get_plugin_shader_path("post_fx.inc.glsl"), "apply_post_fx" };
+}
+
 void ColorCorrectionStage::create()
 {
     stereo_mode_ = pipeline_.is_stereo_mode();
@@ -34,12 +34,16 @@ public:
     RequireType& get_required_inputs() const final { return required_inputs; }
     RequireType& get_required_pipes() const final { return required_pipes; }
     ProduceType get_produced_pipes() const final;
+    PointwiseFunction get_pointwise_function() const final;
 
     RENDER_PIPELINE_STAGE_DOWNCAST();
 
     void create() final;
     void reload_shaders() final;
 
+    /** Chromatic aberration reads neighbor pixels, so the stage is only point-wise without it. */
+    void set_pointwise(bool pointwise) { pointwise_ = pointwise; }
+
 private:
     std::string get_plugin_id() const final;
 
@@ -47,6 +51,7 @@ private:
     static RequireType required_pipes;
 
     bool stereo_mode_ = false;
+    bool pointwise_ = false;
 
     rpcore::RenderTarget* target_;
 };
@@ -37,6 +37,11 @@ ManualExposureStage::ProduceType ManualExposureStage::get_produced_pipes() const
     };
 }
 
+ManualExposureStage::PointwiseFunction ManualExposureStage::get_pointwise_function() const
+{
+    return { get_plugin_shader_path("manual_exposure.inc.glsl"), "apply_manual_exposure" };
+}
+
 void ManualExposureStage::create()
 {
     stereo_mode_ = pipeline_.is_stereo_mode();
@@ -46,6 +46,7 @@ void Plugin::on_pipeline_created()
 void Plugin::on_stage_setup()
 {
     auto stage = std::make_unique<ColorCorrectionStage>(pipeline_);
+    stage->set_pointwise(!get_setting<rpcore::BoolType>("use_chromatic_aberration"));
     stage_ = stage.get();
     add_stage(std::move(stage));
 
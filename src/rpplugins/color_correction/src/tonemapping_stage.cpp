@@ -37,6 +37,11 @@ TonemappingStage::ProduceType TonemappingStage::get_produced_pipes() const
     };
 }
 
+TonemappingStage::PointwiseFunction TonemappingStage::get_pointwise_function() const
+{
+    return { get_plugin_shader_path("apply_tonemap.inc.glsl"), "apply_tonemap" };
+}
+
 void TonemappingStage::create()
 {
     stereo_mode_ = pipeline_.is_stereo_mode();
@@ -34,6 +34,7 @@ public:
     RequireType& get_required_inputs() const final { return required_inputs; }
     RequireType& get_required_pipes() const final { return required_pipes; }
     ProduceType get_produced_pipes() const final;
+    PointwiseFunction get_pointwise_function() const final;
 
     RENDER_PIPELINE_STAGE_DOWNCAST();
 
@@ -28,6 +28,18 @@
 
 #pragma include "render_pipeline_base.inc.glsl"
 
+#if forward_shading_weighted_oit
+    #pragma include "includes/weighted_oit.inc.glsl"
+
+    #if STEREO_MODE
+    uniform sampler2DArray OITAccum;
+    uniform sampler2DArray OITRevealage;
+    #else
+    uniform sampler2D OITAccum;
+    uniform sampler2D OITRevealage;
+    #endif
+#endif
+
 #if STEREO_MODE
 uniform sampler2DArray ShadedScene;
 uniform sampler2DArray SceneDepth;
@@ -64,4 +76,12 @@ void main() {
     forward_result.xyz = forward_result.xyz * forward_result.w +
                             deferred_result * (1 - forward_result.w);
     result = deferred_depth > forward_depth ? deferred_result : forward_result.xyz;
+
+    #if forward_shading_weighted_oit
+        // Composite the average color of the weighted blended pass over the result
+        vec4 accum = textureLod(OITAccum, texcoord, 0);
+        float revealage = get_oit_revealage(textureLod(OITRevealage, texcoord, 0).x);
+        vec3 average_color = accum.xyz / max(accum.w, 1e-5);
+        result = mix(average_color, result, revealage);
+    #endif
 }
@@ -22,6 +22,14 @@
 
 #include "forward_stage.hpp"
 
+#include <algorithm>
+#include <cmath>
+
+#include <colorBlendAttrib.h>
+#include <cullBinAttrib.h>
+#include <depthWriteAttrib.h>
+#include <graphicsBuffer.h>
+
 #include <render_pipeline/rpcore/render_target.hpp>
 #include <render_pipeline/rpcore/globals.hpp>
 #include <render_pipeline/rppanda/showbase/showbase.hpp>
@@ -62,6 +70,36 @@ void ForwardStage::create()
 
     pipeline_.get_tag_mgr()->register_camera("forward", _forward_cam);
 
+    if (weighted_oit_)
+    {
+        _oit_cam = new Camera("ForwardOITCam");
+        _oit_cam->set_lens(rpcore::Globals::base->get_cam_lens());
+
+        // Both targets are additive, so the objects are drawn unsorted without depth write.
+        CPT(RenderState) oit_is = _oit_cam->get_initial_state();
+        oit_is = oit_is->set_attrib(TransparencyAttrib::make(TransparencyAttrib::M_none), 10000);
+        oit_is = oit_is->set_attrib(ColorBlendAttrib::make(ColorBlendAttrib::M_add, ColorBlendAttrib::O_one, ColorBlendAttrib::O_one), 10000);
+        oit_is = oit_is->set_attrib(DepthWriteAttrib::make(DepthWriteAttrib::M_off), 10000);
+        oit_is = oit_is->set_attrib(CullBinAttrib::make("unsorted", 0), 10000);
+        _oit_cam->set_initial_state(oit_is);
+
+        _oit_cam_np = rpcore::Globals::base->get_cam().attach_new_node(_oit_cam);
+
+        _target_oit = create_target("ForwardOIT");
+        _target_oit->add_color_attachment(16, true);
+        _target_oit->add_aux_attachment(16);
+        if (stereo_mode_)
+            _target_oit->set_layers(2);
+        _target_oit->prepare_render(_oit_cam_np);
+        _target_oit->set_clear_color(LColor(0, 0, 0, 0));
+
+        GraphicsBuffer* oit_buffer = _target_oit->get_internal_buffer();
+        oit_buffer->set_clear_active(GraphicsOutput::RTP_aux_hrgba_0, true);
+        oit_buffer->set_clear_value(GraphicsOutput::RTP_aux_hrgba_0, LColor(0, 0, 0, 0));
+
+        pipeline_.get_tag_mgr()->register_camera("forward_oit", _oit_cam);
+    }
+
     _target_merge = create_target("MergeWithDeferred");
     _target_merge->add_color_attachment(16);
     if (stereo_mode_)
@@ -69,6 +107,11 @@ void ForwardStage::create()
     _target_merge->prepare_buffer();
     _target_merge->set_shader_input(ShaderInput("ForwardDepth", _target->get_depth_tex()));
     _target_merge->set_shader_input(ShaderInput("ForwardColor", _target->get_color_tex()));
+    if (_target_oit)
+    {
+        _target_merge->set_shader_input(ShaderInput("OITAccum", _target_oit->get_color_tex()));
+        _target_merge->set_shader_input(ShaderInput("OITRevealage", _target_oit->get_aux_tex(0)));
+    }
 }
 
 void ForwardStage::reload_shaders()
@@ -82,6 +125,20 @@ void ForwardStage::set_shader_input(const ShaderInput& inp)
     RenderStage::set_shader_input(inp);
 }
 
+float ForwardStage::compute_oit_weight(float view_depth, float alpha)
+{
+    const float d5 = view_depth / 5.0f;
+    const float d200 = view_depth / 200.0f;
+    const float d200_2 = d200 * d200;
+    const float weight = 10.0f / (1e-5f + d5 * d5 + d200_2 * d200_2 * d200_2);
+    return alpha * (std::min)((std::max)(weight, 1e-2f), 3e3f);
+}
+
+float ForwardStage::compute_oit_revealage_term(float alpha)
+{
+    return -std::log((std::max)(1.0f - alpha, 1e-4f));
+}
+
 std::string ForwardStage::get_plugin_id() const
 {
     return RPPLUGINS_ID_STRING;
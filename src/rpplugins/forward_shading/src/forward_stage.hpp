@@ -31,6 +31,9 @@ namespace rpplugins {
 /**
  * Forward shading stage, which first renders all forward objects,
  * and then merges them with the scene.
+ *
+ * Objects of the forward_oit pass are rendered with weighted blended
+ * order-independent transparency, so they do not need to be sorted.
  */
 class ForwardStage : public rpcore::RenderStage
 {
@@ -43,6 +46,17 @@ public:
 
     RENDER_PIPELINE_STAGE_DOWNCAST();
 
+    /**
+     * Weight of a fragment for the weighted blended OIT.
+     * This matches get_oit_weight in weighted_oit.inc.glsl.
+     */
+    static float compute_oit_weight(float view_depth, float alpha);
+
+    /** Revealage term accumulated by a fragment. The revealage is exp(-sum). */
+    static float compute_oit_revealage_term(float alpha);
+
+    void set_weighted_oit(bool enabled);
+
     void create() final;
     void reload_shaders() final;
 
@@ -55,12 +69,24 @@ private:
     static RequireType required_pipes;
 
     bool stereo_mode_ = false;
+    bool weighted_oit_ = false;
 
     PT(Camera) _forward_cam;
     NodePath _forward_cam_np;
 
+    PT(Camera) _oit_cam;
+    NodePath _oit_cam_np;
+
     rpcore::RenderTarget* _target;
+    rpcore::RenderTarget* _target_oit = nullptr;
     rpcore::RenderTarget* _target_merge;
 };
 
+// ************************************************************************************************
+
+inline void ForwardStage::set_weighted_oit(bool enabled)
+{
+    weighted_oit_ = enabled;
+}
+
 }    // namespace rpplugins
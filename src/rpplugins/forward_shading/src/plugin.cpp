@@ -24,6 +24,10 @@
 
 #include <boost/dll/alias.hpp>
 
+#include <render_pipeline/rpcore/render_pipeline.hpp>
+#include <render_pipeline/rpcore/effect.hpp>
+#include <render_pipeline/rpcore/native/tag_state_manager.h>
+
 #include "forward_stage.hpp"
 
 RENDER_PIPELINE_PLUGIN_CREATOR(rpplugins::Plugin)
@@ -36,9 +40,20 @@ Plugin::Plugin(rpcore::RenderPipeline& pipeline): BasePlugin(pipeline, RPPLUGINS
 {
 }
 
+void Plugin::on_load()
+{
+    if (get_setting<rpcore::BoolType>("weighted_oit"))
+    {
+        // same template as the forward pass, which checks IN_FORWARD_OIT_SHADER
+        rpcore::Effect::add_pass({ "forward_oit", true, "", "/$$rp/shader/templates/forward.frag.glsl", "" }, false);
+        pipeline_.get_tag_mgr()->add_state("forward_oit", "ForwardOIT", 6, true);
+    }
+}
+
 void Plugin::on_stage_setup()
 {
     auto stage = std::make_unique<ForwardStage>(pipeline_);
+    stage->set_weighted_oit(get_setting<rpcore::BoolType>("weighted_oit"));
 
     if (is_plugin_enabled("scattering"))
     {
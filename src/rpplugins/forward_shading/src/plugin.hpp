@@ -34,6 +34,7 @@ public:
     RequrieType& get_required_plugins() const final { return require_plugins; }
     RENDER_PIPELINE_PLUGIN_DOWNCAST();
 
+    void on_load() final;
     void on_stage_setup() final;
 
 private:
@@ -47,6 +47,8 @@ set(${PROJECT_NAME}_source_root
     "${PROJECT_SOURCE_DIR}/src/nodepath_window.cpp"
     "${PROJECT_SOURCE_DIR}/src/nodepath_window.hpp"
     "${PROJECT_SOURCE_DIR}/src/plugin.cpp"
+    "${PROJECT_SOURCE_DIR}/src/scenegraph_model.cpp"
+    "${PROJECT_SOURCE_DIR}/src/scenegraph_model.hpp"
     "${PROJECT_SOURCE_DIR}/src/scenegraph_window.cpp"
     "${PROJECT_SOURCE_DIR}/src/scenegraph_window.hpp"
     "${PROJECT_SOURCE_DIR}/src/texture_window.cpp"
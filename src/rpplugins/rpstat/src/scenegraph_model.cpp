@@ -0,0 +1,98 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Younguk Kim (bluekyu)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "scenegraph_model.hpp"
+
+#include <geomNode.h>
+
+namespace rpplugins {
+
+void ScenegraphModel::set_expanded(NodePath np, bool expanded)
+{
+    if (expanded == is_expanded(np))
+        return;
+
+    if (expanded)
+        expanded_.insert(np);
+    else
+        expanded_.erase(np);
+    dirty_ = true;
+}
+
+bool ScenegraphModel::update(double time)
+{
+    if (!dirty_ && time - last_rebuild_time_ < refresh_interval_)
+        return false;
+
+    rebuild();
+    last_rebuild_time_ = time;
+    return true;
+}
+
+void ScenegraphModel::rebuild()
+{
+    // forget detached nodes, which are kept alive by the NodePath in the set
+    const NodePath top = root_.is_empty() ? root_ : root_.get_top();
+    for (auto iter = expanded_.begin(); iter != expanded_.end();)
+    {
+        if (iter->is_empty() || iter->get_top() != top)
+            iter = expanded_.erase(iter);
+        else
+            ++iter;
+    }
+
+    rows_.clear();
+    num_visited_nodes_ = 0;
+    append_rows(root_, 0);
+
+    dirty_ = false;
+    ++num_rebuilds_;
+}
+
+void ScenegraphModel::append_rows(NodePath np, int depth)
+{
+    if (np.is_empty() || np == excluded_)
+        return;
+
+    ++num_visited_nodes_;
+
+    PandaNode* node = np.node();
+    const int num_children = np.get_num_children();
+    const bool is_geom_node = node->is_geom_node();
+
+    rows_.push_back(Row{ np, -1, depth, num_children > 0 || is_geom_node });
+
+    if (!rows_.back().has_children || !is_expanded(np))
+        return;
+
+    for (int k = 0; k < num_children; ++k)
+        append_rows(np.get_child(k), depth + 1);
+
+    if (is_geom_node)
+    {
+        for (int k = 0, k_end = DCAST(GeomNode, node)->get_num_geoms(); k < k_end; ++k)
+            rows_.push_back(Row{ np, k, depth + 1, false });
+    }
+}
+
+}
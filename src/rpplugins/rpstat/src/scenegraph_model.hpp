@@ -0,0 +1,159 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Younguk Kim (bluekyu)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <nodePath.h>
+
+#include <set>
+#include <vector>
+
+namespace rpplugins {
+
+/**
+ * Cached and flattened rows of the scene graph for ScenegraphWindow.
+ *
+ * Only the children of expanded nodes are visited, and the rows are rebuilt when
+ * the model is marked as dirty or when the refresh interval is elapsed.
+ * So the cost of a frame does not depend on the size of the scene graph,
+ * and the view can draw only the visible rows.
+ */
+class ScenegraphModel
+{
+public:
+    struct Row
+    {
+        NodePath np;
+
+        /** Index of Geom in GeomNode, or -1 if the row is a node. */
+        int geom_index;
+
+        int depth;
+        bool has_children;
+    };
+
+public:
+    void set_root(NodePath root);
+    NodePath get_root() const;
+
+    /** Set a node which is not shown with its children. */
+    void set_excluded(NodePath np);
+
+    bool is_expanded(NodePath np) const;
+    void set_expanded(NodePath np, bool expanded);
+
+    /** Rebuild the rows in the next update(). */
+    void mark_dirty();
+
+    void set_refresh_interval(double interval);
+    double get_refresh_interval() const;
+
+    /**
+     * Rebuild the rows if dirty or if the refresh interval is elapsed from the last rebuild.
+     * @return  true if the rows are rebuilt.
+     */
+    bool update(double time);
+
+    /** Rebuild the rows immediately. */
+    void rebuild();
+
+    const std::vector<Row>& get_rows() const;
+
+    /** Number of nodes visited in the last rebuild. */
+    size_t get_num_visited_nodes() const;
+
+    /** Number of rebuilds since the creation. */
+    size_t get_num_rebuilds() const;
+
+private:
+    void append_rows(NodePath np, int depth);
+
+    NodePath root_;
+    NodePath excluded_;
+    std::set<NodePath> expanded_;
+
+    std::vector<Row> rows_;
+
+    bool dirty_ = true;
+    double refresh_interval_ = 0.5;
+    double last_rebuild_time_ = 0;
+
+    size_t num_visited_nodes_ = 0;
+    size_t num_rebuilds_ = 0;
+};
+
+// ************************************************************************************************
+
+inline void ScenegraphModel::set_root(NodePath root)
+{
+    root_ = root;
+    dirty_ = true;
+}
+
+inline NodePath ScenegraphModel::get_root() const
+{
+    return root_;
+}
+
+inline void ScenegraphModel::set_excluded(NodePath np)
+{
+    excluded_ = np;
+    dirty_ = true;
+}
+
+inline bool ScenegraphModel::is_expanded(NodePath np) const
+{
+    return expanded_.find(np) != expanded_.end();
+}
+
+inline void ScenegraphModel::mark_dirty()
+{
+    dirty_ = true;
+}
+
+inline void ScenegraphModel::set_refresh_interval(double interval)
+{
+    refresh_interval_ = interval;
+}
+
+inline double ScenegraphModel::get_refresh_interval() const
+{
+    return refresh_interval_;
+}
+
+inline const std::vector<ScenegraphModel::Row>& ScenegraphModel::get_rows() const
+{
+    return rows_;
+}
+
+inline size_t ScenegraphModel::get_num_visited_nodes() const
+{
+    return num_visited_nodes_;
+}
+
+inline size_t ScenegraphModel::get_num_rebuilds() const
+{
+    return num_rebuilds_;
+}
+
+}
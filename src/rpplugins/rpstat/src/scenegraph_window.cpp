@@ -28,6 +28,7 @@
 #include <material.h>
 #include <geomNode.h>
 #include <paramNodePath.h>
+#include <clockObject.h>
 
 #include <fmt/format.h>
 
@@ -57,6 +58,9 @@ ScenegraphWindow::ScenegraphWindow(RPStatPlugin& plugin, rpcore::RenderPipeline&
 
     root_ = rpcore::Globals::render.attach_new_node("imgui-ScenegraphWindow-root");
 
+    model_.set_root(rpcore::Globals::base->get_render());
+    model_.set_excluded(root_);
+
     message_dialog_ = std::make_unique<MessageDialog>("Continue?");
     import_model_dialog_ = std::make_unique<ImportModelDialog>(plugin_, FileDialog::OperationFlag::open, "Importing Model ...");
     import_actor_dialog_ = std::make_unique<ImportModelDialog>(plugin_, FileDialog::OperationFlag::open, "Importing Actor ...");
@@ -101,17 +105,30 @@ void ScenegraphWindow::draw_contents()
 
         if (ImGui::BeginMenu("Tools"))
         {
+            // show new nodes without waiting for the refresh interval
             if (ImGui::MenuItem("Create Empty Node"))
+            {
                 rpcore::Globals::render.attach_new_node(new PandaNode("New-Node"));
+                model_.mark_dirty();
+            }
 
             if (ImGui::MenuItem("Create Plane"))
+            {
                 rpcore::create_plane("Plane").reparent_to(rpcore::Globals::render);
+                model_.mark_dirty();
+            }
 
             if (ImGui::MenuItem("Create Cube"))
+            {
                 rpcore::create_cube("Cube").reparent_to(rpcore::Globals::render);
+                model_.mark_dirty();
+            }
 
             if (ImGui::MenuItem("Create Sphere"))
+            {
                 rpcore::create_sphere("Sphere", 36, 72).reparent_to(rpcore::Globals::render);
+                model_.mark_dirty();
+            }
 
             ImGui::EndMenu();
         }
@@ -130,7 +147,7 @@ void ScenegraphWindow::draw_contents()
     // scenegraph
     ImGui::BeginChild("child_scenegraph", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
 
-    draw_nodepath(rpcore::Globals::base->get_render());
+    draw_scenegraph();
 
     ImGui::EndChild();
 
@@ -142,6 +159,7 @@ void ScenegraphWindow::draw_contents()
     {
         will_remove_np_.remove_node();
         will_remove_np_.clear();
+        model_.mark_dirty();
     }
 }
 
@@ -182,26 +200,67 @@ void ScenegraphWindow::remove_actor(NodePath actor)
     actor_map_.erase(actor);
 }
 
-void ScenegraphWindow::draw_nodepath(NodePath np)
+void ScenegraphWindow::draw_scenegraph()
 {
-    if (!np || np == root_)
-        return;
+    model_.update(ClockObject::get_global_clock()->get_real_time());
+
+    // draw only the visible rows
+    const auto& rows = model_.get_rows();
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(rows.size()));
+    while (clipper.Step())
+    {
+        for (int k = clipper.DisplayStart; k < clipper.DisplayEnd; ++k)
+        {
+            const auto& row = rows[k];
+            if (row.geom_index < 0)
+                draw_nodepath(row);
+            else
+                draw_geom(DCAST(GeomNode, row.np.node()), row.geom_index, row.depth);
+        }
+    }
+    clipper.End();
+
+    // popups are drawn outside of the rows because the row may be clipped.
+    draw_drop_popup();
+
+    if (dialog_np_)
+    {
+        const auto& accepted = message_dialog_->draw();
+        if (accepted)
+        {
+            if (*accepted)
+                will_remove_np_ = dialog_np_;
+            dialog_np_.clear();
+        }
+    }
+}
+
+void ScenegraphWindow::draw_nodepath(const ScenegraphModel::Row& row)
+{
+    NodePath np = row.np;
+
+    // rows are flat, so indent the depth without tree push
+    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + row.depth * ImGui::GetStyle().IndentSpacing);
 
-    bool node_open = false;
     ImGuiTreeNodeFlags flags =
         ImGuiTreeNodeFlags_OpenOnArrow |
         ImGuiTreeNodeFlags_OpenOnDoubleClick |
+        ImGuiTreeNodeFlags_NoTreePushOnOpen |
         (selected_np_ == np ? ImGuiTreeNodeFlags_Selected : 0);
 
     // leaf or not.
-    if (np.get_num_children() == 0 && !np.node()->is_geom_node())
+    if (!row.has_children)
     {
-        flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+        flags |= ImGuiTreeNodeFlags_Leaf;
         ImGui::TreeNodeEx(np.node(), flags, np.node()->get_name().c_str());
     }
     else
     {
-        node_open = ImGui::TreeNodeEx(np.node(), flags, np.node()->get_name().c_str());
+        const bool expanded = model_.is_expanded(np);
+        ImGui::SetNextTreeNodeOpen(expanded);
+        if (ImGui::TreeNodeEx(np.node(), flags, np.node()->get_name().c_str()) != expanded)
+            model_.set_expanded(np, !expanded);
     }
 
     // drag & drop source
@@ -218,58 +277,42 @@ void ScenegraphWindow::draw_nodepath(NodePath np)
     }
 
     // drag & drop target
+    if (ImGui::BeginDragDropTarget())
     {
-        static NodePath dropped_np;
-        static NodePath dragged_np;
-        if (ImGui::BeginDragDropTarget())
+        if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("NodePath"))
         {
-            if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("NodePath"))
-            {
-                dropped_np = np;
-                dragged_np = *reinterpret_cast<NodePath*>(ImGui::GetDragDropPayload()->Data);
-                ImGui::OpenPopup("drop_nodepath");
-            }
-            ImGui::EndDragDropTarget();
-        }
-
-        if (dropped_np == np && ImGui::BeginPopup("drop_nodepath"))
-        {
-            if (ImGui::Selectable("Reparent"))
-            {
-                dragged_np.reparent_to(dropped_np);
-                dragged_np.clear();
-                dropped_np.clear();
-            }
-
-            if (ImGui::Selectable("Reparent (wrt)"))
-            {
-                dragged_np.wrt_reparent_to(dropped_np);
-                dragged_np.clear();
-                dropped_np.clear();
-            }
-
-            ImGui::EndPopup();
+            dropped_np_ = np;
+            dragged_np_ = *reinterpret_cast<NodePath*>(ImGui::GetDragDropPayload()->Data);
+            ImGui::OpenPopup("drop_nodepath");
         }
+        ImGui::EndDragDropTarget();
     }
 
     draw_nodepath_context_menu(np);
-    if (dialog_np_ == np)
+}
+
+void ScenegraphWindow::draw_drop_popup()
+{
+    if (!ImGui::BeginPopup("drop_nodepath"))
+        return;
+
+    if (ImGui::Selectable("Reparent"))
     {
-        const auto& accepted = message_dialog_->draw();
-        if (accepted && *accepted)
-            will_remove_np_ = np;
+        dragged_np_.reparent_to(dropped_np_);
+        dragged_np_.clear();
+        dropped_np_.clear();
+        model_.mark_dirty();
     }
 
-    if (node_open)
+    if (ImGui::Selectable("Reparent (wrt)"))
     {
-        for (int k = 0, k_end = np.get_num_children(); k < k_end; ++k)
-            draw_nodepath(np.get_child(k));
-
-        if (np.node()->is_geom_node())
-            draw_geomnode(DCAST(GeomNode, np.node()));
-
-        ImGui::TreePop();
+        dragged_np_.wrt_reparent_to(dropped_np_);
+        dragged_np_.clear();
+        dropped_np_.clear();
+        model_.mark_dirty();
     }
+
+    ImGui::EndPopup();
 }
 
 void ScenegraphWindow::draw_nodepath_context_menu(NodePath np)
@@ -318,61 +361,59 @@ void ScenegraphWindow::draw_nodepath_context_menu(NodePath np)
     ImGui::EndPopup();
 }
 
-void ScenegraphWindow::draw_geomnode(GeomNode* node)
+void ScenegraphWindow::draw_geom(GeomNode* node, int geom_index, int depth)
 {
     rpcore::RPGeomNode gn(node);
-    for (int k = 0, k_end = gn.get_num_geoms(); k < k_end; ++k)
-    {
-        const Geom* geom = gn->get_geom(k);
-        const auto& state = gn.get_state(k);
+    const int k = geom_index;
+    if (k >= gn.get_num_geoms())
+        return;
 
-        ImGuiTreeNodeFlags flags =
-            ImGuiTreeNodeFlags_OpenOnArrow |
-            ImGuiTreeNodeFlags_OpenOnDoubleClick |
-            (selected_geom_ == geom ? ImGuiTreeNodeFlags_Selected : 0);
+    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + depth * ImGui::GetStyle().IndentSpacing);
 
-        bool node_open = ImGui::TreeNodeEx(geom, flags, "Geom %d", k);
+    const Geom* geom = gn->get_geom(k);
+    const auto& state = gn.get_state(k);
 
-        if (ImGui::IsItemClicked())
-        {
-            selected_np_.clear();
-            selected_geom_ = geom;
-        }
+    ImGuiTreeNodeFlags flags =
+        ImGuiTreeNodeFlags_Leaf |
+        ImGuiTreeNodeFlags_NoTreePushOnOpen |
+        (selected_geom_ == geom ? ImGuiTreeNodeFlags_Selected : 0);
 
-        if (ImGui::BeginPopupContextItem())
+    ImGui::TreeNodeEx(geom, flags, "Geom %d", k);
+
+    if (ImGui::IsItemClicked())
+    {
+        selected_np_.clear();
+        selected_geom_ = geom;
+    }
+
+    if (ImGui::BeginPopupContextItem())
+    {
+        if (state.has_material())
         {
-            if (state.has_material())
-            {
-                if (ImGui::Selectable(SHOW_MATERIAL_WINDOW_TEXT))
-                {
-                    send_show_event("###Material");
-                    throw_event(MaterialWindow::MATERIAL_SELECTED_EVENT_NAME, EventParameter(state.get_material().get_material()));
-                }
-            }
-            else
+            if (ImGui::Selectable(SHOW_MATERIAL_WINDOW_TEXT))
             {
-                ImGui::TextDisabled(SHOW_MATERIAL_WINDOW_TEXT);
+                send_show_event("###Material");
+                throw_event(MaterialWindow::MATERIAL_SELECTED_EVENT_NAME, EventParameter(state.get_material().get_material()));
             }
+        }
+        else
+        {
+            ImGui::TextDisabled(SHOW_MATERIAL_WINDOW_TEXT);
+        }
 
-            if (state.has_texture())
-            {
-                if (ImGui::Selectable(SHOW_TEXTURE_WINDOW_TEXT))
-                {
-                //    send_show_event("###Texture");
-                //    throw_event(TextureWindow::TEXTURE_SELECTED_EVENT_NAME, EventParameter(new ParamNodePath(np)));
-                }
-            }
-            else
+        if (state.has_texture())
+        {
+            if (ImGui::Selectable(SHOW_TEXTURE_WINDOW_TEXT))
             {
-                ImGui::TextDisabled(SHOW_TEXTURE_WINDOW_TEXT);
+            //    send_show_event("###Texture");
+            //    throw_event(TextureWindow::TEXTURE_SELECTED_EVENT_NAME, EventParameter(new ParamNodePath(np)));
             }
-            ImGui::EndPopup();
         }
-
-        if (node_open)
+        else
         {
-            ImGui::TreePop();
+            ImGui::TextDisabled(SHOW_TEXTURE_WINDOW_TEXT);
         }
+        ImGui::EndPopup();
     }
 }
 
@@ -421,6 +462,7 @@ void ScenegraphWindow::draw_import_model()
         if (np)
         {
             np.reparent_to(rpcore::Globals::render);
+            model_.mark_dirty();
             throw_event(ScenegraphWindow::CHANGE_SELECTED_NODE_EVENT_NAME, EventParameter(new ParamNodePath(np)));
         }
     }
@@ -449,6 +491,7 @@ void ScenegraphWindow::draw_import_actor()
         {
             add_actor(actor);
             actor->reparent_to(rpcore::Globals::render);
+            model_.mark_dirty();
             throw_event(ScenegraphWindow::CHANGE_SELECTED_NODE_EVENT_NAME, EventParameter(new ParamNodePath(NodePath(*actor))));
         }
     }
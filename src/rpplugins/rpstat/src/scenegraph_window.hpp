@@ -27,6 +27,7 @@
 #include <nodePath.h>
 
 #include "window_interface.hpp"
+#include "scenegraph_model.hpp"
 
 namespace rppanda {
 class Actor;
@@ -59,9 +60,11 @@ public:
     void remove_actor(NodePath actor);
 
 private:
-    void draw_nodepath(NodePath np);
+    void draw_scenegraph();
+    void draw_nodepath(const ScenegraphModel::Row& row);
     void draw_nodepath_context_menu(NodePath np);
-    void draw_geomnode(GeomNode* node);
+    void draw_drop_popup();
+    void draw_geom(GeomNode* node, int geom_index, int depth);
     void draw_gizmo();
     void draw_import_model();
     void draw_import_actor();
@@ -71,6 +74,10 @@ private:
     const Geom* selected_geom_ = nullptr;
 
     NodePath root_;
+    ScenegraphModel model_;
+
+    NodePath dropped_np_;
+    NodePath dragged_np_;
 
     int gizmo_op_ = 0;
 
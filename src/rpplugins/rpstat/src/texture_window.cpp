@@ -63,19 +63,7 @@ void TextureWindow::draw_contents()
     if (tex_collection_.get_num_textures() == 0)
         return;
 
-    static const char* empty_name = "(no-name)";
-
-    texture_names_.clear();
-    for (int k = 0, k_end = tex_collection_.get_num_textures(); k < k_end; ++k)
-    {
-        auto tex = tex_collection_.get_texture(k);
-        if (tex->has_name())
-            texture_names_.push_back(tex_collection_.get_texture(k)->get_name().c_str());
-        else
-            texture_names_.push_back(empty_name);
-    }
-
-    ImGui::Combo("Textures", &current_item_, texture_names_.data(), texture_names_.size());
+    ui_texture_list();
 
     Texture* tex = tex_collection_.get_texture(current_item_);
 
@@ -101,15 +89,61 @@ void TextureWindow::set_nodepath(NodePath np)
     current_item_ = 0;
 
     if (is_open_)
-        tex_collection_ = np_.find_all_textures();
+        refresh_textures();
 }
 
 void TextureWindow::show()
 {
-    tex_collection_ = np_.find_all_textures();
+    refresh_textures();
     WindowInterface::show();
 }
 
+void TextureWindow::refresh_textures()
+{
+    static const char* empty_name = "(no-name)";
+
+    tex_collection_ = np_ ? np_.find_all_textures() : TextureCollection();
+
+    texture_names_.clear();
+    for (int k = 0, k_end = tex_collection_.get_num_textures(); k < k_end; ++k)
+    {
+        auto tex = tex_collection_.get_texture(k);
+        if (tex->has_name())
+            texture_names_.push_back(tex->get_name().c_str());
+        else
+            texture_names_.push_back(empty_name);
+    }
+
+    current_item_ = (std::min)(current_item_, static_cast<int>(texture_names_.size()) - 1);
+    current_item_ = (std::max)(current_item_, 0);
+}
+
+void TextureWindow::ui_texture_list()
+{
+    ImGui::Text("Textures (%d)", static_cast<int>(texture_names_.size()));
+
+    // draw only the visible rows for nodes having many textures
+    const float height = ImGui::GetTextLineHeightWithSpacing() * (std::min)(8, static_cast<int>(texture_names_.size())) +
+        ImGui::GetStyle().WindowPadding.y * 2;
+    ImGui::BeginChild("texture_list", ImVec2(0, height), true);
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(texture_names_.size()));
+    while (clipper.Step())
+    {
+        for (int k = clipper.DisplayStart; k < clipper.DisplayEnd; ++k)
+        {
+            ImGui::PushID(k);
+            if (ImGui::Selectable(texture_names_[k], current_item_ == k))
+                current_item_ = k;
+            ImGui::PopID();
+        }
+    }
+    clipper.End();
+
+    ImGui::EndChild();
+}
+
 void TextureWindow::ui_texture_type(Texture* tex)
 {
     ImGui::LabelText("Texture Type", Texture::format_texture_type(tex->get_texture_type()).c_str());
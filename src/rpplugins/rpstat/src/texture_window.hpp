@@ -46,6 +46,10 @@ public:
     void show() final;
 
 private:
+    /** Collect the textures of the node and cache their names. */
+    void refresh_textures();
+
+    void ui_texture_list();
     void ui_texture_type(Texture* tex);
     static bool texture_type_list_cache_getter(void* data, int idx, const char** out_text);
 
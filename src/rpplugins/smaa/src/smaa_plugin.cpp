@@ -28,6 +28,8 @@
 #include <texture.h>
 
 #include <render_pipeline/rpcore/globals.hpp>
+#include <render_pipeline/rpcore/render_pipeline.hpp>
+#include <render_pipeline/rpcore/temporal_manager.hpp>
 #include <render_pipeline/rppanda/showbase/showbase.hpp>
 #include <render_pipeline/rpcore/loader.hpp>
 
@@ -60,8 +62,6 @@ public:
 
     SMAAPlugin& self_;
 
-    std::vector<LVecBase2> jitters_;
-    int jitter_index_;
     SMAAStage* smaa_stage_;
 };
 
@@ -73,34 +73,29 @@ SMAAPlugin::Impl::Impl(SMAAPlugin& self): self_(self)
 
 void SMAAPlugin::Impl::on_pre_render_update()
 {
-    // Apply jitter for temporal aa
+    // Jitter for temporal aa is applied by TemporalManager
     if (smaa_stage_->use_reprojection())
     {
-        float jitter_scale = self_.get_setting<rpcore::FloatType>("jitter_amount");
-        const LVecBase2 jitter = jitters_[jitter_index_] * jitter_scale;
-
-        rpcore::Globals::base->get_cam_lens()->set_film_offset(jitter);
-        smaa_stage_->set_jitter_index(jitter_index_);
-
-        // Increase jitter index
-        jitter_index_ += 1;
-        if (jitter_index_ >= static_cast<int>(jitters_.size()))
-            jitter_index_ = 0;
+        rpcore::TemporalManager* temporal_mgr = self_.pipeline_.get_temporal_mgr();
+        temporal_mgr->set_jitter_scale(self_.get_setting<rpcore::FloatType>("jitter_amount"));
+        smaa_stage_->set_jitter_index(static_cast<int>(temporal_mgr->get_jitter_index()));
     }
 }
 
 void SMAAPlugin::Impl::compute_jitters()
 {
-    jitter_index_ = 0;
     float scale = 1.0f / float(rpcore::Globals::native_resolution.get_x());
 
     // Reduce jittering to 35% to avoid flickering
     scale *= 0.35f;
 
+    std::vector<LVecBase2f> jitters;
     for (const LVecBase2& xy: JITTERS.at(self_.get_setting<rpcore::EnumType>("jitter_pattern")))
     {
-        jitters_.push_back((xy * 2 - 1) * scale * 0.5f);
+        jitters.push_back(LCAST(float, (xy * 2 - 1) * scale * 0.5f));
     }
+
+    self_.pipeline_.get_temporal_mgr()->set_jitter_sequence(std::move(jitters));
 }
 
 void SMAAPlugin::Impl::load_textures()
@@ -123,7 +118,7 @@ void SMAAPlugin::Impl::load_textures()
 size_t SMAAPlugin::Impl::get_history_length() const
 {
     if (self_.get_setting<rpcore::BoolType>("use_reprojection"))
-        return jitters_.size();
+        return self_.pipeline_.get_temporal_mgr()->get_jitter_sequence().size();
     return 1;
 }
 
@@ -163,7 +158,8 @@ void SMAAPlugin::on_pre_render_update()
 
 void SMAAPlugin::on_window_resized()
 {
-    impl_->compute_jitters();
+    if (get_setting<rpcore::BoolType>("use_reprojection"))
+        impl_->compute_jitters();
 }
 
 }
@@ -40,6 +40,7 @@ public:
     RENDER_PIPELINE_STAGE_DOWNCAST();
 
     void create() final;
+    void update() final;
     void reload_shaders() final;
 
     virtual void set_enable_volumetric_shadows(bool enable_volumetric_shadows);
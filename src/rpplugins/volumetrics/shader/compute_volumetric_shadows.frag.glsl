@@ -32,6 +32,7 @@
 #pragma include "includes/gbuffer.inc.glsl"
 #pragma include "includes/shadows.inc.glsl"
 #pragma include "includes/noise.inc.glsl"
+#pragma include "includes/reduced_resolution.inc.glsl"
 
 
 #if GET_SETTING(pssm, use_pcf)
@@ -59,7 +60,7 @@ void main() {
         return;
     #endif
 
-    vec2 texcoord = get_half_texcoord();
+    vec2 texcoord = get_reduced_texcoord();
 
     vec3 start_pos = MainSceneData.camera_pos;
     vec3 end_pos = get_gbuffer_position(GBuffer, texcoord);
@@ -22,7 +22,9 @@
 
 #include "../include/volumetrics_stage.hpp"
 
+#include <render_pipeline/rpcore/render_pipeline.hpp>
 #include <render_pipeline/rpcore/render_target.hpp>
+#include <render_pipeline/rpcore/util/bilateral_upscaler.hpp>
 
 namespace rpplugins {
 
@@ -42,8 +44,8 @@ public:
 
     bool enable_volumetric_shadows_ = false;
 
+    std::unique_ptr<rpcore::BilateralUpscaler> upscaler_;
     rpcore::RenderTarget* target_;
-    rpcore::RenderTarget* target_upscale_;
     rpcore::RenderTarget* target_combine_;
 };
 
@@ -58,17 +60,10 @@ void VolumetricsStage::Impl::create()
 {
     if (enable_volumetric_shadows_)
     {
-        target_ = self_.create_target("ComputeVolumetrics");
-        target_->set_size(-2);
-        target_->add_color_attachment(16, true);
-        target_->prepare_buffer();
-
-        target_upscale_ = self_.create_target("Upscale");
-        target_upscale_->add_color_attachment(16, true);
-        target_upscale_->prepare_buffer();
-
-        target_upscale_->set_shader_input(ShaderInput("SourceTex", target_->get_color_tex()));
-        target_upscale_->set_shader_input(ShaderInput("upscaleWeights", LVecBase2f(0.001, 0.001)));
+        upscaler_ = std::make_unique<rpcore::BilateralUpscaler>(self_,
+            rpcore::BilateralUpscaler::get_stage_mode(self_.pipeline_, self_.get_stage_id(), rpcore::BilateralUpscaler::Mode::half),
+            LVecBase2f(0.001f, 0.001f));
+        target_ = upscaler_->create("ComputeVolumetrics", LVecBase4i(16));
     }
 
     target_combine_ = self_.create_target("CombineVolumetrics");
@@ -76,7 +71,7 @@ void VolumetricsStage::Impl::create()
     target_combine_->prepare_buffer();
 
     if (enable_volumetric_shadows_)
-        target_combine_->set_shader_input(ShaderInput("VolumetricsTex", target_upscale_->get_color_tex()));
+        target_combine_->set_shader_input(ShaderInput("VolumetricsTex", upscaler_->get_result_tex()));
 }
 
 void VolumetricsStage::Impl::reload_shaders()
@@ -84,7 +79,7 @@ void VolumetricsStage::Impl::reload_shaders()
     if (enable_volumetric_shadows_)
     {
         target_->set_shader(self_.load_plugin_shader({"compute_volumetric_shadows.frag.glsl"}));
-        target_upscale_->set_shader(self_.load_plugin_shader({"/$$rp/shader/bilateral_upscale.frag.glsl"}));
+        upscaler_->reload_shaders();
     }
 
     target_combine_->set_shader(self_.load_plugin_shader({"apply_volumetrics.frag.glsl"}));
@@ -120,6 +115,12 @@ void VolumetricsStage::create()
     impl_->create();
 }
 
+void VolumetricsStage::update()
+{
+    if (impl_->upscaler_)
+        impl_->upscaler_->update();
+}
+
 void VolumetricsStage::reload_shaders()
 {
     impl_->reload_shaders();
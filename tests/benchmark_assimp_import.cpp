@@ -0,0 +1,231 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Import a large synthetic rig through AssimpLoader.
+ *
+ * The rig has a root bone with chains of bones, and each mesh is skinned to a few
+ * chains. Unrelated nodes are added to the scene, so that a search of the whole tree
+ * for each bone is expensive. The joints of the loaded characters are checked against
+ * the node hierarchy found by aiNode::FindNode, which is the reference search.
+ *
+ * usage: benchmark_assimp_import [chain count] [chain length] [mesh count] [repeat count]
+ */
+
+#include <animBundleNode.h>
+#include <character.h>
+#include <virtualFileMountRamdisk.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+
+#include "rptest.hpp"
+#include "rptest_assimp.hpp"
+
+namespace {
+
+std::string get_bone_name(int chain, int depth)
+{
+    return "bone_" + std::to_string(chain) + "_" + std::to_string(depth);
+}
+
+/** Create the chains of @p mesh in the rig. */
+std::vector<int> get_mesh_chains(int mesh, int chain_count)
+{
+    return { mesh % chain_count, (mesh * 7 + 3) % chain_count };
+}
+
+std::unique_ptr<aiScene> make_rig_scene(int chain_count, int chain_length, int mesh_count)
+{
+    auto scene = std::make_unique<aiScene>();
+    scene->mRootNode = new aiNode("root");
+
+    aiNode* rig_root = new aiNode("rig_root");
+    std::vector<aiNode*> chains;
+    for (int c = 0; c < chain_count; ++c)
+    {
+        aiNode* chain = new aiNode(get_bone_name(c, 0));
+        aiNode* parent = chain;
+        for (int d = 1; d < chain_length; ++d)
+        {
+            aiNode* bone = new aiNode(get_bone_name(c, d));
+            aiMatrix4x4::Translation(aiVector3D(0, 0, 0.1f), bone->mTransformation);
+            rptest::set_children(parent, { bone });
+            parent = bone;
+        }
+        chains.push_back(chain);
+    }
+    rptest::set_children(rig_root, chains);
+
+    // props which are not bones, placed before the rig in the depth-first order.
+    aiNode* props = new aiNode("props");
+    std::vector<aiNode*> prop_nodes;
+    for (int k = 0; k < chain_count * chain_length * 4; ++k)
+        prop_nodes.push_back(new aiNode("prop_" + std::to_string(k)));
+    rptest::set_children(props, prop_nodes);
+
+    std::vector<aiNode*> root_children = { props, rig_root };
+    scene->mNumMeshes = static_cast<unsigned int>(mesh_count);
+    scene->mMeshes = new aiMesh*[mesh_count];
+    for (int m = 0; m < mesh_count; ++m)
+    {
+        const std::string name = "mesh_" + std::to_string(m);
+
+        std::vector<std::string> bone_names = { "rig_root" };
+        for (int chain: get_mesh_chains(m, chain_count))
+        {
+            for (int d = 0; d < chain_length; ++d)
+                bone_names.push_back(get_bone_name(chain, d));
+        }
+        scene->mMeshes[m] = rptest::make_skinned_mesh(name, bone_names);
+
+        aiNode* mesh_node = new aiNode(name);
+        mesh_node->mNumMeshes = 1;
+        mesh_node->mMeshes = new unsigned int[1]{ static_cast<unsigned int>(m) };
+        root_children.push_back(mesh_node);
+    }
+    rptest::set_children(scene->mRootNode, root_children);
+
+    scene->mNumMaterials = 1;
+    scene->mMaterials = new aiMaterial*[1]{ new aiMaterial };
+
+    const unsigned int num_keys = 31;
+    aiAnimation* anim = new aiAnimation;
+    anim->mName = "anim";
+    anim->mTicksPerSecond = 30;
+    anim->mDuration = num_keys - 1;
+    anim->mNumChannels = static_cast<unsigned int>(chain_count * chain_length + 1);
+    anim->mChannels = new aiNodeAnim*[anim->mNumChannels];
+    anim->mChannels[0] = rptest::make_node_anim("rig_root", num_keys);
+    for (int c = 0; c < chain_count; ++c)
+    {
+        for (int d = 0; d < chain_length; ++d)
+        {
+            aiNodeAnim* channel = rptest::make_node_anim(get_bone_name(c, d), num_keys);
+            for (unsigned int k = 0; k < num_keys; ++k)
+                channel->mRotationKeys[k].mValue = aiQuaternion(aiVector3D(1, 0, 0), 0.01f * k * (d + 1));
+            anim->mChannels[1 + c * chain_length + d] = channel;
+        }
+    }
+    scene->mNumAnimations = 1;
+    scene->mAnimations = new aiAnimation*[1]{ anim };
+
+    return scene;
+}
+
+/** Collect the parent name of each joint. */
+void collect_joint_parents(PartGroup* group, std::map<std::string, std::string>& parents)
+{
+    for (int k = 0, k_end = group->get_num_children(); k < k_end; ++k)
+    {
+        PartGroup* child = group->get_child(k);
+        parents[child->get_name()] = group->get_name();
+        collect_joint_parents(child, parents);
+    }
+}
+
+/** Check that the joints of each mesh have the parents of the nodes in the scene. */
+bool check_characters(const aiScene& scene, ModelRoot* root)
+{
+    const NodePathCollection characters = NodePath(root).find_all_matches("**/+Character");
+    if (characters.get_num_paths() != static_cast<int>(scene.mNumMeshes))
+        return false;
+
+    for (int k = 0, k_end = characters.get_num_paths(); k < k_end; ++k)
+    {
+        Character* character = DCAST(Character, characters.get_path(k).node());
+
+        const aiMesh* mesh = nullptr;
+        for (unsigned int m = 0; m < scene.mNumMeshes; ++m)
+        {
+            if (character->get_name() == scene.mMeshes[m]->mName.C_Str())
+                mesh = scene.mMeshes[m];
+        }
+        if (!mesh)
+            return false;
+
+        std::map<std::string, std::string> parents;
+        collect_joint_parents(character->get_bundle(0), parents);
+
+        for (unsigned int b = 0; b < mesh->mNumBones; ++b)
+        {
+            const aiNode* node = scene.mRootNode->FindNode(mesh->mBones[b]->mName);
+            const auto found = parents.find(node->mName.C_Str());
+            if (found == parents.end())
+                return false;
+
+            // the parent of the root bone is the skeleton group.
+            const std::string expected_parent = node->mParent == scene.mRootNode ? "<skeleton>" : node->mParent->mName.C_Str();
+            if (found->second != expected_parent)
+                return false;
+        }
+
+        // the animation has the channels of all joints.
+        const NodePath bundle_node = characters.get_path(k).find("+AnimBundleNode");
+        if (bundle_node.is_empty())
+            return false;
+        AnimBundle* bundle = DCAST(AnimBundleNode, bundle_node.node())->get_bundle();
+        for (const auto& joint: parents)
+        {
+            if (joint.first != "<skeleton>" && !bundle->find_child(joint.first))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int chain_count = argc > 1 ? std::atoi(argv[1]) : 32;
+    const int chain_length = argc > 2 ? std::atoi(argv[2]) : 16;
+    const int mesh_count = argc > 3 ? std::atoi(argv[3]) : 64;
+    const int repeat_count = argc > 4 ? std::atoi(argv[4]) : 3;
+
+    VirtualFileSystem::get_global_ptr()->mount(new VirtualFileMountRamdisk, "/rptest", 0);
+    assimp_optimize_meshes.set_value(false);
+
+    const Filename path("/rptest/rig.assbin");
+    const auto scene = make_rig_scene(chain_count, chain_length, mesh_count);
+    RPTEST_CHECK(rptest::write_scene(*scene, path));
+
+    double import_time = 0;
+    for (int k = 0; k < repeat_count; ++k)
+    {
+        PT(ModelRoot) root;
+        import_time += rptest::measure([&]() {
+            root = rptest::load_model(path);
+        });
+
+        RPTEST_CHECK(root != nullptr);
+        if (root)
+            RPTEST_CHECK(check_characters(*scene, root));
+    }
+
+    std::cout << "bones: " << chain_count * chain_length + 1 << ", meshes: " << mesh_count
+        << ", repeats: " << repeat_count << std::endl;
+    std::cout << "AssimpLoader: " << import_time * 1000.0 / (std::max)(repeat_count, 1) << " ms per import" << std::endl;
+
+    return rptest::result();
+}
@@ -0,0 +1,141 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Compare LerpIntervalBatch with stepping every LerpNodePathInterval by CLerpNodePathInterval.
+ *
+ * Both paths step the same set of lerps on two identical node sets, and the transforms
+ * should be identical after every frame.
+ *
+ * usage: benchmark_lerp_interval [node count] [frame count]
+ */
+
+#include <load_prc_file.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include <render_pipeline/rppanda/interval/lerp_interval.hpp>
+#include <render_pipeline/rppanda/interval/lerp_interval_batch.hpp>
+
+#include "rptest.hpp"
+
+using namespace rppanda;
+
+namespace {
+
+struct Scene
+{
+    NodePath root;
+    std::vector<PT(LerpNodePathInterval)> intervals;
+};
+
+Scene make_scene(int node_count)
+{
+    Scene scene;
+    scene.root = NodePath("root");
+    for (int k = 0; k < node_count; ++k)
+    {
+        NodePath np = scene.root.attach_new_node("prop");
+        np.set_pos(PN_stdfloat(k), 0, 0);
+
+        const PN_stdfloat f = PN_stdfloat(k % 17);
+        switch (k % 4)
+        {
+        case 0:
+            scene.intervals.push_back(new LerpPosInterval(np, 2.0, LVecBase3(f, 2 * f, -f)));
+            break;
+        case 1:
+            scene.intervals.push_back(new LerpHprInterval(np, 3.0, LVecBase3(10 * f, -f, f),
+                boost::none, boost::none, {}, CLerpInterval::BT_ease_in_out));
+            break;
+        case 2:
+            scene.intervals.push_back(new LerpPosHprInterval(np, 1.5, LVecBase3(f), LVecBase3(-f, f, 0)));
+            break;
+        default:
+            // batched pos lerp followed by a quaternion lerp on the same node, which is
+            // stepped by CLerpNodePathInterval and should see the pos lerp applied.
+            scene.intervals.push_back(new LerpPosInterval(np, 2.5, LVecBase3(-f, f, 1)));
+            scene.intervals.push_back(new LerpQuatInterval(np, 2.5, LQuaternion(0.5f, 0.5f, 0.5f, 0.5f)));
+            break;
+        }
+    }
+    return scene;
+}
+
+void step(Scene& scene, double t)
+{
+    for (auto& ival: scene.intervals)
+        ival->set_t((std::min)(t, ival->get_duration()));
+}
+
+bool is_same(const Scene& a, const Scene& b)
+{
+    for (int k = 0, k_end = a.root.get_num_children(); k < k_end; ++k)
+    {
+        if (a.root.get_child(k).get_mat() != b.root.get_child(k).get_mat())
+            return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int node_count = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const int frame_count = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    load_prc_file_data("", "lerp-interval-batch true");
+
+    LerpIntervalBatch* batch = LerpIntervalBatch::get_global_ptr();
+
+    Scene reference = make_scene(node_count);
+    Scene batched = make_scene(node_count);
+
+    double reference_time = 0;
+    double batched_time = 0;
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        const double t = frame / 30.0;
+
+        reference_time += rptest::measure([&]() {
+            step(reference, t);
+        });
+
+        batched_time += rptest::measure([&]() {
+            // intervals are stepped directly, so the global interval manager is empty.
+            batch->begin_capture();
+            RPTEST_CHECK(batch->is_capturing());
+            step(batched, t);
+            batch->end_capture();
+        });
+
+        RPTEST_CHECK(is_same(reference, batched));
+    }
+
+    std::cout << "nodes: " << node_count << ", frames: " << frame_count << std::endl;
+    std::cout << "CLerpNodePathInterval: " << reference_time * 1000.0 << " ms" << std::endl;
+    std::cout << "LerpIntervalBatch: " << batched_time * 1000.0 << " ms" << std::endl;
+
+    return rptest::result();
+}
@@ -0,0 +1,67 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+
+/**
+ * Minimal check macros for the tests.
+ *
+ * RPTEST_CHECK logs the failed condition and counts it. A test returns rptest::result()
+ * from main(), so CTest reports a failure if any check failed.
+ */
+
+namespace rptest {
+
+inline int& failure_count()
+{
+    static int count = 0;
+    return count;
+}
+
+inline void report_failure(const char* expr, const char* file, int line)
+{
+    std::cerr << file << "(" << line << "): check failed: " << expr << std::endl;
+    ++failure_count();
+}
+
+inline int result()
+{
+    if (failure_count() > 0)
+        std::cerr << failure_count() << " check(s) failed." << std::endl;
+    return failure_count() > 0 ? 1 : 0;
+}
+
+/** Return the seconds to run @p func. */
+template <class Func>
+double measure(Func&& func)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+}
+
+#define RPTEST_CHECK(expr) \
+    do { if (!(expr)) rptest::report_failure(#expr, __FILE__, __LINE__); } while (false)
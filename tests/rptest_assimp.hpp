@@ -0,0 +1,140 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <virtualFileSystem.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <assimp/Exporter.hpp>
+#include <assimp/scene.h>
+
+#include "assimpLoader.h"
+#include "config_assimp.h"
+
+/**
+ * Helpers to build Assimp scenes in the tests of rpassimp.
+ *
+ * Scenes are exported with the binary format of Assimp, which keeps all data as it is,
+ * and are loaded through rpassimp::AssimpLoader.
+ */
+
+namespace rptest {
+
+inline void set_children(aiNode* parent, const std::vector<aiNode*>& children)
+{
+    parent->mNumChildren = static_cast<unsigned int>(children.size());
+    parent->mChildren = new aiNode*[children.size()];
+    for (size_t k = 0; k < children.size(); ++k)
+    {
+        children[k]->mParent = parent;
+        parent->mChildren[k] = children[k];
+    }
+}
+
+inline aiMesh* make_triangle_mesh(const std::string& name)
+{
+    aiMesh* mesh = new aiMesh;
+    mesh->mName = name;
+    mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+    mesh->mMaterialIndex = 0;
+
+    mesh->mNumVertices = 3;
+    mesh->mVertices = new aiVector3D[3]{ aiVector3D(0, 0, 0), aiVector3D(1, 0, 0), aiVector3D(0, 0, 1) };
+
+    mesh->mNumFaces = 1;
+    mesh->mFaces = new aiFace[1];
+    mesh->mFaces[0].mNumIndices = 3;
+    mesh->mFaces[0].mIndices = new unsigned int[3]{ 0, 1, 2 };
+
+    return mesh;
+}
+
+/** Create a triangle whose vertices are shared by all bones. */
+inline aiMesh* make_skinned_mesh(const std::string& name, const std::vector<std::string>& bone_names)
+{
+    aiMesh* mesh = make_triangle_mesh(name);
+
+    const auto num_bones = static_cast<unsigned int>(bone_names.size());
+    mesh->mNumBones = num_bones;
+    mesh->mBones = new aiBone*[num_bones];
+    for (unsigned int k = 0; k < num_bones; ++k)
+    {
+        aiBone* bone = new aiBone;
+        bone->mName = bone_names[k];
+        bone->mNumWeights = 3;
+        bone->mWeights = new aiVertexWeight[3];
+        for (unsigned int v = 0; v < 3; ++v)
+            bone->mWeights[v] = aiVertexWeight(v, 1.0f / num_bones);
+        mesh->mBones[k] = bone;
+    }
+
+    return mesh;
+}
+
+/** Create a channel with @p num_keys keys of identity transforms. */
+inline aiNodeAnim* make_node_anim(const std::string& node_name, unsigned int num_keys)
+{
+    aiNodeAnim* channel = new aiNodeAnim;
+    channel->mNodeName = node_name;
+    channel->mNumPositionKeys = num_keys;
+    channel->mPositionKeys = new aiVectorKey[num_keys];
+    channel->mNumRotationKeys = num_keys;
+    channel->mRotationKeys = new aiQuatKey[num_keys];
+    channel->mNumScalingKeys = num_keys;
+    channel->mScalingKeys = new aiVectorKey[num_keys];
+    for (unsigned int k = 0; k < num_keys; ++k)
+    {
+        channel->mPositionKeys[k] = aiVectorKey(k, aiVector3D(0));
+        channel->mRotationKeys[k] = aiQuatKey(k, aiQuaternion());
+        channel->mScalingKeys[k] = aiVectorKey(k, aiVector3D(1));
+    }
+    return channel;
+}
+
+inline bool write_scene(const aiScene& scene, const Filename& path)
+{
+    Assimp::Exporter exporter;
+    const aiExportDataBlob* blob = exporter.ExportToBlob(&scene, "assbin");
+    if (!blob)
+    {
+        std::cerr << "Failed to export the scene: " << exporter.GetErrorString() << std::endl;
+        return false;
+    }
+
+    return VirtualFileSystem::get_global_ptr()->write_file(path,
+        std::string(static_cast<const char*>(blob->data), blob->size), false);
+}
+
+inline PT(ModelRoot) load_model(const Filename& path)
+{
+    PT(rpassimp::AssimpLoader) loader = new rpassimp::AssimpLoader;
+    if (!loader->read(path))
+        return nullptr;
+    loader->build_graph();
+    return loader->_root;
+}
+
+}
@@ -0,0 +1,277 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of the animation conversion of rpassimp.
+ *
+ * A skinned scene is built with Assimp and loaded through AssimpLoader. Two meshes
+ * share the skeleton root, and the second mesh has more bones, so its animation must
+ * have the channels of all joints. The converted channels are compared by bits with
+ * and without assimp-compress-anim.
+ *
+ * If RPTEST_ASSIMP_SAMPLES is set to a directory, the models in the directory are also
+ * compared by bits with and without assimp-compress-anim.
+ */
+
+#include <animBundleNode.h>
+#include <animChannelMatrixXfmTable.h>
+#include <character.h>
+#include <virtualFileMountRamdisk.h>
+#include <virtualFileSystem.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "rptest.hpp"
+#include "rptest_assimp.hpp"
+
+using namespace rpassimp;
+
+namespace {
+
+/**
+ * Create a skeleton of bone_a - bone_b - bone_c. mesh_0 uses bone_a and bone_b,
+ * and mesh_1 uses all bones.
+ */
+std::unique_ptr<aiScene> make_skinned_scene()
+{
+    auto scene = std::make_unique<aiScene>();
+
+    scene->mRootNode = new aiNode("root");
+    aiNode* bone_a = new aiNode("bone_a");
+    aiNode* bone_b = new aiNode("bone_b");
+    aiNode* bone_c = new aiNode("bone_c");
+    aiMatrix4x4::Translation(aiVector3D(0, 0, 1), bone_b->mTransformation);
+    aiMatrix4x4::Translation(aiVector3D(0, 0, 1), bone_c->mTransformation);
+    rptest::set_children(bone_b, { bone_c });
+    rptest::set_children(bone_a, { bone_b });
+
+    aiNode* mesh_nodes[2] = { new aiNode("mesh_0"), new aiNode("mesh_1") };
+    for (unsigned int k = 0; k < 2; ++k)
+    {
+        mesh_nodes[k]->mNumMeshes = 1;
+        mesh_nodes[k]->mMeshes = new unsigned int[1]{ k };
+    }
+    rptest::set_children(scene->mRootNode, { bone_a, mesh_nodes[0], mesh_nodes[1] });
+
+    scene->mNumMeshes = 2;
+    scene->mMeshes = new aiMesh*[2]{
+        rptest::make_skinned_mesh("mesh_0", { "bone_a", "bone_b" }),
+        rptest::make_skinned_mesh("mesh_1", { "bone_a", "bone_b", "bone_c" }),
+    };
+
+    scene->mNumMaterials = 1;
+    scene->mMaterials = new aiMaterial*[1]{ new aiMaterial };
+
+    // bone_a is constant with a negative zero, bone_b rotates and bone_c moves.
+    const unsigned int num_keys = 11;
+    aiAnimation* anim = new aiAnimation;
+    anim->mName = "anim";
+    anim->mTicksPerSecond = 10;
+    anim->mDuration = num_keys - 1;
+    anim->mNumChannels = 3;
+    anim->mChannels = new aiNodeAnim*[3]{
+        rptest::make_node_anim("bone_a", num_keys),
+        rptest::make_node_anim("bone_b", num_keys),
+        rptest::make_node_anim("bone_c", num_keys),
+    };
+    for (unsigned int k = 0; k < num_keys; ++k)
+    {
+        anim->mChannels[0]->mPositionKeys[k].mValue = aiVector3D(0, -0.0f, 0);
+        anim->mChannels[1]->mPositionKeys[k].mValue = aiVector3D(0, 0, 1);
+        anim->mChannels[1]->mRotationKeys[k].mValue = aiQuaternion(aiVector3D(0, 0, 1), 0.1f * k);
+        anim->mChannels[2]->mPositionKeys[k].mValue = aiVector3D(0.05f * k, 0, 1);
+    }
+    scene->mNumAnimations = 1;
+    scene->mAnimations = new aiAnimation*[1]{ anim };
+
+    return scene;
+}
+
+PT(ModelRoot) load_model(const Filename& path, bool compress_anim)
+{
+    assimp_compress_anim.set_value(compress_anim);
+    return rptest::load_model(path);
+}
+
+void collect_channels(AnimGroup* group, std::vector<AnimChannelMatrixXfmTable*>& channels)
+{
+    if (group->is_of_type(AnimChannelMatrixXfmTable::get_class_type()))
+        channels.push_back(DCAST(AnimChannelMatrixXfmTable, group));
+
+    for (int k = 0, k_end = group->get_num_children(); k < k_end; ++k)
+        collect_channels(group->get_child(k), channels);
+}
+
+std::vector<AnimBundle*> get_bundles(ModelRoot* root)
+{
+    std::vector<AnimBundle*> bundles;
+    const NodePathCollection nodes = NodePath(root).find_all_matches("**/+AnimBundleNode");
+    for (int k = 0, k_end = nodes.get_num_paths(); k < k_end; ++k)
+        bundles.push_back(DCAST(AnimBundleNode, nodes.get_path(k).node())->get_bundle());
+    return bundles;
+}
+
+/** Compare the matrices of all channels in all frames by bits. */
+bool is_same_animation(ModelRoot* lhs, ModelRoot* rhs)
+{
+    const auto lhs_bundles = get_bundles(lhs);
+    const auto rhs_bundles = get_bundles(rhs);
+    if (lhs_bundles.size() != rhs_bundles.size())
+        return false;
+
+    for (size_t b = 0; b < lhs_bundles.size(); ++b)
+    {
+        const int num_frames = lhs_bundles[b]->get_num_frames();
+        if (num_frames != rhs_bundles[b]->get_num_frames() ||
+            lhs_bundles[b]->get_base_frame_rate() != rhs_bundles[b]->get_base_frame_rate())
+            return false;
+
+        std::vector<AnimChannelMatrixXfmTable*> lhs_channels;
+        std::vector<AnimChannelMatrixXfmTable*> rhs_channels;
+        collect_channels(lhs_bundles[b], lhs_channels);
+        collect_channels(rhs_bundles[b], rhs_channels);
+        if (lhs_channels.size() != rhs_channels.size())
+            return false;
+
+        for (size_t c = 0; c < lhs_channels.size(); ++c)
+        {
+            if (lhs_channels[c]->get_name() != rhs_channels[c]->get_name())
+                return false;
+
+            for (int f = 0; f < num_frames; ++f)
+            {
+                LMatrix4 lhs_mat;
+                LMatrix4 rhs_mat;
+                lhs_channels[c]->get_value(f, lhs_mat);
+                rhs_channels[c]->get_value(f, rhs_mat);
+                if (std::memcmp(lhs_mat.get_data(), rhs_mat.get_data(), sizeof(PN_stdfloat) * 16) != 0)
+                {
+                    std::cerr << "Channel " << lhs_channels[c]->get_name() << " differs in frame " << f << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+Character* find_character(ModelRoot* root, const std::string& name)
+{
+    const NodePathCollection characters = NodePath(root).find_all_matches("**/+Character");
+    for (int k = 0, k_end = characters.get_num_paths(); k < k_end; ++k)
+    {
+        if (characters.get_path(k).get_name() == name)
+            return DCAST(Character, characters.get_path(k).node());
+    }
+    return nullptr;
+}
+
+AnimBundle* find_bundle(ModelRoot* root, const std::string& character_name)
+{
+    Character* character = find_character(root, character_name);
+    if (!character)
+        return nullptr;
+
+    const NodePath bundle_node = NodePath(character).find("+AnimBundleNode");
+    return bundle_node.is_empty() ? nullptr : DCAST(AnimBundleNode, bundle_node.node())->get_bundle();
+}
+
+void test_shared_skeleton()
+{
+    const Filename path("/rptest/skinned.assbin");
+    RPTEST_CHECK(rptest::write_scene(*make_skinned_scene(), path));
+
+    PT(ModelRoot) root = load_model(path, false);
+    RPTEST_CHECK(root != nullptr);
+    if (!root)
+        return;
+
+    AnimBundle* bundle_0 = find_bundle(root, "mesh_0");
+    AnimBundle* bundle_1 = find_bundle(root, "mesh_1");
+    RPTEST_CHECK(bundle_0 && bundle_1);
+    if (!bundle_0 || !bundle_1)
+        return;
+
+    // mesh_1 has bone_c which mesh_0 does not, so it cannot share the bundle of mesh_0.
+    RPTEST_CHECK(bundle_0->find_child("bone_b") != nullptr);
+    RPTEST_CHECK(bundle_0->find_child("bone_c") == nullptr);
+    RPTEST_CHECK(bundle_1 != bundle_0);
+    RPTEST_CHECK(bundle_1->find_child("bone_c") != nullptr);
+
+    RPTEST_CHECK(bundle_1->get_num_frames() == 11);
+    RPTEST_CHECK(bundle_1->get_base_frame_rate() == 10);
+
+    // the bundle binds to all joints of the character.
+    RPTEST_CHECK(find_character(root, "mesh_1")->find_joint("bone_c") != nullptr);
+
+    PT(ModelRoot) compressed_root = load_model(path, true);
+    RPTEST_CHECK(compressed_root != nullptr);
+    if (compressed_root)
+        RPTEST_CHECK(is_same_animation(root, compressed_root));
+}
+
+void test_sample_assets()
+{
+    const char* samples_dir = std::getenv("RPTEST_ASSIMP_SAMPLES");
+    if (!samples_dir)
+    {
+        std::cout << "RPTEST_ASSIMP_SAMPLES is not set. Sample assets are skipped." << std::endl;
+        return;
+    }
+
+    VirtualFileSystem* vfs = VirtualFileSystem::get_global_ptr();
+    PT(VirtualFileList) files = vfs->scan_directory(Filename::from_os_specific(samples_dir));
+    RPTEST_CHECK(files != nullptr);
+    if (!files)
+        return;
+
+    for (size_t k = 0, k_end = files->get_num_files(); k < k_end; ++k)
+    {
+        const Filename path = files->get_file(k)->get_filename();
+        PT(ModelRoot) root = load_model(path, false);
+        if (!root || get_bundles(root).empty())
+            continue;
+
+        PT(ModelRoot) compressed_root = load_model(path, true);
+        std::cout << "Comparing animations of " << path << std::endl;
+        RPTEST_CHECK(compressed_root != nullptr);
+        if (compressed_root)
+            RPTEST_CHECK(is_same_animation(root, compressed_root));
+    }
+}
+
+}
+
+int main()
+{
+    VirtualFileSystem::get_global_ptr()->mount(new VirtualFileMountRamdisk, "/rptest", 0);
+
+    // keep the meshes of the skinned scene separated.
+    assimp_optimize_meshes.set_value(false);
+
+    test_shared_skeleton();
+    test_sample_assets();
+
+    return rptest::result();
+}
@@ -0,0 +1,225 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of the embedded textures of rpassimp.
+ *
+ * A scene with raw and PNG embedded textures is loaded with one and several decoding
+ * threads, and the pixels of the loaded textures are compared with the source images.
+ */
+
+#include <geomNode.h>
+#include <pnmImage.h>
+#include <textureAttrib.h>
+#include <virtualFileMountRamdisk.h>
+
+#include <cstring>
+#include <sstream>
+
+#include "rptest.hpp"
+#include "rptest_assimp.hpp"
+
+namespace {
+
+constexpr int NUM_PNG_TEXTURES = 8;
+constexpr int TEXTURE_WIDTH = 13;
+constexpr int TEXTURE_HEIGHT = 7;
+
+/** Deterministic image which differs by @p seed and is not symmetric. */
+PNMImage make_image(int seed)
+{
+    PNMImage image(TEXTURE_WIDTH, TEXTURE_HEIGHT, 4);
+    for (int y = 0; y < TEXTURE_HEIGHT; ++y)
+    {
+        for (int x = 0; x < TEXTURE_WIDTH; ++x)
+        {
+            image.set_xel_val(x, y, (x * 19 + seed * 7) % 256, (y * 37 + seed * 11) % 256, (x * y + seed) % 256);
+            image.set_alpha_val(x, y, (255 - x * 5 - seed) % 256);
+        }
+    }
+    return image;
+}
+
+aiTexture* make_png_texture(const PNMImage& image)
+{
+    std::ostringstream out;
+    image.write(out, "image.png");
+    const std::string data = out.str();
+
+    aiTexture* tex = new aiTexture;
+    tex->mWidth = static_cast<unsigned int>(data.size());
+    tex->mHeight = 0;
+    std::strncpy(tex->achFormatHint, "png", sizeof(tex->achFormatHint));
+    tex->pcData = new aiTexel[(data.size() + sizeof(aiTexel) - 1) / sizeof(aiTexel)];
+    std::memcpy(tex->pcData, data.data(), data.size());
+    return tex;
+}
+
+aiTexture* make_raw_texture()
+{
+    aiTexture* tex = new aiTexture;
+    tex->mWidth = TEXTURE_WIDTH;
+    tex->mHeight = TEXTURE_HEIGHT;
+    tex->pcData = new aiTexel[TEXTURE_WIDTH * TEXTURE_HEIGHT];
+    for (int k = 0; k < TEXTURE_WIDTH * TEXTURE_HEIGHT; ++k)
+    {
+        aiTexel& texel = tex->pcData[k];
+        texel.b = static_cast<unsigned char>(k);
+        texel.g = static_cast<unsigned char>(k * 3);
+        texel.r = static_cast<unsigned char>(k * 7);
+        texel.a = static_cast<unsigned char>(255 - k);
+    }
+    return tex;
+}
+
+/** Create a triangle for each texture, and mesh_k uses the texture k. */
+std::unique_ptr<aiScene> make_textured_scene()
+{
+    const unsigned int num_textures = NUM_PNG_TEXTURES + 1;
+
+    auto scene = std::make_unique<aiScene>();
+    scene->mRootNode = new aiNode("root");
+
+    scene->mNumTextures = num_textures;
+    scene->mTextures = new aiTexture*[num_textures];
+    for (unsigned int k = 0; k < NUM_PNG_TEXTURES; ++k)
+        scene->mTextures[k] = make_png_texture(make_image(k));
+    scene->mTextures[NUM_PNG_TEXTURES] = make_raw_texture();
+
+    scene->mNumMeshes = num_textures;
+    scene->mMeshes = new aiMesh*[num_textures];
+    scene->mNumMaterials = num_textures;
+    scene->mMaterials = new aiMaterial*[num_textures];
+    std::vector<aiNode*> mesh_nodes;
+    for (unsigned int k = 0; k < num_textures; ++k)
+    {
+        const std::string name = "mesh_" + std::to_string(k);
+
+        aiMesh* mesh = rptest::make_triangle_mesh(name);
+        mesh->mMaterialIndex = k;
+        scene->mMeshes[k] = mesh;
+
+        aiMaterial* mat = new aiMaterial;
+        const aiString path("*" + std::to_string(k));
+        mat->AddProperty(&path, AI_MATKEY_TEXTURE_DIFFUSE(0));
+        scene->mMaterials[k] = mat;
+
+        aiNode* node = new aiNode(name);
+        node->mNumMeshes = 1;
+        node->mMeshes = new unsigned int[1]{ k };
+        mesh_nodes.push_back(node);
+    }
+    rptest::set_children(scene->mRootNode, mesh_nodes);
+
+    return scene;
+}
+
+/** Get the base color texture of mesh_k. */
+Texture* get_texture(ModelRoot* root, int index)
+{
+    const NodePath np = NodePath(root).find("**/mesh_" + std::to_string(index));
+    if (np.is_empty() || !np.node()->is_geom_node())
+        return nullptr;
+
+    const TextureAttrib* tattr;
+    if (!DCAST(GeomNode, np.node())->get_geom_state(0)->get_attrib(tattr))
+        return nullptr;
+
+    for (int k = 0, k_end = tattr->get_num_on_stages(); k < k_end; ++k)
+    {
+        TextureStage* stage = tattr->get_on_stage(k);
+        if (stage->get_name() == "0")
+            return tattr->get_on_texture(stage);
+    }
+    return nullptr;
+}
+
+bool is_same_image(const PNMImage& lhs, const PNMImage& rhs)
+{
+    if (lhs.get_x_size() != rhs.get_x_size() || lhs.get_y_size() != rhs.get_y_size() ||
+        lhs.get_num_channels() != rhs.get_num_channels())
+        return false;
+
+    for (int y = 0; y < lhs.get_y_size(); ++y)
+    {
+        for (int x = 0; x < lhs.get_x_size(); ++x)
+        {
+            if (lhs.get_xel_val(x, y) != rhs.get_xel_val(x, y) || lhs.get_alpha_val(x, y) != rhs.get_alpha_val(x, y))
+                return false;
+        }
+    }
+    return true;
+}
+
+void test_textures(const aiScene& scene, const Filename& path, int num_threads)
+{
+    assimp_texture_threads.set_value(num_threads);
+
+    PT(ModelRoot) root = rptest::load_model(path);
+    RPTEST_CHECK(root != nullptr);
+    if (!root)
+        return;
+
+    for (int k = 0; k < NUM_PNG_TEXTURES; ++k)
+    {
+        Texture* tex = get_texture(root, k);
+        RPTEST_CHECK(tex != nullptr);
+        if (!tex)
+            continue;
+
+        PNMImage image;
+        RPTEST_CHECK(tex->store(image));
+        RPTEST_CHECK(is_same_image(image, make_image(k)));
+    }
+
+    // raw texels are the RAM image as they are.
+    Texture* raw_tex = get_texture(root, NUM_PNG_TEXTURES);
+    RPTEST_CHECK(raw_tex != nullptr);
+    if (raw_tex)
+    {
+        RPTEST_CHECK(raw_tex->get_x_size() == TEXTURE_WIDTH);
+        RPTEST_CHECK(raw_tex->get_y_size() == TEXTURE_HEIGHT);
+        const CPTA_uchar data = raw_tex->get_ram_image();
+        const aiTexture& source = *scene.mTextures[NUM_PNG_TEXTURES];
+        RPTEST_CHECK(data.size() == TEXTURE_WIDTH * TEXTURE_HEIGHT * sizeof(aiTexel));
+        RPTEST_CHECK(std::memcmp(data.p(), source.pcData, data.size()) == 0);
+    }
+}
+
+}
+
+int main()
+{
+    VirtualFileSystem::get_global_ptr()->mount(new VirtualFileMountRamdisk, "/rptest", 0);
+
+    // keep a mesh and a material for each texture.
+    assimp_optimize_meshes.set_value(false);
+    assimp_remove_redundant_materials.set_value(false);
+
+    const Filename path("/rptest/textured.assbin");
+    const auto scene = make_textured_scene();
+    RPTEST_CHECK(rptest::write_scene(*scene, path));
+
+    test_textures(*scene, path, 1);
+    test_textures(*scene, path, 4);
+
+    return rptest::result();
+}
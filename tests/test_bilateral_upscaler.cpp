@@ -0,0 +1,253 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of the CPU reference of BilateralUpscaler: checkerboard taps, clamping of the
+ * half and quarter taps, and the bilateral weights of the upscale.
+ */
+
+#include <random>
+#include <vector>
+
+#include <render_pipeline/rpcore/util/bilateral_upscaler.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+using Mode = BilateralUpscaler::Mode;
+
+const LVecBase2f UPSCALE_WEIGHTS(0.001f, 0.001f);
+
+bool is_rendered(const LVecBase2i& coord, int parity)
+{
+    return ((coord[0] + coord[1] + parity) & 1) == 0;
+}
+
+void test_checkerboard_taps()
+{
+    // odd width, so the last column has a single neighbor in x.
+    const LVecBase2i full_size(7, 4);
+    BilateralUpscaler::Tap taps[4];
+
+    for (int parity = 0; parity < 2; ++parity)
+    {
+        bool valid = true;
+        for (int y = 0; y < full_size[1]; ++y)
+        {
+            for (int x = 0; x < full_size[0]; ++x)
+            {
+                const LVecBase2i coord(x, y);
+                const int num_taps = BilateralUpscaler::get_taps(Mode::checkerboard, coord, full_size, parity, taps);
+
+                if (is_rendered(coord, parity))
+                {
+                    // the rendered pixel reads its own texel.
+                    valid = valid && num_taps == 1 && taps[0].full_coord == coord &&
+                        BilateralUpscaler::get_full_coord(Mode::checkerboard, taps[0].source_coord, parity) == coord;
+                    continue;
+                }
+
+                valid = valid && num_taps == 4;
+                for (int k = 0; k < num_taps; ++k)
+                {
+                    const LVecBase2i& tap = taps[k].full_coord;
+                    valid = valid && tap[0] >= 0 && tap[0] < full_size[0] && tap[1] >= 0 && tap[1] < full_size[1];
+                    valid = valid && is_rendered(tap, parity);
+                    valid = valid && BilateralUpscaler::get_full_coord(Mode::checkerboard, taps[k].source_coord, parity) == tap;
+                    valid = valid && std::abs(tap[0] - x) + std::abs(tap[1] - y) == 1;
+                }
+            }
+        }
+        RPTEST_CHECK(valid);
+    }
+
+    // the borders mirror the neighbors: left, right, bottom and top.
+    BilateralUpscaler::get_taps(Mode::checkerboard, LVecBase2i(0, 1), full_size, 0, taps);
+    RPTEST_CHECK(taps[0].full_coord == LVecBase2i(1, 1));
+    RPTEST_CHECK(taps[2].full_coord == LVecBase2i(0, 0));
+    BilateralUpscaler::get_taps(Mode::checkerboard, LVecBase2i(6, 3), full_size, 0, taps);
+    RPTEST_CHECK(taps[1].full_coord == LVecBase2i(5, 3));
+    RPTEST_CHECK(taps[3].full_coord == LVecBase2i(6, 2));
+    BilateralUpscaler::get_taps(Mode::checkerboard, LVecBase2i(3, 0), full_size, 0, taps);
+    RPTEST_CHECK(taps[2].full_coord == LVecBase2i(3, 1));
+    RPTEST_CHECK(taps[3].full_coord == LVecBase2i(3, 1));
+}
+
+void test_reduced_taps()
+{
+    BilateralUpscaler::Tap taps[4];
+
+    RPTEST_CHECK(BilateralUpscaler::get_size_constraint(Mode::half) == LVecBase2i(-2));
+    RPTEST_CHECK(BilateralUpscaler::get_size_constraint(Mode::quarter) == LVecBase2i(-4));
+    RPTEST_CHECK(BilateralUpscaler::get_size_constraint(Mode::checkerboard) == LVecBase2i(-2, -1));
+
+    // full mode reads the pixel itself.
+    RPTEST_CHECK(BilateralUpscaler::get_taps(Mode::full, LVecBase2i(3, 2), LVecBase2i(8, 8), 0, taps) == 1);
+    RPTEST_CHECK(taps[0].source_coord == LVecBase2i(3, 2));
+
+    // 2x2 texels from the texel of the pixel.
+    RPTEST_CHECK(BilateralUpscaler::get_taps(Mode::half, LVecBase2i(3, 2), LVecBase2i(8, 8), 0, taps) == 4);
+    RPTEST_CHECK(taps[0].source_coord == LVecBase2i(1, 1));
+    RPTEST_CHECK(taps[1].source_coord == LVecBase2i(2, 1));
+    RPTEST_CHECK(taps[2].source_coord == LVecBase2i(1, 2));
+    RPTEST_CHECK(taps[3].source_coord == LVecBase2i(2, 2));
+    RPTEST_CHECK(taps[3].full_coord == LVecBase2i(4, 4));
+
+    // 10x6 in quarter is 3x2 texels, and the last texels are clamped.
+    const LVecBase2i full_size(10, 6);
+    bool valid = true;
+    for (int y = 0; y < full_size[1]; ++y)
+    {
+        for (int x = 0; x < full_size[0]; ++x)
+        {
+            BilateralUpscaler::get_taps(Mode::quarter, LVecBase2i(x, y), full_size, 0, taps);
+            for (const auto& tap: taps)
+            {
+                valid = valid && tap.source_coord[0] >= 0 && tap.source_coord[0] <= 2;
+                valid = valid && tap.source_coord[1] >= 0 && tap.source_coord[1] <= 1;
+                valid = valid && tap.full_coord == BilateralUpscaler::get_full_coord(Mode::quarter, tap.source_coord, 0);
+                valid = valid && tap.full_coord[0] < full_size[0] && tap.full_coord[1] < full_size[1];
+            }
+        }
+    }
+    RPTEST_CHECK(valid);
+
+    BilateralUpscaler::get_taps(Mode::quarter, LVecBase2i(9, 5), full_size, 0, taps);
+    for (const auto& tap: taps)
+        RPTEST_CHECK(tap.source_coord == LVecBase2i(2, 1));
+}
+
+void test_weight()
+{
+    const LVecBase3f up(0, 0, 1);
+    RPTEST_CHECK(BilateralUpscaler::compute_weight(0.5f, up, 0.5f, up, UPSCALE_WEIGHTS) == 1.0f);
+
+    // beyond the max depth difference, and with opposite normals.
+    RPTEST_CHECK(BilateralUpscaler::compute_weight(0.5f, up, 0.502f, up, UPSCALE_WEIGHTS) == 0.0f);
+    RPTEST_CHECK(BilateralUpscaler::compute_weight(0.5f, up, 0.5f, -up, UPSCALE_WEIGHTS) == 0.0f);
+
+    // a closer sample weighs more.
+    const float near_weight = BilateralUpscaler::compute_weight(0.5f, up, 0.5002f, up, UPSCALE_WEIGHTS);
+    const float far_weight = BilateralUpscaler::compute_weight(0.5f, up, 0.5006f, up, UPSCALE_WEIGHTS);
+    RPTEST_CHECK(near_weight > far_weight && far_weight > 0.0f);
+}
+
+/** Source size of @p mode, like the size constraint of the source target. */
+LVecBase2i get_source_size(Mode mode, const LVecBase2i& full_size)
+{
+    const LVecBase2i constraint = BilateralUpscaler::get_size_constraint(mode);
+    return LVecBase2i(
+        (full_size[0] - constraint[0] - 1) / -constraint[0],
+        (full_size[1] - constraint[1] - 1) / -constraint[1]);
+}
+
+void test_upscale_constant()
+{
+    const LVecBase2i full_size(10, 6);
+    const size_t num_pixels = full_size[0] * full_size[1];
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> depth(num_pixels);
+    std::vector<LVecBase3f> normals(num_pixels);
+    for (size_t k = 0; k < num_pixels; ++k)
+    {
+        depth[k] = dist(rng);
+        normals[k] = LVecBase3f(dist(rng) - 0.5f, dist(rng) - 0.5f, 1.0f).normalized();
+    }
+
+    const LVecBase4f value(0.25f, 0.5f, 0.75f, 1.0f);
+    for (Mode mode: { Mode::half, Mode::quarter, Mode::checkerboard })
+    {
+        for (int parity = 0; parity < 2; ++parity)
+        {
+            const LVecBase2i source_size = get_source_size(mode, full_size);
+            const std::vector<LVecBase4f> source(source_size[0] * source_size[1], value);
+            std::vector<LVecBase4f> result(num_pixels, LVecBase4f(-1.0f));
+            BilateralUpscaler::upscale(mode, parity, full_size, depth.data(), normals.data(), source.data(),
+                UPSCALE_WEIGHTS, result.data());
+
+            bool constant = true;
+            for (const auto& pixel: result)
+                constant = constant && (pixel - value).length() < 1e-5f;
+            RPTEST_CHECK(constant);
+        }
+    }
+}
+
+void test_upscale_depth_edge()
+{
+    // the left half is near and the right half is far, and the source has a different value on each side.
+    const LVecBase2i full_size(8, 4);
+    const size_t num_pixels = full_size[0] * full_size[1];
+    const LVecBase4f near_value(1, 0, 0, 1);
+    const LVecBase4f far_value(0, 0, 1, 1);
+
+    std::vector<float> depth(num_pixels);
+    const std::vector<LVecBase3f> normals(num_pixels, LVecBase3f(0, 0, 1));
+    for (int y = 0; y < full_size[1]; ++y)
+    {
+        for (int x = 0; x < full_size[0]; ++x)
+            depth[y * full_size[0] + x] = x < 4 ? 0.1f : 0.9f;
+    }
+
+    for (Mode mode: { Mode::half, Mode::checkerboard })
+    {
+        const LVecBase2i source_size = get_source_size(mode, full_size);
+        std::vector<LVecBase4f> source(source_size[0] * source_size[1]);
+        for (int y = 0; y < source_size[1]; ++y)
+        {
+            for (int x = 0; x < source_size[0]; ++x)
+            {
+                const LVecBase2i full_coord = BilateralUpscaler::get_full_coord(mode, LVecBase2i(x, y), 0);
+                source[y * source_size[0] + x] = full_coord[0] < 4 ? near_value : far_value;
+            }
+        }
+
+        std::vector<LVecBase4f> result(num_pixels);
+        BilateralUpscaler::upscale(mode, 0, full_size, depth.data(), normals.data(), source.data(),
+            UPSCALE_WEIGHTS, result.data());
+
+        bool separated = true;
+        for (int y = 0; y < full_size[1]; ++y)
+        {
+            for (int x = 0; x < full_size[0]; ++x)
+                separated = separated && result[y * full_size[0] + x] == (x < 4 ? near_value : far_value);
+        }
+        RPTEST_CHECK(separated);
+    }
+}
+
+}
+
+int main()
+{
+    test_checkerboard_taps();
+    test_reduced_taps();
+    test_weight();
+    test_upscale_constant();
+    test_upscale_depth_edge();
+
+    return rptest::result();
+}
@@ -0,0 +1,128 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of the cloud noise generator: the volume does not depend on the number of
+ * threads, and it tiles in every axis.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "rpplugins/clouds/src/noise_generator.hpp"
+
+#include "rptest.hpp"
+
+using namespace rpplugins;
+
+namespace {
+
+using VolumeType = CloudNoiseGenerator::VolumeType;
+
+constexpr int RESOLUTION = 16;
+constexpr uint32_t SEED = 42;
+
+/** FNV-1a hash of the volume. */
+uint64_t compute_checksum(const std::vector<unsigned char>& data)
+{
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c: data)
+    {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void test_threads(VolumeType type)
+{
+    const auto single = CloudNoiseGenerator::compute_volume(type, RESOLUTION, SEED, 1);
+    const auto multi = CloudNoiseGenerator::compute_volume(type, RESOLUTION, SEED, 4);
+
+    RPTEST_CHECK(single.size() == size_t(RESOLUTION) * RESOLUTION * RESOLUTION * 4);
+    RPTEST_CHECK(single == multi);
+    RPTEST_CHECK(compute_checksum(single) == compute_checksum(multi));
+
+    // a different seed gives a different volume.
+    const auto other = CloudNoiseGenerator::compute_volume(type, RESOLUTION, SEED + 1, 4);
+    RPTEST_CHECK(compute_checksum(single) != compute_checksum(other));
+}
+
+/**
+ * Compare the voxels on the faces at 0 with the volume sampled at @p RESOLUTION,
+ * that is, one voxel past the other side.
+ */
+void test_tileable(VolumeType type)
+{
+    const auto data = CloudNoiseGenerator::compute_volume(type, RESOLUTION, SEED, 1);
+    const auto layers = CloudNoiseGenerator::create_volume_layers(type, SEED);
+    const float inv_res = 1.0f / RESOLUTION;
+
+    // the shifted octaves of the worley fbm are not exactly at the same fraction.
+    const int tolerance = 1;
+
+    int max_diff = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (int v = 0; v < RESOLUTION; ++v)
+        {
+            for (int u = 0; u < RESOLUTION; ++u)
+            {
+                LVecBase3i voxel;
+                voxel[axis] = 0;
+                voxel[(axis + 1) % 3] = u;
+                voxel[(axis + 2) % 3] = v;
+
+                LVecBase3f p(voxel[0] * inv_res, voxel[1] * inv_res, voxel[2] * inv_res);
+                p[axis] = 1.0f;
+                const LVecBase4f values = CloudNoiseGenerator::sample_volume(layers, p);
+
+                // BGRA
+                const unsigned char* texel = data.data() + (((voxel[2] * RESOLUTION) + voxel[1]) * RESOLUTION + voxel[0]) * 4;
+                const int order[4] = { 2, 1, 0, 3 };
+                for (int k = 0; k < 4; ++k)
+                {
+                    const float value = (std::min)((std::max)(values[order[k]], 0.0f), 1.0f);
+                    const int wrapped = static_cast<int>(value * 255.0f + 0.5f);
+                    max_diff = (std::max)(max_diff, std::abs(wrapped - texel[k]));
+                }
+            }
+        }
+    }
+
+    if (max_diff > tolerance)
+        std::cerr << "max difference on the faces: " << max_diff << std::endl;
+    RPTEST_CHECK(max_diff <= tolerance);
+}
+
+}
+
+int main()
+{
+    for (VolumeType type: { VolumeType::shape, VolumeType::detail })
+    {
+        test_threads(type);
+        test_tileable(type);
+    }
+
+    return rptest::result();
+}
@@ -0,0 +1,229 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of CPULightCuller on a synthetic AllLightsData buffer.
+ *
+ * The view matrix is the identity, so the light positions are already in the view space
+ * of `view_mat_z_up` (y-up and looking at -z).
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <render_pipeline/rpcore/native/rp_light.h>
+#include <render_pipeline/rpcore/util/cpu_light_culler.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+void add_point_light(std::vector<float>& light_data, const LVecBase3f& pos, float radius, bool casts_shadows)
+{
+    float* data = &*light_data.insert(light_data.end(), CPULightCuller::LIGHT_DATA_STRIDE, 0.0f);
+    data[0] = static_cast<float>(RPLight::LT_point_light);
+    data[1] = -1.0f;
+    data[2] = casts_shadows ? 0.0f : -1.0f;
+    data[3] = pos[0];
+    data[4] = pos[1];
+    data[5] = pos[2];
+    data[9] = radius;
+    data[10] = 0.0f;
+}
+
+void add_spot_light(std::vector<float>& light_data, const LVecBase3f& pos, const LVecBase3f& direction,
+    float radius, float cos_fov)
+{
+    float* data = &*light_data.insert(light_data.end(), CPULightCuller::LIGHT_DATA_STRIDE, 0.0f);
+    data[0] = static_cast<float>(RPLight::LT_spot_light);
+    data[1] = -1.0f;
+    data[2] = -1.0f;
+    data[3] = pos[0];
+    data[4] = pos[1];
+    data[5] = pos[2];
+    data[9] = radius;
+    data[10] = cos_fov;
+    data[11] = direction[0];
+    data[12] = direction[1];
+    data[13] = direction[2];
+}
+
+CPULightCuller::Settings make_settings()
+{
+    CPULightCuller::Settings settings;
+    settings.tile_size = LVecBase2i(16, 16);
+    settings.num_slices = 8;
+    settings.max_distance = 100.0f;
+    settings.max_lights_per_cell = 16;
+    return settings;
+}
+
+/** 90 degrees square frustum in the order BL, BR, TL, TR. */
+std::array<LVecBase3f, 4> make_frustum_directions()
+{
+    return {
+        LVecBase3f(-1, -1, -1).normalized(),
+        LVecBase3f(1, -1, -1).normalized(),
+        LVecBase3f(-1, 1, -1).normalized(),
+        LVecBase3f(1, 1, -1).normalized(),
+    };
+}
+
+void test_slices()
+{
+    CPULightCuller culler(make_settings(), 1);
+
+    RPTEST_CHECK(culler.get_slice_from_distance(0.0f) == 0);
+    RPTEST_CHECK(culler.get_distance_from_slice(0) == 0.0f);
+    RPTEST_CHECK(std::abs(culler.get_distance_from_slice(8) - 100.0f) < 1e-3f);
+    for (int slice = 0; slice < 8; ++slice)
+    {
+        const float middle = (culler.get_distance_from_slice(slice) + culler.get_distance_from_slice(slice + 1)) * 0.5f;
+        RPTEST_CHECK(culler.get_slice_from_distance(middle) == slice);
+    }
+}
+
+void test_cells()
+{
+    // 64x64 pixels are 4x4 tiles, and the screen center is between the tiles 1 and 2.
+    CPULightCuller culler(make_settings(), 1);
+    culler.set_resolution(LVecBase2i(64, 64));
+    culler.set_camera(LMatrix4f::ident_mat(), make_frustum_directions());
+    RPTEST_CHECK(culler.get_num_tiles() == LVecBase2i(4, 4));
+
+    std::vector<float> light_data;
+    add_point_light(light_data, LVecBase3f(0, 0, -10), 1.0f, true);
+    add_spot_light(light_data, LVecBase3f(0, 0, -2), LVecBase3f(0, 0, -1), 16.0f, 0.94f);
+    light_data.insert(light_data.end(), CPULightCuller::LIGHT_DATA_STRIDE, 0.0f);
+    add_point_light(light_data, LVecBase3f(0, 0, 20), 1.0f, false);
+    add_point_light(light_data, LVecBase3f(0, 0, -500), 1.0f, false);
+
+    culler.flag_all_cells();
+    culler.cull_lights(light_data);
+
+    // the empty slot and the light beyond max distance are skipped. Like view_frustum_cull.frag.glsl,
+    // the light behind the camera is kept, but it does not intersect any cell.
+    RPTEST_CHECK(culler.get_num_frustum_lights() == 3);
+    RPTEST_CHECK(culler.get_cells().size() == 4 * 4 * 8);
+
+    // distance 9 to 11 is in slice 1.
+    const int slice = culler.get_slice_from_distance(10.0f);
+    RPTEST_CHECK(slice == 1);
+
+    const int center = culler.find_cell(1, 1, slice);
+    RPTEST_CHECK(center >= 0);
+    if (center >= 0)
+    {
+        // lights are grouped by the light class: spot without shadow, then point with shadow.
+        const auto& cell = culler.get_cells()[center];
+        RPTEST_CHECK((cell.lights == std::vector<int>{ 1, 0 }));
+        RPTEST_CHECK(cell.class_counts[CPULightCuller::LIGHT_CLS_SPOT_NOSHADOW] == 1);
+        RPTEST_CHECK(cell.class_counts[CPULightCuller::LIGHT_CLS_POINT_NOSHADOW] == 0);
+        RPTEST_CHECK(cell.class_counts[CPULightCuller::LIGHT_CLS_POINT_SHADOW] == 1);
+    }
+
+    // the small point light touches only the four center tiles of its slice.
+    for (int y = 0; y < 4; ++y)
+    {
+        for (int x = 0; x < 4; ++x)
+        {
+            for (int s = 0; s < 8; ++s)
+            {
+                const auto& lights = culler.get_cells()[culler.find_cell(x, y, s)].lights;
+                const bool expected = s == slice && (x == 1 || x == 2) && (y == 1 || y == 2);
+                const bool found = std::find(lights.begin(), lights.end(), 0) != lights.end();
+                RPTEST_CHECK(found == expected);
+            }
+        }
+    }
+
+    // the same lists with multiple threads.
+    CPULightCuller threaded(make_settings(), 4);
+    threaded.set_resolution(LVecBase2i(64, 64));
+    threaded.set_camera(LMatrix4f::ident_mat(), make_frustum_directions());
+    threaded.flag_all_cells();
+    threaded.cull_lights(light_data);
+
+    bool same = threaded.get_cells().size() == culler.get_cells().size();
+    for (size_t k = 0; same && k < culler.get_cells().size(); ++k)
+        same = threaded.get_cells()[k].lights == culler.get_cells()[k].lights;
+    RPTEST_CHECK(same);
+}
+
+void test_flag_used_cells()
+{
+    CPULightCuller culler(make_settings(), 1);
+    culler.set_resolution(LVecBase2i(64, 64));
+    culler.set_camera(LMatrix4f::ident_mat(), make_frustum_directions());
+
+    // only the bottom-left tile has a surface at distance 10, and the others are sky.
+    std::vector<float> distances(64 * 64, -1.0f);
+    distances[0] = 10.0f;
+    culler.flag_used_cells(distances.data());
+
+    std::vector<float> light_data;
+    add_point_light(light_data, LVecBase3f(0, 0, -10), 1.0f, false);
+    culler.cull_lights(light_data);
+
+    RPTEST_CHECK(culler.get_cells().size() == 1);
+    RPTEST_CHECK(culler.find_cell(0, 0, 1) == 0);
+    RPTEST_CHECK(culler.find_cell(1, 1, 1) == -1);
+    RPTEST_CHECK(culler.get_num_culled_lights() == 0);
+}
+
+void test_distant_spot_light()
+{
+    // The radius of distant lights is scaled by the distance of the light position like GLSL,
+    // not by the sphere center which is moved along the cone.
+    CPULightCuller::Settings settings = make_settings();
+    settings.max_distance = 400.0f;
+    CPULightCuller culler(settings, 1);
+    culler.set_resolution(LVecBase2i(16, 16));
+
+    // all rays are 24 degrees away from the axis.
+    const float angle = 24.0f * 3.14159265f / 180.0f;
+    const LVecBase3f ray(std::sin(angle), 0, -std::cos(angle));
+    culler.set_camera(LMatrix4f::ident_mat(), { ray, ray, ray, ray });
+
+    // The sphere center is at 190 with radius 72.1, and the distance to the ray is 77.3.
+    // Scaled by the light position (230 / 200), the radius is 82.9.
+    std::vector<float> light_data;
+    add_spot_light(light_data, LVecBase3f(0, 0, -230), LVecBase3f(0, 0, 1), 80.0f, 0.8f);
+
+    culler.flag_all_cells();
+    culler.cull_lights(light_data);
+    RPTEST_CHECK(culler.get_num_frustum_lights() == 1);
+    RPTEST_CHECK(culler.get_num_culled_lights() > 0);
+}
+
+}
+
+int main()
+{
+    test_slices();
+    test_cells();
+    test_flag_used_cells();
+    test_distant_spot_light();
+
+    return rptest::result();
+}
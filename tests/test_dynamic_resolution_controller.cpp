@@ -0,0 +1,179 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of DynamicResolutionController with synthetic frame time traces.
+ *
+ * The target is 60 FPS, so the increase threshold (0.8) is at 13.3 ms.
+ */
+
+#include <cmath>
+
+#include <render_pipeline/rpcore/util/dynamic_resolution_controller.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+constexpr double TARGET = 1.0 / 60.0;
+constexpr int COOLDOWN = 30;
+constexpr int INCREASE_DELAY = 60;
+constexpr int DECREASE_DELAY = 3;
+
+void setup(DynamicResolutionController& controller, float scale)
+{
+    controller.set_target_frame_time(TARGET);
+    controller.set_scale_range(0.5f, 1.0f);
+    controller.set_scale_step(0.05f);
+    controller.set_increase_delay(INCREASE_DELAY);
+    controller.set_decrease_delay(DECREASE_DELAY);
+    controller.set_cooldown(COOLDOWN);
+    controller.set_scale(scale);
+}
+
+/** Add @p count frames of @p seconds, and return the number of changes. */
+int feed(DynamicResolutionController& controller, double seconds, int count)
+{
+    int changes = 0;
+    for (int k = 0; k < count; ++k)
+    {
+        if (controller.add_frame_time(seconds))
+            ++changes;
+    }
+    return changes;
+}
+
+bool is_near(float a, float b)
+{
+    return std::abs(a - b) < 1e-4f;
+}
+
+void test_startup()
+{
+    // the first frame compiles the shaders and takes seconds.
+    DynamicResolutionController controller;
+    setup(controller, 1.0f);
+
+    RPTEST_CHECK(!controller.add_frame_time(3.0));
+    RPTEST_CHECK(feed(controller, 0.015, 200) == 0);
+    RPTEST_CHECK(controller.get_scale() == 1.0f);
+    RPTEST_CHECK(std::abs(controller.get_average_frame_time() - 0.015) < 1e-9);
+}
+
+void test_steady_over_budget()
+{
+    DynamicResolutionController controller;
+    setup(controller, 1.0f);
+    RPTEST_CHECK(feed(controller, 0.025, COOLDOWN) == 0);
+
+    // sqrt(16.7 / 25) = 0.816 is quantized down to 0.8.
+    RPTEST_CHECK(feed(controller, 0.025, DECREASE_DELAY - 1) == 0);
+    RPTEST_CHECK(controller.add_frame_time(0.025));
+    RPTEST_CHECK(is_near(controller.get_scale(), 0.8f));
+
+    // the frames of the old resolution are not used after the change.
+    RPTEST_CHECK(feed(controller, 0.025, COOLDOWN) == 0);
+    RPTEST_CHECK(is_near(controller.get_scale(), 0.8f));
+}
+
+void test_spike()
+{
+    DynamicResolutionController controller;
+    setup(controller, 1.0f);
+    RPTEST_CHECK(feed(controller, 0.015, COOLDOWN + 10) == 0);
+
+    // single spikes, even right after the cooldown, do not drop the scale.
+    RPTEST_CHECK(!controller.add_frame_time(0.2));
+    RPTEST_CHECK(feed(controller, 0.015, 10) == 0);
+    RPTEST_CHECK(!controller.add_frame_time(0.2));
+    RPTEST_CHECK(!controller.add_frame_time(0.2));
+    RPTEST_CHECK(feed(controller, 0.015, 100) == 0);
+    RPTEST_CHECK(controller.get_scale() == 1.0f);
+
+    // a spike in an over budget run does not decide the size of the drop.
+    RPTEST_CHECK(!controller.add_frame_time(0.025));
+    RPTEST_CHECK(!controller.add_frame_time(0.5));
+    RPTEST_CHECK(controller.add_frame_time(0.025));
+    RPTEST_CHECK(is_near(controller.get_scale(), 0.8f));
+}
+
+void test_recovery()
+{
+    DynamicResolutionController controller;
+    setup(controller, 0.5f);
+    RPTEST_CHECK(feed(controller, 0.008, COOLDOWN) == 0);
+
+    // one step after the increase delay, and again after each cooldown.
+    RPTEST_CHECK(feed(controller, 0.008, INCREASE_DELAY - 1) == 0);
+    RPTEST_CHECK(controller.add_frame_time(0.008));
+    RPTEST_CHECK(is_near(controller.get_scale(), 0.55f));
+
+    RPTEST_CHECK(feed(controller, 0.008, COOLDOWN + INCREASE_DELAY) == 1);
+    RPTEST_CHECK(is_near(controller.get_scale(), 0.6f));
+
+    // no increase between the threshold and the target.
+    RPTEST_CHECK(feed(controller, 0.015, 1000) == 0);
+    RPTEST_CHECK(is_near(controller.get_scale(), 0.6f));
+
+    // up to the max scale, and no further.
+    RPTEST_CHECK(feed(controller, 0.008, 10 * (COOLDOWN + INCREASE_DELAY)) == 8);
+    RPTEST_CHECK(controller.get_scale() == 1.0f);
+}
+
+void test_bounds()
+{
+    DynamicResolutionController controller;
+    setup(controller, 1.0f);
+
+    // far over budget drops to the min scale at once.
+    RPTEST_CHECK(feed(controller, 1.0, COOLDOWN + DECREASE_DELAY) == 1);
+    RPTEST_CHECK(controller.get_scale() == 0.5f);
+    RPTEST_CHECK(feed(controller, 1.0, 500) == 0);
+    RPTEST_CHECK(controller.get_scale() == 0.5f);
+
+    // the range clamps the current scale.
+    controller.set_scale(2.0f);
+    RPTEST_CHECK(controller.get_scale() == 1.0f);
+    controller.set_scale_range(0.6f, 0.9f);
+    RPTEST_CHECK(controller.get_scale() == 0.9f);
+    controller.set_scale(0.1f);
+    RPTEST_CHECK(controller.get_scale() == 0.6f);
+
+    // a drop of one step is clamped to the min scale.
+    controller.set_scale(0.62f);
+    RPTEST_CHECK(feed(controller, 0.018, COOLDOWN + DECREASE_DELAY) == 1);
+    RPTEST_CHECK(controller.get_scale() == 0.6f);
+}
+
+}
+
+int main()
+{
+    test_startup();
+    test_steady_over_budget();
+    test_spike();
+    test_recovery();
+    test_bounds();
+
+    return rptest::result();
+}
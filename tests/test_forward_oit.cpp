@@ -0,0 +1,105 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of the weighted blended OIT terms of the forward_shading plugin, which match
+ * "weighted_oit.inc.glsl".
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "rpplugins/forward_shading/src/forward_stage.hpp"
+
+#include "rptest.hpp"
+
+using namespace rpplugins;
+
+namespace {
+
+void test_weight()
+{
+    // the weight does not increase with the distance.
+    bool monotonic = true;
+    float last_weight = ForwardStage::compute_oit_weight(0.0f, 1.0f);
+    for (float depth = 0.01f; depth < 1e5f; depth *= 1.1f)
+    {
+        const float weight = ForwardStage::compute_oit_weight(depth, 1.0f);
+        monotonic = monotonic && weight <= last_weight;
+        last_weight = weight;
+    }
+    RPTEST_CHECK(monotonic);
+
+    // the weight is clamped at both ends, so that near and far fragments keep a finite weight.
+    RPTEST_CHECK(ForwardStage::compute_oit_weight(0.0f, 1.0f) == 3e3f);
+    RPTEST_CHECK(ForwardStage::compute_oit_weight(1e5f, 1.0f) == 1e-2f);
+    RPTEST_CHECK(ForwardStage::compute_oit_weight(10.0f, 1.0f) > 1e-2f);
+    RPTEST_CHECK(ForwardStage::compute_oit_weight(10.0f, 1.0f) < 3e3f);
+
+    // and it scales with the coverage.
+    RPTEST_CHECK(ForwardStage::compute_oit_weight(10.0f, 0.0f) == 0.0f);
+    RPTEST_CHECK(std::abs(ForwardStage::compute_oit_weight(10.0f, 0.25f) -
+        0.25f * ForwardStage::compute_oit_weight(10.0f, 1.0f)) < 1e-6f);
+}
+
+void test_revealage()
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> alpha_dist(0.0f, 0.95f);
+
+    bool round_trip = true;
+    for (int layers = 1; layers <= 8; ++layers)
+    {
+        for (int k = 0; k < 100; ++k)
+        {
+            float sum = 0;
+            double product = 1;
+            for (int l = 0; l < layers; ++l)
+            {
+                const float alpha = alpha_dist(rng);
+                sum += ForwardStage::compute_oit_revealage_term(alpha);
+                product *= 1.0 - alpha;
+            }
+
+            const double revealage = std::exp(-double(sum));
+            round_trip = round_trip && std::abs(revealage - product) <= 1e-4 * product;
+        }
+    }
+    RPTEST_CHECK(round_trip);
+
+    RPTEST_CHECK(ForwardStage::compute_oit_revealage_term(0.0f) == 0.0f);
+
+    // an opaque fragment keeps a finite term, which reveals almost nothing.
+    const float opaque_term = ForwardStage::compute_oit_revealage_term(1.0f);
+    RPTEST_CHECK(std::isfinite(opaque_term));
+    RPTEST_CHECK(std::exp(-opaque_term) <= 1e-4f + 1e-7f);
+}
+
+}
+
+int main()
+{
+    test_weight();
+    test_revealage();
+
+    return rptest::result();
+}
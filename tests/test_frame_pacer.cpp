@@ -0,0 +1,285 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of FramePacer driven by FramePacer::ManualClock: frame rate cap, no catch-up after a
+ * slow frame, the frames-in-flight limit with a simulated GPU, and the frame time histogram.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <render_pipeline/rpcore/util/frame_pacer.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+constexpr double YIELD_STEP = 0.00001;
+
+bool is_near(double a, double b, double tolerance)
+{
+    return std::abs(a - b) <= tolerance;
+}
+
+/** GPU which runs the frames in order, each for a fixed time after it is submitted by insert(). */
+class SimulatedFence : public FramePacer::Fence
+{
+public:
+    SimulatedFence(FramePacer::ManualClock* clock, double gpu_time): clock_(clock), gpu_time_(gpu_time)
+    {
+    }
+
+    void insert(uint64_t frame) final
+    {
+        RPTEST_CHECK(frame == end_times_.size());
+        const double start = (std::max)(clock_->get_time(), end_times_.empty() ? 0.0 : end_times_.back());
+        end_times_.push_back(start + gpu_time_);
+    }
+
+    bool is_completed(uint64_t frame) final
+    {
+        return frame < end_times_.size() && end_times_[frame] <= clock_->get_time();
+    }
+
+    size_t get_num_inserted() const
+    {
+        return end_times_.size();
+    }
+
+    size_t get_num_in_flight() const
+    {
+        const double now = clock_->get_time();
+        return std::count_if(end_times_.begin(), end_times_.end(), [now](double end_time) { return end_time > now; });
+    }
+
+private:
+    FramePacer::ManualClock* clock_;
+    double gpu_time_;
+    std::vector<double> end_times_;
+};
+
+/** Run frames of @p cpu_time on a GPU with @p gpu_time per frame, and return the last frame time. */
+double run_frames_in_flight(int max_frames_in_flight, double cpu_time, double gpu_time, size_t& max_in_flight)
+{
+    auto clock = std::make_unique<FramePacer::ManualClock>();
+    FramePacer::ManualClock* manual_clock = clock.get();
+    manual_clock->set_yield_step(YIELD_STEP);
+
+    auto fence = std::make_unique<SimulatedFence>(manual_clock, gpu_time);
+    SimulatedFence* simulated_fence = fence.get();
+
+    FramePacer pacer(std::move(clock));
+    pacer.set_fence(std::move(fence));
+    pacer.set_max_frames_in_flight(max_frames_in_flight);
+
+    max_in_flight = 0;
+    for (int k = 0; k < 20; ++k)
+    {
+        manual_clock->advance(cpu_time);
+        pacer.end_frame();
+
+        // the next frame is submitted in addition to these.
+        max_in_flight = (std::max)(max_in_flight, simulated_fence->get_num_in_flight() + 1);
+    }
+    RPTEST_CHECK(pacer.get_frame() == 20);
+    RPTEST_CHECK(pacer.get_num_fence_timeouts() == 0);
+    RPTEST_CHECK(pacer.get_last_wait_time() == 0.0);
+    return pacer.get_last_frame_time();
+}
+
+void test_frame_rate_cap()
+{
+    auto clock = std::make_unique<FramePacer::ManualClock>();
+    FramePacer::ManualClock* manual_clock = clock.get();
+    manual_clock->set_oversleep(0.0005);
+    manual_clock->set_yield_step(YIELD_STEP);
+
+    FramePacer pacer(std::move(clock));
+    pacer.set_target_frame_rate(60.0);
+    pacer.set_spin_time(0.002);
+    RPTEST_CHECK(is_near(pacer.get_target_frame_rate(), 60.0, 1e-9));
+
+    // the first frame has no deadline.
+    manual_clock->advance(0.005);
+    pacer.end_frame();
+    RPTEST_CHECK(pacer.get_last_wait_time() == 0.0);
+
+    for (int k = 0; k < 100; ++k)
+    {
+        manual_clock->advance(0.005);
+        pacer.end_frame();
+        // the deadline keeps the cadence, so spinning past one deadline shortens the next frame.
+        RPTEST_CHECK(is_near(pacer.get_last_frame_time(), 1.0 / 60.0, YIELD_STEP + 1e-9));
+    }
+
+    // sleep is only used until the spin time, the rest is spinning.
+    RPTEST_CHECK(manual_clock->get_num_sleeps() == 100);
+    RPTEST_CHECK(manual_clock->get_num_yields() > 0);
+
+    // a slow frame does not wait, and the next frame does not try to catch up.
+    manual_clock->advance(0.05);
+    pacer.end_frame();
+    RPTEST_CHECK(pacer.get_last_wait_time() == 0.0);
+    RPTEST_CHECK(is_near(pacer.get_last_frame_time(), 0.05, 1e-9));
+
+    manual_clock->advance(0.005);
+    pacer.end_frame();
+    RPTEST_CHECK(pacer.get_last_frame_time() >= 1.0 / 60.0 - 1e-9);
+    RPTEST_CHECK(pacer.get_last_frame_time() <= 1.0 / 60.0 + YIELD_STEP + 1e-9);
+
+    // without the cap, nothing waits.
+    pacer.set_target_frame_rate(0.0);
+    RPTEST_CHECK(pacer.get_target_frame_rate() == 0.0);
+    const int num_sleeps = manual_clock->get_num_sleeps();
+    for (int k = 0; k < 10; ++k)
+    {
+        manual_clock->advance(0.005);
+        pacer.end_frame();
+        RPTEST_CHECK(pacer.get_last_wait_time() == 0.0);
+        RPTEST_CHECK(is_near(pacer.get_last_frame_time(), 0.005, 1e-9));
+    }
+    RPTEST_CHECK(manual_clock->get_num_sleeps() == num_sleeps);
+}
+
+void test_frames_in_flight()
+{
+    size_t max_in_flight;
+
+    // 1 synchronizes, so the CPU and the GPU times add up.
+    double frame_time = run_frames_in_flight(1, 0.005, 0.02, max_in_flight);
+    RPTEST_CHECK(is_near(frame_time, 0.025, 2 * YIELD_STEP));
+    RPTEST_CHECK(max_in_flight == 1);
+
+    // with 2 frames, the CPU works while the GPU renders the previous frame.
+    frame_time = run_frames_in_flight(2, 0.005, 0.02, max_in_flight);
+    RPTEST_CHECK(is_near(frame_time, 0.02, 2 * YIELD_STEP));
+    RPTEST_CHECK(max_in_flight == 2);
+
+    frame_time = run_frames_in_flight(3, 0.005, 0.02, max_in_flight);
+    RPTEST_CHECK(is_near(frame_time, 0.02, 2 * YIELD_STEP));
+    RPTEST_CHECK(max_in_flight == 3);
+
+    // a CPU bound frame does not wait.
+    frame_time = run_frames_in_flight(2, 0.02, 0.005, max_in_flight);
+    RPTEST_CHECK(is_near(frame_time, 0.02, 1e-9));
+    RPTEST_CHECK(max_in_flight == 2);
+
+    // without the limit, the fence is not used.
+    auto clock = std::make_unique<FramePacer::ManualClock>();
+    FramePacer::ManualClock* manual_clock = clock.get();
+    auto fence = std::make_unique<SimulatedFence>(manual_clock, 0.02);
+    SimulatedFence* simulated_fence = fence.get();
+
+    FramePacer pacer(std::move(clock));
+    pacer.set_fence(std::move(fence));
+    RPTEST_CHECK(pacer.get_max_frames_in_flight() == 0);
+    for (int k = 0; k < 10; ++k)
+    {
+        manual_clock->advance(0.005);
+        pacer.end_frame();
+        RPTEST_CHECK(pacer.get_last_fence_wait_time() == 0.0);
+    }
+    RPTEST_CHECK(simulated_fence->get_num_inserted() == 0);
+}
+
+void test_fence_with_cap()
+{
+    auto clock = std::make_unique<FramePacer::ManualClock>();
+    FramePacer::ManualClock* manual_clock = clock.get();
+    manual_clock->set_yield_step(YIELD_STEP);
+
+    FramePacer pacer(std::move(clock));
+    pacer.set_fence(std::make_unique<SimulatedFence>(manual_clock, 0.01));
+    pacer.set_max_frames_in_flight(1);
+    pacer.set_target_frame_rate(60.0);
+
+    // 5 ms of CPU and 10 ms of GPU, and the cap waits the rest.
+    for (int k = 0; k < 20; ++k)
+    {
+        manual_clock->advance(0.005);
+        pacer.end_frame();
+    }
+    RPTEST_CHECK(is_near(pacer.get_last_frame_time(), 1.0 / 60.0, 2 * YIELD_STEP));
+    RPTEST_CHECK(is_near(pacer.get_last_fence_wait_time(), 0.01, 2 * YIELD_STEP));
+    RPTEST_CHECK(is_near(pacer.get_last_wait_time(), 1.0 / 60.0 - 0.015, 2 * YIELD_STEP));
+}
+
+void test_fence_timeout()
+{
+    auto clock = std::make_unique<FramePacer::ManualClock>();
+    FramePacer::ManualClock* manual_clock = clock.get();
+    manual_clock->set_yield_step(0.001);
+
+    // the GPU never finishes, for example when the fence buffer is not drawn.
+    FramePacer pacer(std::move(clock));
+    pacer.set_fence(std::make_unique<SimulatedFence>(manual_clock, 1000.0));
+    pacer.set_max_frames_in_flight(2);
+    pacer.set_fence_timeout(0.05);
+
+    manual_clock->advance(0.005);
+    pacer.end_frame();
+    RPTEST_CHECK(pacer.get_num_fence_timeouts() == 0);
+
+    manual_clock->advance(0.005);
+    pacer.end_frame();
+    RPTEST_CHECK(pacer.get_num_fence_timeouts() == 1);
+    RPTEST_CHECK(is_near(pacer.get_last_fence_wait_time(), 0.05, 0.001 + 1e-9));
+}
+
+void test_histogram()
+{
+    FramePacer::FrameTimeHistogram histogram(0.001, 100);
+    RPTEST_CHECK(histogram.get_percentile(50.0) == 0.0);
+
+    for (int k = 1; k <= 100; ++k)
+        histogram.add(k * 0.0001 + 0.01);
+    histogram.add(1.0);
+
+    RPTEST_CHECK(histogram.get_num_samples() == 101);
+    RPTEST_CHECK(is_near(histogram.get_min(), 0.0101, 1e-12));
+    RPTEST_CHECK(histogram.get_max() == 1.0);
+    RPTEST_CHECK(histogram.get_buckets().back() == 1);
+    RPTEST_CHECK(is_near(histogram.get_percentile(0.0), 0.011, 1e-12));
+    RPTEST_CHECK(is_near(histogram.get_percentile(50.0), 0.016, 1e-12));
+    RPTEST_CHECK(histogram.get_percentile(100.0) == 1.0);
+
+    histogram.clear();
+    RPTEST_CHECK(histogram.get_num_samples() == 0);
+    RPTEST_CHECK(histogram.get_mean() == 0.0);
+}
+
+}
+
+int main()
+{
+    test_frame_rate_cap();
+    test_frames_in_flight();
+    test_fence_with_cap();
+    test_fence_timeout();
+    test_histogram();
+
+    return rptest::result();
+}
@@ -0,0 +1,129 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of the Image registry: order of creation, compaction, and snapshots taken while
+ * loader threads create and destroy images.
+ */
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <render_pipeline/rpcore/image.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+constexpr int NUM_THREADS = 4;
+constexpr int NUM_ROUNDS = 200;
+
+void test_order()
+{
+    const size_t base_count = Image::get_num_registered_images();
+    const size_t base_size = Image::get_registered_images_size();
+
+    std::vector<std::unique_ptr<Image>> images;
+    for (int k = 0; k < 8; ++k)
+        images.push_back(Image::create_2d("order" + std::to_string(k), 4, 4, Image::Format::RGBA8));
+
+    RPTEST_CHECK(Image::get_num_registered_images() == base_count + 8);
+    RPTEST_CHECK(Image::get_registered_images_size() == base_size + 8 * 4 * 4 * 4);
+
+    // remove more than half of them, so the slots are compacted.
+    for (int k = 0; k < 8; k += 2)
+        images[k].reset();
+    images[1].reset();
+
+    const auto snapshot = Image::get_registered_images();
+    RPTEST_CHECK(snapshot.size() == base_count + 3);
+    RPTEST_CHECK(Image::get_registered_images_size() == base_size + 3 * 4 * 4 * 4);
+    if (snapshot.size() == base_count + 3)
+    {
+        RPTEST_CHECK(snapshot[base_count + 0].texture == images[3]->get_texture());
+        RPTEST_CHECK(snapshot[base_count + 1].texture == images[5]->get_texture());
+        RPTEST_CHECK(snapshot[base_count + 2].texture == images[7]->get_texture());
+        RPTEST_CHECK(snapshot[base_count + 2].size_in_bytes == 4 * 4 * 4);
+    }
+
+    // the snapshot keeps the texture after the image is destroyed.
+    images.clear();
+    RPTEST_CHECK(Image::get_num_registered_images() == base_count);
+    RPTEST_CHECK(snapshot.back().texture->get_x_size() == 4);
+    RPTEST_CHECK(snapshot.back().texture->get_name() == "Img2D-order7");
+}
+
+void test_threads()
+{
+    const size_t base_count = Image::get_num_registered_images();
+    const size_t base_size = Image::get_registered_images_size();
+
+    std::atomic<bool> running(true);
+    std::vector<std::thread> loaders;
+    for (int t = 0; t < NUM_THREADS; ++t)
+    {
+        loaders.emplace_back([t]() {
+            std::vector<std::unique_ptr<Image>> images;
+            for (int k = 0; k < NUM_ROUNDS; ++k)
+            {
+                images.push_back(Image::create_buffer("loader" + std::to_string(t), 16, Image::Format::R32));
+                if (k % 3 == 2)
+                    images.erase(images.begin());
+            }
+        });
+    }
+
+    // read the snapshots like BufferViewer while images are created and destroyed.
+    size_t num_invalid = 0;
+    std::thread viewer([&]() {
+        while (running)
+        {
+            for (const auto& image: Image::get_registered_images())
+            {
+                if (!image.texture || image.texture->get_name().empty())
+                    ++num_invalid;
+            }
+        }
+    });
+
+    for (auto& loader: loaders)
+        loader.join();
+    running = false;
+    viewer.join();
+
+    RPTEST_CHECK(num_invalid == 0);
+    RPTEST_CHECK(Image::get_num_registered_images() == base_count);
+    RPTEST_CHECK(Image::get_registered_images_size() == base_size);
+}
+
+}
+
+int main()
+{
+    test_order();
+    test_threads();
+
+    return rptest::result();
+}
@@ -0,0 +1,225 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Stress test of LightCommandBuffer: many producer threads queue add, update and remove
+ * commands while the main thread drains them into a slot storage, like
+ * LightManager::commit_queued_lights does with InternalLightManager.
+ */
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <render_pipeline/rpcore/native/pointer_slot_storage.h>
+#include <render_pipeline/rpcore/native/rp_point_light.h>
+
+#include "rpcore/light_command_buffer.hpp"
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+constexpr int NUM_THREADS = 8;
+constexpr int LIGHTS_PER_THREAD = 64;
+constexpr int NUM_ROUNDS = 200;
+constexpr int MAX_SLOTS = NUM_THREADS * LIGHTS_PER_THREAD;
+
+/** Applies the commands on the consumer thread and counts commands in wrong order. */
+class SlotConsumer
+{
+public:
+    void operator()(LightCommandBuffer::Command& cmd)
+    {
+        RPLight* light = cmd.light;
+        switch (cmd.type)
+        {
+        case LightCommandBuffer::CommandType::ADD:
+        {
+            int slot;
+            if (light->has_slot() || !slots_.find_slot(slot))
+            {
+                ++num_invalid_;
+                break;
+            }
+            light->assign_slot(slot);
+            slots_.reserve_slot(slot, light);
+            break;
+        }
+
+        case LightCommandBuffer::CommandType::REMOVE:
+            if (!light->has_slot())
+            {
+                ++num_invalid_;
+                break;
+            }
+            slots_.free_slot(light->get_slot());
+            light->remove_slot();
+            break;
+
+        case LightCommandBuffer::CommandType::UPDATE:
+            // updates are queued only for attached lights.
+            if (!light->has_slot())
+                ++num_invalid_;
+            if (cmd.update_function)
+                cmd.update_function(light);
+            break;
+        }
+    }
+
+    const PointerSlotStorage<RPLight*, MAX_SLOTS>& get_slots() const { return slots_; }
+    int get_num_invalid() const { return num_invalid_; }
+
+private:
+    PointerSlotStorage<RPLight*, MAX_SLOTS> slots_;
+    int num_invalid_ = 0;
+};
+
+struct ProducerState
+{
+    std::vector<PT(RPLight)> lights;
+    std::vector<bool> attached;
+    std::vector<LVecBase3f> positions;
+    size_t num_pushed = 0;
+};
+
+void produce(LightCommandBuffer& buffer, int thread_index, ProducerState& state)
+{
+    for (int round = 0; round < NUM_ROUNDS; ++round)
+    {
+        for (int k = 0; k < LIGHTS_PER_THREAD; ++k)
+        {
+            RPLight* light = state.lights[k];
+            if (!state.attached[k])
+            {
+                buffer.push_add(light);
+                state.attached[k] = true;
+                ++state.num_pushed;
+            }
+
+            const LVecBase3f pos(static_cast<float>(thread_index), static_cast<float>(k), static_cast<float>(round));
+            buffer.push_update(light, [pos](RPLight* l) { l->set_pos(pos); });
+            state.positions[k] = pos;
+            ++state.num_pushed;
+
+            if ((round + k) % 3 == 0)
+            {
+                buffer.push_remove(light);
+                state.attached[k] = false;
+                ++state.num_pushed;
+            }
+        }
+    }
+}
+
+void test_stress()
+{
+    LightCommandBuffer buffer;
+    std::unique_ptr<SlotConsumer> consumer = std::make_unique<SlotConsumer>();
+
+    std::vector<ProducerState> states(NUM_THREADS);
+    for (auto& state: states)
+    {
+        for (int k = 0; k < LIGHTS_PER_THREAD; ++k)
+            state.lights.push_back(new RPPointLight);
+        state.attached.resize(LIGHTS_PER_THREAD, false);
+        state.positions.resize(LIGHTS_PER_THREAD);
+    }
+
+    std::atomic<int> num_running{ NUM_THREADS };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            produce(buffer, t, states[t]);
+            --num_running;
+        });
+    }
+
+    // drain concurrently with the producers, then once more after they are done.
+    size_t num_drained = 0;
+    while (num_running > 0)
+        num_drained += buffer.drain(*consumer);
+    for (auto& thread: threads)
+        thread.join();
+    num_drained += buffer.drain(*consumer);
+
+    size_t num_pushed = 0;
+    size_t num_attached = 0;
+    for (const auto& state: states)
+    {
+        num_pushed += state.num_pushed;
+        for (int k = 0; k < LIGHTS_PER_THREAD; ++k)
+        {
+            RPLight* light = state.lights[k];
+            RPTEST_CHECK(light->has_slot() == state.attached[k]);
+            if (light->has_slot())
+            {
+                RPTEST_CHECK(consumer->get_slots().begin()[light->get_slot()] == light);
+                ++num_attached;
+            }
+            RPTEST_CHECK(light->get_pos() == state.positions[k]);
+        }
+    }
+
+    RPTEST_CHECK(num_drained == num_pushed);
+    RPTEST_CHECK(buffer.get_num_pending() == 0);
+    RPTEST_CHECK(consumer->get_num_invalid() == 0);
+    RPTEST_CHECK(consumer->get_slots().get_num_entries() == num_attached);
+
+    // every used slot belongs to exactly one attached light.
+    size_t num_used_slots = 0;
+    for (RPLight* light: consumer->get_slots())
+    {
+        if (!light)
+            continue;
+        RPTEST_CHECK(light->has_slot());
+        ++num_used_slots;
+    }
+    RPTEST_CHECK(num_used_slots == num_attached);
+}
+
+void test_pending_commands_release_lights()
+{
+    PT(RPLight) light = new RPPointLight;
+    {
+        LightCommandBuffer buffer;
+        buffer.push_add(light);
+        buffer.push_update(light, [](RPLight*) {});
+        buffer.push_remove(light);
+        RPTEST_CHECK(buffer.get_num_pending() == 3);
+        RPTEST_CHECK(light->get_ref_count() == 4);
+    }
+    RPTEST_CHECK(light->get_ref_count() == 1);
+}
+
+}
+
+int main()
+{
+    test_stress();
+    test_pending_commands_release_lights();
+
+    return rptest::result();
+}
@@ -0,0 +1,375 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of LightDataCodec: round trip of the compact light, half float edge cases and the
+ * delta stream.
+ *
+ * Integers of the light data are stored as float values, because the tree is built with
+ * PACK_INT_AS_FLOAT 0.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <render_pipeline/rpcore/native/rp_light.h>
+#include <render_pipeline/rpcore/native/rp_point_light.h>
+#include <render_pipeline/rpcore/util/light_data_codec.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+using Record = std::array<float, LightDataCodec::LIGHT_DATA_STRIDE>;
+
+Record make_point_light(float x)
+{
+    Record record = {};
+    record[0] = static_cast<float>(RPLight::LT_point_light);
+    record[1] = -1.0f;
+    record[2] = 12.0f;
+    record[3] = x;
+    record[4] = -20.25f;
+    record[5] = 3.5f;
+    record[6] = 0.8f;
+    record[7] = 0.5f;
+    record[8] = 0.25f;
+    record[9] = 15.0f;
+    record[10] = 0.5f;
+    return record;
+}
+
+Record make_spot_light(const LVecBase3f& dir)
+{
+    Record record = {};
+    record[0] = static_cast<float>(RPLight::LT_spot_light);
+    record[1] = 3.0f;
+    record[2] = -1.0f;
+    record[3] = 1.0f;
+    record[4] = 2.0f;
+    record[5] = 3.0f;
+    record[6] = 20.0f;
+    record[7] = 10.0f;
+    record[8] = 1.0f;
+    record[9] = 30.0f;
+    record[10] = 0.8660254f;
+    record[11] = dir[0];
+    record[12] = dir[1];
+    record[13] = dir[2];
+    return record;
+}
+
+bool is_near(float a, float b, float tolerance)
+{
+    return std::abs(a - b) <= tolerance;
+}
+
+uint16_t half_round_trip(uint16_t value)
+{
+    return LightDataCodec::encode_half(LightDataCodec::decode_half(value));
+}
+
+void test_light_round_trip()
+{
+    const Record point = make_point_light(123.456f);
+    Record decoded;
+    LightDataCodec::decode(LightDataCodec::encode(point.data()), decoded.data());
+
+    // type, IES profile, shadow source and position are exact.
+    for (int k = 0; k < 6; ++k)
+        RPTEST_CHECK(decoded[k] == point[k]);
+
+    // RGB9E5 has 9 bits of mantissa for the largest component.
+    for (int k = 6; k < 9; ++k)
+        RPTEST_CHECK(is_near(decoded[k], point[k], 0.8f / 256.0f));
+
+    RPTEST_CHECK(decoded[9] == 15.0f);
+    RPTEST_CHECK(decoded[10] == 0.5f);
+    for (int k = 11; k < LightDataCodec::LIGHT_DATA_STRIDE; ++k)
+        RPTEST_CHECK(decoded[k] == 0.0f);
+
+    const LVecBase3f dir = LVecBase3f(0.3f, -0.4f, -0.8f).normalized();
+    const Record spot = make_spot_light(dir);
+    LightDataCodec::decode(LightDataCodec::encode(spot.data()), decoded.data());
+
+    for (int k = 0; k < 6; ++k)
+        RPTEST_CHECK(decoded[k] == spot[k]);
+    RPTEST_CHECK(is_near(decoded[6], 20.0f, 20.0f / 256.0f));
+    RPTEST_CHECK(is_near(decoded[10], 0.8660254f, 0.001f));
+    for (int k = 0; k < 3; ++k)
+        RPTEST_CHECK(is_near(decoded[11 + k], dir[k], 0.001f));
+
+    // every field of the compact light is re-encoded to the same words.
+    const LightDataCodec::CompactLight compact = LightDataCodec::encode(spot.data());
+    LightDataCodec::decode(compact, decoded.data());
+    RPTEST_CHECK(LightDataCodec::encode(decoded.data()) == compact);
+}
+
+void test_half()
+{
+    const float inf = std::numeric_limits<float>::infinity();
+
+    // NaN stays NaN, and infinity keeps the sign.
+    const uint16_t nan_half = LightDataCodec::encode_half(std::numeric_limits<float>::quiet_NaN());
+    RPTEST_CHECK((nan_half & 0x7C00) == 0x7C00 && (nan_half & 0x3FF) != 0);
+    RPTEST_CHECK(std::isnan(LightDataCodec::decode_half(nan_half)));
+    RPTEST_CHECK(LightDataCodec::encode_half(inf) == 0x7C00);
+    RPTEST_CHECK(LightDataCodec::encode_half(-inf) == 0xFC00);
+    RPTEST_CHECK(LightDataCodec::decode_half(0xFC00) == -inf);
+
+    // overflow goes to infinity. 65520 is the half way to the next power of two.
+    RPTEST_CHECK(LightDataCodec::encode_half(65504.0f) == 0x7BFF);
+    RPTEST_CHECK(LightDataCodec::encode_half(65519.0f) == 0x7BFF);
+    RPTEST_CHECK(LightDataCodec::encode_half(65520.0f) == 0x7C00);
+    RPTEST_CHECK(LightDataCodec::encode_half(1.0e6f) == 0x7C00);
+    RPTEST_CHECK(LightDataCodec::encode_half(-1.0e6f) == 0xFC00);
+
+    // subnormal and underflow, rounded to nearest even.
+    RPTEST_CHECK(LightDataCodec::encode_half(std::ldexp(1.0f, -14)) == 0x0400);
+    RPTEST_CHECK(LightDataCodec::encode_half(std::ldexp(1.0f, -24)) == 0x0001);
+    RPTEST_CHECK(LightDataCodec::encode_half(std::ldexp(1.0f, -25)) == 0x0000);
+    RPTEST_CHECK(LightDataCodec::encode_half(std::ldexp(3.0f, -25)) == 0x0002);
+    RPTEST_CHECK(LightDataCodec::encode_half(std::ldexp(1.0f, -26) * 3.0f) == 0x0001);
+    RPTEST_CHECK(LightDataCodec::encode_half(-std::ldexp(1.0f, -24)) == 0x8001);
+    RPTEST_CHECK(LightDataCodec::encode_half(1.0e-10f) == 0x0000);
+    RPTEST_CHECK(LightDataCodec::encode_half(-1.0e-10f) == 0x8000);
+    RPTEST_CHECK(LightDataCodec::decode_half(0x0001) == std::ldexp(1.0f, -24));
+    RPTEST_CHECK(LightDataCodec::decode_half(0x03FF) == std::ldexp(1023.0f, -24));
+
+    // normal, rounded to nearest even.
+    RPTEST_CHECK(LightDataCodec::encode_half(1.0f + std::ldexp(1.0f, -11)) == 0x3C00);
+    RPTEST_CHECK(LightDataCodec::encode_half(1.0f + std::ldexp(3.0f, -11)) == 0x3C02);
+    RPTEST_CHECK(LightDataCodec::encode_half(-2.0f) == 0xC000);
+
+    // every half except NaN survives the round trip.
+    for (uint32_t value = 0; value <= 0xFFFF; ++value)
+    {
+        const uint16_t half = static_cast<uint16_t>(value);
+        if ((half & 0x7C00) == 0x7C00 && (half & 0x3FF) != 0)
+            continue;
+        if (half_round_trip(half) != half)
+        {
+            RPTEST_CHECK(half_round_trip(half) == half);
+            break;
+        }
+    }
+}
+
+void test_rgb9e5_and_octahedral()
+{
+    std::mt19937 rng(57);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    for (int k = 0; k < 10000; ++k)
+    {
+        const LVecBase3f color(std::abs(dist(rng)) * 500.0f, std::abs(dist(rng)) * 50.0f, std::abs(dist(rng)));
+        const LVecBase3f decoded = LightDataCodec::decode_rgb9e5(LightDataCodec::encode_rgb9e5(color));
+        const float max_component = (std::max)({ color[0], color[1], color[2] });
+        for (int c = 0; c < 3; ++c)
+            RPTEST_CHECK(is_near(decoded[c], color[c], max_component / 256.0f));
+    }
+
+    RPTEST_CHECK(LightDataCodec::encode_rgb9e5(LVecBase3f(0.0f)) == 0);
+    RPTEST_CHECK(LightDataCodec::decode_rgb9e5(LightDataCodec::encode_rgb9e5(LVecBase3f(-1.0f, 0.0f, 0.0f))) == LVecBase3f(0.0f));
+
+    for (int k = 0; k < 10000; ++k)
+    {
+        const LVecBase3f dir = LVecBase3f(dist(rng), dist(rng), dist(rng)).normalized();
+        const LVecBase3f decoded = LightDataCodec::decode_octahedral(LightDataCodec::encode_octahedral(dir));
+        RPTEST_CHECK(dir.dot(decoded) > 0.99999f);
+    }
+
+    // axes, including the folded -z hemisphere.
+    const LVecBase3f axes[] = {
+        LVecBase3f(1, 0, 0), LVecBase3f(-1, 0, 0), LVecBase3f(0, 1, 0),
+        LVecBase3f(0, -1, 0), LVecBase3f(0, 0, 1), LVecBase3f(0, 0, -1),
+    };
+    for (const auto& axis: axes)
+        RPTEST_CHECK(axis.dot(LightDataCodec::decode_octahedral(LightDataCodec::encode_octahedral(axis))) > 0.99999f);
+}
+
+void test_delta()
+{
+    std::vector<float> light_data(LightDataCodec::LIGHT_DATA_STRIDE * 3, 0.0f);
+    const Record point = make_point_light(1.0f);
+    const Record spot = make_spot_light(LVecBase3f(0, 0, -1));
+    std::copy(point.begin(), point.end(), light_data.begin());
+    std::copy(spot.begin(), spot.end(), light_data.begin() + 2 * LightDataCodec::LIGHT_DATA_STRIDE);
+
+    LightDataCodec::DeltaEncoder encoder;
+    std::vector<LightDataCodec::CompactLight> lights;
+    std::vector<bool> present;
+
+    const auto check_state = [&]() {
+        const size_t count = light_data.size() / LightDataCodec::LIGHT_DATA_STRIDE;
+        for (size_t slot = 0; slot < count; ++slot)
+        {
+            const float* record = light_data.data() + slot * LightDataCodec::LIGHT_DATA_STRIDE;
+            const bool expected = record[0] != static_cast<float>(RPLight::LT_empty);
+            RPTEST_CHECK((slot < present.size() && present[slot]) == expected);
+            if (expected && slot < lights.size())
+                RPTEST_CHECK(lights[slot] == LightDataCodec::encode(record));
+        }
+    };
+
+    // new lights write every word.
+    encoder.update_all(light_data);
+    RPTEST_CHECK(encoder.get_num_entries() == 2);
+    RPTEST_CHECK(encoder.get_stream().size() == 2 * (1 + LightDataCodec::COMPACT_LIGHT_WORDS));
+    RPTEST_CHECK(LightDataCodec::apply_delta(encoder.get_stream(), lights, present));
+    check_state();
+
+    // unchanged lights write nothing.
+    encoder.clear_stream();
+    encoder.update_all(light_data);
+    RPTEST_CHECK(encoder.get_stream().empty());
+
+    // moving a light only writes the changed position word.
+    light_data[4] += 1.0f;
+    encoder.update_all(light_data);
+    RPTEST_CHECK(encoder.get_num_entries() == 1);
+    RPTEST_CHECK(encoder.get_stream().size() == 2);
+    RPTEST_CHECK(encoder.get_stream()[0] == ((1u << 2) << LightDataCodec::DELTA_WORDS_SHIFT));
+    RPTEST_CHECK(LightDataCodec::apply_delta(encoder.get_stream(), lights, present));
+    check_state();
+
+    // removal and re-adding in the same slot.
+    encoder.clear_stream();
+    light_data[0] = static_cast<float>(RPLight::LT_empty);
+    encoder.update_all(light_data);
+    RPTEST_CHECK(encoder.get_stream().size() == 1);
+    RPTEST_CHECK((encoder.get_stream()[0] & LightDataCodec::DELTA_REMOVE_BIT) != 0);
+    RPTEST_CHECK(LightDataCodec::apply_delta(encoder.get_stream(), lights, present));
+    check_state();
+
+    encoder.clear_stream();
+    light_data[0] = static_cast<float>(RPLight::LT_point_light);
+    encoder.update_all(light_data);
+    RPTEST_CHECK(encoder.get_stream().size() == 1 + LightDataCodec::COMPACT_LIGHT_WORDS);
+    RPTEST_CHECK(LightDataCodec::apply_delta(encoder.get_stream(), lights, present));
+    check_state();
+
+    // random updates of many lights.
+    std::mt19937 rng(75);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    std::uniform_int_distribution<int> field(3, 10);
+    light_data.assign(LightDataCodec::LIGHT_DATA_STRIDE * 64, 0.0f);
+    for (int frame = 0; frame < 50; ++frame)
+    {
+        for (int k = 0; k < 16; ++k)
+        {
+            const size_t slot = static_cast<size_t>(std::abs(dist(rng))) % 64;
+            float* record = light_data.data() + slot * LightDataCodec::LIGHT_DATA_STRIDE;
+            if (record[0] == static_cast<float>(RPLight::LT_empty))
+            {
+                const Record light = make_point_light(dist(rng));
+                std::copy(light.begin(), light.end(), record);
+            }
+            else if (k % 5 == 0)
+            {
+                record[0] = static_cast<float>(RPLight::LT_empty);
+            }
+            else
+            {
+                record[field(rng)] = std::abs(dist(rng));
+            }
+        }
+
+        encoder.clear_stream();
+        encoder.update_all(light_data);
+        RPTEST_CHECK(LightDataCodec::apply_delta(encoder.get_stream(), lights, present));
+        check_state();
+    }
+
+    // reset writes every light again.
+    encoder.reset();
+    encoder.update_all(light_data);
+    std::vector<LightDataCodec::CompactLight> fresh_lights;
+    std::vector<bool> fresh_present;
+    RPTEST_CHECK(LightDataCodec::apply_delta(encoder.get_stream(), fresh_lights, fresh_present));
+    lights.swap(fresh_lights);
+    present.swap(fresh_present);
+    check_state();
+}
+
+void test_point_light_shadow_mode()
+{
+    // the shadow mode of point light is in word 6.
+    Record point = make_point_light(1.0f);
+    point[11] = static_cast<float>(RPPointLight::SM_tetrahedral);
+    Record decoded;
+    LightDataCodec::decode(LightDataCodec::encode(point.data()), decoded.data());
+    RPTEST_CHECK(decoded[11] == static_cast<float>(RPPointLight::SM_tetrahedral));
+
+    point[11] = static_cast<float>(RPPointLight::SM_cube);
+    LightDataCodec::decode(LightDataCodec::encode(point.data()), decoded.data());
+    RPTEST_CHECK(decoded[11] == static_cast<float>(RPPointLight::SM_cube));
+
+    // changing only the shadow mode writes only word 6.
+    LightDataCodec::DeltaEncoder encoder;
+    std::vector<LightDataCodec::CompactLight> lights;
+    std::vector<bool> present;
+    encoder.update(0, point.data());
+    RPTEST_CHECK(LightDataCodec::apply_delta(encoder.get_stream(), lights, present));
+
+    encoder.clear_stream();
+    point[11] = static_cast<float>(RPPointLight::SM_tetrahedral);
+    encoder.update(0, point.data());
+    RPTEST_CHECK(encoder.get_stream().size() == 2);
+    RPTEST_CHECK(encoder.get_stream()[0] == ((1u << 6) << LightDataCodec::DELTA_WORDS_SHIFT));
+    RPTEST_CHECK(LightDataCodec::apply_delta(encoder.get_stream(), lights, present));
+
+    LightDataCodec::decode(lights[0], decoded.data());
+    RPTEST_CHECK(decoded[11] == static_cast<float>(RPPointLight::SM_tetrahedral));
+}
+
+void test_malformed_delta()
+{
+    std::vector<LightDataCodec::CompactLight> lights;
+    std::vector<bool> present;
+
+    // new light without all words.
+    RPTEST_CHECK(!LightDataCodec::apply_delta({ 0u | (1u << LightDataCodec::DELTA_WORDS_SHIFT), 0u }, lights, present));
+
+    // truncated entry.
+    RPTEST_CHECK(!LightDataCodec::apply_delta({ 0u | (LightDataCodec::DELTA_ALL_WORDS << LightDataCodec::DELTA_WORDS_SHIFT), 0u, 0u }, lights, present));
+
+    // removal with words.
+    RPTEST_CHECK(!LightDataCodec::apply_delta({ 0u | LightDataCodec::DELTA_REMOVE_BIT | (1u << LightDataCodec::DELTA_WORDS_SHIFT) }, lights, present));
+}
+
+}
+
+int main()
+{
+    test_light_round_trip();
+    test_half();
+    test_rgb9e5_and_octahedral();
+    test_delta();
+    test_point_light_shadow_mode();
+    test_malformed_delta();
+
+    return rptest::result();
+}
@@ -0,0 +1,154 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * CPU tests of OcclusionCuller: depth pyramid, occluder rasterization and occludee visibility.
+ *
+ * The view-projection is the identity, so world x, y map to the screen and world z maps to
+ * depth z * 0.5 + 0.5.
+ */
+
+#include <cardMaker.h>
+
+#include <cmath>
+
+#include <render_pipeline/rpcore/util/occlusion_culler.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+void test_pyramid()
+{
+    // farthest depth of each 2x2 block is the block index / 10.
+    const std::vector<float> depth = {
+        0.0f, 0.1f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.2f, 0.0f,
+        0.3f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.4f,
+    };
+
+    OcclusionCuller::DepthPyramid pyramid;
+    pyramid.build(depth.data(), 4, 4);
+
+    RPTEST_CHECK(pyramid.get_num_levels() == 3);
+    RPTEST_CHECK(pyramid.get_size(1) == LVecBase2i(2, 2));
+    RPTEST_CHECK(pyramid.get_depth(1, 0, 0) == 0.1f);
+    RPTEST_CHECK(pyramid.get_depth(1, 1, 0) == 0.2f);
+    RPTEST_CHECK(pyramid.get_depth(1, 0, 1) == 0.3f);
+    RPTEST_CHECK(pyramid.get_depth(1, 1, 1) == 0.4f);
+    RPTEST_CHECK(pyramid.get_depth(2, 0, 0) == 0.4f);
+
+    // the rectangle should be covered conservatively.
+    RPTEST_CHECK(pyramid.get_max_depth(0, 0, 1, 1) >= 0.1f);
+    RPTEST_CHECK(pyramid.get_max_depth(0, 0, 3, 3) == 0.4f);
+
+    // odd sizes keep the last row and column.
+    const std::vector<float> odd = { 0.0f, 0.0f, 0.9f };
+    pyramid.build(odd.data(), 3, 1);
+    RPTEST_CHECK(pyramid.get_size(1) == LVecBase2i(2, 1));
+    RPTEST_CHECK(pyramid.get_depth(1, 1, 0) == 0.9f);
+}
+
+void test_rasterizer()
+{
+    OcclusionCuller::SoftwareRasterizer rasterizer;
+    rasterizer.clear(8, 8);
+
+    // full screen quad at z = 0 (depth 0.5) and a nearer quad on the left half.
+    const std::vector<LPoint3f> vertices = {
+        LPoint3f(-1, -1, 0), LPoint3f(1, -1, 0), LPoint3f(1, 1, 0), LPoint3f(-1, 1, 0),
+        LPoint3f(-1, -1, -0.5f), LPoint3f(0, -1, -0.5f), LPoint3f(0, 1, -0.5f), LPoint3f(-1, 1, -0.5f),
+    };
+    const std::vector<int> indices = { 0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7 };
+    rasterizer.rasterize(LMatrix4f::ident_mat(), vertices, indices);
+
+    const std::vector<float>& depth = rasterizer.get_depth();
+    bool covered = true;
+    for (int y = 0; y < 8; ++y)
+    {
+        for (int x = 0; x < 8; ++x)
+        {
+            const float expected = x < 4 ? 0.25f : 0.5f;
+            covered = covered && std::abs(depth[y * 8 + x] - expected) < 1e-5f;
+        }
+    }
+    RPTEST_CHECK(covered);
+
+    // triangles crossing the near plane are skipped.
+    LMatrix4f behind = LMatrix4f::ident_mat();
+    behind.set_cell(3, 3, -1.0f);
+    rasterizer.clear(8, 8);
+    rasterizer.rasterize(behind, vertices, indices);
+    RPTEST_CHECK(rasterizer.get_depth()[0] == 1.0f);
+}
+
+void test_occlusion()
+{
+    const std::vector<float> depth(16 * 16, 0.5f);
+
+    OcclusionCuller culler;
+    culler.set_depth_buffer(depth.data(), 16, 16, LMatrix4f::ident_mat());
+
+    // behind, in front of, and crossing the depth buffer.
+    RPTEST_CHECK(culler.is_occluded(LPoint3f(-0.5f, -0.5f, 0.2f), LPoint3f(0.5f, 0.5f, 0.4f)));
+    RPTEST_CHECK(!culler.is_occluded(LPoint3f(-0.5f, -0.5f, -0.5f), LPoint3f(0.5f, 0.5f, -0.2f)));
+    RPTEST_CHECK(!culler.is_occluded(LPoint3f(-0.5f, -0.5f, -0.2f), LPoint3f(0.5f, 0.5f, 0.4f)));
+
+    // outside of the view is left to the frustum culling.
+    RPTEST_CHECK(!culler.is_occluded(LPoint3f(2, 2, 0.2f), LPoint3f(3, 3, 0.4f)));
+
+    // occludee is hidden from the tested mask only, and shown again when it gets visible.
+    NodePath root("root");
+    CardMaker maker("card");
+    maker.set_frame(-0.2f, 0.2f, -0.2f, 0.2f);
+    NodePath card = root.attach_new_node(maker.generate());
+    card.set_pos(0, 0, 0.5f);
+    culler.add_occludee(card);
+
+    const BitMask32 mask = BitMask32::bit(3);
+    culler.begin_cull();
+    culler.test_view(mask);
+    culler.end_cull();
+    RPTEST_CHECK(culler.get_num_occluded() == 1);
+    RPTEST_CHECK(card.is_hidden(mask));
+    RPTEST_CHECK(!card.is_hidden(BitMask32::bit(4)));
+
+    card.set_pos(0, 0, 0);
+    culler.begin_cull();
+    culler.test_view(mask);
+    culler.end_cull();
+    RPTEST_CHECK(culler.get_num_occluded() == 0);
+    RPTEST_CHECK(!card.is_hidden(mask));
+}
+
+}
+
+int main()
+{
+    test_pyramid();
+    test_rasterizer();
+    test_occlusion();
+
+    return rptest::result();
+}
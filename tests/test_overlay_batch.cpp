@@ -0,0 +1,191 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Headless tests of OverlayBatch: the text layout with a stub glyph lookup,
+ * the batching by glyph state, and the skipped updates of unchanged text.
+ */
+
+#include <colorAttrib.h>
+
+#include <cmath>
+
+#include <render_pipeline/rpcore/gui/overlay_batch.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+using Align = OverlayBatch::Align;
+
+const float LINE_HEIGHT = 1.5f;
+const LVecBase2f POS(10, 20);
+const float SIZE = 2;
+
+/** 'a' and 'b' are on different pages, ' ' has no quad, and other characters are missing. */
+OverlayBatch::GlyphLookup make_lookup()
+{
+    const CPT(RenderState) page_a = RenderState::make(ColorAttrib::make_flat(LColor(1, 0, 0, 1)));
+    const CPT(RenderState) page_b = RenderState::make(ColorAttrib::make_flat(LColor(0, 1, 0, 1)));
+
+    return [page_a, page_b](int character, OverlayBatch::Glyph& glyph) {
+        glyph.advance = 1.0f;
+        glyph.dimensions = LVecBase4f(0.1f, -0.2f, 0.9f, 0.8f);
+        glyph.texcoords = LVecBase4f(0, 0, 1, 1);
+        switch (character)
+        {
+        case 'a':
+            glyph.has_quad = true;
+            glyph.state = page_a;
+            return true;
+        case 'b':
+            glyph.has_quad = true;
+            glyph.state = page_b;
+            return true;
+        case ' ':
+            glyph.has_quad = false;
+            glyph.advance = 0.5f;
+            return true;
+        default:
+            return false;
+        }
+    };
+}
+
+bool is_near(float a, float b)
+{
+    return std::abs(a - b) < 1e-5f;
+}
+
+std::vector<OverlayBatch::BatchQuad> layout(const std::wstring& text, Align align)
+{
+    std::vector<OverlayBatch::BatchQuad> quads;
+    OverlayBatch::layout_text(text, make_lookup(), LINE_HEIGHT, align, POS, SIZE, LColorf(1), quads);
+    return quads;
+}
+
+void test_alignment()
+{
+    // left: the line starts at the position.
+    auto quads = layout(L"ab", Align::left);
+    RPTEST_CHECK(quads.size() == 2);
+    RPTEST_CHECK(is_near(quads[0].second.dimensions[0], 10.2f) && is_near(quads[0].second.dimensions[2], 11.8f));
+    RPTEST_CHECK(is_near(quads[1].second.dimensions[0], 12.2f) && is_near(quads[1].second.dimensions[2], 13.8f));
+    RPTEST_CHECK(is_near(quads[0].second.dimensions[1], 19.6f) && is_near(quads[0].second.dimensions[3], 21.6f));
+
+    // right: the line (2 advances * size) ends at the position.
+    quads = layout(L"ab", Align::right);
+    RPTEST_CHECK(quads.size() == 2);
+    RPTEST_CHECK(is_near(quads[0].second.dimensions[0], 6.2f));
+    RPTEST_CHECK(is_near(quads[1].second.dimensions[2], 9.8f));
+
+    // center
+    quads = layout(L"ab", Align::center);
+    RPTEST_CHECK(quads.size() == 2);
+    RPTEST_CHECK(is_near(quads[0].second.dimensions[0], 8.2f));
+    RPTEST_CHECK(is_near(quads[1].second.dimensions[2], 11.8f));
+
+    // a space advances without a quad, and a missing glyph neither advances nor has a quad.
+    std::vector<OverlayBatch::BatchQuad> out;
+    RPTEST_CHECK(OverlayBatch::layout_text(L"a b", make_lookup(), LINE_HEIGHT, Align::left, POS, SIZE, LColorf(1), out) == 2);
+    RPTEST_CHECK(out.size() == 2 && is_near(out[1].second.dimensions[0], 13.2f));
+
+    out.clear();
+    RPTEST_CHECK(OverlayBatch::layout_text(L"a?b", make_lookup(), LINE_HEIGHT, Align::left, POS, SIZE, LColorf(1), out) == 2);
+    RPTEST_CHECK(out.size() == 2 && is_near(out[1].second.dimensions[0], 12.2f));
+}
+
+void test_newlines()
+{
+    // each line goes down by line height * size, and is aligned on its own.
+    auto quads = layout(L"ab\nb", Align::right);
+    RPTEST_CHECK(quads.size() == 3);
+    RPTEST_CHECK(is_near(quads[2].second.dimensions[1], 20.0f - 3.0f - 0.4f));
+    RPTEST_CHECK(is_near(quads[2].second.dimensions[0], 8.2f));
+    RPTEST_CHECK(is_near(quads[2].second.dimensions[2], 9.8f));
+
+    // empty lines keep their height.
+    quads = layout(L"\n\na", Align::left);
+    RPTEST_CHECK(quads.size() == 1);
+    RPTEST_CHECK(is_near(quads[0].second.dimensions[1], 20.0f - 6.0f - 0.4f));
+    RPTEST_CHECK(is_near(quads[0].second.dimensions[0], 10.2f));
+
+    RPTEST_CHECK(layout(L"a\n", Align::left).size() == 1);
+    RPTEST_CHECK(layout(L"", Align::left).empty());
+}
+
+void test_batches()
+{
+    RPTEST_CHECK(OverlayBatch::count_batches(layout(L"", Align::left)) == 0);
+    RPTEST_CHECK(OverlayBatch::count_batches(layout(L"aaa", Align::left)) == 1);
+    RPTEST_CHECK(OverlayBatch::count_batches(layout(L"abab\nba", Align::left)) == 2);
+
+    // sprites are batched by the texture in each layer.
+    PT(Texture) tex_a = new Texture("a");
+    PT(Texture) tex_b = new Texture("b");
+
+    OverlayBatch batch(NodePath("root"), nullptr);
+    batch.add_sprite(tex_a, LVecBase2f(0, 0), LVecBase2f(1, 1));
+    batch.add_sprite(tex_a, LVecBase2f(2, 0), LVecBase2f(1, 1));
+    batch.add_sprite(tex_b, LVecBase2f(4, 0), LVecBase2f(1, 1));
+    batch.add_sprite(tex_a, LVecBase2f(6, 0), LVecBase2f(1, 1), LColorf(1), 1);
+    batch.update();
+    RPTEST_CHECK(batch.get_num_draw_calls() == 3);
+}
+
+void test_skipped_updates()
+{
+    OverlayBatch batch(NodePath("root"), nullptr);
+    const auto handle = batch.add_text("fps", LVecBase2f(0, 0), 1.0f);
+    batch.update();
+    RPTEST_CHECK(batch.get_num_item_regenerations() == 1);
+    RPTEST_CHECK(batch.get_num_layer_regenerations() == 1);
+
+    // the same text does not mark the item dirty.
+    batch.reset_counters();
+    batch.set_text(handle, "fps");
+    batch.set_text(handle, "fps");
+    batch.update();
+    RPTEST_CHECK(batch.get_num_skipped_updates() == 2);
+    RPTEST_CHECK(batch.get_num_item_regenerations() == 0);
+    RPTEST_CHECK(batch.get_num_layer_regenerations() == 0);
+
+    batch.set_text(handle, "60 fps");
+    batch.update();
+    RPTEST_CHECK(batch.get_text(handle) == "60 fps");
+    RPTEST_CHECK(batch.get_num_skipped_updates() == 2);
+    RPTEST_CHECK(batch.get_num_item_regenerations() == 1);
+    RPTEST_CHECK(batch.get_num_layer_regenerations() == 1);
+}
+
+}
+
+int main()
+{
+    test_alignment();
+    test_newlines();
+    test_batches();
+    test_skipped_updates();
+
+    return rptest::result();
+}
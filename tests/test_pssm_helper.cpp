@@ -0,0 +1,149 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Test of PSSMHelper::find_projection_mat against the previous solver, which solved
+ * the dense 32x16 system of all matrix coefficients.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <Eigen/Dense>
+
+#include <render_pipeline/rpcore/native/pssm_helper.h>
+
+#include "rptest.hpp"
+
+namespace {
+
+const LVector4f expected_points[8] = {
+    LVector4f(-1,  1, 0, 1),
+    LVector4f( 1,  1, 0, 1),
+    LVector4f(-1, -1, 0, 1),
+    LVector4f( 1, -1, 0, 1),
+    LVector4f(-1,  1, 1, 1),
+    LVector4f( 1,  1, 1, 1),
+    LVector4f(-1, -1, 1, 1),
+    LVector4f( 1, -1, 1, 1),
+};
+
+/** The previous implementation of find_projection_mat. */
+LMatrix4f find_projection_mat_reference(const LVector4f points[8])
+{
+    // We have 8*4 = 32 equations, which require 16 coefficients each
+    Eigen::MatrixXf equation_system(32, 16);
+    Eigen::VectorXf equation_results(32);
+    equation_system.fill(0);
+
+    for (int k = 0; k < 8; ++k)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+                equation_system(k * 4 + row, row * 4 + col) = points[k].get_cell(col);
+            equation_results(k * 4 + row) = expected_points[k].get_cell(row);
+        }
+    }
+
+    Eigen::VectorXf solved_system = equation_system.colPivHouseholderQr().solve(equation_results);
+
+    return LMatrix4f(
+        solved_system(0), solved_system(4), solved_system(8),  solved_system(12),
+        solved_system(1), solved_system(5), solved_system(9),  solved_system(13),
+        solved_system(2), solved_system(6), solved_system(10), solved_system(14),
+        solved_system(3), solved_system(7), solved_system(11), solved_system(15));
+}
+
+/** Random rotated frustum with a tapered far plane, like the frustum of a split. */
+void make_frustum(std::mt19937& rng, LVector4f points[8])
+{
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    const Eigen::Matrix3f rotation = Eigen::Quaternionf(
+        Eigen::Vector4f(dist(rng), dist(rng), dist(rng), dist(rng)).normalized()).toRotationMatrix();
+    const Eigen::Vector3f center(dist(rng) * 500, dist(rng) * 500, dist(rng) * 500);
+    const Eigen::Vector3f extent(
+        5 + std::abs(dist(rng)) * 200,
+        5 + std::abs(dist(rng)) * 200,
+        5 + std::abs(dist(rng)) * 500);
+    const float taper = 1.0f + 0.3f * dist(rng);
+
+    // same order as expected_points: ul, ur, ll, lr of the near and the far plane
+    int k = 0;
+    for (int z = 0; z < 2; ++z)
+    {
+        const float scale = z ? taper : 1.0f;
+        for (int y: { 1, -1 })
+        {
+            for (int x: { -1, 1 })
+            {
+                const Eigen::Vector3f p = center + rotation * Eigen::Vector3f(
+                    x * extent.x() * scale, z * extent.z(), y * extent.y() * scale);
+                points[k++] = LVector4f(p.x(), p.y(), p.z(), 1);
+            }
+        }
+    }
+}
+
+void test_reference()
+{
+    std::mt19937 rng(7);
+
+    float max_rel_diff = 0;
+    for (int iteration = 0; iteration < 1000; ++iteration)
+    {
+        LVector4f points[8];
+        make_frustum(rng, points);
+
+        const LMatrix4f reference = find_projection_mat_reference(points);
+        const LMatrix4f result = PSSMHelper::find_projection_mat(
+            points[0], points[1], points[2], points[3],
+            points[4], points[5], points[6], points[7]);
+
+        float max_diff = 0;
+        float max_coeff = 0;
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                max_diff = (std::max)(max_diff, std::abs(result.get_cell(row, col) - reference.get_cell(row, col)));
+                max_coeff = (std::max)(max_coeff, std::abs(reference.get_cell(row, col)));
+            }
+        }
+        max_rel_diff = (std::max)(max_rel_diff, max_diff / max_coeff);
+    }
+
+    if (max_rel_diff > 1e-3f)
+        std::cerr << "max relative difference: " << max_rel_diff << std::endl;
+    RPTEST_CHECK(max_rel_diff <= 1e-3f);
+}
+
+}
+
+int main()
+{
+    test_reference();
+
+    return rptest::result();
+}
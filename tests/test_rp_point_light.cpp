@@ -0,0 +1,180 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of the shadow faces of RPPointLight.
+ *
+ * find_shadow_face has to choose the same face as the lighting shader
+ * (get_pointlight_source_offs and get_pointlight_tetrahedral_source_offs in
+ * lighting_pipeline.inc.glsl), and the frustum of the chosen face has to contain
+ * the direction. Otherwise, a surface samples a shadow map which was not rendered
+ * in its direction.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <render_pipeline/rpcore/native/rp_point_light.h>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+/** Same with get_pointlight_source_offs in GLSL. */
+size_t glsl_cube_face(const LVecBase3f& direction)
+{
+    const LVecBase3f abs_dir(std::abs(direction[0]), std::abs(direction[1]), std::abs(direction[2]));
+    const float max_comp = (std::max)({ abs_dir[0], abs_dir[1], abs_dir[2] });
+    if (abs_dir[0] >= max_comp - 1e-5f)
+        return direction[0] >= 0.0f ? 0 : 1;
+    if (abs_dir[1] >= max_comp - 1e-5f)
+        return direction[1] >= 0.0f ? 2 : 3;
+    return direction[2] >= 0.0f ? 4 : 5;
+}
+
+/** Same with get_pointlight_tetrahedral_source_offs in GLSL. */
+size_t glsl_tetrahedral_face(const LVecBase3f& direction)
+{
+    const float d[4] = {
+        direction[0] + direction[1] + direction[2],
+        direction[0] - direction[1] - direction[2],
+        -direction[0] + direction[1] - direction[2],
+        -direction[0] - direction[1] + direction[2],
+    };
+    size_t face = 0;
+    for (size_t k = 1; k < 4; ++k)
+    {
+        if (d[k] > d[face])
+            face = k;
+    }
+    return face;
+}
+
+/** Directions evenly distributed on the sphere, and the directions between the faces. */
+std::vector<LVecBase3f> make_directions()
+{
+    std::vector<LVecBase3f> directions;
+
+    const int count = 20000;
+    const double golden_angle = PI * (3.0 - std::sqrt(5.0));
+    for (int k = 0; k < count; ++k)
+    {
+        const double z = 1.0 - (k + 0.5) * 2.0 / count;
+        const double r = std::sqrt(1.0 - z * z);
+        const double phi = golden_angle * k;
+        directions.emplace_back(float(r * std::cos(phi)), float(r * std::sin(phi)), float(z));
+    }
+
+    // opposite of a tetrahedral face direction is the farthest from the other faces.
+    for (size_t face = 0; face < 4; ++face)
+        directions.push_back(-RPPointLight::get_shadow_face_direction(RPPointLight::SM_tetrahedral, face));
+
+    // corners and edges of the cube faces.
+    for (int x = -1; x <= 1; ++x)
+    {
+        for (int y = -1; y <= 1; ++y)
+        {
+            for (int z = -1; z <= 1; ++z)
+            {
+                if (x != 0 || y != 0 || z != 0)
+                    directions.push_back(LVecBase3f(float(x), float(y), float(z)).normalized());
+            }
+        }
+    }
+
+    return directions;
+}
+
+double get_angle_deg(const LVecBase3f& a, const LVecBase3f& b)
+{
+    const double cos_angle = double(a.dot(b)) / (double(a.length()) * double(b.length()));
+    return std::acos((std::min)(1.0, (std::max)(-1.0, cos_angle))) * 180.0 / PI;
+}
+
+void test_face_choice()
+{
+    for (const auto& direction: make_directions())
+    {
+        // GLSL prefers x, then y, within 1e-5, so nearly tied directions are compared only
+        // if they are exactly tied. Both faces cover such a direction.
+        LVecBase3f abs_dir(std::abs(direction[0]), std::abs(direction[1]), std::abs(direction[2]));
+        std::sort(&abs_dir[0], &abs_dir[0] + 3);
+        const float gap = abs_dir[2] - abs_dir[1];
+        if (gap == 0.0f || gap > 1e-4f)
+            RPTEST_CHECK(RPPointLight::find_shadow_face(RPPointLight::SM_cube, direction) == glsl_cube_face(direction));
+        RPTEST_CHECK(RPPointLight::find_shadow_face(RPPointLight::SM_tetrahedral, direction) == glsl_tetrahedral_face(direction));
+
+        // the length of the direction does not matter.
+        RPTEST_CHECK(RPPointLight::find_shadow_face(RPPointLight::SM_tetrahedral, direction * 7.5f) == glsl_tetrahedral_face(direction));
+    }
+}
+
+void test_tetrahedral_coverage()
+{
+    const auto mode = RPPointLight::SM_tetrahedral;
+    const double half_fov = RPPointLight::get_shadow_face_fov(mode) * 0.5;
+
+    // every direction is within the cone of its face, and the cone is in the square frustum.
+    double max_angle = 0;
+    for (const auto& direction: make_directions())
+    {
+        const size_t face = RPPointLight::find_shadow_face(mode, direction);
+        max_angle = (std::max)(max_angle, get_angle_deg(direction, RPPointLight::get_shadow_face_direction(mode, face)));
+    }
+
+    const double expected_max_angle = std::acos(1.0 / 3.0) * 180.0 / PI;
+    RPTEST_CHECK(std::abs(max_angle - expected_max_angle) < 0.01);
+    RPTEST_CHECK(max_angle < half_fov);
+    RPTEST_CHECK(std::abs(half_fov - 72.03) < 0.01);
+}
+
+void test_cube_coverage()
+{
+    const auto mode = RPPointLight::SM_cube;
+    const double tan_half_fov = std::tan(RPPointLight::get_shadow_face_fov(mode) * 0.5 * PI / 180.0);
+
+    // faces are axis aligned square frustums, so both other axes are within the fov.
+    for (const auto& direction: make_directions())
+    {
+        const size_t face = RPPointLight::find_shadow_face(mode, direction);
+        const int axis = int(face / 2);
+        const double forward = direction[axis] * (face % 2 == 0 ? 1.0 : -1.0);
+        RPTEST_CHECK(forward > 0);
+        RPTEST_CHECK(std::abs(direction[(axis + 1) % 3]) <= forward * tan_half_fov);
+        RPTEST_CHECK(std::abs(direction[(axis + 2) % 3]) <= forward * tan_half_fov);
+    }
+}
+
+}
+
+int main()
+{
+    test_face_choice();
+    test_tetrahedral_coverage();
+    test_cube_coverage();
+
+    return rptest::result();
+}
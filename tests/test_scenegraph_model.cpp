@@ -0,0 +1,181 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Headless tests of ScenegraphModel of rpstat with a large scene graph.
+ *
+ * The rows are built only from expanded nodes, so the cost of a rebuild depends on
+ * the visible part of the graph and not on the number of nodes.
+ */
+
+#include <geomNode.h>
+#include <geomVertexData.h>
+
+#include "rpplugins/rpstat/src/scenegraph_model.hpp"
+
+#include "rptest.hpp"
+
+using namespace rpplugins;
+
+namespace {
+
+constexpr int NUM_CHILDREN = 100;
+constexpr int NUM_GRANDCHILDREN = 100;
+
+/** Create 1 + 100 + 100 * 100 nodes. */
+NodePath make_large_graph()
+{
+    NodePath root("root");
+    for (int i = 0; i < NUM_CHILDREN; ++i)
+    {
+        NodePath child = root.attach_new_node("child");
+        for (int j = 0; j < NUM_GRANDCHILDREN; ++j)
+            child.attach_new_node("grandchild");
+    }
+    return root;
+}
+
+void test_visible_rows()
+{
+    NodePath root = make_large_graph();
+
+    ScenegraphModel model;
+    model.set_root(root);
+    model.rebuild();
+    RPTEST_CHECK(model.get_rows().size() == 1);
+    RPTEST_CHECK(model.get_num_visited_nodes() == 1);
+    RPTEST_CHECK(model.get_rows()[0].has_children);
+
+    model.set_expanded(root, true);
+    model.rebuild();
+    RPTEST_CHECK(model.get_rows().size() == 1 + NUM_CHILDREN);
+    RPTEST_CHECK(model.get_num_visited_nodes() == 1 + NUM_CHILDREN);
+
+    // rows are in the depth-first order.
+    const NodePath child = root.get_child(3);
+    model.set_expanded(child, true);
+    model.rebuild();
+    const auto& rows = model.get_rows();
+    RPTEST_CHECK(rows.size() == 1 + NUM_CHILDREN + NUM_GRANDCHILDREN);
+    RPTEST_CHECK(rows[4].np == child);
+    RPTEST_CHECK(rows[4].depth == 1);
+    RPTEST_CHECK(rows[5].np == child.get_child(0));
+    RPTEST_CHECK(rows[5].depth == 2);
+    RPTEST_CHECK(!rows[5].has_children);
+    RPTEST_CHECK(rows[5 + NUM_GRANDCHILDREN].np == root.get_child(4));
+
+    // excluded node is hidden with its children.
+    model.set_excluded(child);
+    model.rebuild();
+    RPTEST_CHECK(model.get_rows().size() == NUM_CHILDREN);
+}
+
+void test_refresh()
+{
+    NodePath root = make_large_graph();
+
+    ScenegraphModel model;
+    model.set_root(root);
+    model.set_expanded(root, true);
+    model.set_refresh_interval(0.5);
+
+    RPTEST_CHECK(model.update(0.0));
+    RPTEST_CHECK(model.get_num_rebuilds() == 1);
+
+    // frames in the interval do not visit the graph.
+    for (int k = 1; k < 10; ++k)
+        RPTEST_CHECK(!model.update(k * 0.01));
+    RPTEST_CHECK(model.get_num_rebuilds() == 1);
+
+    // new node is shown after mark_dirty() without waiting for the interval.
+    root.attach_new_node("new-node");
+    RPTEST_CHECK(model.get_rows().size() == 1 + NUM_CHILDREN);
+    model.mark_dirty();
+    RPTEST_CHECK(model.update(0.2));
+    RPTEST_CHECK(model.get_rows().size() == 2 + NUM_CHILDREN);
+
+    RPTEST_CHECK(!model.update(0.5));
+    RPTEST_CHECK(model.update(0.8));
+    RPTEST_CHECK(model.get_num_rebuilds() == 3);
+}
+
+void test_geom_rows()
+{
+    NodePath root("root");
+    PT(GeomNode) geom_node = new GeomNode("geom");
+    for (int k = 0; k < 3; ++k)
+        geom_node->add_geom(new Geom(new GeomVertexData("vdata", GeomVertexFormat::get_v3(), Geom::UH_static)));
+    NodePath geom_np = root.attach_new_node(geom_node);
+    geom_np.attach_new_node("child");
+
+    ScenegraphModel model;
+    model.set_root(root);
+    model.set_expanded(root, true);
+    model.set_expanded(geom_np, true);
+    model.rebuild();
+
+    // children first, then the geoms.
+    const auto& rows = model.get_rows();
+    RPTEST_CHECK(rows.size() == 1 + 1 + 1 + 3);
+    RPTEST_CHECK(rows[1].np == geom_np && rows[1].geom_index == -1);
+    RPTEST_CHECK(rows[2].np == geom_np.get_child(0));
+    for (int k = 0; k < 3; ++k)
+    {
+        RPTEST_CHECK(rows[3 + k].np == geom_np);
+        RPTEST_CHECK(rows[3 + k].geom_index == k);
+        RPTEST_CHECK(rows[3 + k].depth == 2);
+    }
+}
+
+void test_detached_nodes()
+{
+    NodePath root = make_large_graph();
+    NodePath child = root.get_child(0);
+
+    ScenegraphModel model;
+    model.set_root(root);
+    model.set_expanded(root, true);
+    model.set_expanded(child, true);
+    model.rebuild();
+    RPTEST_CHECK(model.get_rows().size() == 1 + NUM_CHILDREN + NUM_GRANDCHILDREN);
+
+    // removed nodes are forgotten, so they are collapsed when attached again.
+    child.detach_node();
+    model.rebuild();
+    RPTEST_CHECK(model.get_rows().size() == NUM_CHILDREN);
+    RPTEST_CHECK(!model.is_expanded(child));
+
+    child.reparent_to(root);
+    model.rebuild();
+    RPTEST_CHECK(model.get_rows().size() == 1 + NUM_CHILDREN);
+}
+
+}
+
+int main()
+{
+    test_visible_rows();
+    test_refresh();
+    test_geom_rows();
+    test_detached_nodes();
+
+    return rptest::result();
+}
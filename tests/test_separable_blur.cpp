@@ -0,0 +1,126 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of the CPU parts of SeparableBlur: the generated kernel against the weights
+ * in "gaussian_weights.inc.glsl", and the depth and normal rejection.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <render_pipeline/rpcore/util/separable_blur.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+// copied from "resources/rpcore/shader/includes/gaussian_weights.inc.glsl"
+const std::vector<float> gaussian_weights_2 = { 0.97826491685f, 0.0108675415748f };
+const std::vector<float> gaussian_weights_4 = { 0.399050279652f, 0.242036229376f, 0.0540055826224f, 0.00443304817524f };
+const std::vector<float> gaussian_weights_7 = { 0.199675627498f, 0.176213122789f, 0.121109390075f, 0.0648251851385f,
+    0.0270231576029f, 0.00877313479159f, 0.00221819585465f };
+const std::vector<float> gaussian_weights_17 = { 0.0749475595843f, 0.0736416335058f, 0.0698588070848f, 0.0639809599576f,
+    0.0565733860467f, 0.0482953623493f, 0.0398043484331f, 0.0316728718988f, 0.0243319101415f, 0.0180466584178f,
+    0.0129225799304f, 0.0089337437364f, 0.00596279102016f, 0.00384235530188f, 0.00239043692594f, 0.00143578327773f,
+    0.000832592179972f };
+
+bool is_near(const std::vector<float>& a, const std::vector<float>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t k = 0; k < a.size(); ++k)
+    {
+        if (std::abs(a[k] - b[k]) > 1e-6f)
+            return false;
+    }
+    return true;
+}
+
+void test_gaussian_weights()
+{
+    RPTEST_CHECK(is_near(SeparableBlur::generate_gaussian_weights(2), gaussian_weights_2));
+    RPTEST_CHECK(is_near(SeparableBlur::generate_gaussian_weights(4), gaussian_weights_4));
+    RPTEST_CHECK(is_near(SeparableBlur::generate_gaussian_weights(7), gaussian_weights_7));
+    RPTEST_CHECK(is_near(SeparableBlur::generate_gaussian_weights(17), gaussian_weights_17));
+
+    RPTEST_CHECK(is_near(SeparableBlur::generate_gaussian_weights(1), { 1.0f }));
+
+    // the weights are decreasing, and the kernel (center + both sides) sums up to 1.
+    for (int size = 1; size <= SeparableBlur::MAX_KERNEL_SIZE; ++size)
+    {
+        const auto weights = SeparableBlur::generate_gaussian_weights(size);
+        double sum = weights[0];
+        bool decreasing = true;
+        for (int k = 1; k < size; ++k)
+        {
+            sum += 2 * weights[k];
+            decreasing = decreasing && weights[k] < weights[k - 1];
+        }
+        RPTEST_CHECK(std::abs(sum - 1.0) < 1e-6);
+        RPTEST_CHECK(decreasing);
+    }
+}
+
+void test_bilateral_weight()
+{
+    const LVecBase3f up(0, 0, 1);
+    const LVecBase3f side(1, 0, 0);
+    const LVecBase2f factors(1.0f, 1.0f);
+
+    // the same surface keeps the kernel weight.
+    RPTEST_CHECK(SeparableBlur::compute_bilateral_weight(0.25f, up, 0.5f, up, 0.5f, factors) == 0.25f);
+
+    // a perpendicular normal and a large depth difference are rejected.
+    RPTEST_CHECK(SeparableBlur::compute_bilateral_weight(0.25f, up, 0.5f, side, 0.5f, factors) == 0.0f);
+    RPTEST_CHECK(SeparableBlur::compute_bilateral_weight(0.25f, up, 0.5f, up, 0.9f, factors) == 0.0f);
+
+    // partial rejection is linear in the depth difference (times 3).
+    const float partial = SeparableBlur::compute_bilateral_weight(0.25f, up, 0.5f, up, 0.6f, factors);
+    RPTEST_CHECK(std::abs(partial - 0.25f * 0.7f) < 1e-6f);
+
+    // zero factors disable the rejection.
+    RPTEST_CHECK(SeparableBlur::compute_bilateral_weight(0.25f, up, 0.5f, side, 0.9f, LVecBase2f(0.0f)) == 0.25f);
+
+    // the rejection is symmetric.
+    RPTEST_CHECK(SeparableBlur::compute_bilateral_weight(0.25f, up, 0.5f, up, 0.6f, factors) ==
+        SeparableBlur::compute_bilateral_weight(0.25f, up, 0.6f, up, 0.5f, factors));
+}
+
+void test_dispatch_size()
+{
+    RPTEST_CHECK(SeparableBlur::get_dispatch_size(LVecBase2i(1920, 1080), true) == LVecBase3i(15, 1080, 1));
+    RPTEST_CHECK(SeparableBlur::get_dispatch_size(LVecBase2i(1920, 1080), false) == LVecBase3i(9, 1920, 1));
+    RPTEST_CHECK(SeparableBlur::get_dispatch_size(LVecBase2i(129, 1), true) == LVecBase3i(2, 1, 1));
+}
+
+}
+
+int main()
+{
+    test_gaussian_weights();
+    test_bilateral_weight();
+    test_dispatch_size();
+
+    return rptest::result();
+}
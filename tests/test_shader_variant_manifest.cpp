@@ -0,0 +1,181 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of ShaderVariantManifest without GPU: the manifest format, the diff of
+ * variants and the recording of effect variants.
+ */
+
+#include <render_pipeline/rpcore/util/shader_variant_manifest.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+using Variant = ShaderVariantManifest::Variant;
+
+Variant make_variant(const std::string& type, const std::vector<std::string>& sources,
+    const std::map<std::string, bool>& options={})
+{
+    Variant variant;
+    variant.type = type;
+    variant.sources = sources;
+    variant.options = options;
+    return variant;
+}
+
+bool is_equal(const Variant& a, const Variant& b)
+{
+    return a.type == b.type && a.sources == b.sources && a.options == b.options;
+}
+
+void test_round_trip()
+{
+    const std::vector<Variant> variants = {
+        make_variant("effect", { "/$$rp/effects/default.yaml" }, { { "alpha_testing", true }, { "parallax_mapping", false } }),
+        make_variant("stage", { "/$$rp/shader/default_post_process.vert.glsl", "/$$rp/shader/a b: c.frag.glsl" }),
+        make_variant("stage", { "/$$rp/shader/compute.compute.glsl" }),
+    };
+
+    std::vector<Variant> parsed;
+    RPTEST_CHECK(ShaderVariantManifest::parse(ShaderVariantManifest::serialize(variants), parsed));
+    RPTEST_CHECK(parsed.size() == variants.size());
+
+    bool same = parsed.size() == variants.size();
+    for (size_t k = 0; same && k < variants.size(); ++k)
+        same = is_equal(parsed[k], variants[k]);
+    RPTEST_CHECK(same);
+
+    // empty manifest
+    parsed.clear();
+    RPTEST_CHECK(ShaderVariantManifest::parse(ShaderVariantManifest::serialize({}), parsed));
+    RPTEST_CHECK(parsed.empty());
+}
+
+void test_malformed()
+{
+    std::vector<Variant> parsed;
+
+    // invalid content is rejected as a whole.
+    RPTEST_CHECK(!ShaderVariantManifest::parse("variants: [", parsed));
+    RPTEST_CHECK(!ShaderVariantManifest::parse("- type: stage", parsed));
+    RPTEST_CHECK(!ShaderVariantManifest::parse("variants: 3", parsed));
+    RPTEST_CHECK(!ShaderVariantManifest::parse("other: []", parsed));
+    RPTEST_CHECK(parsed.empty());
+
+    // invalid entries are skipped, and the valid entries are kept.
+    const std::string content =
+        "variants:\n"
+        "  - type: stage\n"
+        "    sources: [a.vert.glsl, a.frag.glsl]\n"
+        "  - sources: [no_type.frag.glsl]\n"
+        "  - type: stage\n"
+        "  - type: stage\n"
+        "    sources: []\n"
+        "  - type: effect\n"
+        "    sources: [bad_option.yaml]\n"
+        "    options: {alpha_testing: maybe}\n"
+        "  - type: effect\n"
+        "    sources: [{nested: map}]\n"
+        "  - 3\n"
+        "  - type: effect\n"
+        "    sources: [b.yaml]\n"
+        "    options: {normal_mapping: false}\n";
+    RPTEST_CHECK(ShaderVariantManifest::parse(content, parsed));
+    RPTEST_CHECK(parsed.size() == 2);
+    if (parsed.size() == 2)
+    {
+        RPTEST_CHECK(is_equal(parsed[0], make_variant("stage", { "a.vert.glsl", "a.frag.glsl" })));
+        RPTEST_CHECK(is_equal(parsed[1], make_variant("effect", { "b.yaml" }, { { "normal_mapping", false } })));
+    }
+}
+
+void test_diff()
+{
+    // the order of the options does not change the variant.
+    std::vector<Variant> base;
+    RPTEST_CHECK(ShaderVariantManifest::parse(
+        "variants:\n"
+        "  - type: effect\n"
+        "    sources: [a.yaml]\n"
+        "    options: {parallax_mapping: true, alpha_testing: false}\n"
+        "  - type: stage\n"
+        "    sources: [a.vert.glsl, a.frag.glsl]\n", base));
+
+    const std::vector<Variant> current = {
+        make_variant("effect", { "a.yaml" }, { { "alpha_testing", false }, { "parallax_mapping", true } }),
+        make_variant("effect", { "a.yaml" }, { { "alpha_testing", true }, { "parallax_mapping", true } }),
+        make_variant("stage", { "a.vert.glsl", "a.frag.glsl" }),
+        make_variant("stage", { "a.frag.glsl", "a.vert.glsl" }),
+    };
+
+    const auto missing = ShaderVariantManifest::diff(base, current);
+    RPTEST_CHECK(missing.size() == 2);
+    if (missing.size() == 2)
+    {
+        RPTEST_CHECK(is_equal(missing[0], current[1]));
+        RPTEST_CHECK(is_equal(missing[1], current[3]));
+    }
+
+    RPTEST_CHECK(ShaderVariantManifest::diff(current, base).empty());
+
+    // the report lists the enabled options in order.
+    RPTEST_CHECK(ShaderVariantManifest::make_report(missing) ==
+        "[effect] a.yaml (alpha_testing, parallax_mapping)\n"
+        "[stage] a.frag.glsl, a.vert.glsl\n");
+}
+
+void test_record()
+{
+    ShaderVariantManifest manifest("/$$rptemp/test_shader_variants.yaml");
+
+    // options are merged with the defaults, so explicit default values are the same variant.
+    manifest.record_effect("effects/a.yaml", {});
+    manifest.record_effect("effects/a.yaml", { { "normal_mapping", true } });
+    RPTEST_CHECK(manifest.get_recorded_variants().size() == 1);
+    RPTEST_CHECK(manifest.get_recorded_variants().front().options.size() == Effect::get_default_options().size());
+
+    manifest.record_effect("effects/a.yaml", { { "parallax_mapping", true } });
+    RPTEST_CHECK(manifest.get_recorded_variants().size() == 2);
+
+    // generated shaders are not recorded.
+    manifest.record_stage_shader({ "/$$rp/shader/a.vert.glsl", "/$$rptemp/generated.frag.glsl" });
+    manifest.record_stage_shader({ "/$$rp/shader/a.vert.glsl", "/$$rp/shader/a.frag.glsl" });
+    manifest.record_stage_shader({ "/$$rp/shader/a.vert.glsl", "/$$rp/shader/a.frag.glsl" });
+    RPTEST_CHECK(manifest.get_recorded_variants().size() == 3);
+
+    // nothing is loaded, so every recorded variant is missing.
+    RPTEST_CHECK(manifest.get_missing_variants().size() == 3);
+}
+
+}
+
+int main()
+{
+    test_round_trip();
+    test_malformed();
+    test_diff();
+    test_record();
+
+    return rptest::result();
+}
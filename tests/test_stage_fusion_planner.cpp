@@ -0,0 +1,115 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Tests of StageFusionPlanner: grouping of point-wise stages and the generated shader.
+ */
+
+#include <render_pipeline/rpcore/util/stage_fusion_planner.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+StageFusionPlanner::StageInfo pointwise(const std::string& id, bool active = true)
+{
+    return StageFusionPlanner::StageInfo{ id, true, active, { "ShadedScene" } };
+}
+
+void test_plan()
+{
+    const StageFusionPlanner planner;
+
+    const std::vector<StageFusionPlanner::StageInfo> stages = {
+        pointwise("A"),
+        pointwise("B"),
+        StageFusionPlanner::StageInfo{ "Blur", false, true, { "ShadedScene" } },
+        pointwise("C"),
+        StageFusionPlanner::StageInfo{ "Other", true, true, { "GBuffer" } },
+        pointwise("D"),
+        pointwise("E", false),
+        pointwise("F"),
+        pointwise("G"),
+        pointwise("H"),
+    };
+
+    // not point-wise, not reading the chain pipe, and inactive stages split the runs.
+    const auto groups = planner.plan(stages);
+    RPTEST_CHECK(groups.size() == 2);
+    RPTEST_CHECK(groups.size() > 0 && groups[0].begin == 0 && groups[0].end == 2);
+    RPTEST_CHECK(groups.size() > 1 && groups[1].begin == 7 && groups[1].end == 10);
+
+    RPTEST_CHECK(planner.plan({}).empty());
+    RPTEST_CHECK(planner.plan({ pointwise("A") }).empty());
+}
+
+void test_max_group_size()
+{
+    const StageFusionPlanner planner("ShadedScene", 3);
+
+    std::vector<StageFusionPlanner::StageInfo> stages;
+    for (int k = 0; k < 7; ++k)
+        stages.push_back(pointwise(std::to_string(k)));
+
+    // the last stage of the run is left alone.
+    const auto groups = planner.plan(stages);
+    RPTEST_CHECK(groups.size() == 2);
+    RPTEST_CHECK(groups.size() > 0 && groups[0].begin == 0 && groups[0].end == 3);
+    RPTEST_CHECK(groups.size() > 1 && groups[1].begin == 3 && groups[1].end == 6);
+
+    RPTEST_CHECK(StageFusionPlanner("ShadedScene", 0).get_max_group_size() == 2);
+}
+
+void test_shader()
+{
+    const StageFusionPlanner planner;
+    const std::string shader = planner.generate_fragment_shader({
+        { "/$$rp/a.inc.glsl", "apply_a" },
+        { "/$$rp/b.inc.glsl", "apply_b" },
+    });
+
+    const size_t include_a = shader.find("#pragma include \"/$$rp/a.inc.glsl\"");
+    const size_t include_b = shader.find("#pragma include \"/$$rp/b.inc.glsl\"");
+    const size_t call_a = shader.find("scene_color = apply_a(scene_color, texcoord);");
+    const size_t call_b = shader.find("scene_color = apply_b(scene_color, texcoord);");
+
+    RPTEST_CHECK(include_a != std::string::npos && include_b != std::string::npos);
+    RPTEST_CHECK(call_a != std::string::npos && call_b != std::string::npos);
+    RPTEST_CHECK(include_a < include_b && include_b < call_a && call_a < call_b);
+
+    // the chain pipe is sampled once.
+    const size_t first_sample = shader.find("textureLod(ShadedScene, texcoord, 0)");
+    RPTEST_CHECK(first_sample != std::string::npos);
+    RPTEST_CHECK(shader.find("textureLod(ShadedScene, texcoord, 0)", first_sample + 1) == std::string::npos);
+}
+
+}
+
+int main()
+{
+    test_plan();
+    test_max_group_size();
+    test_shader();
+
+    return rptest::result();
+}
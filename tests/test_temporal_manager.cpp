@@ -0,0 +1,234 @@
+/**
+ * Render Pipeline C++
+ *
+ * Copyright (c) 2018 Center of Human-centered Interaction for Coexistence.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * CPU tests of TemporalManager: Halton jitter, jitter removal with the film offset of a lens,
+ * the reprojection matrix and the matrix history.
+ */
+
+#include <perspectiveLens.h>
+
+#include <cmath>
+
+#include <render_pipeline/rpcore/temporal_manager.hpp>
+
+#include "rptest.hpp"
+
+using namespace rpcore;
+
+namespace {
+
+bool is_near(float a, float b, float tolerance)
+{
+    return std::abs(a - b) <= tolerance;
+}
+
+bool is_near(const LMatrix4f& a, const LMatrix4f& b, float tolerance)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            if (!is_near(a(i, j), b(i, j), tolerance))
+                return false;
+        }
+    }
+    return true;
+}
+
+LVecBase3f to_ndc(const LVecBase4f& clip)
+{
+    return clip.get_xyz() / clip[3];
+}
+
+/** View matrix of a camera at @p pos with @p hpr. */
+LMatrix4f make_view_mat(const LVecBase3f& pos, const LVecBase3f& hpr)
+{
+    LMatrix4f camera_mat;
+    compose_matrix(camera_mat, LVecBase3f(1.0f), LVecBase3f(0.0f), hpr, pos);
+    return invert(camera_mat);
+}
+
+LMatrix4f make_proj_mat(PerspectiveLens* lens)
+{
+    return LCAST(float, lens->get_projection_mat());
+}
+
+void test_halton()
+{
+    RPTEST_CHECK(TemporalManager::halton(1, 2) == 0.5f);
+    RPTEST_CHECK(TemporalManager::halton(2, 2) == 0.25f);
+    RPTEST_CHECK(TemporalManager::halton(3, 2) == 0.75f);
+    RPTEST_CHECK(is_near(TemporalManager::halton(1, 3), 1.0f / 3.0f, 1e-6f));
+    RPTEST_CHECK(is_near(TemporalManager::halton(2, 3), 2.0f / 3.0f, 1e-6f));
+    RPTEST_CHECK(is_near(TemporalManager::halton(3, 3), 1.0f / 9.0f, 1e-6f));
+    RPTEST_CHECK(is_near(TemporalManager::halton(4, 3), 4.0f / 9.0f, 1e-6f));
+    RPTEST_CHECK(TemporalManager::halton(0, 2) == 0.0f);
+
+    // the sequence skips (0, 0), and the points are distinct and in [0, 1).
+    const auto sequence = TemporalManager::generate_halton_sequence(16);
+    RPTEST_CHECK(sequence.size() == 16);
+    RPTEST_CHECK(sequence[0] == LVecBase2f(0.5f, TemporalManager::halton(1, 3)));
+    for (size_t i = 0; i < sequence.size(); ++i)
+    {
+        RPTEST_CHECK(sequence[i][0] >= 0.0f && sequence[i][0] < 1.0f);
+        RPTEST_CHECK(sequence[i][1] >= 0.0f && sequence[i][1] < 1.0f);
+        for (size_t j = 0; j < i; ++j)
+            RPTEST_CHECK(sequence[i] != sequence[j]);
+    }
+
+}
+
+void test_jitter_sequence()
+{
+    TemporalManager manager;
+    RPTEST_CHECK(manager.get_current_jitter() == LVecBase2f(0.0f));
+    manager.advance_jitter();
+    RPTEST_CHECK(manager.get_jitter_index() == 0);
+
+    manager.set_jitter_sequence({ LVecBase2f(1, 2), LVecBase2f(3, 4), LVecBase2f(5, 6) });
+    manager.set_jitter_scale(0.5f);
+    RPTEST_CHECK(manager.get_current_jitter() == LVecBase2f(0.5f, 1.0f));
+
+    manager.advance_jitter();
+    manager.advance_jitter();
+    RPTEST_CHECK(manager.get_jitter_index() == 2);
+    RPTEST_CHECK(manager.get_current_jitter() == LVecBase2f(2.5f, 3.0f));
+
+    // wraps around, and a new sequence starts from the beginning.
+    manager.advance_jitter();
+    RPTEST_CHECK(manager.get_jitter_index() == 0);
+    manager.advance_jitter();
+    manager.set_jitter_sequence({ LVecBase2f(7, 8) });
+    RPTEST_CHECK(manager.get_jitter_index() == 0);
+    RPTEST_CHECK(manager.get_current_jitter() == LVecBase2f(3.5f, 4.0f));
+}
+
+void test_remove_jitter()
+{
+    PT(PerspectiveLens) lens = new PerspectiveLens;
+    lens->set_fov(70.0f, 50.0f);
+    lens->set_near_far(0.1f, 500.0f);
+    const LMatrix4f proj_mat = make_proj_mat(lens);
+
+    const LVecBase2f film_offset(0.013f, -0.021f);
+    lens->set_film_offset(LCAST(PN_stdfloat, film_offset));
+    const LMatrix4f jittered_proj_mat = make_proj_mat(lens);
+    const LVecBase2f ndc_jitter = TemporalManager::film_offset_to_ndc(film_offset, LCAST(float, lens->get_film_size()));
+
+    // a point in front of the camera moves by the NDC jitter.
+    const LVecBase4f point(1.5f, 20.0f, -2.0f, 1.0f);
+    const LVecBase3f ndc = to_ndc(point * proj_mat);
+    const LVecBase3f jittered_ndc = to_ndc(point * jittered_proj_mat);
+    RPTEST_CHECK(is_near(jittered_ndc[0] - ndc[0], ndc_jitter[0], 1e-5f));
+    RPTEST_CHECK(is_near(jittered_ndc[1] - ndc[1], ndc_jitter[1], 1e-5f));
+    RPTEST_CHECK(is_near(jittered_ndc[2], ndc[2], 1e-5f));
+
+    RPTEST_CHECK(is_near(TemporalManager::remove_jitter(jittered_proj_mat, ndc_jitter), proj_mat, 1e-5f));
+}
+
+void test_reprojection()
+{
+    PT(PerspectiveLens) lens = new PerspectiveLens;
+    lens->set_fov(60.0f, 40.0f);
+    lens->set_near_far(0.1f, 500.0f);
+    const LMatrix4f proj_mat = make_proj_mat(lens);
+
+    const LVecBase2f prev_jitter(0.002f, -0.001f);
+    const LVecBase2f curr_jitter(-0.0015f, 0.0025f);
+    const LMatrix4f prev_view_mat = make_view_mat(LVecBase3f(0.0f, -10.0f, 2.0f), LVecBase3f(10.0f, -5.0f, 0.0f));
+    const LMatrix4f curr_view_mat = make_view_mat(LVecBase3f(0.5f, -9.0f, 2.2f), LVecBase3f(12.0f, -4.0f, 1.0f));
+
+    TemporalManager manager;
+    manager.begin_frame(prev_view_mat, proj_mat * LMatrix4f::translate_mat(prev_jitter[0], prev_jitter[1], 0.0f), prev_jitter);
+    RPTEST_CHECK(!manager.is_history_valid());
+    manager.begin_frame(curr_view_mat, proj_mat * LMatrix4f::translate_mat(curr_jitter[0], curr_jitter[1], 0.0f), curr_jitter);
+    RPTEST_CHECK(manager.is_history_valid());
+
+    RPTEST_CHECK(is_near(manager.get_current_frame().view_proj_mat_no_jitter, curr_view_mat * proj_mat, 1e-5f));
+    RPTEST_CHECK(is_near(manager.get_previous_frame().view_proj_mat_no_jitter, prev_view_mat * proj_mat, 1e-5f));
+
+    // a world point seen in the current frame lands where the previous frame saw it.
+    const LMatrix4f reprojection_mat = manager.get_reprojection_mat();
+    const LVecBase4f points[] = {
+        LVecBase4f(0.0f, 10.0f, 2.0f, 1.0f),
+        LVecBase4f(3.0f, 25.0f, -1.0f, 1.0f),
+        LVecBase4f(-4.0f, 60.0f, 8.0f, 1.0f),
+    };
+    for (const auto& point: points)
+    {
+        const LVecBase4f curr_clip = point * (curr_view_mat * proj_mat);
+        const LVecBase3f reprojected = to_ndc(curr_clip * reprojection_mat);
+        const LVecBase3f expected = to_ndc(point * (prev_view_mat * proj_mat));
+        for (int k = 0; k < 3; ++k)
+            RPTEST_CHECK(is_near(reprojected[k], expected[k], 1e-4f));
+    }
+
+    // a static camera reprojects to itself, even with a different jitter.
+    manager.begin_frame(curr_view_mat, proj_mat * LMatrix4f::translate_mat(prev_jitter[0], prev_jitter[1], 0.0f), prev_jitter);
+    RPTEST_CHECK(is_near(manager.get_reprojection_mat(), LMatrix4f::ident_mat(), 1e-4f));
+}
+
+void test_history()
+{
+    TemporalManager manager;
+    manager.set_history_length(1);
+    RPTEST_CHECK(manager.get_history_length() == 2);
+    manager.set_history_length(3);
+
+    const LMatrix4f proj_mat = LMatrix4f::ident_mat();
+    for (int k = 0; k < 5; ++k)
+        manager.begin_frame(make_view_mat(LVecBase3f(float(k), 0.0f, 0.0f), LVecBase3f(0.0f)), proj_mat, LVecBase2f(0.0f));
+
+    RPTEST_CHECK(manager.get_num_valid_frames() == 3);
+    RPTEST_CHECK(manager.get_frame(0).frame_index == 4);
+    RPTEST_CHECK(manager.get_frame(2).frame_index == 2);
+
+    // too old frames return the oldest valid frame.
+    RPTEST_CHECK(manager.get_frame(10).frame_index == 2);
+
+    manager.invalidate_history();
+    RPTEST_CHECK(!manager.is_history_valid());
+    manager.begin_frame(make_view_mat(LVecBase3f(5.0f, 0.0f, 0.0f), LVecBase3f(0.0f)), proj_mat, LVecBase2f(0.0f));
+    RPTEST_CHECK(manager.get_num_valid_frames() == 1);
+    RPTEST_CHECK(manager.get_previous_frame().frame_index == 5);
+
+    // camera cut.
+    manager.set_camera_cut_distance(2.0f);
+    manager.begin_frame(make_view_mat(LVecBase3f(6.0f, 0.0f, 0.0f), LVecBase3f(0.0f)), proj_mat, LVecBase2f(0.0f));
+    RPTEST_CHECK(manager.is_history_valid());
+    manager.begin_frame(make_view_mat(LVecBase3f(16.0f, 0.0f, 0.0f), LVecBase3f(0.0f)), proj_mat, LVecBase2f(0.0f));
+    RPTEST_CHECK(!manager.is_history_valid());
+    RPTEST_CHECK(manager.get_num_valid_frames() == 1);
+}
+
+}
+
+int main()
+{
+    test_halton();
+    test_jitter_sequence();
+    test_remove_jitter();
+    test_reprojection();
+    test_history();
+
+    return rptest::result();
+}